@@ -12,6 +12,7 @@
 #include "cinder/params/Params.h"
 
 #include "../../../_common/MiniConfig.h"
+#include "../../../_common/VoxelVolume.h"
 
 using namespace ci;
 using namespace ci::app;
@@ -33,19 +34,28 @@ struct CiApp : public AppBasic
         setupConfigUI(&mParams);
 
         mWorldTex = loadImage(loadAsset("texture.png"));
+        mWorldTex.setWrap(GL_REPEAT, GL_REPEAT);
 
-        for (int z = 0; z < kCellCount; z++)
+        mVolume = VoxelVolume(Vec3i(WORLD_SIZE, WORLD_SIZE, WORLD_SIZE), CELL_SIZE);
+        mChunkVbos.assign(mVolume.getChunkCount(), gl::VboMesh());
+
+        for (int z = 0; z < WORLD_SIZE; z++)
         {
-            for (int y = 0; y < kCellCount; y++)
+            for (int y = 0; y < WORLD_SIZE; y++)
             {
-                for (int x = 0; x < kCellCount; x++)
+                for (int x = 0; x < WORLD_SIZE; x++)
                 {
-                    float yd = (y - kCellCount * 0.5f + 0.5f) * 0.4;
-                    float zd = (z - kCellCount * 0.5f + 0.5f) * 0.4;
-                    mCells[z][y][x] = randInt(16);
+                    float yd = (y - WORLD_SIZE * 0.5f + 0.5f) * 0.4;
+                    float zd = (z - WORLD_SIZE * 0.5f + 0.5f) * 0.4;
+                    int idx = randInt(16);
                     if (randFloat() > math<float>::sqrt(math<float>::sqrt(yd * yd + zd * zd)) - 0.8f)
                     {
-                        mCells[z][y][x] = 0;
+                        idx = 0;
+                    }
+                    // only the last item is solid
+                    if (idx > 14)
+                    {
+                        mVolume.set(x, y, z, idx);
                     }
                 }
             }
@@ -69,7 +79,20 @@ struct CiApp : public AppBasic
 
     void update()
     {
+        if (mVolume.updateMeshes(&mMeshedChunks) == 0)
+            return;
+
+        for (size_t i = 0; i < mMeshedChunks.size(); i++)
+        {
+            size_t c = mMeshedChunks[i];
+            const TriMesh& mesh = mVolume.getChunkMesh(c);
+            mChunkVbos[c] = mesh.getNumIndices() > 0 ? gl::VboMesh(mesh) : gl::VboMesh();
+        }
 
+        VoxelVolume::ChunkStats stats = mVolume.getTotalStats();
+        console() << mVolume.getChunkCount() << " chunks, " << stats.numTriangles << " triangles, "
+            << stats.meshSeconds * 1000 / mVolume.getChunkCount() << " ms per chunk, "
+            << mVolume.getMemoryUsage() << " voxel bytes" << endl;
     }
 
     void draw()
@@ -77,20 +100,10 @@ struct CiApp : public AppBasic
         gl::clear(ColorA::black());
 
         mWorldTex.bind();
-        for (int z = 0; z < kCellCount; z++)
+        for (size_t c = 0; c < mChunkVbos.size(); c++)
         {
-            for (int y = 0; y < kCellCount; y++)
-            {
-                for (int x = 0; x < kCellCount; x++)
-                {
-                    int idx = mCells[z][y][x];
-                    if (idx > 14)
-                    {
-                        gl::drawCube(Vec3f(x * CELL_SIZE, y * CELL_SIZE, z * CELL_SIZE), 
-                            Vec3f(CELL_SIZE, CELL_SIZE, CELL_SIZE));
-                    }
-                }
-            }
+            if (mChunkVbos[c])
+                gl::draw(mChunkVbos[c]);
         }
         mParams.draw();
     }
@@ -103,8 +116,9 @@ private:
 
 private:
     // world
-    static const size_t kCellCount = 64;
-    int                 mCells[kCellCount][kCellCount][kCellCount];
+    VoxelVolume         mVolume;
+    vector<gl::VboMesh> mChunkVbos;
+    vector<size_t>      mMeshedChunks;
 };
 
 CINDER_APP_BASIC(CiApp, RendererGl)
@@ -2,7 +2,9 @@
 #include "cinder/ImageIo.h"
 #include "cinder/Camera.h"
 #include "cinder/Json.h"
+#include "cinder/JsonDoc.h"
 #include "cinder/Text.h"
+#include "cinder/Timer.h"
 #include "cinder/Utilities.h"
 
 #include "cinder/ip/Flip.h"
@@ -19,6 +21,14 @@
 
 #include <boost/foreach.hpp>
 
+#if defined(CINDER_MSW)
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#elif defined(CINDER_MAC)
+#include <sys/resource.h>
+#endif
+
 using namespace ci;
 using namespace ci::app;
 using namespace std;
@@ -26,7 +36,8 @@ using namespace std;
 const string kAllNodeName = "ALL";
 const fs::directory_iterator kEndIt;
 
-typedef function<void(const JsonTree&)> JsonHandler;
+typedef JsonDoc::Node JsonNode;
+typedef function<void(const JsonNode&)> JsonHandler;
 typedef pair<string, JsonHandler> NameHandlerPair;
 typedef pair<string, gl::Texture> NameTexturePair;
 typedef pair<string, vector<float>> NameValuePair;
@@ -500,6 +511,87 @@ struct CiApp : public AppBasic
         {
             quit();
         }
+        else if (event.getChar() == 'j')
+        {
+            benchmarkJson();
+        }
+    }
+
+    // Approximate heap footprint of a JsonTree: list nodes plus heap-allocated keys and values.
+    static size_t getJsonTreeBytes(const JsonTree& tree)
+    {
+        const size_t kSmallString = 15;
+        size_t bytes = sizeof(JsonTree) + 2 * sizeof(void*);
+        if (tree.getKey().capacity() > kSmallString) bytes += tree.getKey().capacity() + 1;
+        if (tree.getValue().capacity() > kSmallString) bytes += tree.getValue().capacity() + 1;
+        BOOST_FOREACH(const JsonTree& child, tree.getChildren())
+        {
+            bytes += getJsonTreeBytes(child);
+        }
+        return bytes;
+    }
+
+    // The largest amount of memory the process has used so far, or 0 where it can't be queried.
+    static size_t getPeakMemoryBytes()
+    {
+#if defined(CINDER_MSW)
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        {
+            return counters.PeakWorkingSetSize;
+        }
+        return 0;
+#elif defined(CINDER_MAC)
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return (size_t)usage.ru_maxrss; // bytes on Mac OS X
+#else
+        return 0;
+#endif
+    }
+
+    // Parses the current hero's json with JsonDoc and JsonTree, and logs parse time, retained memory and the process's peak memory
+    // before and after each parser's runs. The peak only ever grows, so a parser shows up in it only where it needs more memory than
+    // the process ever did before; JsonDoc runs first as it needs the least.
+    void benchmarkJson()
+    {
+        if (mCurrentHero < 0)
+        {
+            return;
+        }
+        const string& heroName = mHeroNames[mCurrentHero];
+        fs::path meshPath = mHeroesFolder / heroName / (heroName + ".json");
+        const int kRuns = 10;
+
+        size_t docPeakBefore = getPeakMemoryBytes();
+        Timer timer(true);
+        size_t docBytes = 0, docNodes = 0;
+        for (int i = 0; i < kRuns; i++)
+        {
+            JsonDoc doc(loadFile(meshPath));
+            docBytes = doc.getMemoryUsage();
+            docNodes = doc.getNumNodes();
+        }
+        double docSeconds = timer.getSeconds() / kRuns;
+        size_t docPeakAfter = getPeakMemoryBytes();
+
+        size_t treePeakBefore = docPeakAfter;
+        timer.start();
+        size_t treeBytes = 0;
+        for (int i = 0; i < kRuns; i++)
+        {
+            JsonTree tree(loadFile(meshPath));
+            treeBytes = getJsonTreeBytes(tree);
+        }
+        double treeSeconds = timer.getSeconds() / kRuns;
+        size_t treePeakAfter = getPeakMemoryBytes();
+
+        size_t fileBytes = (size_t)fs::file_size(meshPath);
+        console() << heroName << ".json: " << fileBytes / 1024 << " KB, " << docNodes << " nodes" << endl;
+        console() << "JsonDoc:  " << docSeconds * 1000 << " ms, retained " << docBytes / 1024 << " KB, process peak "
+            << docPeakBefore / 1024 << " -> " << docPeakAfter / 1024 << " KB" << endl;
+        console() << "JsonTree: " << treeSeconds * 1000 << " ms, retained " << treeBytes / 1024 << " KB, process peak "
+            << treePeakBefore / 1024 << " -> " << treePeakAfter / 1024 << " KB" << endl;
     }
 
     void update()
@@ -644,8 +736,9 @@ private:
             return false;
         }
 
-        // hero.json
-        JsonTree heroJsonRoot = JsonTree(loadFile(meshPath));
+        // hero.json, parsed in place; node handles are only valid while heroJson is alive
+        JsonDoc heroJson(loadFile(meshPath));
+        JsonNode heroJsonRoot = heroJson.getRoot();
 
         mHero = Hero();
         mNodeNames.clear();
@@ -674,13 +767,13 @@ private:
         return true;
     }
 
-    void handleDefault(const JsonTree& tree)
+    void handleDefault(const JsonNode& tree)
     {
     }
 
-    void handleChildren(const JsonTree& tree, const JsonHandler& handler)
+    void handleChildren(const JsonNode& tree, const JsonHandler& handler)
     {
-        BOOST_FOREACH(const JsonTree& child, tree.getChildren())
+        BOOST_FOREACH(const JsonNode& child, tree.getChildren())
         {
 #ifdef _DEBUG
             console() << child.getKey() << ":" << child.getChildren().size() << endl;
@@ -693,7 +786,7 @@ private:
     //    "byteLength": 1185936,
     //    "path": "abaddon.bin"
     //}
-    void handleBuffer(const JsonTree& tree)
+    void handleBuffer(const JsonNode& tree)
     {
         size_t byteLength = tree["byteLength"].getValue<size_t>();
         string path = tree["path"].getValue();
@@ -712,7 +805,7 @@ private:
     //    "byteOffset": 0,
     //    "target": "ARRAY_BUFFER"
     //},
-    void handleBufferView(const JsonTree& tree)
+    void handleBufferView(const JsonNode& tree)
     {
         gl::Vbo vbo(getGlEnum(tree, "target"));
         int path = tree["byteLength"].getValue<int>();
@@ -732,7 +825,7 @@ private:
     //"image_0": {
     //    "path": "textures/abaddon_body_color.png"
     //},
-    void handleImage(const JsonTree& tree)
+    void handleImage(const JsonNode& tree)
     {
         fs::path imgPath = getAbsolutePath(tree["path"].getValue());
 
@@ -745,7 +838,7 @@ private:
     //    "wrapS": "REPEAT",
     //    "wrapT": "REPEAT"
     //},
-    void handleSampler(const JsonTree& tree)
+    void handleSampler(const JsonNode& tree)
     {
         gl::Texture::Format format;
         format.setMagFilter(getGlEnum(tree, "magFilter"));
@@ -764,7 +857,7 @@ private:
     //    "source": "image_0",
     //    "target": "TEXTURE_2D"
     //},
-    void handleTexture(const JsonTree& tree)
+    void handleTexture(const JsonNode& tree)
     {
         const Surface& image = mHero.mImages[tree["source"].getValue()];
 
@@ -795,13 +888,13 @@ private:
     //        }
     //    }
     //},
-    void handleTechnique(const JsonTree& tree)
+    void handleTechnique(const JsonNode& tree)
     {
         Hero::Technique tech;
         tech.name = tree.getKey();
 
         string passName = tree["pass"].getValue();
-        const JsonTree& defaultPassTree = tree["passes"][passName];
+        const JsonNode& defaultPassTree = tree["passes"][passName];
         tech.blendEnable = defaultPassTree["states"]["blendEnable"].getValue<bool>();
         tech.blendEnable = defaultPassTree["states"]["cullFaceEnable"].getValue<bool>();
         tech.blendEnable = defaultPassTree["states"]["depthMask"].getValue<bool>();
@@ -830,7 +923,7 @@ private:
     //    },
     //    "name": "Material #151"
     //},
-    void handleMaterial(const JsonTree& tree)
+    void handleMaterial(const JsonNode& tree)
     {
         Hero::Material material;
         material.name = tree.getKey();
@@ -839,7 +932,7 @@ private:
         const Hero::Technique& technique = mHero.mTechniques[techniqueName];
         material.pTechnique = &technique;
 
-        BOOST_FOREACH(const JsonTree& value, tree["instanceTechnique"]["values"].getChildren())
+        BOOST_FOREACH(const JsonNode& value, tree["instanceTechnique"]["values"].getChildren())
         {
             string paramName = value["parameter"].getValue();
 
@@ -860,7 +953,7 @@ private:
             }
             else
             {
-                BOOST_FOREACH(const JsonTree& floatItem, value["value"].getChildren())
+                BOOST_FOREACH(const JsonNode& floatItem, value["value"].getChildren())
                 {
                     float floatValue = fromString<float>(floatItem.getValue());
                     floatArray.push_back(floatValue);
@@ -878,7 +971,7 @@ private:
     //    "count": 840,
     //    "type": "UNSIGNED_SHORT"
     //},
-    void handleIndex(const JsonTree& tree)
+    void handleIndex(const JsonNode& tree)
     {
         Hero::Index index;
         index.indexBuffer = mHero.mBufferViews[tree["bufferView"].getValue()];
@@ -907,7 +1000,7 @@ private:
     //    "type": "FLOAT_VEC2"
     //},
     // https://github.com/KhronosGroup/glTF/blob/master/specification/meshAttribute.schema.json
-    void handleAttribute(const JsonTree& tree)
+    void handleAttribute(const JsonNode& tree)
     {
         Hero::Attribute meshAttrib;
         meshAttrib.vextexBuffer = mHero.mBufferViews[tree["bufferView"].getValue()];
@@ -942,18 +1035,18 @@ private:
     //    ]
     //},
     // https://github.com/KhronosGroup/glTF/blob/master/specification/mesh.schema.json
-    void handleMesh(const JsonTree& tree)
+    void handleMesh(const JsonNode& tree)
     {
         Hero::Mesh mesh;
         mesh.name = tree.getKey();
 
-        BOOST_FOREACH(const JsonTree& primitive, tree["primitives"].getChildren())
+        BOOST_FOREACH(const JsonNode& primitive, tree["primitives"].getChildren())
         {
             Hero::Mesh::Primitive prim;
             prim.pIndexBuffer = &mHero.mIndices[primitive["indices"].getValue()];
             prim.pMaterial = &mHero.mMaterials[primitive["material"].getValue()];
 
-            BOOST_FOREACH(const JsonTree& semantic, primitive["semantics"].getChildren())
+            BOOST_FOREACH(const JsonNode& semantic, primitive["semantics"].getChildren())
             {
                 prim.pVertexBuffers.push_back(make_pair(semantic.getKey(), &mHero.mAttributes[semantic.getValue()]));
             }
@@ -975,17 +1068,17 @@ private:
     //    ],
     //    "roots": ["clavicle_R"]
     //},
-    void handleSkin(const JsonTree& tree)
+    void handleSkin(const JsonNode& tree)
     {
         Hero::Skin skin;
 
         // TODO: supports more fields
-        BOOST_FOREACH(const JsonTree& joint, tree["joints"].getChildren())
+        BOOST_FOREACH(const JsonNode& joint, tree["joints"].getChildren())
         {
             skin.pJoints.push_back(&mHero.mNodes[joint.getValue()]);
         }
 
-        BOOST_FOREACH(const JsonTree& root, tree["roots"].getChildren())
+        BOOST_FOREACH(const JsonNode& root, tree["roots"].getChildren())
         {
             skin.pRoots.push_back(&mHero.mNodes[root.getValue()]);
         }
@@ -1018,18 +1111,18 @@ private:
     //    "name": "Cloth_R3C0"
     //},
     // https://github.com/KhronosGroup/glTF/blob/master/specification/node.schema.json
-    void handleNode(const JsonTree& tree)
+    void handleNode(const JsonNode& tree)
     {
         Hero::Node node;
         node.name = tree.getKey();
 
-        BOOST_FOREACH(const JsonTree& child, tree["children"].getChildren())
+        BOOST_FOREACH(const JsonNode& child, tree["children"].getChildren())
         {
             node.pChildren.push_back(&mHero.mNodes[child.getValue()]);
         }
 
         size_t i = 0;
-        BOOST_FOREACH(const JsonTree& number, tree["matrix"].getChildren())
+        BOOST_FOREACH(const JsonNode& number, tree["matrix"].getChildren())
         {
             node.matrix.m[i] = number.getValue<float>();
             i++;
@@ -1037,7 +1130,7 @@ private:
 
         if (tree.hasChild("meshes"))
         {
-            BOOST_FOREACH(const JsonTree& mesh, tree["meshes"].getChildren())
+            BOOST_FOREACH(const JsonNode& mesh, tree["meshes"].getChildren())
             {
                 node.pMeshes.push_back(&mHero.mMeshes[mesh.getValue()]);
             }
@@ -1056,12 +1149,12 @@ private:
     //        "weapon_model_LOD0"
     //    ]
     //}
-    void handleScene(const JsonTree& tree)
+    void handleScene(const JsonNode& tree)
     {
         Hero::Scene scene;
 
         mNodeNames.push_back(kAllNodeName);
-        BOOST_FOREACH(const JsonTree& node, tree["nodes"].getChildren())
+        BOOST_FOREACH(const JsonNode& node, tree["nodes"].getChildren())
         {
             scene.pNodes.push_back(&mHero.mNodes[node.getValue()]);
             mNodeNames.push_back(node.getValue());
@@ -1161,7 +1254,7 @@ private:
         return mHeroesFolder / mHeroNames[mCurrentHero] / relativePath;
     }
 
-    GLenum getGlEnum(const JsonTree& tree, const string& childKeyName)
+    GLenum getGlEnum(const JsonNode& tree, const string& childKeyName)
     {
         const string& childKeyValue = tree[childKeyName].getValue();
         return getGlEnum(childKeyValue);
@@ -0,0 +1,287 @@
+#include "VoxelVolume.h"
+#include "cinder/Thread.h"
+#include "cinder/Timer.h"
+
+#include <algorithm>
+
+using namespace ci;
+using namespace std;
+
+namespace
+{
+    const int kChunkVolume = VoxelVolume::CHUNK_SIZE * VoxelVolume::CHUNK_SIZE * VoxelVolume::CHUNK_SIZE;
+    // chunk plus a one voxel border from the neighbors
+    const int kPaddedSize = VoxelVolume::CHUNK_SIZE + 2;
+}
+
+VoxelVolume::Voxel VoxelVolume::Chunk::get(int index) const
+{
+    if (bitsPerVoxel == 0)
+        return palette[0];
+
+    int bit = index * bitsPerVoxel;
+    uint32_t mask = (1u << bitsPerVoxel) - 1;
+    return palette[(indices[bit >> 5] >> (bit & 31)) & mask];
+}
+
+void VoxelVolume::Chunk::set(int index, Voxel voxel)
+{
+    size_t entry = find(palette.begin(), palette.end(), voxel) - palette.begin();
+    if (entry == palette.size())
+    {
+        palette.push_back(voxel);
+        if (palette.size() > (1u << bitsPerVoxel))
+            repack(bitsPerVoxel == 0 ? 1 : bitsPerVoxel * 2);
+    }
+    if (bitsPerVoxel == 0)
+        return;
+
+    int bit = index * bitsPerVoxel;
+    uint32_t mask = ((1u << bitsPerVoxel) - 1) << (bit & 31);
+    uint32_t& word = indices[bit >> 5];
+    word = (word & ~mask) | ((uint32_t)entry << (bit & 31));
+}
+
+void VoxelVolume::Chunk::repack(int newBitsPerVoxel)
+{
+    vector<uint32_t> packed(kChunkVolume * newBitsPerVoxel / 32, 0);
+    if (bitsPerVoxel > 0)
+    {
+        uint32_t mask = (1u << bitsPerVoxel) - 1;
+        for (int i = 0; i < kChunkVolume; i++)
+        {
+            int bit = i * bitsPerVoxel;
+            uint32_t entry = (indices[bit >> 5] >> (bit & 31)) & mask;
+            int newBit = i * newBitsPerVoxel;
+            packed[newBit >> 5] |= entry << (newBit & 31);
+        }
+    }
+    indices.swap(packed);
+    bitsPerVoxel = newBitsPerVoxel;
+}
+
+VoxelVolume::VoxelVolume(const Vec3i& size, float voxelSize)
+: mSize(size), mVoxelSize(voxelSize)
+{
+    mNumChunks = Vec3i((size.x + CHUNK_SIZE - 1) / CHUNK_SIZE, (size.y + CHUNK_SIZE - 1) / CHUNK_SIZE, (size.z + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    mChunks.resize(mNumChunks.x * mNumChunks.y * mNumChunks.z);
+}
+
+VoxelVolume::Voxel VoxelVolume::get(int x, int y, int z) const
+{
+    if (x < 0 || y < 0 || z < 0 || x >= mSize.x || y >= mSize.y || z >= mSize.z)
+        return 0;
+
+    const Chunk& chunk = mChunks[getChunkIndex(x / CHUNK_SIZE, y / CHUNK_SIZE, z / CHUNK_SIZE)];
+    return chunk.get(((z % CHUNK_SIZE) * CHUNK_SIZE + (y % CHUNK_SIZE)) * CHUNK_SIZE + (x % CHUNK_SIZE));
+}
+
+void VoxelVolume::set(int x, int y, int z, Voxel voxel)
+{
+    if (x < 0 || y < 0 || z < 0 || x >= mSize.x || y >= mSize.y || z >= mSize.z)
+        return;
+
+    Chunk& chunk = mChunks[getChunkIndex(x / CHUNK_SIZE, y / CHUNK_SIZE, z / CHUNK_SIZE)];
+    int index = ((z % CHUNK_SIZE) * CHUNK_SIZE + (y % CHUNK_SIZE)) * CHUNK_SIZE + (x % CHUNK_SIZE);
+    if (chunk.get(index) == voxel)
+        return;
+
+    chunk.set(index, voxel);
+    markDirty(x, y, z);
+}
+
+void VoxelVolume::markDirty(int x, int y, int z)
+{
+    int cx = x / CHUNK_SIZE, cy = y / CHUNK_SIZE, cz = z / CHUNK_SIZE;
+    mChunks[getChunkIndex(cx, cy, cz)].dirty = true;
+
+    // a voxel on a chunk boundary hides or exposes faces of the neighboring chunk
+    int local[3] = { x % CHUNK_SIZE, y % CHUNK_SIZE, z % CHUNK_SIZE };
+    int c[3] = { cx, cy, cz };
+    int numChunks[3] = { mNumChunks.x, mNumChunks.y, mNumChunks.z };
+    for (int axis = 0; axis < 3; axis++)
+    {
+        int n[3] = { c[0], c[1], c[2] };
+        if (local[axis] == 0 && c[axis] > 0)
+            n[axis] = c[axis] - 1;
+        else if (local[axis] == CHUNK_SIZE - 1 && c[axis] + 1 < numChunks[axis])
+            n[axis] = c[axis] + 1;
+        else
+            continue;
+        mChunks[getChunkIndex(n[0], n[1], n[2])].dirty = true;
+    }
+}
+
+struct VoxelVolume::MeshJob
+{
+    void operator()(size_t begin, size_t end) const
+    {
+        for (size_t i = begin; i < end; i++)
+            volume->meshChunk((*chunks)[i]);
+    }
+
+    VoxelVolume* volume;
+    const vector<size_t>* chunks;
+};
+
+size_t VoxelVolume::updateMeshes(vector<size_t>* meshedChunks)
+{
+    vector<size_t> dirtyChunks;
+    for (size_t c = 0; c < mChunks.size(); c++)
+    {
+        if (mChunks[c].dirty)
+            dirtyChunks.push_back(c);
+    }
+
+    MeshJob job = { this, &dirtyChunks };
+    parallelFor(dirtyChunks.size(), job, 1);
+    if (meshedChunks)
+        *meshedChunks = dirtyChunks;
+    return dirtyChunks.size();
+}
+
+void VoxelVolume::meshChunk(size_t chunkIndex)
+{
+    Timer timer(true);
+    Chunk& chunk = mChunks[chunkIndex];
+
+    const int cz = chunkIndex / (mNumChunks.x * mNumChunks.y);
+    const int cy = (chunkIndex / mNumChunks.x) % mNumChunks.y;
+    const int cx = chunkIndex % mNumChunks.x;
+    const int origin[3] = { cx * CHUNK_SIZE, cy * CHUNK_SIZE, cz * CHUNK_SIZE };
+
+    // decode the chunk with a one voxel border, so that faces against neighbors can be culled
+    vector<Voxel> voxels(kPaddedSize * kPaddedSize * kPaddedSize);
+    for (int z = -1; z <= CHUNK_SIZE; z++)
+    {
+        for (int y = -1; y <= CHUNK_SIZE; y++)
+        {
+            bool inside = (z >= 0 && z < CHUNK_SIZE && y >= 0 && y < CHUNK_SIZE);
+            Voxel* row = &voxels[((z + 1) * kPaddedSize + (y + 1)) * kPaddedSize];
+            for (int x = -1; x <= CHUNK_SIZE; x++)
+            {
+                if (inside && x >= 0 && x < CHUNK_SIZE)
+                    row[x + 1] = chunk.get((z * CHUNK_SIZE + y) * CHUNK_SIZE + x);
+                else
+                    row[x + 1] = get(origin[0] + x, origin[1] + y, origin[2] + z);
+            }
+        }
+    }
+
+    TriMesh& mesh = chunk.mesh;
+    mesh.clear();
+
+    // mask entries are the voxel value, negated for faces pointing down the axis
+    vector<int> mask(CHUNK_SIZE * CHUNK_SIZE);
+    const int stride[3] = { 1, kPaddedSize, kPaddedSize * kPaddedSize };
+    for (int d = 0; d < 3; d++)
+    {
+        const int u = (d + 1) % 3, v = (d + 2) % 3;
+        int pos[3];
+        for (pos[d] = -1; pos[d] < CHUNK_SIZE; pos[d]++)
+        {
+            // faces between slice pos[d] and pos[d] + 1 which belong to this chunk
+            for (pos[v] = 0; pos[v] < CHUNK_SIZE; pos[v]++)
+            {
+                for (pos[u] = 0; pos[u] < CHUNK_SIZE; pos[u]++)
+                {
+                    int index = (pos[0] + 1) * stride[0] + (pos[1] + 1) * stride[1] + (pos[2] + 1) * stride[2];
+                    Voxel a = voxels[index], b = voxels[index + stride[d]];
+                    int face = 0;
+                    if (a != 0 && b == 0 && pos[d] >= 0)
+                        face = a;
+                    else if (a == 0 && b != 0 && pos[d] + 1 < CHUNK_SIZE)
+                        face = -(int)b;
+                    mask[pos[v] * CHUNK_SIZE + pos[u]] = face;
+                }
+            }
+
+            // greedily merge equal faces into rectangles
+            for (int j = 0; j < CHUNK_SIZE; j++)
+            {
+                for (int i = 0; i < CHUNK_SIZE;)
+                {
+                    int face = mask[j * CHUNK_SIZE + i];
+                    if (face == 0)
+                    {
+                        i++;
+                        continue;
+                    }
+
+                    int w = 1;
+                    while (i + w < CHUNK_SIZE && mask[j * CHUNK_SIZE + i + w] == face)
+                        w++;
+                    int h = 1;
+                    for (; j + h < CHUNK_SIZE; h++)
+                    {
+                        int k = 0;
+                        while (k < w && mask[(j + h) * CHUNK_SIZE + i + k] == face)
+                            k++;
+                        if (k < w)
+                            break;
+                    }
+
+                    float corner[3];
+                    corner[d] = (float)(origin[d] + pos[d] + 1);
+                    corner[u] = (float)(origin[u] + i);
+                    corner[v] = (float)(origin[v] + j);
+                    Vec3f base(corner[0], corner[1], corner[2]);
+                    Vec3f du = Vec3f::zero(), dv = Vec3f::zero(), normal = Vec3f::zero();
+                    du[u] = (float)w;
+                    dv[v] = (float)h;
+                    normal[d] = (face > 0) ? 1.0f : -1.0f;
+
+                    uint32_t first = mesh.getNumVertices();
+                    mesh.appendVertex(base * mVoxelSize);
+                    mesh.appendVertex((base + du) * mVoxelSize);
+                    mesh.appendVertex((base + du + dv) * mVoxelSize);
+                    mesh.appendVertex((base + dv) * mVoxelSize);
+                    mesh.appendTexCoord(Vec2f(0, 0));
+                    mesh.appendTexCoord(Vec2f((float)w, 0));
+                    mesh.appendTexCoord(Vec2f((float)w, (float)h));
+                    mesh.appendTexCoord(Vec2f(0, (float)h));
+                    for (int n = 0; n < 4; n++)
+                        mesh.appendNormal(normal);
+                    // u x v == d, so this winding faces +d
+                    if (face > 0)
+                    {
+                        mesh.appendTriangle(first, first + 1, first + 2);
+                        mesh.appendTriangle(first, first + 2, first + 3);
+                    }
+                    else
+                    {
+                        mesh.appendTriangle(first, first + 2, first + 1);
+                        mesh.appendTriangle(first, first + 3, first + 2);
+                    }
+
+                    for (int y = 0; y < h; y++)
+                        fill(mask.begin() + (j + y) * CHUNK_SIZE + i, mask.begin() + (j + y) * CHUNK_SIZE + i + w, 0);
+                    i += w;
+                }
+            }
+        }
+    }
+
+    chunk.stats.numTriangles = mesh.getNumTriangles();
+    chunk.stats.meshSeconds = timer.getSeconds();
+    chunk.dirty = false;
+}
+
+VoxelVolume::ChunkStats VoxelVolume::getTotalStats() const
+{
+    ChunkStats result;
+    for (size_t c = 0; c < mChunks.size(); c++)
+    {
+        result.numTriangles += mChunks[c].stats.numTriangles;
+        result.meshSeconds += mChunks[c].stats.meshSeconds;
+    }
+    return result;
+}
+
+size_t VoxelVolume::getMemoryUsage() const
+{
+    size_t result = mChunks.size() * sizeof(Chunk);
+    for (size_t c = 0; c < mChunks.size(); c++)
+        result += mChunks[c].palette.capacity() * sizeof(Voxel) + mChunks[c].indices.capacity() * sizeof(uint32_t);
+    return result;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "cinder/TriMesh.h"
+#include <vector>
+
+// A voxel volume split into CHUNK_SIZE^3 chunks.
+// Each chunk keeps a palette of the voxel values it contains plus bit-packed palette indices,
+// so a uniform chunk costs a few bytes and typical terrain 1 to 4 bits per voxel.
+// Edited chunks are re-meshed by updateMeshes() with hidden-face culling and greedy quad merging.
+class VoxelVolume
+{
+public:
+    typedef ci::uint16_t Voxel; // 0 is empty
+    enum { CHUNK_SIZE = 32 };
+
+    struct ChunkStats
+    {
+        ChunkStats() : numTriangles(0), meshSeconds(0) {}
+
+        size_t numTriangles;
+        double meshSeconds;
+    };
+
+    VoxelVolume() : mSize(0, 0, 0), mNumChunks(0, 0, 0), mVoxelSize(1.0f) {}
+    explicit VoxelVolume(const ci::Vec3i& size, float voxelSize = 1.0f);
+
+    const ci::Vec3i& getSize() const { return mSize; }
+    const ci::Vec3i& getNumChunks() const { return mNumChunks; }
+    size_t getChunkCount() const { return mChunks.size(); }
+    float getVoxelSize() const { return mVoxelSize; }
+
+    // Out of range coordinates read as empty
+    Voxel get(int x, int y, int z) const;
+    // Marks the owning chunk dirty, plus the neighbors whose boundary faces depend on this voxel
+    void set(int x, int y, int z, Voxel voxel);
+
+    // Re-meshes every chunk edited since the last call, spread across threads.
+    // Returns the number of chunks that were meshed; their indices are stored in meshedChunks when given.
+    size_t updateMeshes(std::vector<size_t>* meshedChunks = NULL);
+    bool isChunkDirty(size_t chunk) const { return mChunks[chunk].dirty; }
+
+    // Mesh in world units; positions, per-face normals and texcoords in voxel units (use GL_REPEAT)
+    const ci::TriMesh& getChunkMesh(size_t chunk) const { return mChunks[chunk].mesh; }
+    const ChunkStats& getChunkStats(size_t chunk) const { return mChunks[chunk].stats; }
+    // Sum of all chunk meshes
+    ChunkStats getTotalStats() const;
+
+    // Bytes used by voxel storage, excluding meshes
+    size_t getMemoryUsage() const;
+
+private:
+    struct Chunk
+    {
+        Chunk() : bitsPerVoxel(0), dirty(true) { palette.push_back(0); }
+
+        Voxel get(int index) const;
+        void set(int index, Voxel voxel);
+        void repack(int newBitsPerVoxel);
+
+        std::vector<Voxel> palette;
+        std::vector<ci::uint32_t> indices; // bitsPerVoxel bits per voxel, never straddling a word
+        int bitsPerVoxel;              // 0 while the chunk is uniform
+
+        ci::TriMesh mesh;
+        ChunkStats stats;
+        bool dirty;
+    };
+
+    struct MeshJob;
+    friend struct MeshJob;
+
+    size_t getChunkIndex(int cx, int cy, int cz) const { return (cz * mNumChunks.y + cy) * mNumChunks.x + cx; }
+    void markDirty(int x, int y, int z);
+    void meshChunk(size_t chunk);
+
+    ci::Vec3i mSize, mNumChunks;
+    float mVoxelSize;
+    std::vector<Chunk> mChunks;
+};
@@ -0,0 +1,104 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "ciMsaFluidSolver.h"
+#include "cinder/Color.h"
+
+#include <vector>
+
+// Particles carried by the velocity of a ciMsaFluidSolver, stored as one array per attribute. The live particles
+// are the first getNumParticles() elements of each array, oldest first. Once the capacity is reached, emitting
+// overwrites the oldest particles, and emitting and removing particles never allocates once the capacity is set.
+// update() samples the fluid for batches of particles at a time and spreads the batches across threads
+class ciMsaFluidParticles {
+  public:
+	ciMsaFluidParticles();
+	explicit ciMsaFluidParticles( size_t capacity );
+	
+	// sets the maximum number of live particles, and removes the particles beyond it
+	ciMsaFluidParticles& setCapacity( size_t capacity );
+	size_t getCapacity() const { return capacity; }
+	size_t getNumParticles() const { return numParticles; }
+	
+	// the size of the area covered by the fluid, in the units of the particle positions. Defaults to (1, 1)
+	ciMsaFluidParticles& setWorldSize( const ci::Vec2f &worldSize );
+	const ci::Vec2f& getWorldSize() const { return worldSize; }
+	// how strongly the fluid velocity drives the particles
+	ciMsaFluidParticles& setFluidForce( float fluidForce );
+	float getFluidForce() const { return fluidForce; }
+	// the fraction of its velocity a particle keeps from one step to the next
+	ciMsaFluidParticles& setMomentum( float momentum );
+	float getMomentum() const { return momentum; }
+	// the speed of the random kick given to particles slower than one unit per step, which makes them glitter as they
+	// come to rest. Defaults to 0, which turns it off
+	ciMsaFluidParticles& setGlitter( float glitter );
+	float getGlitter() const { return glitter; }
+	
+	// emits 'count' particles scattered within 'spread' of 'pos', which live for 'lifetime' steps. Their 'mass' scales the
+	// fluid force. Once the capacity is reached each new particle replaces the oldest one
+	void emit( const ci::Vec2f &pos, size_t count, float spread, float lifetime, const ci::ColorA &color = ci::ColorA( 1, 1, 1, 1 ), const ci::Vec2f &vel = ci::Vec2f::zero(), float mass = 1 );
+	// removes every particle
+	void clear();
+	
+	// advances the particles by one step of 'solver', and removes the particles that outlived their lifetime
+	void update( const ciMsaFluidSolver &solver );
+	
+	// the attribute arrays, each holding getNumParticles() live particles
+	const float*		getPositionsX() const { return posX.empty() ? NULL : &posX[head]; }
+	const float*		getPositionsY() const { return posY.empty() ? NULL : &posY[head]; }
+	const float*		getVelocitiesX() const { return velX.empty() ? NULL : &velX[head]; }
+	const float*		getVelocitiesY() const { return velY.empty() ? NULL : &velY[head]; }
+	// the number of steps each particle has lived, and the number it lives in total
+	const float*		getAges() const { return age.empty() ? NULL : &age[head]; }
+	const float*		getLifetimes() const { return lifetime.empty() ? NULL : &lifetime[head]; }
+	const float*		getMasses() const { return mass.empty() ? NULL : &mass[head]; }
+	const ci::ColorA*	getColors() const { return color.empty() ? NULL : &color[head]; }
+	
+  protected:
+	struct UpdateRange;
+	
+	// the number of particles sampled from the solver in one call
+	static const size_t BATCH_SIZE = 256;
+	
+	void	updateRange( const ciMsaFluidSolver &solver, size_t begin, size_t end );
+	void	removeDead();
+	void	copyParticle( size_t to, size_t from );
+	// moves the live particles to the front of the arrays
+	void	moveToFront();
+	
+	// the live particles are the elements [head, head + numParticles) of arrays twice the capacity, so overwriting the
+	// oldest particle only advances head, and the particles are moved back to the front once they reach the end
+	size_t		capacity, numParticles, head;
+	uint32_t	step;
+	ci::Vec2f	worldSize;
+	float		fluidForce;
+	float		momentum;
+	float		glitter;
+	
+	std::vector<float>		posX, posY;
+	std::vector<float>		velX, velY;
+	std::vector<float>		age, lifetime;
+	std::vector<float>		mass;
+	std::vector<ci::ColorA>	color;
+};
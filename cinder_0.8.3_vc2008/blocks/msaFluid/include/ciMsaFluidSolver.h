@@ -49,6 +49,10 @@
 #include "cinder/Vector.h"
 #include "cinder/Color.h"
 
+#include <vector>
+
+namespace boost { class barrier; }
+
 // do not change these values, you can override them using the solver methods
 #define		FLUID_DEFAULT_NX					100
 #define		FLUID_DEFAULT_NY					100
@@ -57,11 +61,27 @@
 #define     FLUID_DEFAULT_COLOR_DIFFUSION	0
 #define     FLUID_DEFAULT_FADESPEED         .03
 #define		FLUID_DEFAULT_SOLVER_ITERATIONS		10
+#define		FLUID_DEFAULT_SOLVER_TOLERANCE		0.001f
 
 #define		FLUID_IX(i, j)		((i) + (_NX + 2)  *(j))
 
 class ciMsaFluidSolver {
 public:	
+	// SOLVER_GAUSS_SEIDEL relaxes each grid in place on a single thread.
+	// SOLVER_RED_BLACK relaxes alternate cells in two passes without dependencies along a row, and runs every pass
+	// of the step over bands of rows on several threads. It converges like SOLVER_GAUSS_SEIDEL, but scales to larger grids
+	// SOLVER_MULTIGRID solves the pressure and diffusion equations with multigrid V-cycles, which converge in a few cycles
+	// regardless of the grid size. The solver iterations are the maximum number of cycles per solve, and a solve stops
+	// early once its residual falls below the solver tolerance
+	enum SolverMode { SOLVER_GAUSS_SEIDEL, SOLVER_RED_BLACK, SOLVER_MULTIGRID };
+
+	// the work and the remaining error of the linear solves of one update()
+	struct SolverStats {
+		int		iterations;		// relaxation iterations, or V-cycles in SOLVER_MULTIGRID mode
+		float	residual;		// the largest rms residual of a solve, relative to the rms of its right hand side. Only computed
+								// by SOLVER_MULTIGRID unless setSolverStatsEnabled() is on, 0 otherwise
+	};
+
 	ciMsaFluidSolver();
 	virtual ~ciMsaFluidSolver();
 	
@@ -89,6 +109,9 @@ public:
 	inline void getInfoAtPos(float x, float y, ci::Vec2f *vel, ci::Color *color = NULL) const;
 	
 	inline ci::Vec2f getVelocityAtPos( const ci::Vec2f &pos ) const;
+	// samples the velocity at 'count' normalized positions (x[i], y[i]) with bilinear interpolation, in the units
+	// of getVelocityAtPos(). Runs 4 positions at a time with SSE where available
+	void getVelocitiesAtPos( const float *x, const float *y, size_t count, float *velX, float *velY ) const;
 	
 	// get info at fluid cell pixels (i, j) if you know it. range: (0..NX-1), (0..NY-1)
 	inline	void getInfoAtCell(int i, int j, ci::Vec2f *vel, ci::Color *color = NULL) const;
@@ -141,6 +164,31 @@ public:
 	ciMsaFluidSolver& enableVorticityConfinement(bool b);
 	bool getVorticityConfinement();
 	ciMsaFluidSolver& setWrap( bool bx, bool by );
+	ciMsaFluidSolver& setSolverMode( SolverMode mode );
+	SolverMode getSolverMode() const;
+	// threads used by SOLVER_RED_BLACK. 0 uses one per core, limited so that each has enough cells to be worthwhile
+	ciMsaFluidSolver& setNumThreads( int numThreads = 0 );
+	int getNumThreads() const;
+	// the relative residual at which SOLVER_MULTIGRID stops iterating
+	ciMsaFluidSolver& setSolverTolerance( float tolerance = FLUID_DEFAULT_SOLVER_TOLERANCE );
+	float getSolverTolerance() const;
+	
+	// computes the residuals reported by getProjectStats() and getDiffuseStats() in every mode. It costs an extra pass over
+	// each solved grid, so it is off by default and the residuals are then only reported by SOLVER_MULTIGRID, which has them anyway
+	ciMsaFluidSolver& setSolverStatsEnabled( bool enabled = true );
+	bool getSolverStatsEnabled() const;
+	
+	// solves the pressure against the divergence, starting from zero, in SOLVER_GAUSS_SEIDEL and SOLVER_RED_BLACK modes
+	// too, which removes more divergence per iteration. Off by default, so those modes keep the original projection, which
+	// relaxes the divergence itself against a zero right hand side and reports a projection residual of 0.
+	// SOLVER_MULTIGRID always solves against the divergence
+	ciMsaFluidSolver& enablePoissonProjection( bool b );
+	bool getPoissonProjection() const;
+	
+	// returns the statistics of the pressure projections of the last update()
+	const SolverStats&	getProjectStats() const { return _projectStats; }
+	// returns the statistics of the velocity and color diffusion of the last update()
+	const SolverStats&	getDiffuseStats() const { return _diffuseStats; }
 	
 	// returns average density of fluid 
 	float getAvgDensity() const;
@@ -165,7 +213,12 @@ public:
 	
 	bool	doRGB;				// for monochrome, only update r
 	bool	doVorticityConfinement;
+	bool	doPoissonProjection;
 	int		solverIterations;
+	SolverMode	solverMode;
+	int		numThreads;
+	float	solverTolerance;
+	bool	solverStatsEnabled;
 	
 	float	colorDiffusion;
 	float	viscocity;
@@ -190,6 +243,70 @@ public:
 	float	_uniformity;			// this will hold the _uniformity of the last frame (how uniform the color is);
 	float	_avgSpeed;
 	
+	SolverStats	_projectStats, _diffuseStats;
+
+	// a range of rows [jBegin, jEnd) processed by one thread in SOLVER_RED_BLACK mode. Iterative passes synchronize on 'barrier'
+	struct Band {
+		int				jBegin, jEnd;
+		bool			first;
+		boost::barrier	*barrier;
+	};
+	typedef void (ciMsaFluidSolver::*BandFn)( const Band &band );
+	struct BandTask;
+
+	// the arguments of the pass run by runBands()
+	struct PassArgs {
+		int					bound;
+		float				*x;
+		const float			*x0;
+		ci::Vec2f			*xy;
+		ci::Vec2f			*pDiv;
+		const ci::Vec2f		*duv;
+		float				a, c;
+	};
+	PassArgs	_pass;
+
+	int		calcNumBands() const;
+	// runs 'fn' over bands of rows, in parallel in SOLVER_RED_BLACK mode and otherwise as one band on the calling thread
+	void	runBands( BandFn fn );
+
+	void	curlBand( const Band &band );
+	void	vorticityBand( const Band &band );
+	void	advectBand( const Band &band );
+	void	advect2dBand( const Band &band );
+	void	advectRGBBand( const Band &band );
+	void	divergenceBand( const Band &band );
+	void	gradientBand( const Band &band );
+	void	linearSolverRedBlack( const Band &band );
+	void	linearSolverProjectRedBlack( const Band &band );
+	void	linearSolverRGBRedBlack( const Band &band );
+	void	linearSolverUVRedBlack( const Band &band );
+	
+	// one level of the multigrid hierarchy; each level has half the resolution of the previous one.
+	// The finest level uses the solver's own grids, and only its buffers are used to hold strided components
+	struct MultigridLevel {
+		int					nx, ny;
+		std::vector<float>	x, rhs, residual;
+	};
+	std::vector<MultigridLevel>	_multigrid;
+	
+	void	setupMultigrid();
+	// solves c * x - a * (sum of the 4 neighbors of x) = rhs; returns the relative residual
+	float	multigridSolve( int bound, float *x, const float *rhs, float a, float c, int *cycles );
+	void	multigridCycle( int level, int bound, float *x, const float *rhs, float a, float c );
+	void	multigridSmooth( int level, int bound, float *x, const float *rhs, float a, float c, int iterations );
+	float	multigridResidual( int level, const float *x, const float *rhs, float a, float c );
+	void	multigridRestrict( int level );
+	void	multigridProlong( int level, float *x );
+	void	setMultigridBoundary( int level, int bound, float *x );
+	// whether project() solves for the pressure against the divergence in the current mode
+	bool	usesPoissonProjection() const { return doPoissonProjection || solverMode == SOLVER_MULTIGRID; }
+	// whether the solves of the current mode need calcResidual() to report their residual
+	bool	needsResidualPass() const { return solverStatsEnabled && solverMode != SOLVER_MULTIGRID; }
+	// returns the rms residual of c * x - a * (sum of neighbors) = rhs relative to the rms of rhs, for strided components
+	float	calcResidual( const float *x, int xStride, const float *rhs, int rhsStride, float a, float c ) const;
+	void	addSolverStats( SolverStats *stats, int iterations, float residual );
+	
 	void	destroy();
 	
 	inline	float	calcCurl(int i, int j);
@@ -201,17 +318,18 @@ public:
 	
 	void	advect(int b, float *d, const float *d0, const ci::Vec2f *duv);
 	void	advect2d( ci::Vec2f *uv, const ci::Vec2f *duv );
-	void	advectRGB(int b, const ci::Vec2f *duv);
+	void	advectRGB(const ci::Vec2f *duv);
 	
 	void	diffuse(int b, float *c, float *c0, float diff);
 	void	diffuseRGB(int b, float diff);
 	void	diffuseUV(float diff);
 	
 	void	project(ci::Vec2f *xy, ci::Vec2f *pDiv);
-	void	linearSolver(int b, float *x, const float *x0, float a, float c);
-	void	linearSolverProject( ci::Vec2f *pdiv );
-	void	linearSolverRGB( float a, float c);
-	void	linearSolverUV(float a, float c);
+	// the linear solvers return the iterations they ran. In SOLVER_MULTIGRID mode they also store the relative residual of the solve in 'residual'
+	int		linearSolver(int b, float *x, const float *x0, float a, float c, float *residual);
+	int		linearSolverProject( ci::Vec2f *pdiv, float *residual );
+	int		linearSolverRGB( float a, float c, float *residual );
+	int		linearSolverUV(float a, float c, float *residual );
 	
 	void	setBoundary(int b, float *x);
 	void	setBoundary02d(ci::Vec2f* x);
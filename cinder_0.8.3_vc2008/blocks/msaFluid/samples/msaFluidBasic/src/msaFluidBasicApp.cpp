@@ -1,4 +1,5 @@
 #include "cinder/app/AppBasic.h"
+#include "cinder/Timer.h"
 
 #include "ciMsaFluidSolver.h"
 #include "ciMsaFluidDrawerGl.h"
@@ -16,6 +17,7 @@ class msaFluidBasicApp : public AppBasic {
 	void	mouseMove( MouseEvent event );
 	void	mouseDrag( MouseEvent event );
 	void	resize( int w, int h );
+	void	benchmarkSolvers();
 	
 	void	update();
 	void	draw();
@@ -110,9 +112,76 @@ void msaFluidBasicApp::keyDown( KeyEvent event )
 		case ' ':
 			fluidSolver.randomizeColor();
 		break;
+		case 'r': {
+			const char *names[] = { "Gauss-Seidel", "red-black", "multigrid" };
+			ciMsaFluidSolver::SolverMode mode = (ciMsaFluidSolver::SolverMode)( ( fluidSolver.getSolverMode() + 1 ) % 3 );
+			fluidSolver.setSolverMode( mode );
+			console() << "solver mode: " << names[mode] << std::endl;
+		}
+		break;
+		case 'b':
+			benchmarkSolvers();
+		break;
     }
 }
 
+// Steps identical solvers in each mode with the same stirring forces. Reports the time per step and the residual
+// left by the pressure projection, along with the largest difference of each result from the Gauss-Seidel one. The times
+// of the relaxation modes include the residual pass that solver stats cost them. Every mode solves the pressure against the
+// divergence, so the residuals are comparable
+void msaFluidBasicApp::benchmarkSolvers()
+{
+	const int sizes[] = { 128, 256, 512 };
+	const int numSteps = 60;
+	const int numConfigs = 4;
+	const ciMsaFluidSolver::SolverMode modes[numConfigs] = { ciMsaFluidSolver::SOLVER_GAUSS_SEIDEL, ciMsaFluidSolver::SOLVER_GAUSS_SEIDEL,
+			ciMsaFluidSolver::SOLVER_RED_BLACK, ciMsaFluidSolver::SOLVER_MULTIGRID };
+	const int iterations[numConfigs] = { 10, 40, 10, 10 };
+	const char *names[numConfigs] = { "Gauss-Seidel x10", "Gauss-Seidel x40", "red-black x10", "multigrid" };
+	
+	for( int s = 0; s < 3; ++s ) {
+		ciMsaFluidSolver solvers[numConfigs];
+		for( int m = 0; m < numConfigs; ++m ) {
+			ciMsaFluidSolver &solver = solvers[m];
+			solver.setup( sizes[s], sizes[s] );
+			solver.enableRGB( true ).setFadeSpeed( 0.002f ).setDeltaT( 0.5f ).setVisc( 0.00015f ).setColorDiffusion( 0 );
+			solver.enableVorticityConfinement( true );
+			solver.setSolverMode( modes[m] ).setSolverIterations( iterations[m] ).setSolverStatsEnabled().enablePoissonProjection( true );
+			
+			Timer timer( true );
+			float maxResidual = 0;
+			int projectIterations = 0;
+			for( int step = 0; step < numSteps; ++step ) {
+				float angle = step * 0.1f;
+				Vec2f pos( 0.5f + 0.3f * math<float>::cos( angle ), 0.5f + 0.3f * math<float>::sin( angle ) );
+				solver.addForceAtPos( pos, Vec2f( -math<float>::sin( angle ), math<float>::cos( angle ) ) * 0.05f );
+				solver.addColorAtPos( pos, Color( 1, 0.5f, 0.25f ) );
+				solver.update();
+				maxResidual = std::max( maxResidual, solver.getProjectStats().residual );
+				projectIterations += solver.getProjectStats().iterations;
+			}
+			double stepMs = timer.getSeconds() * 1000 / numSteps;
+			
+			float maxVelDiff = 0, maxColorDiff = 0;
+			for( int y = 0; y < sizes[s]; ++y ) {
+				for( int x = 0; x < sizes[s]; ++x ) {
+					Vec2f pos( ( x + 0.5f ) / sizes[s], ( y + 0.5f ) / sizes[s] );
+					Vec2f vel[2];
+					Color color[2];
+					solvers[0].getInfoAtPos( pos.x, pos.y, &vel[0], &color[0] );
+					solver.getInfoAtPos( pos.x, pos.y, &vel[1], &color[1] );
+					maxVelDiff = std::max( maxVelDiff, vel[0].distance( vel[1] ) );
+					maxColorDiff = std::max( maxColorDiff, math<float>::abs( color[0].r - color[1].r ) );
+				}
+			}
+			
+			console() << sizes[s] << "x" << sizes[s] << " " << names[m] << ": " << stepMs << "ms per step, "
+					<< projectIterations / (float)numSteps << " projection iterations per step, max residual " << maxResidual
+					<< ", max difference: velocity " << maxVelDiff << " color " << maxColorDiff << std::endl;
+		}
+	}
+}
+
 void msaFluidBasicApp::mouseMove( MouseEvent event )
 {
 	Vec2f mouseNorm = Vec2f( event.getPos() ) / getWindowSize();
@@ -7,31 +7,30 @@
  */
 #pragma once
 
-#include "Particle.h"
+#include "ciMsaFluidParticles.h"
 #include "cinder/Vector.h"
 
+#include <vector>
+
 #define MAX_PARTICLES		50000
 
 
 class ParticleSystem {
 public:	
 	
-    float posArray[MAX_PARTICLES * 2 * 2];
-    float colArray[MAX_PARTICLES * 3 * 2];
+	std::vector<float>	posArray;
+	std::vector<float>	colArray;
 	ci::Vec2i	windowSize;
 	ci::Vec2f	invWindowSize;
 	const ciMsaFluidSolver	*solver;
 	
-    int curIndex;
-	
-    Particle particles[MAX_PARTICLES];
+	ciMsaFluidParticles	particles;
 	
 	ParticleSystem();
 	void setFluidSolver( const ciMsaFluidSolver *aSolver ) { solver = aSolver; }
 	
     void updateAndDraw( bool drawingFluid );
 	void addParticles( const ci::Vec2f &pos, int count );
-	void addParticle( const ci::Vec2f &pos );
 	void setWindowSize( ci::Vec2i winSize );
 };
 
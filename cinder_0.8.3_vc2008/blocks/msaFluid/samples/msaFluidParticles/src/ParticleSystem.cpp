@@ -13,9 +13,15 @@
 
 using namespace ci;
 
-ParticleSystem::ParticleSystem() 
+// the per frame alpha decay of the original Particle, which died once its alpha fell below MIN_ALPHA
+static const float ALPHA_DECAY = 0.999f;
+static const float MIN_ALPHA = 0.01f;
+
+ParticleSystem::ParticleSystem()
+: particles( MAX_PARTICLES )
 {
-	curIndex = 0;
+	// the fluid force and glitter of the original Particle objects
+	particles.setFluidForce( 0.6f ).setGlitter( 0.5f );
 	setWindowSize( Vec2i( 1, 1 ) );
 }
 
@@ -23,27 +29,62 @@ void ParticleSystem::setWindowSize( Vec2i winSize )
 {
 	windowSize = winSize;
 	invWindowSize = Vec2f( 1.0f / winSize.x, 1.0f / winSize.y );
+	particles.setWorldSize( windowSize );
 }
 
 void ParticleSystem::updateAndDraw( bool drawingFluid ){
+	particles.update( *solver );
+	
+	const size_t count = particles.getNumParticles();
+	if( count == 0 )
+		return;
+	
+	posArray.resize( count * 4 );
+	colArray.resize( count * 6 );
+	const float *px = particles.getPositionsX(), *py = particles.getPositionsY();
+	const float *vx = particles.getVelocitiesX(), *vy = particles.getVelocitiesY();
+	const float *age = particles.getAges();
+	const float *mass = particles.getMasses();
+	const ColorA *color = particles.getColors();
+	
+	for( size_t i = 0; i < count; i++ ) {
+		float *pos = &posArray[i * 4];
+		pos[0] = px[i] - vx[i];
+		pos[1] = py[i] - vy[i];
+		pos[2] = px[i];
+		pos[3] = py[i];
+		
+		// fade out exponentially, as the original Particle did
+		float alpha = color[i].a * math<float>::pow( ALPHA_DECAY, age[i] );
+		Color c( alpha, alpha, alpha );
+		if( ! drawingFluid ) {
+			// when not drawing the fluid, color by speed
+			float vxNorm = vx[i] * invWindowSize.x;
+			float vyNorm = vy[i] * invWindowSize.y;
+			float v2 = vxNorm * vxNorm + vyNorm * vyNorm;
+#define VMAX 0.013f
+			if(v2>VMAX*VMAX) v2 = VMAX*VMAX;
+			c = Color( CM_HSV, 0, v2 / ( VMAX * VMAX ), lerp( 0.5f, 1.0f, mass[i] ) * alpha );
+		}
+		
+		float *col = &colArray[i * 6];
+		col[0] = col[3] = c.r;
+		col[1] = col[4] = c.g;
+		col[2] = col[5] = c.b;
+	}
+
 	glEnable(GL_BLEND);
 	glDisable( GL_TEXTURE_2D );
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glEnable(GL_LINE_SMOOTH);       
 	
-	for(int i=0; i<MAX_PARTICLES; i++) {
-		if(particles[i].alpha > 0) {
-			particles[i].update( *solver, windowSize, invWindowSize );
-			particles[i].updateVertexArrays( drawingFluid, invWindowSize, i, posArray, colArray);
-		}
-	}    
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(2, GL_FLOAT, 0, posArray);
+	glVertexPointer(2, GL_FLOAT, 0, &posArray[0]);
 	
 	glEnableClientState(GL_COLOR_ARRAY);
-	glColorPointer(3, GL_FLOAT, 0, colArray);
+	glColorPointer(3, GL_FLOAT, 0, &colArray[0]);
 	
-	glDrawArrays(GL_LINES, 0, MAX_PARTICLES * 2);
+	glDrawArrays(GL_LINES, 0, count * 2);
 
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_COLOR_ARRAY);
@@ -53,13 +94,11 @@ void ParticleSystem::updateAndDraw( bool drawingFluid ){
 
 
 void ParticleSystem::addParticles( const Vec2f &pos, int count ){
-	for(int i=0; i<count; i++)
-		addParticle( pos + Rand::randVec2f() * 15 );
-}
-
-
-void ParticleSystem::addParticle( const Vec2f &pos ) {
-	particles[curIndex].init( pos.x, pos.y );
-	curIndex++;
-	if(curIndex >= MAX_PARTICLES) curIndex = 0;
+	// once MAX_PARTICLES are alive, new particles replace the oldest ones
+	for(int i=0; i<count; i++) {
+		float alpha = Rand::randFloat( 0.3f, 1 );
+		// live until the decayed alpha falls below MIN_ALPHA
+		float lifetime = math<float>::log( MIN_ALPHA / alpha ) / math<float>::log( ALPHA_DECAY );
+		particles.emit( pos, 1, 15, lifetime, ColorA( 1, 1, 1, alpha ), Vec2f::zero(), Rand::randFloat( 0.1f, 1 ) );
+	}
 }
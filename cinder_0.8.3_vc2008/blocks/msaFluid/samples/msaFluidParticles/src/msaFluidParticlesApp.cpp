@@ -1,4 +1,5 @@
 #include "cinder/app/AppBasic.h"
+#include "cinder/Rand.h"
 
 #include "ciMsaFluidSolver.h"
 #include "ciMsaFluidDrawerGl.h"
@@ -16,6 +17,7 @@ class msaFluidParticlesApp : public AppBasic {
 	void	fadeToColor( float r, float g, float b, float speed );
 	void	addToFluid( Vec2f pos, Vec2f vel, bool addColor, bool addForce );
 	void	keyDown( KeyEvent event );
+	void	benchmarkParticles();
 	void	mouseMove( MouseEvent event );
 	void	mouseDrag( MouseEvent event );
 	void	resize( int w, int h );
@@ -142,11 +144,45 @@ void msaFluidParticlesApp::keyDown( KeyEvent event )
 				fluidSolver.update();
 			timer.stop();
 			console() << ITERS << " iterations took " << timer.getSeconds() << " seconds." << std::endl;
+			benchmarkParticles();
 		}
 		break;
     }
 }
 
+// compares updating the same particles as Particle objects and as ciMsaFluidParticles
+void msaFluidParticlesApp::benchmarkParticles()
+{
+	const int NUM_PARTICLES = 200000;
+	const int STEPS = 100;
+	const Vec2f windowSize( getWindowSize() );
+	const Vec2f invWindowSize( 1.0f / windowSize.x, 1.0f / windowSize.y );
+	
+	std::vector<Particle> objects( NUM_PARTICLES );
+	ciMsaFluidParticles soa( NUM_PARTICLES );
+	soa.setWorldSize( windowSize ).setFluidForce( 0.6f ).setGlitter( 0.5f );
+	for( int i = 0; i < NUM_PARTICLES; ++i ) {
+		Vec2f pos( Rand::randFloat( windowSize.x ), Rand::randFloat( windowSize.y ) );
+		objects[i].init( pos.x, pos.y );
+		soa.emit( pos, 1, 0, STEPS + 1, ColorA( 1, 1, 1, 1 ), Vec2f::zero(), objects[i].mass );
+	}
+	
+	Timer timer;
+	timer.start();
+	for( int step = 0; step < STEPS; ++step ) {
+		for( int i = 0; i < NUM_PARTICLES; ++i )
+			objects[i].update( fluidSolver, windowSize, invWindowSize );
+	}
+	timer.stop();
+	console() << "Particle objects: " << NUM_PARTICLES * STEPS / ( timer.getSeconds() * 1000 ) << " particles/ms" << std::endl;
+	
+	timer.start();
+	for( int step = 0; step < STEPS; ++step )
+		soa.update( fluidSolver );
+	timer.stop();
+	console() << "ciMsaFluidParticles: " << NUM_PARTICLES * STEPS / ( timer.getSeconds() * 1000 ) << " particles/ms" << std::endl;
+}
+
 void msaFluidParticlesApp::mouseMove( MouseEvent event )
 {
 	Vec2f mouseNorm = Vec2f( event.getPos() ) / getWindowSize();
@@ -0,0 +1,250 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "ciMsaFluidParticles.h"
+#include "cinder/CinderMath.h"
+#include "cinder/Rand.h"
+#include "cinder/Thread.h"
+
+#include <algorithm>
+
+// below this many particles per thread, starting the threads costs more than it saves
+static const size_t PARTICLES_PER_THREAD = 8192;
+
+// the direction of the glitter kick, hashed from the particle and the step so it doesn't depend on how the
+// particles are split across threads
+static float glitterAngle( uint32_t index, uint32_t step )
+{
+	uint32_t h = ( index * 0x9E3779B9u ) ^ ( step * 0x85EBCA6Bu );
+	h ^= h >> 16;
+	h *= 0x7FEB352Du;
+	h ^= h >> 15;
+	return h * ( 2 * (float)M_PI / 4294967296.0f );
+}
+
+struct ciMsaFluidParticles::UpdateRange {
+	UpdateRange( ciMsaFluidParticles *particles, const ciMsaFluidSolver *solver )
+		: mParticles( particles ), mSolver( solver )
+	{}
+
+	void operator()( size_t begin, size_t end ) const
+	{
+		mParticles->updateRange( *mSolver, begin, end );
+	}
+
+	ciMsaFluidParticles		*mParticles;
+	const ciMsaFluidSolver	*mSolver;
+};
+
+ciMsaFluidParticles::ciMsaFluidParticles()
+: capacity( 0 )
+, numParticles( 0 )
+, head( 0 )
+, step( 0 )
+, worldSize( 1, 1 )
+, fluidForce( 0.3f )
+, momentum( 0.5f )
+, glitter( 0 )
+{
+}
+
+ciMsaFluidParticles::ciMsaFluidParticles( size_t capacity )
+: capacity( 0 )
+, numParticles( 0 )
+, head( 0 )
+, step( 0 )
+, worldSize( 1, 1 )
+, fluidForce( 0.3f )
+, momentum( 0.5f )
+, glitter( 0 )
+{
+	setCapacity( capacity );
+}
+
+ciMsaFluidParticles& ciMsaFluidParticles::setCapacity( size_t capacity )
+{
+	// keep the newest particles that fit
+	if( numParticles > capacity ) {
+		head += numParticles - capacity;
+		numParticles = capacity;
+	}
+	moveToFront();
+	
+	this->capacity = capacity;
+	posX.resize( capacity * 2 );
+	posY.resize( capacity * 2 );
+	velX.resize( capacity * 2 );
+	velY.resize( capacity * 2 );
+	age.resize( capacity * 2 );
+	lifetime.resize( capacity * 2 );
+	mass.resize( capacity * 2 );
+	color.resize( capacity * 2 );
+	return *this;
+}
+
+ciMsaFluidParticles& ciMsaFluidParticles::setWorldSize( const ci::Vec2f &worldSize )
+{
+	this->worldSize = worldSize;
+	return *this;
+}
+
+ciMsaFluidParticles& ciMsaFluidParticles::setFluidForce( float fluidForce )
+{
+	this->fluidForce = fluidForce;
+	return *this;
+}
+
+ciMsaFluidParticles& ciMsaFluidParticles::setMomentum( float momentum )
+{
+	this->momentum = momentum;
+	return *this;
+}
+
+ciMsaFluidParticles& ciMsaFluidParticles::setGlitter( float glitter )
+{
+	this->glitter = glitter;
+	return *this;
+}
+
+void ciMsaFluidParticles::emit( const ci::Vec2f &pos, size_t count, float spread, float lifetime, const ci::ColorA &color, const ci::Vec2f &vel, float mass )
+{
+	if( capacity == 0 )
+		return;
+	
+	for( size_t n = 0; n < count; ++n ) {
+		// overwrite the oldest particle
+		if( numParticles == capacity ) {
+			++head;
+			--numParticles;
+		}
+		if( head + numParticles == posX.size() )
+			moveToFront();
+		
+		const size_t i = head + numParticles++;
+		ci::Vec2f p = pos + ci::Rand::randVec2f() * ci::Rand::randFloat( spread );
+		posX[i] = p.x;
+		posY[i] = p.y;
+		velX[i] = vel.x;
+		velY[i] = vel.y;
+		age[i] = 0;
+		this->lifetime[i] = lifetime;
+		this->mass[i] = mass;
+		this->color[i] = color;
+	}
+}
+
+void ciMsaFluidParticles::clear()
+{
+	numParticles = 0;
+	head = 0;
+}
+
+void ciMsaFluidParticles::update( const ciMsaFluidSolver &solver )
+{
+	ci::parallelFor( numParticles, UpdateRange( this, &solver ), PARTICLES_PER_THREAD );
+	++step;
+	removeDead();
+}
+
+void ciMsaFluidParticles::updateRange( const ciMsaFluidSolver &solver, size_t begin, size_t end )
+{
+	float fluidX[BATCH_SIZE], fluidY[BATCH_SIZE];
+	float fluidVelX[BATCH_SIZE], fluidVelY[BATCH_SIZE];
+	
+	const float invWidth = 1 / worldSize.x, invHeight = 1 / worldSize.y;
+	const float width = worldSize.x, height = worldSize.y;
+	const float forceX = fluidForce * width, forceY = fluidForce * height;
+	
+	for( size_t batch = begin; batch < end; batch += BATCH_SIZE ) {
+		const size_t count = std::min<size_t>( (size_t)BATCH_SIZE, end - batch );
+		float *px = &posX[head + batch], *py = &posY[head + batch];
+		float *vx = &velX[head + batch], *vy = &velY[head + batch];
+		float *a = &age[head + batch];
+		const float *m = &mass[head + batch];
+		
+		for( size_t i = 0; i < count; ++i ) {
+			fluidX[i] = px[i] * invWidth;
+			fluidY[i] = py[i] * invHeight;
+		}
+		solver.getVelocitiesAtPos( fluidX, fluidY, count, fluidVelX, fluidVelY );
+		
+		for( size_t i = 0; i < count; ++i ) {
+			float x = px[i] + ( vx[i] = fluidVelX[i] * forceX * m[i] + vx[i] * momentum );
+			float y = py[i] + ( vy[i] = fluidVelY[i] * forceY * m[i] + vy[i] * momentum );
+			// bounce off the edges
+			if( x < 0 || x > width ) {
+				x = ( x < 0 ) ? 0 : width;
+				vx[i] = -vx[i];
+			}
+			if( y < 0 || y > height ) {
+				y = ( y < 0 ) ? 0 : height;
+				vy[i] = -vy[i];
+			}
+			px[i] = x;
+			py[i] = y;
+			a[i] += 1;
+			
+			if( ( glitter > 0 ) && ( vx[i] * vx[i] + vy[i] * vy[i] < 1 ) ) {
+				const float angle = glitterAngle( (uint32_t)( batch + i ), step );
+				vx[i] += ci::math<float>::cos( angle ) * glitter;
+				vy[i] += ci::math<float>::sin( angle ) * glitter;
+			}
+		}
+	}
+}
+
+void ciMsaFluidParticles::removeDead()
+{
+	// keeps the order of the live particles, so the oldest stay first
+	size_t live = head;
+	for( size_t i = head; i < head + numParticles; ++i ) {
+		if( age[i] >= lifetime[i] )
+			continue;
+		if( live != i )
+			copyParticle( live, i );
+		++live;
+	}
+	numParticles = live - head;
+	if( numParticles == 0 )
+		head = 0;
+}
+
+void ciMsaFluidParticles::copyParticle( size_t to, size_t from )
+{
+	posX[to] = posX[from];
+	posY[to] = posY[from];
+	velX[to] = velX[from];
+	velY[to] = velY[from];
+	age[to] = age[from];
+	lifetime[to] = lifetime[from];
+	mass[to] = mass[from];
+	color[to] = color[from];
+}
+
+void ciMsaFluidParticles::moveToFront()
+{
+	if( head == 0 )
+		return;
+	for( size_t i = 0; i < numParticles; ++i )
+		copyParticle( i, head + i );
+	head = 0;
+}
@@ -46,6 +46,15 @@
 
 #include "ciMsaFluidSolver.h"
 #include "cinder/Rand.h"
+#include "cinder/Thread.h"
+
+#include <boost/thread/barrier.hpp>
+#include <vector>
+
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+#	include <emmintrin.h>
+#	include <xmmintrin.h>
+#endif
 
 ciMsaFluidSolver::ciMsaFluidSolver()
 :r(NULL)
@@ -57,6 +66,11 @@ ciMsaFluidSolver::ciMsaFluidSolver()
 ,uv(NULL)
 ,uvOld(NULL)
 ,curl(NULL)
+,doPoissonProjection(false)
+,solverMode(SOLVER_GAUSS_SEIDEL)
+,numThreads(0)
+,solverTolerance(FLUID_DEFAULT_SOLVER_TOLERANCE)
+,solverStatsEnabled(false)
 ,_isInited(false)
 {
 }
@@ -86,6 +100,7 @@ ciMsaFluidSolver& ciMsaFluidSolver::setup(int NX, int NY)
 	setDeltaT();
 	setFadeSpeed();
 	setSolverIterations();
+	setSolverTolerance();
 	enableVorticityConfinement(false);
 	setWrap( false, false );
 	
@@ -127,12 +142,57 @@ bool ciMsaFluidSolver::getVorticityConfinement() {
 	return doVorticityConfinement;
 }
 
+ciMsaFluidSolver& ciMsaFluidSolver::enablePoissonProjection( bool b ) {
+	doPoissonProjection = b;
+	return *this;
+}
+
+bool ciMsaFluidSolver::getPoissonProjection() const {
+	return doPoissonProjection;
+}
+
 ciMsaFluidSolver& ciMsaFluidSolver::setWrap( bool bx, bool by ) {
 	wrap_x = bx;
 	wrap_y = by;
 	return *this;
 }
 
+ciMsaFluidSolver& ciMsaFluidSolver::setSolverMode( SolverMode mode ) {
+	solverMode = mode;
+	return *this;
+}
+
+ciMsaFluidSolver::SolverMode ciMsaFluidSolver::getSolverMode() const {
+	return solverMode;
+}
+
+ciMsaFluidSolver& ciMsaFluidSolver::setNumThreads( int numThreads ) {
+	this->numThreads = numThreads;
+	return *this;
+}
+
+int ciMsaFluidSolver::getNumThreads() const {
+	return numThreads;
+}
+
+ciMsaFluidSolver& ciMsaFluidSolver::setSolverTolerance( float tolerance ) {
+	solverTolerance = tolerance;
+	return *this;
+}
+
+float ciMsaFluidSolver::getSolverTolerance() const {
+	return solverTolerance;
+}
+
+ciMsaFluidSolver& ciMsaFluidSolver::setSolverStatsEnabled( bool enabled ) {
+	solverStatsEnabled = enabled;
+	return *this;
+}
+
+bool ciMsaFluidSolver::getSolverStatsEnabled() const {
+	return solverStatsEnabled;
+}
+
 bool ciMsaFluidSolver::isInited() const {
 	return _isInited;
 }
@@ -156,6 +216,7 @@ void ciMsaFluidSolver::destroy() {
 	if(uv)		delete []uv;
 	if(uvOld)	delete []uvOld;
 	if(curl)       delete []curl;
+	_multigrid.clear();
 }
 
 
@@ -182,6 +243,8 @@ void ciMsaFluidSolver::reset() {
 		curl[i] = 0.0f;
 		r[i] = rOld[i] = g[i] = gOld[i] = b[i] = bOld[i] = 0;
 	}
+	_projectStats.iterations = _diffuseStats.iterations = 0;
+	_projectStats.residual = _diffuseStats.residual = 0;
 }
 
 // return total number of cells (_NX+2) * (_NY+2)
@@ -260,20 +323,32 @@ float ciMsaFluidSolver::calcCurl( int i, int j)
 }
 
 void ciMsaFluidSolver::vorticityConfinement(ci::Vec2f* Fvc_xy) {
-	float dw_dx, dw_dy;
-	float length;
-	float v;
-	
+	_pass.xy = Fvc_xy;
+	// the force at each cell depends on the curl of its neighbors, so the curl is completed first
+	runBands( &ciMsaFluidSolver::curlBand );
+	runBands( &ciMsaFluidSolver::vorticityBand );
+}
+
+void ciMsaFluidSolver::curlBand( const Band &band ) {
 	// Calculate magnitude of calcCurl(u,v) for each cell. (|w|)
-	for (int j = _NY; j > 0; --j )
+	for (int j = band.jEnd - 1; j >= band.jBegin; --j )
 	{
 		for (int i = _NX; i > 0; --i )
 		{
 			curl[FLUID_IX(i, j)] = fabs(calcCurl(i, j));
 		}
 	}
+}
+
+void ciMsaFluidSolver::vorticityBand( const Band &band ) {
+	float dw_dx, dw_dy;
+	float length;
+	float v;
+	ci::Vec2f *Fvc_xy = _pass.xy;
 	
-	for (int j = _NY-1; j > 1; --j )	//for (int j = 2; j < _NY; j++)
+	const int jBegin = std::max( band.jBegin, 2 );
+	const int jEnd = std::min( band.jEnd, _NY );
+	for (int j = jEnd - 1; j >= jBegin; --j )	//for (int j = 2; j < _NY; j++)
 	{
 		for (int i = _NX-1; i > 1; --i )		//for (int i = 2; i < _NX; i++)		
 		{
@@ -299,7 +374,67 @@ void ciMsaFluidSolver::vorticityConfinement(ci::Vec2f* Fvc_xy) {
 	}
 }
 
+void ciMsaFluidSolver::getVelocitiesAtPos( const float *x, const float *y, size_t count, float *velX, float *velY ) const
+{
+	// cell i covers [i, i + 1) / (_NX + 2), so its center is at (i + 0.5) / (_NX + 2)
+	const int step = _NX + 2;
+	const float scaleX = (float)( _NX + 2 ), scaleY = (float)( _NY + 2 );
+	size_t p = 0;
+
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+	const __m128 half = _mm_set1_ps( 0.5f ), zero = _mm_setzero_ps(), one = _mm_set1_ps( 1.0f );
+	const __m128 maxX = _mm_set1_ps( (float)( _NX + 1 ) ), maxY = _mm_set1_ps( (float)( _NY + 1 ) );
+	const __m128 maxCellX = _mm_set1_ps( (float)_NX ), maxCellY = _mm_set1_ps( (float)_NY );
+	const __m128 stepF = _mm_set1_ps( (float)step );
+	for( ; p + 4 <= count; p += 4 ) {
+		// _mm_max_ps returns its second operand for a NaN, so NaN positions clamp to 0
+		__m128 fx = _mm_min_ps( _mm_max_ps( _mm_sub_ps( _mm_mul_ps( _mm_loadu_ps( x + p ), _mm_set1_ps( scaleX ) ), half ), zero ), maxX );
+		__m128 fy = _mm_min_ps( _mm_max_ps( _mm_sub_ps( _mm_mul_ps( _mm_loadu_ps( y + p ), _mm_set1_ps( scaleY ) ), half ), zero ), maxY );
+		// truncation is floor for the clamped, positive coordinates
+		__m128 cellX = _mm_cvtepi32_ps( _mm_cvttps_epi32( _mm_min_ps( fx, maxCellX ) ) );
+		__m128 cellY = _mm_cvtepi32_ps( _mm_cvttps_epi32( _mm_min_ps( fy, maxCellY ) ) );
+		__m128 sx = _mm_sub_ps( fx, cellX ), sy = _mm_sub_ps( fy, cellY );
+		
+		// SSE2 has no 32 bit integer multiply, but the cell indices are exact as floats
+		int indices[4];
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( indices ), _mm_cvttps_epi32( _mm_add_ps( cellX, _mm_mul_ps( cellY, stepF ) ) ) );
+		float u00[4], u10[4], u01[4], u11[4], v00[4], v10[4], v01[4], v11[4];
+		for( int k = 0; k < 4; ++k ) {
+			const ci::Vec2f *cell = uv + indices[k];
+			u00[k] = cell[0].x;			v00[k] = cell[0].y;
+			u10[k] = cell[1].x;			v10[k] = cell[1].y;
+			u01[k] = cell[step].x;		v01[k] = cell[step].y;
+			u11[k] = cell[step + 1].x;	v11[k] = cell[step + 1].y;
+		}
+		
+		__m128 tx = _mm_sub_ps( one, sx ), ty = _mm_sub_ps( one, sy );
+		__m128 u0 = _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( u00 ), tx ), _mm_mul_ps( _mm_loadu_ps( u10 ), sx ) );
+		__m128 u1 = _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( u01 ), tx ), _mm_mul_ps( _mm_loadu_ps( u11 ), sx ) );
+		__m128 v0 = _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( v00 ), tx ), _mm_mul_ps( _mm_loadu_ps( v10 ), sx ) );
+		__m128 v1 = _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( v01 ), tx ), _mm_mul_ps( _mm_loadu_ps( v11 ), sx ) );
+		_mm_storeu_ps( velX + p, _mm_add_ps( _mm_mul_ps( u0, ty ), _mm_mul_ps( u1, sy ) ) );
+		_mm_storeu_ps( velY + p, _mm_add_ps( _mm_mul_ps( v0, ty ), _mm_mul_ps( v1, sy ) ) );
+	}
+#endif
+
+	for( ; p < count; ++p ) {
+		// ordered so NaN positions clamp to 0, like the SSE path, rather than reach the int conversion
+		float fx = std::max( 0.0f, std::min( x[p] * scaleX - 0.5f, (float)( _NX + 1 ) ) );
+		float fy = std::max( 0.0f, std::min( y[p] * scaleY - 0.5f, (float)( _NY + 1 ) ) );
+		int i = std::min( (int)fx, _NX ), j = std::min( (int)fy, _NY );
+		float sx = fx - i, sy = fy - j;
+		const ci::Vec2f *cell = uv + FLUID_IX( i, j );
+		ci::Vec2f v0 = cell[0] * ( 1 - sx ) + cell[1] * sx;
+		ci::Vec2f v1 = cell[step] * ( 1 - sx ) + cell[step + 1] * sx;
+		velX[p] = v0.x * ( 1 - sy ) + v1.x * sy;
+		velY[p] = v0.y * ( 1 - sy ) + v1.y * sy;
+	}
+}
+
 void ciMsaFluidSolver::update() {
+	_projectStats.iterations = _diffuseStats.iterations = 0;
+	_projectStats.residual = _diffuseStats.residual = 0;
+	
 	addSourceUV();
 	
 	if( doVorticityConfinement )
@@ -331,7 +466,7 @@ void ciMsaFluidSolver::update() {
 			swapRGB();
 		}
 		
-		advectRGB(0, uv);
+		advectRGB(uv);
 		fadeRGB();
 	} 
 	else
@@ -487,14 +622,25 @@ void ciMsaFluidSolver::addSource(float* x, float* x0) {
 }
 
 void ciMsaFluidSolver::advect( int bound, float* d, const float* d0, const ci::Vec2f* duv) {
+	_pass.x = d;
+	_pass.x0 = d0;
+	_pass.duv = duv;
+	runBands( &ciMsaFluidSolver::advectBand );
+	setBoundary(bound, d);
+}
+
+void ciMsaFluidSolver::advectBand( const Band &band ) {
 	int i0, j0, i1, j1;
 	float x, y, s0, t0, s1, t1;
 	int	index;
+	float *d = _pass.x;
+	const float *d0 = _pass.x0;
+	const ci::Vec2f *duv = _pass.duv;
 	
 	const float dt0x = _dt * _NX;
 	const float dt0y = _dt * _NY;
 	
-	for (int j = _NY; j > 0; --j)
+	for (int j = band.jEnd - 1; j >= band.jBegin; --j)
 	{
 		for (int i = _NX; i > 0; --i)
 		{
@@ -524,21 +670,30 @@ void ciMsaFluidSolver::advect( int bound, float* d, const float* d0, const ci::V
 			
 		}
 	}
-	setBoundary(bound, d);
 }
 
 //          d    d0    du    dv
 // advect(1, u, uOld, uOld, vOld);
 // advect(2, v, vOld, uOld, vOld);
 void ciMsaFluidSolver::advect2d( ci::Vec2f *uv, const ci::Vec2f *duv ) {
+	_pass.xy = uv;
+	_pass.duv = duv;
+	runBands( &ciMsaFluidSolver::advect2dBand );
+	setBoundary2d(1, uv);
+	setBoundary2d(2, uv);	
+}
+
+void ciMsaFluidSolver::advect2dBand( const Band &band ) {
 	int i0, j0, i1, j1;
 	float s0, t0, s1, t1;
 	int	index;
+	ci::Vec2f *uv = _pass.xy;
+	const ci::Vec2f *duv = _pass.duv;
 	
 	const float dt0x = _dt * _NX;
 	const float dt0y = _dt * _NY;
 	
-	for (int j = _NY; j > 0; --j)
+	for (int j = band.jEnd - 1; j >= band.jBegin; --j)
 	{
 		for (int i = _NX; i > 0; --i)
 		{
@@ -570,19 +725,24 @@ void ciMsaFluidSolver::advect2d( ci::Vec2f *uv, const ci::Vec2f *duv ) {
 			
 		}
 	}
-	setBoundary2d(1, uv);
-	setBoundary2d(2, uv);	
 }
 
-void ciMsaFluidSolver::advectRGB(int bound, const ci::Vec2f* duv) {
+void ciMsaFluidSolver::advectRGB(const ci::Vec2f* duv) {
+	_pass.duv = duv;
+	runBands( &ciMsaFluidSolver::advectRGBBand );
+	setBoundaryRGB();
+}
+
+void ciMsaFluidSolver::advectRGBBand( const Band &band ) {
 	int i0, j0;
 	float x, y, s0, t0, s1, t1, dt0x, dt0y;
 	int	index;
+	const ci::Vec2f *duv = _pass.duv;
 	
 	dt0x = _dt * _NX;
 	dt0y = _dt * _NY;
 	
-	for (int j = _NY; j > 0; --j)
+	for (int j = band.jEnd - 1; j >= band.jBegin; --j)
 	{
 		for (int i = _NX; i > 0; --i)
 		{
@@ -612,53 +772,108 @@ void ciMsaFluidSolver::advectRGB(int bound, const ci::Vec2f* duv) {
 			b[index] = s0 * ( t0 * bOld[i0] + t1 * bOld[j0] ) + s1 * ( t0 * bOld[i0+1] + t1 * bOld[j0+1] );                          
 		}
 	}
-	setBoundaryRGB();
 }
 
 void ciMsaFluidSolver::diffuse( int bound, float* c, float* c0, float diff )
 {
 	float a = _dt * diff * _NX * _NY;	//todo find the exact strategy for using _NX and _NY in the factors
-	linearSolver( bound, c, c0, a, 1.0 + 4 * a );
+	float residual = 0;
+	int iterations = linearSolver( bound, c, c0, a, 1.0 + 4 * a, &residual );
+	if( needsResidualPass() )
+		residual = calcResidual( c, 1, c0, 1, a, 1 + 4 * a );
+	addSolverStats( &_diffuseStats, iterations, residual );
 }
 
 void ciMsaFluidSolver::diffuseRGB( int bound, float diff )
 {
 	float a = _dt * diff * _NX * _NY;
-	linearSolverRGB( a, 1.0 + 4 * a );
+	float residual = 0;
+	int iterations = linearSolverRGB( a, 1.0 + 4 * a, &residual );
+	if( needsResidualPass() ) {
+		residual = std::max( calcResidual( r, 1, rOld, 1, a, 1 + 4 * a ), calcResidual( g, 1, gOld, 1, a, 1 + 4 * a ) );
+		residual = std::max( residual, calcResidual( b, 1, bOld, 1, a, 1 + 4 * a ) );
+	}
+	addSolverStats( &_diffuseStats, iterations, residual );
 }
 
 void ciMsaFluidSolver::diffuseUV( float diff )
 {
 	float a = _dt * diff * _NX * _NY;
-	linearSolverUV( a, 1.0 + 4 * a );
+	float residual = 0;
+	int iterations = linearSolverUV( a, 1.0 + 4 * a, &residual );
+	if( needsResidualPass() )
+		residual = std::max( calcResidual( &uv[0].x, 2, &uvOld[0].x, 2, a, 1 + 4 * a ), calcResidual( &uv[0].y, 2, &uvOld[0].y, 2, a, 1 + 4 * a ) );
+	addSolverStats( &_diffuseStats, iterations, residual );
 }
 
 void ciMsaFluidSolver::project(ci::Vec2f* xy, ci::Vec2f* pDiv) 
+{
+	_pass.xy = xy;
+	_pass.pDiv = pDiv;
+	runBands( &ciMsaFluidSolver::divergenceBand );
+	
+	if( usesPoissonProjection() ) {
+		// the pressure only exists if the divergence sums to zero, which the boundaries only approximate
+		float meanDiv = 0;
+		for (int j = _NY; j > 0; --j)
+			for (int i = _NX; i > 0; --i)
+				meanDiv += pDiv[FLUID_IX(i, j)].y;
+		meanDiv /= _NX * _NY;
+		for (int j = _NY; j > 0; --j)
+			for (int i = _NX; i > 0; --i)
+				pDiv[FLUID_IX(i, j)].y -= meanDiv;
+	}
+	
+	setBoundary02d( reinterpret_cast<ci::Vec2f*>( &pDiv[0].x ));
+	setBoundary02d( reinterpret_cast<ci::Vec2f*>( &pDiv[0].y ));
+	
+	float residual = 0;
+	int iterations = linearSolverProject( pDiv, &residual );
+	if( needsResidualPass() )
+		residual = calcResidual( &pDiv[0].x, 2, &pDiv[0].y, 2, 1, 4 );
+	addSolverStats( &_projectStats, iterations, residual );
+	
+	runBands( &ciMsaFluidSolver::gradientBand );
+	
+	setBoundary2d(1, xy);
+	setBoundary2d(2, xy);
+}
+
+void ciMsaFluidSolver::divergenceBand( const Band &band )
 {
 	float	h;
 	int		index;
 	int		step_x = _NX + 2;
+	const ci::Vec2f *xy = _pass.xy;
+	ci::Vec2f *pDiv = _pass.pDiv;
+	const bool poisson = usesPoissonProjection();
 	
 	h = - 0.5f / _NX;
-	for (int j = _NY; j > 0; --j)
+	for (int j = band.jEnd - 1; j >= band.jBegin; --j)
 	{
 		index = FLUID_IX(_NX, j);
 		for (int i = _NX; i > 0; --i)
 		{
-			pDiv[index].x = h * ( xy[index+1].x - xy[index-1].x + xy[index+step_x].y - xy[index-step_x].y );
-			pDiv[index].y = 0;
+			// the Poisson projection starts the pressure in x at zero and solves for it with the divergence in y. The original
+			// projection starts from the divergence in x and relaxes it against zero
+			const float div = h * ( xy[index+1].x - xy[index-1].x + xy[index+step_x].y - xy[index-step_x].y );
+			pDiv[index].x = poisson ? 0 : div;
+			pDiv[index].y = poisson ? div : 0;
 			--index;
 		}
 	}
-	
-	setBoundary02d( reinterpret_cast<ci::Vec2f*>( &pDiv[0].x ));
-	setBoundary02d( reinterpret_cast<ci::Vec2f*>( &pDiv[0].y ));
-	
-	linearSolverProject( pDiv );
+}
+
+void ciMsaFluidSolver::gradientBand( const Band &band )
+{
+	int		index;
+	int		step_x = _NX + 2;
+	ci::Vec2f *xy = _pass.xy;
+	const ci::Vec2f *pDiv = _pass.pDiv;
 	
 	float fx = 0.5f * _NX;
 	float fy = 0.5f * _NY;	//maa	change it from _NX to _NY
-	for (int j = _NY; j > 0; --j)
+	for (int j = band.jEnd - 1; j >= band.jBegin; --j)
 	{
 		index = FLUID_IX(_NX, j);
 		for (int i = _NX; i > 0; --i)
@@ -668,18 +883,30 @@ void ciMsaFluidSolver::project(ci::Vec2f* xy, ci::Vec2f* pDiv)
 			--index;
 		}
 	}
-	
-	setBoundary2d(1, xy);
-	setBoundary2d(2, xy);
 }
 
-
 //	Gauss-Seidel relaxation
-void ciMsaFluidSolver::linearSolver( int bound, float* __restrict x, const float* __restrict x0, float a, float c )
+int ciMsaFluidSolver::linearSolver( int bound, float* __restrict x, const float* __restrict x0, float a, float c, float *residual )
 {
 	int	step_x = _NX + 2;
 	int index;
+	if( solverMode == SOLVER_MULTIGRID ) {
+		int cycles;
+		*residual = multigridSolve( bound, x, x0, a, c, &cycles );
+		return cycles;
+	}
+
 	c = 1. / c;
+	if( solverMode == SOLVER_RED_BLACK ) {
+		_pass.bound = bound;
+		_pass.x = x;
+		_pass.x0 = x0;
+		_pass.a = a;
+		_pass.c = c;
+		runBands( &ciMsaFluidSolver::linearSolverRedBlack );
+		return solverIterations;
+	}
+
 	for (int k = solverIterations; k > 0; --k)	// MEMO 
 	{
 		for (int j = _NY; j > 0 ; --j)
@@ -693,12 +920,34 @@ void ciMsaFluidSolver::linearSolver( int bound, float* __restrict x, const float
 		}
 		setBoundary( bound, x );
 	}
+	return solverIterations;
 }
 
-void ciMsaFluidSolver::linearSolverProject( ci::Vec2f* __restrict pdiv )
+int ciMsaFluidSolver::linearSolverProject( ci::Vec2f* __restrict pdiv, float *residual )
 {
 	int	step_x = _NX + 2;
 	int index;
+	if( solverMode == SOLVER_MULTIGRID ) {
+		setupMultigrid();
+		float *x = &_multigrid[0].x[0];
+		float *rhs = &_multigrid[0].rhs[0];
+		for (int i = 0; i < _numCells; ++i) {
+			x[i] = pdiv[i].x;
+			rhs[i] = pdiv[i].y;
+		}
+		int cycles;
+		*residual = multigridSolve( 0, x, rhs, 1, 4, &cycles );
+		for (int i = 0; i < _numCells; ++i)
+			pdiv[i].x = x[i];
+		return cycles;
+	}
+
+	if( solverMode == SOLVER_RED_BLACK ) {
+		_pass.pDiv = pdiv;
+		runBands( &ciMsaFluidSolver::linearSolverProjectRedBlack );
+		return solverIterations;
+	}
+
 	for (int k = solverIterations; k > 0; --k) {
 		for (int j = _NY; j > 0 ; --j) {
 			index = FLUID_IX(_NX, j );
@@ -712,13 +961,29 @@ void ciMsaFluidSolver::linearSolverProject( ci::Vec2f* __restrict pdiv )
 		}
 		setBoundary02d( reinterpret_cast<ci::Vec2f*>( &pdiv[0].x ) );
 	}
+	return solverIterations;
 }
 
-void ciMsaFluidSolver::linearSolverRGB( float a, float c )
+int ciMsaFluidSolver::linearSolverRGB( float a, float c, float *residual )
 {
 	int index3, index4, index;
 	int	step_x = _NX + 2;
+	if( solverMode == SOLVER_MULTIGRID ) {
+		int cycles[3];
+		*residual = multigridSolve( 0, r, rOld, a, c, &cycles[0] );
+		*residual = std::max( *residual, multigridSolve( 0, g, gOld, a, c, &cycles[1] ) );
+		*residual = std::max( *residual, multigridSolve( 0, b, bOld, a, c, &cycles[2] ) );
+		return cycles[0] + cycles[1] + cycles[2];
+	}
+
 	c = 1. / c;
+	if( solverMode == SOLVER_RED_BLACK ) {
+		_pass.a = a;
+		_pass.c = c;
+		runBands( &ciMsaFluidSolver::linearSolverRGBRedBlack );
+		return solverIterations;
+	}
+
 	for ( int k = solverIterations; k > 0; --k )	// MEMO
 	{           
 		for (int j = _NY; j > 0 ; --j)
@@ -741,13 +1006,41 @@ void ciMsaFluidSolver::linearSolverRGB( float a, float c )
 		}
 		setBoundaryRGB();	
 	}
+	return solverIterations;
 }
 
-void ciMsaFluidSolver::linearSolverUV( float a, float c )
+int ciMsaFluidSolver::linearSolverUV( float a, float c, float *residual )
 {
 	int index;
 	int	step_x = _NX + 2;
+	if( solverMode == SOLVER_MULTIGRID ) {
+		setupMultigrid();
+		float *x = &_multigrid[0].x[0];
+		float *rhs = &_multigrid[0].rhs[0];
+		int cycles = 0;
+		for (int component = 0; component < 2; ++component) {
+			for (int i = 0; i < _numCells; ++i) {
+				x[i] = uv[i][component];
+				rhs[i] = uvOld[i][component];
+			}
+			int componentCycles;
+			float componentResidual = multigridSolve( component + 1, x, rhs, a, c, &componentCycles );
+			*residual = ( component == 0 ) ? componentResidual : std::max( *residual, componentResidual );
+			for (int i = 0; i < _numCells; ++i)
+				uv[i][component] = x[i];
+			cycles += componentCycles;
+		}
+		return cycles;
+	}
+
 	c = 1. / c;
+	if( solverMode == SOLVER_RED_BLACK ) {
+		_pass.a = a;
+		_pass.c = c;
+		runBands( &ciMsaFluidSolver::linearSolverUVRedBlack );
+		return solverIterations;
+	}
+
 	ci::Vec2f* __restrict localUV = uv;
 	const ci::Vec2f* __restrict localOldUV = uvOld;
 
@@ -769,6 +1062,420 @@ void ciMsaFluidSolver::linearSolverUV( float a, float c )
 		}
 		setBoundary2d( 1, uv );
 	}
+	return solverIterations;
+}
+
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+//	SSE2 red-black row kernels. The cells of one color are every other float (or every other Vec2f), so each kernel
+//	deinterleaves its operands with shuffles and relaxes several cells at once. Only the cells being relaxed are
+//	stored: writing the other color back as well would make the next loads straddle those stores and stall. The sums
+//	are ordered as in the scalar loops, so results are identical. Each returns the first cell it left to the scalar loop.
+//	The pressure relaxation only updates .x of each Vec2f, so packing its operands costs more than it saves and it
+//	stays scalar.
+static inline __m128 loadEven( const float *p )
+{
+	return _mm_shuffle_ps( _mm_loadu_ps( p ), _mm_loadu_ps( p + 4 ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+}
+
+static inline int relaxRowSse( float *x, const float *x0, int index, int indexEnd, int step_x, float a, float c )
+{
+	const __m128 av = _mm_set1_ps( a ), cv = _mm_set1_ps( c );
+	for( ; index + 8 <= indexEnd; index += 8 ) {
+		const float *p = x + index;
+		__m128 sum = _mm_add_ps( _mm_add_ps( _mm_add_ps( loadEven( p - 1 ), loadEven( p + 1 ) ), loadEven( p - step_x ) ), loadEven( p + step_x ) );
+		__m128 result = _mm_mul_ps( _mm_add_ps( _mm_mul_ps( sum, av ), loadEven( x0 + index ) ), cv );
+		_mm_store_ss( x + index, result );
+		_mm_store_ss( x + index + 2, _mm_shuffle_ps( result, result, _MM_SHUFFLE( 1, 1, 1, 1 ) ) );
+		_mm_store_ss( x + index + 4, _mm_movehl_ps( result, result ) );
+		_mm_store_ss( x + index + 6, _mm_shuffle_ps( result, result, _MM_SHUFFLE( 3, 3, 3, 3 ) ) );
+	}
+	return index;
+}
+
+// loads the Vec2f at p and the one two cells further
+static inline __m128 loadEven2d( const float *p )
+{
+	return _mm_shuffle_ps( _mm_loadu_ps( p ), _mm_loadu_ps( p + 4 ), _MM_SHUFFLE( 1, 0, 1, 0 ) );
+}
+
+static inline int relaxRow2dSse( ci::Vec2f *x, const ci::Vec2f *x0, int index, int indexEnd, int step_x, float a, float c )
+{
+	const __m128 av = _mm_set1_ps( a ), cv = _mm_set1_ps( c );
+	for( ; index + 4 <= indexEnd; index += 4 ) {
+		float *p = &x[index].x;
+		__m128 sum = _mm_add_ps( _mm_add_ps( _mm_add_ps( loadEven2d( p - 2 ), loadEven2d( p + 2 ) ), loadEven2d( p - 2 * step_x ) ), loadEven2d( p + 2 * step_x ) );
+		__m128 result = _mm_mul_ps( _mm_add_ps( _mm_mul_ps( sum, av ), loadEven2d( &x0[index].x ) ), cv );
+		_mm_storel_pi( reinterpret_cast<__m64*>( p ), result );
+		_mm_storeh_pi( reinterpret_cast<__m64*>( p + 4 ), result );
+	}
+	return index;
+}
+#endif
+
+//	Red-black Gauss-Seidel relaxation. Cells of one color only read cells of the other color, so neither pass
+//	has a dependency along the row and bands of rows are relaxed concurrently. The bands meet at the barrier after
+//	each pass, and the first band sets the boundaries before the next iteration starts. Rows of the scalar and
+//	velocity grids run through the SSE2 kernels above where available.
+void ciMsaFluidSolver::linearSolverRedBlack( const Band &band )
+{
+	int	step_x = _NX + 2;
+	float* __restrict x = _pass.x;
+	const float* __restrict x0 = _pass.x0;
+	const float a = _pass.a;
+	const float c = _pass.c;
+	for (int k = solverIterations; k > 0; --k)
+	{
+		for (int color = 0; color < 2; ++color)
+		{
+			for (int j = band.jBegin; j < band.jEnd; ++j)
+			{
+				// first cell of this color in row j
+				const int indexEnd = FLUID_IX(_NX + 1, j);
+				int index = FLUID_IX(1 + ( ( 1 + j + color ) & 1 ), j);
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+				index = relaxRowSse( x, x0, index, indexEnd, step_x, a, c );
+#endif
+				for (; index < indexEnd; index += 2)
+					x[index] = ( ( x[index-1] + x[index+1] + x[index - step_x] + x[index + step_x] ) * a + x0[index] ) * c;
+			}
+			band.barrier->wait();
+		}
+		if( band.first )
+			setBoundary( _pass.bound, x );
+		band.barrier->wait();
+	}
+}
+
+void ciMsaFluidSolver::linearSolverProjectRedBlack( const Band &band )
+{
+	int	step_x = _NX + 2;
+	ci::Vec2f* __restrict pdiv = _pass.pDiv;
+	for (int k = solverIterations; k > 0; --k)
+	{
+		for (int color = 0; color < 2; ++color)
+		{
+			for (int j = band.jBegin; j < band.jEnd; ++j)
+			{
+				const int indexEnd = FLUID_IX(_NX + 1, j);
+				for (int index = FLUID_IX(1 + ( ( 1 + j + color ) & 1 ), j); index < indexEnd; index += 2)
+					pdiv[index].x = ( pdiv[index-1].x + pdiv[index+1].x + pdiv[index - step_x].x + pdiv[index + step_x].x + pdiv[index].y ) * .25f;
+			}
+			band.barrier->wait();
+		}
+		if( band.first )
+			setBoundary02d( reinterpret_cast<ci::Vec2f*>( &pdiv[0].x ) );
+		band.barrier->wait();
+	}
+}
+
+void ciMsaFluidSolver::linearSolverRGBRedBlack( const Band &band )
+{
+	int	step_x = _NX + 2;
+	const float a = _pass.a;
+	const float c = _pass.c;
+	for (int k = solverIterations; k > 0; --k)
+	{
+		for (int color = 0; color < 2; ++color)
+		{
+			for (int j = band.jBegin; j < band.jEnd; ++j)
+			{
+				const int indexEnd = FLUID_IX(_NX + 1, j);
+				int index = FLUID_IX(1 + ( ( 1 + j + color ) & 1 ), j);
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+				relaxRowSse( r, rOld, index, indexEnd, step_x, a, c );
+				relaxRowSse( g, gOld, index, indexEnd, step_x, a, c );
+				index = relaxRowSse( b, bOld, index, indexEnd, step_x, a, c );
+#endif
+				for (; index < indexEnd; index += 2)
+				{
+					r[index] = ( ( r[index-1] + r[index+1]  +  r[index - step_x] + r[index + step_x] ) * a  +  rOld[index] ) * c;
+					g[index] = ( ( g[index-1] + g[index+1]  +  g[index - step_x] + g[index + step_x] ) * a  +  gOld[index] ) * c;
+					b[index] = ( ( b[index-1] + b[index+1]  +  b[index - step_x] + b[index + step_x] ) * a  +  bOld[index] ) * c;
+				}
+			}
+			band.barrier->wait();
+		}
+		if( band.first )
+			setBoundaryRGB();
+		band.barrier->wait();
+	}
+}
+
+void ciMsaFluidSolver::linearSolverUVRedBlack( const Band &band )
+{
+	int	step_x = _NX + 2;
+	const float a = _pass.a;
+	const float c = _pass.c;
+	ci::Vec2f* __restrict localUV = uv;
+	const ci::Vec2f* __restrict localOldUV = uvOld;
+	for (int k = solverIterations; k > 0; --k)
+	{
+		for (int color = 0; color < 2; ++color)
+		{
+			for (int j = band.jBegin; j < band.jEnd; ++j)
+			{
+				const int indexEnd = FLUID_IX(_NX + 1, j);
+				int index = FLUID_IX(1 + ( ( 1 + j + color ) & 1 ), j);
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+				index = relaxRow2dSse( localUV, localOldUV, index, indexEnd, step_x, a, c );
+#endif
+				for (; index < indexEnd; index += 2)
+				{
+					localUV[index].x = ( ( localUV[index-1].x + localUV[index+1].x + localUV[index - step_x].x + localUV[index + step_x].x ) * a  + localOldUV[index].x ) * c;
+					localUV[index].y = ( ( localUV[index-1].y + localUV[index+1].y + localUV[index - step_x].y + localUV[index + step_x].y ) * a  + localOldUV[index].y ) * c;
+				}
+			}
+			band.barrier->wait();
+		}
+		if( band.first )
+			setBoundary2d( 1, uv );
+		band.barrier->wait();
+	}
+}
+
+struct ciMsaFluidSolver::BandTask : public ci::ThreadTask {
+	BandTask( ciMsaFluidSolver *solver, BandFn fn, const Band *bands )
+		: mSolver( solver ), mFn( fn ), mBands( bands )
+	{}
+
+	virtual void run( size_t threadIndex ) const
+	{
+		(mSolver->*mFn)( mBands[threadIndex] );
+	}
+
+	ciMsaFluidSolver	*mSolver;
+	BandFn				mFn;
+	const Band			*mBands;
+};
+
+int ciMsaFluidSolver::calcNumBands() const
+{
+	if( solverMode != SOLVER_RED_BLACK )
+		return 1;
+
+	int result = numThreads;
+	if( result <= 0 ) {
+		result = std::max<int>( 1, std::thread::hardware_concurrency() );
+		// with fewer cells than this per thread, waking the worker threads costs more than it saves
+		result = std::min( result, std::max( 1, _numCells / 8192 ) );
+	}
+	return std::min( result, _NY );
+}
+
+void ciMsaFluidSolver::runBands( BandFn fn )
+{
+	const int numBands = calcNumBands();
+	boost::barrier barrier( numBands );
+	std::vector<Band> bands( numBands );
+	for( int i = 0; i < numBands; ++i ) {
+		bands[i].jBegin = 1 + _NY * i / numBands;
+		bands[i].jEnd = 1 + _NY * ( i + 1 ) / numBands;
+		bands[i].first = ( i == 0 );
+		bands[i].barrier = &barrier;
+	}
+
+	if( numBands == 1 ) {
+		(this->*fn)( bands[0] );
+		return;
+	}
+
+	// every band waits on the barrier, so each needs a thread of its own; runOnThreads() guarantees that
+	ci::runOnThreads( BandTask( this, fn, &bands[0] ), numBands );
+}
+
+//	Multigrid. Each cycle smooths the error with red-black relaxation, solves for the remaining smooth error on a grid
+//	of half the resolution, where it is rough again, and corrects with the interpolated result. The grids are cell
+//	centered, so a coarse cell is the average of 2x2 fine cells; the equation keeps its form on the coarser grid with
+//	a quarter of 'a', since 'a' is proportional to 1 / (cell size)^2.
+namespace {
+
+const int MULTIGRID_SMOOTH_ITERATIONS = 2;
+const int MULTIGRID_COARSEST_ITERATIONS = 32;
+
+inline int levelIndex( int nx, int i, int j )
+{
+	return i + ( nx + 2 ) * j;
+}
+
+} // anonymous namespace
+
+void ciMsaFluidSolver::setupMultigrid()
+{
+	if( ( ! _multigrid.empty() ) && ( _multigrid[0].nx == _NX ) && ( _multigrid[0].ny == _NY ) )
+		return;
+
+	_multigrid.clear();
+	int nx = _NX, ny = _NY;
+	while( true ) {
+		_multigrid.push_back( MultigridLevel() );
+		MultigridLevel &level = _multigrid.back();
+		level.nx = nx;
+		level.ny = ny;
+		level.x.resize( ( nx + 2 ) * ( ny + 2 ), 0 );
+		level.rhs.resize( ( nx + 2 ) * ( ny + 2 ), 0 );
+		level.residual.resize( ( nx + 2 ) * ( ny + 2 ), 0 );
+		if( std::max( nx, ny ) <= 4 )
+			break;
+		nx = ( nx + 1 ) / 2;
+		ny = ( ny + 1 ) / 2;
+	}
+}
+
+float ciMsaFluidSolver::multigridSolve( int bound, float *x, const float *rhs, float a, float c, int *cycles )
+{
+	setupMultigrid();
+
+	double rhs2 = 0;
+	for( int j = 1; j <= _NY; ++j )
+		for( int i = 1; i <= _NX; ++i )
+			rhs2 += rhs[FLUID_IX( i, j )] * rhs[FLUID_IX( i, j )];
+	if( rhs2 <= 0 )
+		rhs2 = 1;
+
+	*cycles = 0;
+	float residual = (float)sqrt( multigridResidual( 0, x, rhs, a, c ) / rhs2 );
+	while( ( *cycles < solverIterations ) && ( residual > solverTolerance ) ) {
+		multigridCycle( 0, bound, x, rhs, a, c );
+		++*cycles;
+		residual = (float)sqrt( multigridResidual( 0, x, rhs, a, c ) / rhs2 );
+	}
+	return residual;
+}
+
+void ciMsaFluidSolver::multigridCycle( int level, int bound, float *x, const float *rhs, float a, float c )
+{
+	if( level == (int)_multigrid.size() - 1 ) {
+		multigridSmooth( level, bound, x, rhs, a, c, MULTIGRID_COARSEST_ITERATIONS );
+		return;
+	}
+
+	multigridSmooth( level, bound, x, rhs, a, c, MULTIGRID_SMOOTH_ITERATIONS );
+	multigridResidual( level, x, rhs, a, c );
+	multigridRestrict( level );
+
+	MultigridLevel &coarse = _multigrid[level + 1];
+	const float coarseA = a * 0.25f;
+	multigridCycle( level + 1, bound, &coarse.x[0], &coarse.rhs[0], coarseA, c - 4 * a + 4 * coarseA );
+
+	multigridProlong( level, x );
+	setMultigridBoundary( level, bound, x );
+	multigridSmooth( level, bound, x, rhs, a, c, MULTIGRID_SMOOTH_ITERATIONS );
+}
+
+void ciMsaFluidSolver::multigridSmooth( int level, int bound, float *x, const float *rhs, float a, float c, int iterations )
+{
+	const int nx = _multigrid[level].nx, ny = _multigrid[level].ny;
+	const int step = nx + 2;
+	c = 1 / c;
+	for( int k = iterations; k > 0; --k ) {
+		for( int color = 0; color < 2; ++color ) {
+			for( int j = 1; j <= ny; ++j ) {
+				const int indexEnd = levelIndex( nx, nx + 1, j );
+				for( int index = levelIndex( nx, 1 + ( ( 1 + j + color ) & 1 ), j ); index < indexEnd; index += 2 )
+					x[index] = ( ( x[index-1] + x[index+1] + x[index - step] + x[index + step] ) * a + rhs[index] ) * c;
+			}
+		}
+		setMultigridBoundary( level, bound, x );
+	}
+}
+
+float ciMsaFluidSolver::multigridResidual( int level, const float *x, const float *rhs, float a, float c )
+{
+	const int nx = _multigrid[level].nx, ny = _multigrid[level].ny;
+	const int step = nx + 2;
+	float *residual = &_multigrid[level].residual[0];
+	double residual2 = 0;
+	for( int j = 1; j <= ny; ++j ) {
+		const int indexEnd = levelIndex( nx, nx + 1, j );
+		for( int index = levelIndex( nx, 1, j ); index < indexEnd; ++index ) {
+			residual[index] = rhs[index] - ( c * x[index] - a * ( x[index-1] + x[index+1] + x[index - step] + x[index + step] ) );
+			residual2 += residual[index] * residual[index];
+		}
+	}
+	return (float)residual2;
+}
+
+void ciMsaFluidSolver::multigridRestrict( int level )
+{
+	const MultigridLevel &fine = _multigrid[level];
+	MultigridLevel &coarse = _multigrid[level + 1];
+	const float *residual = &fine.residual[0];
+	for( int j = 1; j <= coarse.ny; ++j ) {
+		for( int i = 1; i <= coarse.nx; ++i ) {
+			// with an odd number of fine cells, the last coarse cell extends past the grid, where the residual is zero
+			float sum = 0;
+			for( int fj = 2 * j - 1; fj <= std::min( 2 * j, fine.ny ); ++fj )
+				for( int fi = 2 * i - 1; fi <= std::min( 2 * i, fine.nx ); ++fi )
+					sum += residual[levelIndex( fine.nx, fi, fj )];
+			coarse.rhs[levelIndex( coarse.nx, i, j )] = 0.25f * sum;
+		}
+	}
+	std::fill( coarse.x.begin(), coarse.x.end(), 0.0f );
+}
+
+void ciMsaFluidSolver::multigridProlong( int level, float *x )
+{
+	const MultigridLevel &fine = _multigrid[level];
+	const MultigridLevel &coarse = _multigrid[level + 1];
+	const float *xc = &coarse.x[0];
+	// bilinear interpolation; a fine cell lies a quarter of a coarse cell from the center of the coarse cell
+	// containing it, towards the neighbor it also interpolates from
+	for( int j = 1; j <= fine.ny; ++j ) {
+		const int jc = ( j + 1 ) / 2, jn = ( j & 1 ) ? jc - 1 : jc + 1;
+		for( int i = 1; i <= fine.nx; ++i ) {
+			const int ic = ( i + 1 ) / 2, in = ( i & 1 ) ? ic - 1 : ic + 1;
+			x[levelIndex( fine.nx, i, j )] += 0.5625f * xc[levelIndex( coarse.nx, ic, jc )]
+					+ 0.1875f * ( xc[levelIndex( coarse.nx, in, jc )] + xc[levelIndex( coarse.nx, ic, jn )] )
+					+ 0.0625f * xc[levelIndex( coarse.nx, in, jn )];
+		}
+	}
+}
+
+void ciMsaFluidSolver::setMultigridBoundary( int level, int bound, float *x )
+{
+	if( level == 0 ) {
+		setBoundary( bound, x );
+		return;
+	}
+
+	// the same conditions as setBoundary() on the coarser grid
+	const int nx = _multigrid[level].nx, ny = _multigrid[level].ny;
+	const float signX = ( bound == 1 && ! wrap_x ) ? -1.0f : 1.0f;
+	const float signY = ( bound == 2 && ! wrap_y ) ? -1.0f : 1.0f;
+	for( int j = 1; j <= ny; ++j ) {
+		x[levelIndex( nx, 0, j )] = signX * x[levelIndex( nx, wrap_x ? nx : 1, j )];
+		x[levelIndex( nx, nx + 1, j )] = signX * x[levelIndex( nx, wrap_x ? 1 : nx, j )];
+	}
+	for( int i = 1; i <= nx; ++i ) {
+		x[levelIndex( nx, i, 0 )] = signY * x[levelIndex( nx, i, wrap_y ? ny : 1 )];
+		x[levelIndex( nx, i, ny + 1 )] = signY * x[levelIndex( nx, i, wrap_y ? 1 : ny )];
+	}
+	x[levelIndex( nx, 0, 0 )] = 0.5f * ( x[levelIndex( nx, 1, 0 )] + x[levelIndex( nx, 0, 1 )] );
+	x[levelIndex( nx, 0, ny + 1 )] = 0.5f * ( x[levelIndex( nx, 1, ny + 1 )] + x[levelIndex( nx, 0, ny )] );
+	x[levelIndex( nx, nx + 1, 0 )] = 0.5f * ( x[levelIndex( nx, nx, 0 )] + x[levelIndex( nx, nx + 1, 1 )] );
+	x[levelIndex( nx, nx + 1, ny + 1 )] = 0.5f * ( x[levelIndex( nx, nx, ny + 1 )] + x[levelIndex( nx, nx + 1, ny )] );
+}
+
+float ciMsaFluidSolver::calcResidual( const float *x, int xStride, const float *rhs, int rhsStride, float a, float c ) const
+{
+	const int step = ( _NX + 2 ) * xStride;
+	double residual2 = 0, rhs2 = 0;
+	for( int j = 1; j <= _NY; ++j ) {
+		for( int i = 1; i <= _NX; ++i ) {
+			const float *xi = x + FLUID_IX( i, j ) * xStride;
+			const float rhsi = rhs[FLUID_IX( i, j ) * rhsStride];
+			const float residual = rhsi - ( c * xi[0] - a * ( xi[-xStride] + xi[xStride] + xi[-step] + xi[step] ) );
+			residual2 += residual * residual;
+			rhs2 += rhsi * rhsi;
+		}
+	}
+	return ( rhs2 > 0 ) ? (float)sqrt( residual2 / rhs2 ) : 0;
+}
+
+void ciMsaFluidSolver::addSolverStats( SolverStats *stats, int iterations, float residual )
+{
+	stats->iterations += iterations;
+	stats->residual = std::max( stats->residual, residual );
 }
 
 // specifies simple boundry conditions.
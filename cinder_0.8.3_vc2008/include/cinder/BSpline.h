@@ -76,14 +76,17 @@ class BSplineBasis
 	// evaluate basis functions and their derivatives
 	void compute( float fTime, unsigned int uiOrder, int &riMinIndex, int &riMaxIndex ) const;
 
+	// Determine knot index i for which knot[i] <= rfTime < knot[i+1].
+	// rfTime is clamped or wrapped to [0,1] first.
+	int getKey( float& rfTime ) const;
+	//! Returns the full knot array, which has getNumControlPoints() + getDegree() + 1 elements
+	const float* getKnots() const { return mKnots; }
+
  protected:
 	int initialize( int iNumCtrlPoints, int iDegree, bool bOpen );
 	float** allocate() const;
 	void deallocate( float** aafArray );
 
-	// Determine knot index i for which knot[i] <= rfTime < knot[i+1].
-	int getKey( float& rfTime ) const;
-
 	int mNumCtrlPoints;    // n+1
 	int mDegree;           // d
 	float *mKnots;          // knot[n+d+2]
@@ -174,6 +177,13 @@ class BSpline
 	//! Returns the time associated with an arc length in the range [0,getLength(0,1)]
 	float getTime( float length ) const;
 
+	/*! Evaluates the spline at the \a count parameters \a t into \a positions and optionally \a derivatives, either of which may be NULL.
+		Each knot span is converted to polynomial form once and reused by every following parameter in the same span, so \a t should be sorted.
+		Unlike get(), this is safe to call from several threads at once. Large batches of splines up to degree 7 are evaluated in parallel; higher degrees are evaluated serially. **/
+	void getPositions( const float *t, size_t count, T *positions, T *derivatives = NULL ) const;
+	//! Evaluates \a count parameters evenly spaced over <tt>[t0,t1]</tt> into \a positions and optionally \a derivatives
+	void getPositions( float t0, float t1, size_t count, T *positions, T *derivatives = NULL ) const;
+
 	// Access the basis function to compute it without control points.  This
 	// is useful for least squares fitting of curves.
 	BSplineBasis& getBasis();
@@ -184,6 +194,14 @@ class BSpline
     // be a closed curve.
     void createControl( const T *akCtrlPoint );
 
+	struct EvalBatch;
+	// Computes the Taylor coefficients of the curve around the start of knot span 'span'
+	void computeSpanPolynomial( int span, T *coeffs ) const;
+	// Evaluates parameters [begin,end), read from 't' or else spaced 'dt' apart from 't0'
+	void evalBatch( const float *t, float t0, float dt, size_t begin, size_t end, T *positions, T *derivatives ) const;
+	// Evaluates parameters [0,count) through the basis functions, for degrees above MAX_BATCH_DEGREE; thread safe unlike get()
+	void evalSerial( const float *t, float t0, float dt, size_t count, T *positions, T *derivatives ) const;
+
     int mNumCtrlPoints;
     T *mCtrlPoints;  // ctrl[n+1]
     bool mLoop;
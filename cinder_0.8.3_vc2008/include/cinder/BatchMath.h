@@ -0,0 +1,69 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Vector.h"
+#include "cinder/Matrix.h"
+#include "cinder/AxisAlignedBox.h"
+
+namespace cinder { namespace batch {
+
+/*! Array versions of the common Vec3f, Vec4f and Matrix44f operations. Each function selects an SSE2 kernel at runtime when
+	System::hasSse2() reports support, and otherwise runs a scalar loop over the equivalent Matrix44f / Vec3f member functions.
+	The SSE2 kernels evaluate the same expressions in the same order as the scalar ones and produce identical results.
+	Unless noted, \a dst may be the same array as a source for in-place operation, but must not otherwise overlap it. **/
+
+//! Sets \a dst[i] to \a mat.transformPoint( \a src[i] ), including the divide by w
+void	transformPoints( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count );
+//! Sets \a dst[i] to \a mat.transformPointAffine( \a src[i] ), ignoring the bottom row of \a mat
+void	transformPointsAffine( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count );
+//! Sets \a dst[i] to \a mat.transformVec( \a src[i] ), applying only the upper 3x3 of \a mat
+void	transformVecs( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count );
+//! Sets \a dst[i] to the full product \a mat * \a src[i], including translation and the w row, unlike transformVecs()
+void	transform( const Matrix44f &mat, const Vec4f *src, Vec4f *dst, size_t count );
+
+//! Sets \a dst[i] to \a a[i] * \a b[i]
+void	multiply( const Matrix44f *a, const Matrix44f *b, Matrix44f *dst, size_t count );
+//! Sets \a dst[i] to \a a * \a b[i], as when concatenating a parent transform with many local transforms
+void	multiply( const Matrix44f &a, const Matrix44f *b, Matrix44f *dst, size_t count );
+
+//! Sets \a dst[i] to \a src[i] normalized. Zero-length vectors are copied unchanged, as with Vec3f::safeNormalize().
+void	normalize( const Vec3f *src, Vec3f *dst, size_t count );
+//! Sets \a dst[i] to \a a[i].dot( \a b[i] )
+void	dot( const Vec3f *a, const Vec3f *b, float *dst, size_t count );
+
+//! Transforms the boxes given by \a srcMin[i] and \a srcMax[i] by the affine transform \a mat and writes the bounds of the results to \a dstMin[i] and \a dstMax[i]
+void	transformBoxes( const Matrix44f &mat, const Vec3f *srcMin, const Vec3f *srcMax, Vec3f *dstMin, Vec3f *dstMax, size_t count );
+//! Sets \a dst[i] to the bounds of \a src[i] transformed by the affine transform \a mat. Matches AxisAlignedBox3f::transformed() up to rounding, but works from the box's center and extents rather than its 8 corners.
+void	transformBoxes( const Matrix44f &mat, const AxisAlignedBox3f *src, AxisAlignedBox3f *dst, size_t count );
+
+/*! Enables or disables the SIMD kernels. They are enabled by default when the CPU supports them. Useful for benchmarking and debugging.
+	The setting is not synchronized, so only change it while no other thread is inside a batch function, FrustumCuller or TriMeshBvh call. */
+void		setSimdEnabled( bool enable );
+//! Returns whether the SIMD kernels are in use, which requires both setSimdEnabled( true ) and CPU support
+bool		isSimdEnabled();
+//! Returns the name of the instruction set the batch functions currently use, such as \c "SSE2" or \c "scalar"
+const char*	getBackendName();
+
+} } // namespace cinder::batch
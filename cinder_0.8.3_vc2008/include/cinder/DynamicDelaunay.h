@@ -0,0 +1,105 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Vector.h"
+#include "cinder/Rect.h"
+#include "cinder/TriMesh.h"
+
+#include <vector>
+
+namespace cinder {
+
+/*! Delaunay triangulation of a 2D point set which changes over time. Points can be inserted, removed and moved individually without rebuilding the triangulation.
+	Insertion is Bowyer-Watson with a walking point location, removal retriangulates the hole left behind, and a move which does not fold the point's
+	neighborhood is applied in place followed by local edge flips. The mesh is stored as flat half-edge arrays inside a large enclosing triangle.
+	Points are identified by the id returned from insert(); the ids of removed points are reused. **/
+class DynamicDelaunay {
+  public:
+	//! Creates an empty triangulation for points around \a bounds. Points may stray well outside of \a bounds, up to several hundred times its size.
+	DynamicDelaunay( const Rectf &bounds = Rectf( 0, 0, 1, 1 ) );
+
+	//! Removes all points and sets the region the triangulation is built around to \a bounds
+	void		clear( const Rectf &bounds );
+	//! Replaces all points with \a points, which receive ids \c 0 through <tt>points.size() - 1</tt>. Much faster than inserting the points one by one, as they are inserted in spatially coherent order.
+	void		build( const std::vector<Vec2f> &points );
+
+	//! Inserts a point at \a pos and returns its id. A point coinciding with an existing one is kept, but left out of the triangulation until it is moved elsewhere.
+	uint32_t	insert( const Vec2f &pos );
+	//! Removes the point \a id
+	void		remove( uint32_t id );
+	//! Moves the point \a id to \a pos
+	void		move( uint32_t id, const Vec2f &pos );
+
+	//! Returns the position of the point \a id
+	Vec2f		getPosition( uint32_t id ) const { return Vec2f( mPositions[id + NUM_SUPER_VERTICES] ); }
+	//! Returns whether \a id refers to a point which has not been removed
+	bool		contains( uint32_t id ) const { return id + NUM_SUPER_VERTICES < mVertexState.size() && mVertexState[id + NUM_SUPER_VERTICES] != VERTEX_REMOVED; }
+	//! Returns whether the point \a id is part of the triangulation, which is not the case when it coincides with another point
+	bool		isTriangulated( uint32_t id ) const { return contains( id ) && mVertexState[id + NUM_SUPER_VERTICES] == VERTEX_TRIANGULATED; }
+	//! Returns the number of points
+	size_t		getNumPoints() const { return mNumPoints; }
+	//! Returns one more than the largest point id in use
+	size_t		getMaxPointId() const { return mPositions.size() - NUM_SUPER_VERTICES; }
+
+	//! Returns the number of triangles
+	size_t		getNumTriangles() const;
+	//! Appends the point ids of each triangle to \a result, three per triangle in counter-clockwise order
+	void		getTriangleIndices( std::vector<uint32_t> *result ) const;
+	//! Returns the triangulation as a TriMesh2d whose vertex \c i is point \c i. Removed points leave unreferenced vertices.
+	TriMesh2d	calcMesh() const;
+
+  private:
+	enum { NUM_SUPER_VERTICES = 3 };
+	enum VertexState { VERTEX_REMOVED, VERTEX_DETACHED, VERTEX_TRIANGULATED };
+
+	int32_t		allocateTriangle();
+	void		freeTriangle( int32_t t );
+	void		link( int32_t e, int32_t twin );
+	int32_t		locate( const Vec2d &p );
+	bool		insertVertex( int32_t v );
+	void		removeVertex( int32_t v );
+	bool		moveVertexInPlace( int32_t v, const Vec2d &pos );
+	void		legalize();
+	bool		inCircle( int32_t a, int32_t b, int32_t c, const Vec2d &p, bool pIsSuper ) const;
+
+	std::vector<Vec2d>		mPositions;		// the enclosing triangle's vertices come first
+	std::vector<uint8_t>	mVertexState;
+	std::vector<int32_t>	mVertexEdge;	// a half-edge leaving each triangulated vertex
+	std::vector<uint32_t>	mFreeIds;
+	size_t					mNumPoints;
+
+	std::vector<int32_t>	mTriVertices;	// origin vertex of each half-edge; half-edges 3t to 3t+2 form triangle t counter-clockwise, -1 marks a free triangle
+	std::vector<int32_t>	mHalfEdges;		// opposite half-edge, -1 along the enclosing triangle
+	std::vector<int32_t>	mFreeTriangles;
+	int32_t					mLastTriangle;	// a live triangle where point location starts
+
+	// scratch space reused between operations
+	std::vector<uint32_t>	mTriangleMarks;
+	uint32_t				mMarkStamp;
+	std::vector<int32_t>	mStack, mCavity, mBoundary, mVertexTriangle, mPolygon, mPolygonOuter;
+};
+
+} // namespace cinder
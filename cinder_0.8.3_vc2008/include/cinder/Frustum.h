@@ -82,6 +82,9 @@ class Frustum
 		return intersects(box); 
 	};
 
+	//! Returns one of the six planes, indexed by NEAR, FAR, LEFT, RIGHT, TOP or BOTTOM. Normals point into the frustum.
+	const Plane<T>&	getPlane( int index ) const { return mFrustumPlanes[index]; }
+
   protected:
 	Plane<T>	mFrustumPlanes[6];
 };
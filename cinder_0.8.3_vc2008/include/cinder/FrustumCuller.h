@@ -0,0 +1,63 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Frustum.h"
+
+namespace cinder {
+
+/*! Culls large sets of bounding volumes against a Frustumf in one call. The volumes are passed as structure-of-arrays float arrays, and the result is a
+	bitmask with bit <tt>i % 32</tt> of word <tt>i / 32</tt> set when volume \c i is visible. Four volumes are tested against all six planes at a time with SSE2
+	where available (see batch::setSimdEnabled()), and large sets can be split across threads. The results match Frustumf::intersects().
+
+	Passing a \a lastPlane array enables temporal coherence: it holds, per volume, the index of the plane which last rejected it, and should be zero-initialized
+	and then kept from frame to frame. That plane is tested first, so volumes which stay outside the frustum are usually rejected by a single plane test. This mostly helps the scalar path;
+	the SSE2 path tests all six planes so cheaply that gathering each volume's cached plane costs about as much as it saves. **/
+class FrustumCuller {
+  public:
+	FrustumCuller();
+	FrustumCuller( const Frustumf &frustum );
+
+	void	set( const Frustumf &frustum );
+
+	//! Culls \a count spheres with centers (\a centerX[i], \a centerY[i], \a centerZ[i]) and radii \a radius[i]. \a visible must hold getMaskSize( \a count ) words.
+	void	cullSpheres( const float *centerX, const float *centerY, const float *centerZ, const float *radius, size_t count,
+						uint32_t *visible, uint8_t *lastPlane = 0, bool parallel = false ) const;
+	//! Culls \a count axis-aligned boxes with corners (\a minX[i], \a minY[i], \a minZ[i]) and (\a maxX[i], \a maxY[i], \a maxZ[i]). \a visible must hold getMaskSize( \a count ) words.
+	void	cullBoxes( const float *minX, const float *minY, const float *minZ, const float *maxX, const float *maxY, const float *maxZ, size_t count,
+						uint32_t *visible, uint8_t *lastPlane = 0, bool parallel = false ) const;
+
+	//! Returns the number of 32-bit words in the visibility mask of \a count volumes
+	static size_t	getMaskSize( size_t count ) { return ( count + 31 ) / 32; }
+	//! Returns whether bit \a index of the visibility mask \a visible is set
+	static bool		isVisible( const uint32_t *visible, size_t index ) { return ( visible[index / 32] >> ( index % 32 ) & 1 ) != 0; }
+	//! Returns the number of visible volumes among the first \a count of \a visible
+	static size_t	countVisible( const uint32_t *visible, size_t count );
+
+  protected:
+	// plane normals' x, y and z, followed by their distances, each indexed by Frustumf's plane enum
+	float	mPlanes[4][6];
+};
+
+} // namespace cinder
@@ -0,0 +1,265 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Json.h"
+
+#include <boost/noncopyable.hpp>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace cinder {
+
+/*! Read-only JSON document parsed in a single pass into a flat, preorder array of nodes. Keys and values are not copied out of
+	the source: each node stores an offset and length into the DataSource's Buffer, which the document keeps alive. Node storage
+	is reserved once from an upper bound computed by a quick scan of the source, so parsing performs two allocations regardless of
+	document size. Subtrees are skipped in constant time, which keeps child iteration and path lookups cheap on large documents.
+	Nodes are accessed through lightweight JsonDoc::Node handles which mirror the read-only part of the JsonTree interface.
+	Unlike JsonTree, object members keep their document order. **/
+class JsonDoc : private boost::noncopyable {
+  public:
+	class Node;
+	class ConstIter;
+
+	//! Parses the JSON contained in \a dataSource, keeping a reference to its Buffer. Throws ExcJsonParserError on malformed input.
+	explicit JsonDoc( DataSourceRef dataSource );
+	//! Parses the JSON contained in \a buffer without copying it
+	explicit JsonDoc( const Buffer &buffer );
+	//! Parses a copy of the JSON contained in \a jsonString
+	explicit JsonDoc( const std::string &jsonString );
+
+	//! Returns the document's root node
+	Node			getRoot() const;
+	//! Returns the number of nodes in the document
+	size_t			getNumNodes() const { return mNodes.size(); }
+	//! Returns the number of bytes held by the document: the source buffer plus the node array
+	size_t			getMemoryUsage() const;
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	//! Handle to a node of a JsonDoc. Handles are cheap to copy and remain valid for the lifetime of the document.
+	class Node {
+	  public:
+		Node() : mDoc( 0 ), mIndex( 0 ) {}
+
+		//! Returns the child at \a relativePath. Throws ExcChildNotFound if none matches.
+		Node			operator[]( const std::string &relativePath ) const { return getChild( relativePath ); }
+		//! Returns the child at \a index. Throws ExcChildNotFound if none matches.
+		Node			operator[]( size_t index ) const { return getChild( index ); }
+
+		/**! Returns the child at \a relativePath. Throws ExcChildNotFound if none matches. 
+			<br><tt>JsonDoc::Node node = myNode.getChild( "path.to.child" );</tt> **/
+		Node			getChild( const std::string &relativePath, bool caseSensitive = false, char separator = '.' ) const;
+		//! Returns the child at \a index. Throws ExcChildNotFound if none matches.
+		Node			getChild( size_t index ) const;
+		//! Returns whether the child at \a relativePath exists.
+		bool			hasChild( const std::string &relativePath, bool caseSensitive = false, char separator = '.' ) const;
+		//! Returns whether this node has any children
+		bool			hasChildren() const { return getNumChildren() != 0; }
+		//! Returns the number of children of this node
+		size_t			getNumChildren() const;
+
+		//! Returns a ConstIter to the first child of this node.
+		ConstIter		begin() const;
+		//! Returns a ConstIter which marks the end of the children of this node.
+		ConstIter		end() const;
+
+		class Children;
+		//! Returns a range over the node's children, usable with BOOST_FOREACH in place of JsonTree::getChildren()
+		Children		getChildren() const;
+
+		//! Returns the node which is the parent of this node. Throws ExcChildNotFound on the root node.
+		Node			getParent() const;
+		//! Returns whether this node has a parent node.
+		bool			hasParent() const;
+
+		//! Returns the node's key, which is empty for array elements and the root node
+		std::string		getKey() const;
+		//! Returns a path to this node, separated by the character \a separator.
+		std::string		getPath( char separator = '.' ) const;
+
+		//! Returns the value of the node with escape sequences decoded. Booleans are returned as they appear in the source, \c "true" or \c "false".
+		std::string		getValue() const;
+		/**! \brief Returns the value of the node cast to T. Numbers and booleans are converted directly from the source buffer; other types use ci::fromString().
+			<br><tt>float value = myNode.getValue<float>();</tt> **/
+		template<typename T>
+		T				getValue() const
+		{
+			try {
+				return fromString<T>( getValue() );
+			} catch( boost::bad_lexical_cast & ) {
+				throw ExcNonConvertible( *this );
+			}
+			return (T)0; // Unreachable. Prevents warning.
+		}
+
+		//! Returns a pointer to the node's value in the source buffer, without decoding escape sequences. Not null-terminated.
+		const char*		getValueData() const;
+		//! Returns the length in bytes of the node's value in the source buffer
+		size_t			getValueSize() const;
+
+		//! Get type of Node
+		JsonTree::NodeType	getNodeType() const;
+		//! Get type of Value
+		JsonTree::ValueType	getValueType() const;
+
+		//! Returns the document this node belongs to
+		const JsonDoc*	getDoc() const { return mDoc; }
+
+		bool			operator==( const Node &rhs ) const { return mDoc == rhs.mDoc && mIndex == rhs.mIndex; }
+		bool			operator!=( const Node &rhs ) const { return ! ( *this == rhs ); }
+
+	  private:
+		Node( const JsonDoc *doc, uint32_t index ) : mDoc( doc ), mIndex( index ) {}
+
+		double			toDouble() const;
+		int64_t			toInt() const;
+		bool			toBool() const;
+		
+		const JsonDoc	*mDoc;
+		uint32_t		mIndex;
+
+		friend class JsonDoc;
+		friend class ConstIter;
+	};
+
+	//! Forward iterator over the children of a Node
+	class ConstIter {
+	  public:
+		typedef std::forward_iterator_tag	iterator_category;
+		typedef Node						value_type;
+		typedef std::ptrdiff_t				difference_type;
+		typedef const Node*					pointer;
+		typedef const Node&					reference;
+
+		ConstIter() {}
+
+		const Node&		operator*() const { return mNode; }
+		const Node*		operator->() const { return &mNode; }
+		ConstIter&		operator++() { mNode.mIndex = mNode.mDoc->mNodes[mNode.mIndex].mNext; return *this; }
+		ConstIter		operator++( int ) { ConstIter prev( *this ); ++(*this); return prev; }
+
+		bool			operator==( const ConstIter &rhs ) const { return mNode == rhs.mNode; }
+		bool			operator!=( const ConstIter &rhs ) const { return mNode != rhs.mNode; }
+
+	  private:
+		ConstIter( const JsonDoc *doc, uint32_t index ) : mNode( doc, index ) {}
+
+		Node	mNode;
+
+		friend class Node;
+	};
+
+	//! Range over the children of a Node
+	class Node::Children {
+	  public:
+		typedef JsonDoc::ConstIter	iterator;
+		typedef JsonDoc::ConstIter	const_iterator;
+
+		ConstIter	begin() const { return mParent.begin(); }
+		ConstIter	end() const { return mParent.end(); }
+		size_t		size() const { return mParent.getNumChildren(); }
+		bool		empty() const { return size() == 0; }
+
+	  private:
+		explicit Children( const Node &parent ) : mParent( parent ) {}
+
+		Node	mParent;
+
+		friend class Node;
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	//! Exception expressing the absence of an expected child node.
+	class ExcChildNotFound : public JsonTree::Exception {
+	  public:
+		ExcChildNotFound( const Node &node, const std::string &key ) throw();
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[ 2048 ];
+	};
+
+	//! Exception expressing the inability to convert a node's value to a requested type.
+	class ExcNonConvertible : public JsonTree::Exception {
+	  public:
+		ExcNonConvertible( const Node &node ) throw();
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[ 2048 ];
+	};
+
+	//! Exception expressing malformed JSON, reporting the line and column of the error.
+	class ExcJsonParserError : public JsonTree::Exception {
+	  public:
+		ExcJsonParserError( const std::string &errorMessage ) throw();
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[ 2048 ];
+	};
+
+  private:
+	enum { FLAG_KEY_ESCAPED = 1, FLAG_VALUE_ESCAPED = 2 };
+
+	struct NodeData {
+		uint32_t	mKeyOffset, mKeyLength;
+		uint32_t	mValueOffset, mValueLength;
+		//! Index of the node following this one's subtree; for the last child of a node this equals the parent's mNext
+		uint32_t	mNext;
+		uint32_t	mParent;
+		uint32_t	mNumChildren;
+		uint8_t		mNodeType, mValueType, mFlags;
+	};
+
+	class Parser;
+
+	void	parse();
+	const NodeData&	getData( uint32_t index ) const { return mNodes[index]; }
+	const char*		getSource() const { return mSource; }
+
+	Buffer					mBuffer;
+	const char				*mSource;
+	size_t					mSourceLength;
+	std::vector<NodeData>	mNodes;
+
+	friend class Node;
+	friend class ConstIter;
+};
+
+//! \cond
+template<> inline float		JsonDoc::Node::getValue<float>() const		{ return (float)toDouble(); }
+template<> inline double	JsonDoc::Node::getValue<double>() const		{ return toDouble(); }
+template<> inline int32_t	JsonDoc::Node::getValue<int32_t>() const	{ return (int32_t)toInt(); }
+template<> inline uint32_t	JsonDoc::Node::getValue<uint32_t>() const	{ return (uint32_t)toInt(); }
+template<> inline int64_t	JsonDoc::Node::getValue<int64_t>() const	{ return toInt(); }
+template<> inline uint64_t	JsonDoc::Node::getValue<uint64_t>() const	{ return (uint64_t)toInt(); }
+template<> inline bool		JsonDoc::Node::getValue<bool>() const		{ return toBool(); }
+//! \endcond
+
+} // namespace cinder
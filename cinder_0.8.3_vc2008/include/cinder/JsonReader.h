@@ -0,0 +1,168 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/DataSource.h"
+#include "cinder/Json.h"
+#include "cinder/StreamScanner.h"
+
+#include <string>
+#include <vector>
+
+namespace cinder {
+
+/*! Event-based pull parser for JSON documents too large to hold in memory. Each call to next() reads just enough of the stream
+	to report the next event, so memory use is bounded by the reader's chunk size and the size of the largest single token.
+	nextMatching() skips over subtrees which cannot match a path filter without decoding them, and readTree() materializes
+	the subtree at the current event as a JsonTree.
+	\code
+	JsonReader reader( loadFile( "log.json" ) );
+	while( reader.nextMatching( "samples.*.value" ) )
+		sum += reader.getValue<float>();
+	\endcode **/
+class JsonReader {
+  public:
+	typedef enum {
+		EVENT_NONE, EVENT_START_OBJECT, EVENT_END_OBJECT, EVENT_START_ARRAY, EVENT_END_ARRAY, EVENT_VALUE, EVENT_END_DOCUMENT
+	} Event;
+
+	//! Reads the JSON in \a dataSource through a stream, without loading its Buffer
+	explicit JsonReader( DataSourceRef dataSource, size_t chunkSize = 64 * 1024 );
+	explicit JsonReader( IStreamRef stream, size_t chunkSize = 64 * 1024 );
+
+	//! Advances to the next event. Returns \c false once the end of the document has been reached.
+	bool				next();
+	/*! Advances to the next value, object or array whose path matches \a pathFilter, skipping subtrees which cannot contain a match.
+		Path components are separated by \a separator; array elements are matched by their index and \c * matches any single component.
+		Returns \c false once the end of the document has been reached. **/
+	bool				nextMatching( const std::string &pathFilter, bool caseSensitive = false, char separator = '.' );
+	//! Skips the remainder of the object or array just started. Has no effect on other events.
+	void				skip();
+
+	//! Returns the current event
+	Event				getEvent() const { return mEvent; }
+	//! Returns the nesting depth of the current event, 0 for the root value
+	size_t				getDepth() const { return mPath.size() - 1; }
+	//! Returns the key of the current value, object or array, which is empty for array elements and the root value
+	const std::string&	getKey() const { return mPath.back().mKey; }
+	//! Returns the position of the current value among its parent's children
+	size_t				getIndex() const { return mPath.back().mIndex; }
+	//! Returns the path of the current event in the format used by JsonTree::getPath()
+	std::string			getPath( char separator = '.' ) const;
+
+	//! Returns the type of the current value
+	JsonTree::ValueType	getValueType() const { return mValueType; }
+	//! Returns whether the current value is \c null
+	bool				isNull() const { return mIsNull; }
+	//! Returns the current value with escape sequences decoded. Numbers and booleans are returned as they appear in the source.
+	const std::string&	getValue() const { return mValue; }
+	//! Returns the current value cast to T. Numbers and booleans are converted directly; other types use ci::fromString().
+	template<typename T>
+	T					getValue() const
+	{
+		try {
+			return fromString<T>( mValue );
+		} catch( boost::bad_lexical_cast & ) {
+			throw ExcNonConvertible( *this );
+		}
+		return (T)0; // Unreachable. Prevents warning.
+	}
+
+	//! Consumes the current value, object or array and returns its JSON text
+	std::string			readRaw();
+	//! Consumes the current value, object or array and returns it as a JsonTree. The key of a returned object or array is empty.
+	JsonTree			readTree();
+
+	//! Returns the number of bytes consumed from the stream
+	uint64_t			getOffset() const { return mScanner.getOffset(); }
+
+	//! Exception expressing malformed JSON, reporting the byte offset of the error.
+	class ExcJsonParserError : public JsonTree::Exception {
+	  public:
+		ExcJsonParserError( const std::string &errorMessage, uint64_t offset ) throw();
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[ 2048 ];
+	};
+
+	//! Exception expressing the inability to convert the current value to a requested type.
+	class ExcNonConvertible : public JsonTree::Exception {
+	  public:
+		ExcNonConvertible( const JsonReader &reader ) throw();
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[ 2048 ];
+	};
+
+  private:
+	struct PathComponent {
+		PathComponent() : mIndex( 0 ), mNumChildren( 0 ), mContainer( 0 ) {}
+
+		std::string		mKey;
+		size_t			mIndex;
+		//! Children read so far, and '{' or '[' when this component is an open object or array
+		size_t			mNumChildren;
+		char			mContainer;
+	};
+
+	void				init();
+	double				toDouble() const;
+	int64_t				toInt() const;
+	bool				toBool() const;
+	void				readValue();
+	void				readString( std::string *out );
+	void				skipContainer( std::string *capture );
+	void				closeContainer();
+	bool				matchesFilter( bool *canContainMatch ) const;
+	void				error( const std::string &message ) const;
+
+	StreamScanner				mScanner;
+	Event						mEvent;
+	//! Components from the root to the current event. The last one is popped once its value or closing bracket has been reported.
+	std::vector<PathComponent>	mPath;
+	bool						mPopPending;
+	std::string					mValue;
+	JsonTree::ValueType			mValueType;
+	bool						mIsNull;
+
+	std::string					mFilterString;
+	char						mFilterSeparator;
+	bool						mFilterCaseSensitive;
+	std::vector<std::string>	mFilter;
+};
+
+//! \cond
+template<> inline float		JsonReader::getValue<float>() const		{ return (float)toDouble(); }
+template<> inline double	JsonReader::getValue<double>() const	{ return toDouble(); }
+template<> inline int32_t	JsonReader::getValue<int32_t>() const	{ return (int32_t)toInt(); }
+template<> inline uint32_t	JsonReader::getValue<uint32_t>() const	{ return (uint32_t)toInt(); }
+template<> inline int64_t	JsonReader::getValue<int64_t>() const	{ return toInt(); }
+template<> inline uint64_t	JsonReader::getValue<uint64_t>() const	{ return (uint64_t)toInt(); }
+template<> inline bool		JsonReader::getValue<bool>() const		{ return toBool(); }
+//! \endcond
+
+} // namespace cinder
@@ -24,6 +24,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Vector.h"
+#include "cinder/Thread.h"
 
 #include <vector>
 #include <float.h>
@@ -56,7 +57,7 @@ struct KdNode {
 
 struct NullLookupProc {
  public:
-	void process( uint32_t id, float distSqrd, float &maxDistSqrd ) {}
+	void process( uint32_t id, float distSqrd, float &maxDistSqrd ) const {}
 };
 
 template <typename NodeData, unsigned char K=3, class LookupProc = NullLookupProc> class KdTree {
@@ -66,7 +67,8 @@ public:
 	// KdTree Public Methods
 	template<typename NodeDataVector>
 	KdTree( const NodeDataVector &data );
-	KdTree() {}
+	KdTree() : nodes( 0 ), mNodeData( 0 ), nNodes( 0 ) {}
+	//! Builds the tree over \a d, which must outlive the tree. Large inputs build their subtrees in parallel.
 	template<typename NodeDataVector>
 	void initialize( const NodeDataVector &d );
 	~KdTree() {
@@ -76,15 +78,81 @@ public:
 	void recursiveBuild( uint32_t nodeNum, uint32_t start, uint32_t end, std::vector<NodeDataIndex> &buildNodes );
 	void lookup( const NodeData &p, const LookupProc &process, float maxDist ) const;
 	void findNearest( float p[K], float result[K], uint32_t *resultIndex ) const;
+
+	//! Returns the number of points in the tree
+	uint32_t	getSize() const { return nNodes; }
+
+	/*! Finds the \a k nearest neighbors of \a p closer than \a maxDist. Their indices and squared distances are written in order of increasing distance to \a resultIndices and \a resultDistSqrd, each of which must hold \a k elements. Returns the number of neighbors found.
+		An \a epsilon greater than zero enables approximate search: each reported neighbor is then no further than (1 + \a epsilon) times the true i-th nearest neighbor, in exchange for visiting fewer nodes. **/
+	uint32_t	findKNearest( const NodeData &p, uint32_t k, uint32_t *resultIndices, float *resultDistSqrd, float maxDist = FLT_MAX, float epsilon = 0.0f ) const;
+	/*! Finds every point closer than \a maxDist to \a p. The first \a maxResults of them, in no particular order, are written to \a resultIndices and \a resultDistSqrd (which may be NULL).
+		Returns the total number of points found, which may exceed \a maxResults. **/
+	uint32_t	findInRadius( const NodeData &p, float maxDist, uint32_t *resultIndices, float *resultDistSqrd, uint32_t maxResults ) const;
+
+	/*! Runs findKNearest() for each of the \a numPoints points of \a points, spread across all cores. The results for point \c i start at <tt>resultIndices[i * k]</tt> and <tt>resultDistSqrd[i * k]</tt>.
+		The number of neighbors found for each point is written to \a resultCounts unless it is NULL. **/
+	void		findKNearestBatch( const NodeData *points, size_t numPoints, uint32_t k, uint32_t *resultIndices, float *resultDistSqrd, uint32_t *resultCounts = 0, float maxDist = FLT_MAX, float epsilon = 0.0f ) const;
+	/*! Runs findInRadius() for each of the \a numPoints points of \a points, spread across all cores. The results for point \c i start at <tt>resultIndices[i * maxResultsPerPoint]</tt> and <tt>resultDistSqrd[i * maxResultsPerPoint]</tt> (which may be NULL).
+		The total number of points found for each query, which may exceed \a maxResultsPerPoint, is written to \a resultCounts. **/
+	void		findInRadiusBatch( const NodeData *points, size_t numPoints, float maxDist, uint32_t *resultIndices, float *resultDistSqrd, uint32_t maxResultsPerPoint, uint32_t *resultCounts ) const;
 	
 private:
+	struct BuildTask {
+		BuildTask( uint32_t nodeNum, uint32_t start, uint32_t end ) : mNodeNum( nodeNum ), mStart( start ), mEnd( end ) {}
+		uint32_t	mNodeNum, mStart, mEnd;
+	};
+
+	struct ParallelBuild {
+		ParallelBuild( KdTree *tree, const std::vector<BuildTask> *tasks, std::vector<NodeDataIndex> *buildNodes )
+			: mTree( tree ), mTasks( tasks ), mBuildNodes( buildNodes ) {}
+		void operator()( size_t begin, size_t end ) const {
+			for( size_t t = begin; t < end; ++t )
+				mTree->recursiveBuild( (*mTasks)[t].mNodeNum, (*mTasks)[t].mStart, (*mTasks)[t].mEnd, *mBuildNodes );
+		}
+		KdTree								*mTree;
+		const std::vector<BuildTask>		*mTasks;
+		std::vector<NodeDataIndex>			*mBuildNodes;
+	};
+
+	struct ParallelKNearest {
+		void operator()( size_t begin, size_t end ) const {
+			for( size_t i = begin; i < end; ++i ) {
+				uint32_t count = mTree->findKNearest( mPoints[i], mK, mResultIndices + i * mK, mResultDistSqrd + i * mK, mMaxDist, mEpsilon );
+				if( mResultCounts )
+					mResultCounts[i] = count;
+			}
+		}
+		const KdTree	*mTree;
+		const NodeData	*mPoints;
+		uint32_t		mK;
+		uint32_t		*mResultIndices, *mResultCounts;
+		float			*mResultDistSqrd;
+		float			mMaxDist, mEpsilon;
+	};
+
+	struct ParallelInRadius {
+		void operator()( size_t begin, size_t end ) const {
+			for( size_t i = begin; i < end; ++i )
+				mResultCounts[i] = mTree->findInRadius( mPoints[i], mMaxDist, mResultIndices + i * mMaxResults, mResultDistSqrd ? mResultDistSqrd + i * mMaxResults : 0, mMaxResults );
+		}
+		const KdTree	*mTree;
+		const NodeData	*mPoints;
+		float			mMaxDist;
+		uint32_t		*mResultIndices, *mResultCounts;
+		float			*mResultDistSqrd;
+		uint32_t		mMaxResults;
+	};
+
 	// KdTree Private Methods
+	uint32_t buildNode( uint32_t nodeNum, uint32_t start, uint32_t end, std::vector<NodeDataIndex> &buildNodes );
 	void privateLookup(uint32_t nodeNum, float p[K], const LookupProc &process, float &maxDistSquared) const;
 	void privateFindNearest( uint32_t nodeNum, float p[K], float &maxDistSquared, float result[K], uint32_t *resultIndex ) const;
+	void privateFindKNearest( uint32_t nodeNum, const float p[K], uint32_t k, uint32_t *resultIndices, float *resultDistSqrd, uint32_t &count, float &maxDistSquared, float epsilonScale ) const;
+	void privateFindInRadius( uint32_t nodeNum, const float p[K], float maxDistSquared, uint32_t *resultIndices, float *resultDistSqrd, uint32_t maxResults, uint32_t &count ) const;
 	// KdTree Private Data
 	KdNode<K> *nodes;
 	NodeDataIndex *mNodeData;
-	uint32_t nNodes, nextFreeNode;
+	uint32_t nNodes;
 };
 
 
@@ -108,7 +176,7 @@ struct NodeDataTraits
 	static float getAxis0( const NodeData &data ) { return static_cast<float>( data.x ); }
 	static float getAxis1( const NodeData &data ) { return static_cast<float>( data.y ); }
 	static float getAxis2( const NodeData &data ) { return static_cast<float>( data.z ); }
-	static float distanceSquared( const NodeData &data, float k[3] ) {
+	static float distanceSquared( const NodeData &data, const float k[3] ) {
 		float result = ( data.x - k[0] ) * ( data.x - k[0] );
 		result += ( data.y - k[1] ) * ( data.y - k[1] );
 		result += ( data.z - k[2] ) * ( data.z - k[2] );
@@ -125,7 +193,7 @@ struct NodeDataTraits<Vec2f>
 	}
 	static float getAxis0( const Vec2f &data ) { return static_cast<float>( data.x ); }
 	static float getAxis1( const Vec2f &data ) { return static_cast<float>( data.y ); }
-	static float distanceSquared( const Vec2f &data, float k[2] ) {
+	static float distanceSquared( const Vec2f &data, const float k[2] ) {
 		float result = ( data.x - k[0] ) * ( data.x - k[0] );
 		result += ( data.y - k[1] ) * ( data.y - k[1] );
 		return result;
@@ -146,6 +214,7 @@ template<typename NodeData> struct CompareNode {
 template<typename NodeData, unsigned char K, typename LookupProc>
  template<typename NodeDataVector>
 KdTree<NodeData, K, LookupProc>::KdTree(const NodeDataVector &d)
+	: nodes( 0 ), mNodeData( 0 ), nNodes( 0 )
 {
 	initialize( d );
 }
@@ -154,33 +223,68 @@ template<typename NodeData, unsigned char K, typename LookupProc>
  template<typename NodeDataVector>
 void KdTree<NodeData, K, LookupProc>::initialize( const NodeDataVector &d )
 {
+	free( nodes );
+	delete[] mNodeData;
+
 	nNodes = NodeDataVectorTraits<NodeDataVector>::getSize( d );
-	nextFreeNode = 1;
 	nodes = (KdNode<K> *)malloc(nNodes * sizeof(KdNode<K>));
 	mNodeData = new NodeDataIndex[nNodes];
+	if( nNodes == 0 )
+		return;
 	std::vector<NodeDataIndex> buildNodes;
 	buildNodes.reserve( nNodes );
 	for( uint32_t i = 0; i < nNodes; ++i )
 		buildNodes.push_back( std::make_pair( &d[i], i ) );
-	// Begin the KdTree building process
-	recursiveBuild( 0, 0, nNodes, buildNodes );
+
+	// Begin the KdTree building process. Each subtree occupies a contiguous block of nodes whose position
+	// follows from its size alone, so the top levels are split here and the subtrees below them built in parallel
+	const uint32_t minTaskSize = 4096;
+	const size_t maxTasks = std::max<size_t>( 1, std::thread::hardware_concurrency() ) * 8;
+	std::vector<BuildTask> tasks, pending;
+	pending.push_back( BuildTask( 0, 0, nNodes ) );
+	while( ! pending.empty() ) {
+		BuildTask task = pending.back();
+		pending.pop_back();
+		if( task.mEnd - task.mStart < minTaskSize || tasks.size() + pending.size() >= maxTasks ) {
+			tasks.push_back( task );
+			continue;
+		}
+		uint32_t splitPos = buildNode( task.mNodeNum, task.mStart, task.mEnd, buildNodes );
+		if( nodes[task.mNodeNum].hasLeftChild )
+			pending.push_back( BuildTask( task.mNodeNum + 1, task.mStart, splitPos ) );
+		if( nodes[task.mNodeNum].rightChild < nNodes )
+			pending.push_back( BuildTask( nodes[task.mNodeNum].rightChild, splitPos + 1, task.mEnd ) );
+	}
+
+	parallelFor( tasks.size(), ParallelBuild( this, &tasks, &buildNodes ), 1 );
 }
 
 template<typename NodeData, unsigned char K, typename LookupProc>
 void KdTree<NodeData, K, LookupProc>::recursiveBuild( uint32_t nodeNum, uint32_t start, uint32_t end, std::vector<NodeDataIndex> &buildNodes )
+{
+	uint32_t splitPos = buildNode( nodeNum, start, end, buildNodes );
+	if( nodes[nodeNum].hasLeftChild )
+		recursiveBuild( nodeNum + 1, start, splitPos, buildNodes );
+	if( nodes[nodeNum].rightChild < nNodes )
+		recursiveBuild( nodes[nodeNum].rightChild, splitPos + 1, end, buildNodes );
+}
+
+// Initializes node \a nodeNum over [start, end) and returns the split position; the left child, if any, is nodeNum + 1
+template<typename NodeData, unsigned char K, typename LookupProc>
+uint32_t KdTree<NodeData, K, LookupProc>::buildNode( uint32_t nodeNum, uint32_t start, uint32_t end, std::vector<NodeDataIndex> &buildNodes )
 {
 	// Create leaf node of kd-tree if we've reached the bottom
 	if( start + 1 == end) {
 		nodes[nodeNum].initLeaf();
 		mNodeData[nodeNum] = buildNodes[start];
-		return;
+		return start;
 	}
 	// Choose split direction and partition data
 	// Compute bounds of data from _start_ to _end_
 	float boundMin[K], boundMax[K];
 	for( unsigned char k = 0; k < K; ++k ) {
 		boundMin[k] = FLT_MAX;
-		boundMax[k] = FLT_MIN;
+		boundMax[k] = -FLT_MAX;
 	}
 	
 	for( uint32_t i = start; i < end; ++i ) {
@@ -200,18 +304,14 @@ void KdTree<NodeData, K, LookupProc>::recursiveBuild( uint32_t nodeNum, uint32_t
 	}
 	uint32_t splitPos = ( start + end ) / 2;
 	std::nth_element( &buildNodes[start], &buildNodes[splitPos], &buildNodes[end-1] + 1, CompareNode<NodeData>(splitAxis) );
-	// Allocate kd-tree node and continue recursively
+	// Initialize kd-tree node; its left subtree takes the next splitPos - start nodes, followed by the right subtree
 	nodes[nodeNum].init( NodeDataTraits<NodeData>::getAxis( *buildNodes[splitPos].first, splitAxis ), splitAxis );
 	mNodeData[nodeNum] = buildNodes[splitPos];
-	if( start < splitPos ) {
+	if( start < splitPos )
 		nodes[nodeNum].hasLeftChild = 1;
-		uint32_t childNum = nextFreeNode++;
-		recursiveBuild( childNum, start, splitPos, buildNodes );
-	}
-	if( splitPos + 1 < end ) {
-		nodes[nodeNum].rightChild = nextFreeNode++;
-		recursiveBuild( nodes[nodeNum].rightChild, splitPos + 1, end, buildNodes );
-	}
+	if( splitPos + 1 < end )
+		nodes[nodeNum].rightChild = nodeNum + 1 + ( splitPos - start );
+	return splitPos;
 }
 
 template<typename NodeData, unsigned char K, typename LookupProc>
@@ -301,4 +401,125 @@ void KdTree<NodeData, K, LookupProc>::privateFindNearest( uint32_t nodeNum, floa
 	}
 }
 
+// Find K Nearest
+template<typename NodeData, unsigned char K, typename LookupProc>
+uint32_t KdTree<NodeData, K, LookupProc>::findKNearest( const NodeData &p, uint32_t k, uint32_t *resultIndices, float *resultDistSqrd, float maxDist, float epsilon ) const
+{
+	if( nNodes == 0 || k == 0 )
+		return 0;
+	float pt[K];
+	for( unsigned char a = 0; a < K; ++a )
+		pt[a] = NodeDataTraits<NodeData>::getAxis( p, a );
+
+	float maxDistSqrd = ( maxDist < FLT_MAX ) ? maxDist * maxDist : FLT_MAX;
+	uint32_t count = 0;
+	privateFindKNearest( 0, pt, k, resultIndices, resultDistSqrd, count, maxDistSqrd, ( 1.0f + epsilon ) * ( 1.0f + epsilon ) );
+	return count;
+}
+
+// Results are kept sorted by insertion, which beats a heap for the small k used in practice
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::privateFindKNearest( uint32_t nodeNum, const float p[K], uint32_t k, uint32_t *resultIndices, float *resultDistSqrd, uint32_t &count, float &maxDistSquared, float epsilonScale ) const
+{
+	const KdNode<K> *node = &nodes[nodeNum];
+	float distSqr = NodeDataTraits<NodeData>::distanceSquared( *mNodeData[nodeNum].first, p );
+	if( distSqr < maxDistSquared ) {
+		uint32_t i = ( count < k ) ? count++ : k - 1;
+		for( ; i > 0 && resultDistSqrd[i-1] > distSqr; --i ) {
+			resultDistSqrd[i] = resultDistSqrd[i-1];
+			resultIndices[i] = resultIndices[i-1];
+		}
+		resultDistSqrd[i] = distSqr;
+		resultIndices[i] = mNodeData[nodeNum].second;
+		if( count == k )
+			maxDistSquared = resultDistSqrd[k-1];
+	}
+
+	int axis = node->splitAxis;
+	if( axis == K )
+		return;
+	float dist2 = ( p[axis] - node->splitPos ) * ( p[axis] - node->splitPos );
+	if( p[axis] <= node->splitPos ) {
+		if( node->hasLeftChild )
+			privateFindKNearest( nodeNum + 1, p, k, resultIndices, resultDistSqrd, count, maxDistSquared, epsilonScale );
+		if( ( dist2 * epsilonScale < maxDistSquared ) && ( node->rightChild < nNodes ) )
+			privateFindKNearest( node->rightChild, p, k, resultIndices, resultDistSqrd, count, maxDistSquared, epsilonScale );
+	}
+	else {
+		if( node->rightChild < nNodes )
+			privateFindKNearest( node->rightChild, p, k, resultIndices, resultDistSqrd, count, maxDistSquared, epsilonScale );
+		if( ( dist2 * epsilonScale < maxDistSquared ) && node->hasLeftChild )
+			privateFindKNearest( nodeNum + 1, p, k, resultIndices, resultDistSqrd, count, maxDistSquared, epsilonScale );
+	}
+}
+
+// Find In Radius
+template<typename NodeData, unsigned char K, typename LookupProc>
+uint32_t KdTree<NodeData, K, LookupProc>::findInRadius( const NodeData &p, float maxDist, uint32_t *resultIndices, float *resultDistSqrd, uint32_t maxResults ) const
+{
+	if( nNodes == 0 )
+		return 0;
+	float pt[K];
+	for( unsigned char a = 0; a < K; ++a )
+		pt[a] = NodeDataTraits<NodeData>::getAxis( p, a );
+
+	uint32_t count = 0;
+	privateFindInRadius( 0, pt, maxDist * maxDist, resultIndices, resultDistSqrd, maxResults, count );
+	return count;
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::privateFindInRadius( uint32_t nodeNum, const float p[K], float maxDistSquared, uint32_t *resultIndices, float *resultDistSqrd, uint32_t maxResults, uint32_t &count ) const
+{
+	const KdNode<K> *node = &nodes[nodeNum];
+	int axis = node->splitAxis;
+	if( axis != K ) {
+		float dist2 = ( p[axis] - node->splitPos ) * ( p[axis] - node->splitPos );
+		if( ( p[axis] <= node->splitPos || dist2 < maxDistSquared ) && node->hasLeftChild )
+			privateFindInRadius( nodeNum + 1, p, maxDistSquared, resultIndices, resultDistSqrd, maxResults, count );
+		if( ( p[axis] > node->splitPos || dist2 < maxDistSquared ) && ( node->rightChild < nNodes ) )
+			privateFindInRadius( node->rightChild, p, maxDistSquared, resultIndices, resultDistSqrd, maxResults, count );
+	}
+
+	float distSqr = NodeDataTraits<NodeData>::distanceSquared( *mNodeData[nodeNum].first, p );
+	if( distSqr < maxDistSquared ) {
+		if( count < maxResults ) {
+			resultIndices[count] = mNodeData[nodeNum].second;
+			if( resultDistSqrd )
+				resultDistSqrd[count] = distSqr;
+		}
+		++count;
+	}
+}
+
+// Batched queries
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::findKNearestBatch( const NodeData *points, size_t numPoints, uint32_t k, uint32_t *resultIndices, float *resultDistSqrd, uint32_t *resultCounts, float maxDist, float epsilon ) const
+{
+	ParallelKNearest fn;
+	fn.mTree = this;
+	fn.mPoints = points;
+	fn.mK = k;
+	fn.mResultIndices = resultIndices;
+	fn.mResultDistSqrd = resultDistSqrd;
+	fn.mResultCounts = resultCounts;
+	fn.mMaxDist = maxDist;
+	fn.mEpsilon = epsilon;
+	parallelFor( numPoints, fn, 256 );
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::findInRadiusBatch( const NodeData *points, size_t numPoints, float maxDist, uint32_t *resultIndices, float *resultDistSqrd, uint32_t maxResultsPerPoint, uint32_t *resultCounts ) const
+{
+	ParallelInRadius fn;
+	fn.mTree = this;
+	fn.mPoints = points;
+	fn.mMaxDist = maxDist;
+	fn.mResultIndices = resultIndices;
+	fn.mResultDistSqrd = resultDistSqrd;
+	fn.mMaxResults = maxResultsPerPoint;
+	fn.mResultCounts = resultCounts;
+	parallelFor( numPoints, fn, 256 );
+}
+
 } // namespace ci
@@ -62,12 +62,12 @@ class ObjLoader {
 	 * \param destTriMesh the destination TriMesh, whose contents are cleared first
 	 * \param loadNormals  should normals be loaded or generated if not present. Default determines from the contents of the file
 	 * \param loadTexCoords  should 2D texture coordinates be loaded or set to zero if not present. Default determines from the contents of the file
-	 * \param optimizeVertices  should the loader minimze the vertices by identifying shared vertices between faces. */
+	 * \param optimizeVertices  should the loader minimze the vertices by identifying shared vertices between faces, and reorder triangles and vertices for the post-transform vertex cache. \sa optimizeTriMesh() */
 	void	load( TriMesh *destTriMesh, boost::tribool loadNormals = boost::logic::indeterminate, boost::tribool loadTexCoords = boost::logic::indeterminate, bool optimizeVertices = true );
 	/**Loads a particular group into a TriMesh
 	 * \param loadNormals  should normals be loaded or generated if not present. Default determines from the contents of the file
 	 * \param loadTexCoords  should 2D texture coordinates be loaded or set to zero if not present. Default determines from the contents of the file
-	 * \param optimizeVertices  should the loader minimize the vertices by identifying shared vertices between faces.*/
+	 * \param optimizeVertices  should the loader minimize the vertices by identifying shared vertices between faces, and reorder triangles and vertices for the post-transform vertex cache. \sa optimizeTriMesh() */
 	void	load( size_t groupIndex, TriMesh *destTriMesh, boost::tribool loadNormals = boost::logic::indeterminate, boost::tribool loadTexCoords = boost::logic::indeterminate, bool optimizeVertices = true );
 	
     struct Material {
@@ -29,12 +29,13 @@
 #include "cinder/MatrixAffine2.h"
 
 #include <vector>
+#include <boost/detail/atomic_count.hpp>
 
 namespace cinder {
 
 class Path2d {
  public:
-	Path2d() {}
+	Path2d() : mRevision( 0 ) {}
 	explicit Path2d( const BSpline<Vec2f> &spline, float subdivisionStep = 0.01f );
 
 	//! Sets the start point of the path to \a p. This is the only legal first command, and only legal as the first command.
@@ -53,14 +54,14 @@ class Path2d {
 	void	arcTo( float x, float y, float tanX, float tanY, float radius) { arcTo( Vec2f( x, y ), Vec2f( tanX, tanY ), radius ); }
 	
 	//! Closes the path, by drawing a straight line from the first to the last point. This is only legal as the last command.
-	void	close() { mSegments.push_back( CLOSE ); }
+	void	close() { mSegments.push_back( CLOSE ); touch(); }
 	bool	isClosed() const { return ( mSegments.size() > 1 ) && mSegments.back() == CLOSE; }
     
 	//! Reverses the order of the path's points, inverting its winding order
     void	reverse();
 	
 	bool	empty() const { return mPoints.empty(); }
-	void	clear() { mSegments.clear(); mPoints.clear(); }
+	void	clear() { mSegments.clear(); mPoints.clear(); touch(); }
 	size_t	getNumSegments() const { return mSegments.size(); }
 	size_t	getNumPoints() const { return mPoints.size(); }
 
@@ -84,7 +85,7 @@ class Path2d {
 	const Vec2f&				getPoint( size_t point ) const { return mPoints[point]; }
 	Vec2f&						getPoint( size_t point ) { return mPoints[point]; }
 	const Vec2f&				getCurrentPoint() const { return mPoints.back(); }
-	void						setPoint( size_t index, const Vec2f &p ) { mPoints[index] = p; }
+	void						setPoint( size_t index, const Vec2f &p ) { mPoints[index] = p; touch(); }
 
 	enum SegmentType { MOVETO, LINETO, QUADTO, CUBICTO, CLOSE };
 	static const int sSegmentTypePointCounts[];
@@ -103,6 +104,9 @@ class Path2d {
 	//! Returns whether the point \a pt is contained within the boundaries of the path
 	bool	contains( const Vec2f &pt ) const;
 
+	//! Returns a value which changes whenever the path is edited through its methods. Edits made through the non-const references returned by getPoints(), getPoint() and getSegments() are not tracked.
+	uint32_t	getRevision() const { return mRevision; }
+
 	friend class Shape2d;
 	friend std::ostream& operator<<( std::ostream &out, const Path2d &p );
   private:
@@ -110,9 +114,14 @@ class Path2d {
 	void	arcSegmentAsCubicBezier( const Vec2f &center, float radius, float startRadians, float endRadians );
 	void	subdivideQuadratic( float distanceToleranceSqr, const Vec2f &p1, const Vec2f &p2, const Vec2f &p3, int level, std::vector<Vec2f> *result ) const;
 	void	subdivideCubic( float distanceToleranceSqr, const Vec2f &p1, const Vec2f &p2, const Vec2f &p3, const Vec2f &p4, int level, std::vector<Vec2f> *result ) const;
+	// revisions are drawn from a global counter so that a copy-assigned path never reports a stale revision; the counter is atomic since paths are built on several threads at once
+	void	touch() { mRevision = (uint32_t)++sRevisionCounter; }
 
 	std::vector<Vec2f>			mPoints;
 	std::vector<SegmentType>	mSegments;
+	uint32_t					mRevision;
+
+	static boost::detail::atomic_count	sRevisionCounter;
 };
 
 inline std::ostream& operator<<( std::ostream &out, const Path2d &p )
@@ -0,0 +1,101 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Path2d.h"
+
+#include <vector>
+
+namespace cinder {
+
+/*! Caches a flattened polyline of a Path2d along with its cumulative arc length, so that positions and tangents at a given
+	distance along the path can be looked up in O(log n) instead of re-evaluating the curve. Unlike Path2d::getPosition(), which
+	advances by an equal amount of parameter per segment, lookups here move at constant speed along the path.
+	The sampler keeps a pointer to the Path2d, which must outlive it. The cache is rebuilt lazily whenever Path2d::getRevision() changes;
+	call invalidate() after editing the path through its non-const point references. **/
+class Path2dSampler {
+  public:
+	Path2dSampler();
+	//! Samples \a path, flattened with the same \a approximationScale semantics as Path2d::subdivide()
+	explicit Path2dSampler( const Path2d &path, float approximationScale = 1.0f );
+
+	void			setPath( const Path2d &path );
+	const Path2d*	getPath() const { return mPath; }
+	void			setApproximationScale( float approximationScale );
+	float			getApproximationScale() const { return mApproximationScale; }
+
+	//! Forces the flattened polyline to be rebuilt on the next query
+	void	invalidate() { mValid = false; }
+	//! Rebuilds the flattened polyline if the path has changed. Queries call this implicitly; call it explicitly before querying from several threads at once.
+	void	update() const;
+
+	//! Returns the arc length of the path
+	float	getLength() const { update(); return mLengths.empty() ? 0 : mLengths.back(); }
+	//! Returns the flattened polyline
+	const std::vector<Vec2f>&	getPoints() const { update(); return mPoints; }
+
+	//! Returns the point at distance \a length along the path. Distances outside <tt>[0,getLength()]</tt> wrap around on closed paths and are clamped on open ones.
+	Vec2f	getPositionAtLength( float length ) const;
+	//! Returns the unit tangent at distance \a length along the path
+	Vec2f	getTangentAtLength( float length ) const;
+	//! Returns the point at the fraction \a t of the path's arc length, where \a t lies in the range <tt>[0,1]</tt>
+	Vec2f	getPosition( float t ) const { return getPositionAtLength( t * getLength() ); }
+	//! Returns the unit tangent at the fraction \a t of the path's arc length
+	Vec2f	getTangent( float t ) const { return getTangentAtLength( t * getLength() ); }
+	//! Returns the arc length at which Path2d::getPosition( \a t ) lies, for converting existing parameter-based animation
+	float	getLengthAtParameter( float t ) const;
+
+	//! Evaluates \a count distances in \a lengths into \a positions and optionally \a tangents. Large batches are evaluated in parallel.
+	void	getPositionsAtLengths( const float *lengths, size_t count, Vec2f *positions, Vec2f *tangents = 0 ) const;
+	//! Evaluates \a count arc length fractions in \a t into \a positions and optionally \a tangents
+	void	getPositions( const float *t, size_t count, Vec2f *positions, Vec2f *tangents = 0 ) const;
+
+  private:
+	struct EvalPositions;
+
+	void	flatten() const;
+	void	flattenSegment( const Vec2f *pts, const Vec2f &closePoint, Path2d::SegmentType type, float paramOffset, float paramScale,
+								float t0, const Vec2f &p0, float t1, const Vec2f &p1, int level ) const;
+	void	addPoint( const Vec2f &p, const Vec2f &startTangent, const Vec2f &endTangent, float param ) const;
+	float	wrapLength( float length ) const;
+	size_t	findSpan( float length ) const;
+	void	evalSpan( float length, Vec2f *position, Vec2f *tangent ) const;
+
+	const Path2d		*mPath;
+	float				mApproximationScale;
+
+	mutable bool		mValid;
+	mutable uint32_t	mRevision;
+	mutable float		mDistanceToleranceSqr;
+	mutable bool		mClosed;
+	// per flattened point: position, cumulative arc length and Path2d::getPosition() parameter
+	mutable std::vector<Vec2f>	mPoints;
+	mutable std::vector<float>	mLengths;
+	mutable std::vector<float>	mParams;
+	// per span between mPoints[i] and mPoints[i+1]: the curve's unit tangents at either end
+	mutable std::vector<Vec2f>	mTangents;
+};
+
+} // namespace cinder
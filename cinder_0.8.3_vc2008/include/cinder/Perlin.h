@@ -27,6 +27,11 @@
 
 namespace cinder {
 
+template<typename T> class ChannelT;
+typedef ChannelT<float>		Channel32f;
+template<typename T> class SurfaceT;
+typedef SurfaceT<float>		Surface32f;
+
 class Perlin
 {
  public:
@@ -61,9 +66,55 @@ class Perlin
 	Vec2f	dnoise( float x, float y ) const;
 	Vec3f	dnoise( float x, float y, float z ) const;
 
+	/// Fills \a dst with fBm sampled on a lattice: the value at pixel (x, y) is fBm( origin + Vec2f( x * step.x, y * step.y ) ).
+	/// The batch versions evaluate 4 points at a time with SSE where available, spread rows across threads, and match the single point results
+	void	fBm( Channel32f *dst, const Vec2f &origin, const Vec2f &step ) const;
+	/// Fills \a dst with a slice of 3D fBm: the value at pixel (x, y) is fBm( origin + Vec3f( x * step.x, y * step.y, 0 ) )
+	void	fBm( Channel32f *dst, const Vec3f &origin, const Vec2f &step ) const;
+	/// Like fBm( Channel32f* ... ), writing the same value to the red, green and blue channels of \a dst and leaving alpha untouched
+	void	fBm( Surface32f *dst, const Vec2f &origin, const Vec2f &step ) const;
+	void	fBm( Surface32f *dst, const Vec3f &origin, const Vec2f &step ) const;
+	/// Fills a \a width x \a height lattice, writing the value for (x, y) to dst[( y * width + x ) * increment]
+	void	fBm( float *dst, int32_t width, int32_t height, const Vec2f &origin, const Vec2f &step, int32_t increment = 1 ) const;
+	/// Fills a \a width x \a height x \a depth lattice, writing the value for (x, y, z) to dst[( ( z * height + y ) * width + x ) * increment]
+	void	fBm( float *dst, int32_t width, int32_t height, int32_t depth, const Vec3f &origin, const Vec3f &step, int32_t increment = 1 ) const;
+	/// Evaluates fBm at \a count points, writing the value for points[i] to dst[i * increment]
+	void	fBm( const Vec2f *points, size_t count, float *dst, int32_t increment = 1 ) const;
+	void	fBm( const Vec3f *points, size_t count, float *dst, int32_t increment = 1 ) const;
+
+	/// Calculates a single octave of 3D simplex noise, which has fewer directional artifacts than noise(). Shares the seed of the Perlin noise
+	float	simplex( float x, float y, float z ) const;
+	/// Fractal Brownian motion of simplex noise, summing 'mOctaves' worth of simplex()
+	float	simplexFbm( const Vec3f &v ) const;
+	float	simplexFbm( float x, float y, float z ) const { return simplexFbm( Vec3f( x, y, z ) ); }
+	/// Batch versions of simplexFbm(), laid out like the corresponding fBm() batch versions
+	void	simplexFbm( Channel32f *dst, const Vec3f &origin, const Vec2f &step ) const;
+	void	simplexFbm( float *dst, int32_t width, int32_t height, int32_t depth, const Vec3f &origin, const Vec3f &step, int32_t increment = 1 ) const;
+	void	simplexFbm( const Vec3f *points, size_t count, float *dst, int32_t increment = 1 ) const;
+
  private:
+	// evaluates 4 points at a time; 2D functions ignore z
+	typedef void (Perlin::*BatchFn)( const float *x, const float *y, const float *z, float *result ) const;
+
+	struct Lattice {
+		BatchFn		fn;
+		float		*dst;
+		int32_t		width, height, increment, rowStride;
+		Vec3f		origin, step;
+	};
+	struct LatticeRange;
+	struct PointRange;
+
 	void	initPermutationTable();
 
+	void	batchFbm2d( const float *x, const float *y, const float *z, float *result ) const;
+	void	batchFbm3d( const float *x, const float *y, const float *z, float *result ) const;
+	void	batchSimplexFbm( const float *x, const float *y, const float *z, float *result ) const;
+	void	fillLattice( BatchFn fn, float *dst, int32_t width, int32_t height, int32_t depth, const Vec3f &origin, const Vec3f &step, int32_t increment, int32_t rowStride ) const;
+	void	fillLatticeRows( const Lattice &lattice, size_t begin, size_t end ) const;
+	void	fillPoints( BatchFn fn, const float *points, int32_t dims, size_t count, float *dst, int32_t increment ) const;
+	void	fillPointRange( BatchFn fn, const float *points, int32_t dims, float *dst, int32_t increment, size_t begin, size_t end ) const;
+
 	float grad( int32_t hash, float x ) const;
 	float grad( int32_t hash, float x, float y ) const;
 	float grad( int32_t hash, float x, float y, float z ) const;
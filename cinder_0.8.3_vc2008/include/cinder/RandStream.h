@@ -0,0 +1,99 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Vector.h"
+
+namespace cinder {
+
+/*! Counter-based random number generator using Philox4x32-10. The n-th 32-bit value of a stream is a pure function of the seed,
+	the stream id and n, so there is no shared state to race on: give each thread or each work item its own stream with getStream(),
+	or jump anywhere in a stream with setPosition(). The fill functions generate 4 blocks at a time with SSE where available and
+	spread large fills across threads, and produce the same values as the equivalent sequence of next*() calls however the work is
+	divided. Unlike the static Rand functions, separate RandStream objects may be used concurrently. **/
+class RandStream {
+  public:
+	//! Constructs stream \a streamId of the generator seeded with \a seed, positioned at its start
+	explicit RandStream( uint64_t seed = 214, uint64_t streamId = 0 );
+
+	//! Returns stream \a streamId of the generator with this stream's seed, positioned at its start. Different ids give independent streams
+	RandStream	getStream( uint64_t streamId ) const { return RandStream( mSeed, streamId ); }
+	uint64_t	getSeed() const { return mSeed; }
+	uint64_t	getStreamId() const { return mStreamId; }
+
+	//! Returns the index of the next 32-bit value the stream will use
+	uint64_t	getPosition() const { return mPosition; }
+	//! Moves the stream to the 32-bit value at index \a position, discarding a pending nextGaussian() value
+	void		setPosition( uint64_t position ) { mPosition = position; mHaveNextGaussian = false; }
+
+	//! Returns a random integer in the range [0,4294967295]. Uses one value
+	uint32_t	nextUint();
+	//! Returns a random integer in the range [0,v). Uses one value
+	int32_t		nextInt( int32_t v ) { return (int32_t)( ( (uint64_t)nextUint() * (uint32_t)v ) >> 32 ); }
+	//! Returns a random integer in the range [a,b). Uses one value
+	int32_t		nextInt( int32_t a, int32_t b ) { return nextInt( b - a ) + a; }
+	//! Returns a random float in the range [0.0f,1.0f). Uses one value
+	float		nextFloat() { return toFloat( nextUint() ); }
+	//! Returns a random float in the range [0.0f,v). Uses one value
+	float		nextFloat( float v ) { return nextFloat() * v; }
+	//! Returns a random float in the range [a,b). Uses one value
+	float		nextFloat( float a, float b ) { return nextFloat() * ( b - a ) + a; }
+	//! Returns a random Vec2f that represents a point on the unit circle. Uses one value
+	Vec2f		nextVec2f();
+	//! Returns a random Vec3f that represents a point on the unit sphere. Uses two values
+	Vec3f		nextVec3f();
+	//! Returns a random float via Gaussian distribution. Gaussians are generated in pairs from two values, and every other call returns the second of the pair
+	float		nextGaussian();
+
+	//! Fills \a dst with \a count values of nextUint()
+	void		fillUints( uint32_t *dst, size_t count );
+	//! Fills \a dst with \a count values of nextFloat( \a a, \a b )
+	void		fillFloats( float *dst, size_t count, float a = 0.0f, float b = 1.0f );
+	//! Fills \a dst with \a count values of nextVec2f()
+	void		fillVec2f( Vec2f *dst, size_t count );
+	//! Fills \a dst with \a count values of nextVec3f()
+	void		fillVec3f( Vec3f *dst, size_t count );
+	//! Fills \a dst with \a count values of nextGaussian() * \a stdDev + \a mean
+	void		fillGaussians( float *dst, size_t count, float mean = 0.0f, float stdDev = 1.0f );
+
+	//! Writes the \a count 32-bit values of the stream starting at index \a position to \a dst, without moving the stream
+	void		generate( uint64_t position, size_t count, uint32_t *dst ) const;
+
+	//! Maps a 32-bit value to a float in the range [0.0f,1.0f), as used by nextFloat()
+	static float	toFloat( uint32_t v ) { return (float)( v >> 8 ) * ( 1.0f / 16777216.0f ); }
+
+  private:
+	// writes the 4 values of each of the 'count' blocks starting at 'block'
+	void		generateBlocks( uint64_t block, size_t count, uint32_t *dst ) const;
+
+	uint64_t	mSeed, mStreamId;
+	uint64_t	mPosition;
+	// the most recently generated block, which sequential calls read from
+	uint64_t	mCachedBlock;
+	uint32_t	mCache[4];
+	float		mNextGaussian;
+	bool		mHaveNextGaussian;
+};
+
+} // namespace cinder
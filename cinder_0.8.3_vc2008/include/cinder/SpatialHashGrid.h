@@ -0,0 +1,285 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Vector.h"
+#include "cinder/Thread.h"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace cinder {
+
+namespace detail {
+template<typename VecT>
+struct SpatialHashGridTraits {
+	static const int DIMS = 3;
+	static float getAxis( const VecT &v, int axis ) { return v[axis]; }
+};
+
+template<>
+struct SpatialHashGridTraits<Vec2f> {
+	static const int DIMS = 2;
+	static float getAxis( const Vec2f &v, int axis ) { return v[axis]; }
+};
+} // namespace detail
+
+/*! Uniform grid spatial index for fully dynamic point sets such as particles, meant to be rebuilt every frame.
+	Points are hashed by the integer cell containing them and counting-sorted into a contiguous, cell-ordered copy, so a neighborhood query
+	touches a handful of short runs of memory. \a VecT is Vec2f or Vec3f. Queries are fastest when the cell size is close to the query radius. **/
+template<typename VecT>
+class SpatialHashGrid {
+  public:
+	//! Creates an empty grid whose cells are \a cellSize wide
+	SpatialHashGrid( float cellSize = 1.0f )
+		: mCellSize( cellSize ), mInvCellSize( 1.0f / cellSize ), mBucketMask( 0 )
+	{}
+
+	//! Sets the cell size. Takes effect on the next rebuild(); until then queries keep using the size the grid was built with.
+	void	setCellSize( float cellSize ) { mCellSize = cellSize; }
+	//! Returns the cell size set last, which the grid uses from the next rebuild() on
+	float	getCellSize() const { return mCellSize; }
+
+	//! Rebuilds the grid from \a numPoints points. The points are copied, so \a points need not outlive the grid. Large inputs are hashed and sorted in parallel.
+	void	rebuild( const VecT *points, size_t numPoints );
+	//! Rebuilds the grid from a std::vector of points
+	void	rebuild( const std::vector<VecT> &points ) { rebuild( points.empty() ? 0 : &points[0], points.size() ); }
+
+	//! Returns the number of points in the grid
+	size_t	getSize() const { return mSortedPoints.size(); }
+	//! Returns the points in cell order
+	const std::vector<VecT>&		getSortedPoints() const { return mSortedPoints; }
+	//! Returns the original index of each point in getSortedPoints()
+	const std::vector<uint32_t>&	getSortedIndices() const { return mSortedIndices; }
+
+	/*! Calls \a fn( index, distSqrd ) for every point closer than \a radius to \a p, where \a index is the point's position in the array passed to rebuild().
+		Points are visited in no particular order. **/
+	template<typename Fn>
+	void		forEachNeighbor( const VecT &p, float radius, Fn &fn ) const;
+	/*! Finds every point closer than \a radius to \a p. The first \a maxResults of them, in no particular order, are written to \a resultIndices and \a resultDistSqrd (which may be NULL).
+		Returns the total number of points found, which may exceed \a maxResults. **/
+	uint32_t	findNeighbors( const VecT &p, float radius, uint32_t *resultIndices, float *resultDistSqrd, uint32_t maxResults ) const;
+	/*! Runs findNeighbors() for each of the \a numPoints points of \a points, spread across all cores. The results for point \c i start at <tt>resultIndices[i * maxResultsPerPoint]</tt> and <tt>resultDistSqrd[i * maxResultsPerPoint]</tt> (which may be NULL).
+		The total number of points found for each query, which may exceed \a maxResultsPerPoint, is written to \a resultCounts. **/
+	void		findNeighborsBatch( const VecT *points, size_t numPoints, float radius, uint32_t *resultIndices, float *resultDistSqrd, uint32_t maxResultsPerPoint, uint32_t *resultCounts ) const;
+
+  private:
+	enum { DIMS = detail::SpatialHashGridTraits<VecT>::DIMS };
+
+	void		getCell( const VecT &p, int cell[3] ) const
+	{
+		cell[2] = 0;
+		for( int a = 0; a < DIMS; ++a )
+			cell[a] = static_cast<int>( std::floor( detail::SpatialHashGridTraits<VecT>::getAxis( p, a ) * mInvCellSize ) );
+	}
+	uint32_t	hashCell( const int cell[3] ) const
+	{
+		return ( ( (uint32_t)cell[0] * 73856093u ) ^ ( (uint32_t)cell[1] * 19349663u ) ^ ( (uint32_t)cell[2] * 83492791u ) ) & mBucketMask;
+	}
+
+	struct FindNeighborsFn {
+		FindNeighborsFn( uint32_t *resultIndices, float *resultDistSqrd, uint32_t maxResults )
+			: mResultIndices( resultIndices ), mResultDistSqrd( resultDistSqrd ), mMaxResults( maxResults ), mCount( 0 ) {}
+		void operator()( uint32_t index, float distSqrd ) {
+			if( mCount < mMaxResults ) {
+				mResultIndices[mCount] = index;
+				if( mResultDistSqrd )
+					mResultDistSqrd[mCount] = distSqrd;
+			}
+			++mCount;
+		}
+		uint32_t	*mResultIndices;
+		float		*mResultDistSqrd;
+		uint32_t	mMaxResults, mCount;
+	};
+
+	// Rebuild phases, each run over mNumChunks contiguous slices of the input
+	struct CountFn {
+		void operator()( size_t begin, size_t end ) const {
+			for( size_t c = begin; c < end; ++c ) {
+				uint32_t *counts = &mGrid->mChunkOffsets[c * mGrid->mNumBuckets];
+				std::fill( counts, counts + mGrid->mNumBuckets, 0 );
+				size_t last = std::min( ( c + 1 ) * mChunkSize, mNumPoints );
+				for( size_t i = c * mChunkSize; i < last; ++i ) {
+					int cell[3];
+					mGrid->getCell( mPoints[i], cell );
+					uint32_t bucket = mGrid->hashCell( cell );
+					mGrid->mPointBuckets[i] = bucket;
+					++counts[bucket];
+				}
+			}
+		}
+		SpatialHashGrid		*mGrid;
+		const VecT			*mPoints;
+		size_t				mNumPoints, mChunkSize;
+	};
+
+	struct ScatterFn {
+		void operator()( size_t begin, size_t end ) const {
+			for( size_t c = begin; c < end; ++c ) {
+				uint32_t *offsets = &mGrid->mChunkOffsets[c * mGrid->mNumBuckets];
+				size_t last = std::min( ( c + 1 ) * mChunkSize, mNumPoints );
+				for( size_t i = c * mChunkSize; i < last; ++i ) {
+					uint32_t dest = offsets[mGrid->mPointBuckets[i]]++;
+					mGrid->mSortedPoints[dest] = mPoints[i];
+					mGrid->mSortedIndices[dest] = static_cast<uint32_t>( i );
+				}
+			}
+		}
+		SpatialHashGrid		*mGrid;
+		const VecT			*mPoints;
+		size_t				mNumPoints, mChunkSize;
+	};
+
+	struct BatchFn {
+		void operator()( size_t begin, size_t end ) const {
+			for( size_t i = begin; i < end; ++i )
+				mResultCounts[i] = mGrid->findNeighbors( mPoints[i], mRadius, mResultIndices + i * mMaxResults, mResultDistSqrd ? mResultDistSqrd + i * mMaxResults : 0, mMaxResults );
+		}
+		const SpatialHashGrid	*mGrid;
+		const VecT				*mPoints;
+		float					mRadius;
+		uint32_t				*mResultIndices, *mResultCounts;
+		float					*mResultDistSqrd;
+		uint32_t				mMaxResults;
+	};
+
+	float					mCellSize;			// as set by setCellSize(), applied by rebuild()
+	float					mInvCellSize;		// of the cell size the grid was built with, which getCell() and the queries use
+	uint32_t				mNumBuckets, mBucketMask;
+	std::vector<uint32_t>	mBucketStart;		// mNumBuckets + 1 offsets into the sorted arrays
+	std::vector<VecT>		mSortedPoints;
+	std::vector<uint32_t>	mSortedIndices;
+	std::vector<uint32_t>	mPointBuckets;		// scratch: bucket of each input point
+	std::vector<uint32_t>	mChunkOffsets;		// scratch: per-chunk bucket counts, then scatter offsets
+};
+
+template<typename VecT>
+void SpatialHashGrid<VecT>::rebuild( const VecT *points, size_t numPoints )
+{
+	mInvCellSize = 1.0f / mCellSize;
+
+	// One bucket per point keeps the chance of two occupied cells sharing a bucket low
+	mNumBuckets = 1024;
+	while( mNumBuckets < numPoints )
+		mNumBuckets *= 2;
+	mBucketMask = mNumBuckets - 1;
+
+	mSortedPoints.resize( numPoints );
+	mSortedIndices.resize( numPoints );
+	mPointBuckets.resize( numPoints );
+	mBucketStart.resize( mNumBuckets + 1 );
+
+	// Counting sort by bucket; each chunk keeps its own histogram so the count and scatter passes run in parallel and stay stable
+	const size_t minChunkSize = 16384;
+	size_t numChunks = std::max<size_t>( 1, std::min<size_t>( std::thread::hardware_concurrency(), numPoints / minChunkSize ) );
+	size_t chunkSize = ( numPoints + numChunks - 1 ) / numChunks;
+	mChunkOffsets.resize( numChunks * mNumBuckets );
+
+	CountFn countFn;
+	countFn.mGrid = this;
+	countFn.mPoints = points;
+	countFn.mNumPoints = numPoints;
+	countFn.mChunkSize = chunkSize;
+	parallelFor( numChunks, countFn, 1 );
+
+	uint32_t offset = 0;
+	for( uint32_t b = 0; b < mNumBuckets; ++b ) {
+		mBucketStart[b] = offset;
+		for( size_t c = 0; c < numChunks; ++c ) {
+			uint32_t count = mChunkOffsets[c * mNumBuckets + b];
+			mChunkOffsets[c * mNumBuckets + b] = offset;
+			offset += count;
+		}
+	}
+	mBucketStart[mNumBuckets] = offset;
+
+	ScatterFn scatterFn;
+	scatterFn.mGrid = this;
+	scatterFn.mPoints = points;
+	scatterFn.mNumPoints = numPoints;
+	scatterFn.mChunkSize = chunkSize;
+	parallelFor( numChunks, scatterFn, 1 );
+}
+
+template<typename VecT>
+ template<typename Fn>
+void SpatialHashGrid<VecT>::forEachNeighbor( const VecT &p, float radius, Fn &fn ) const
+{
+	if( mSortedPoints.empty() )
+		return;
+
+	int minCell[3] = { 0, 0, 0 }, maxCell[3] = { 0, 0, 0 };
+	for( int a = 0; a < DIMS; ++a ) {
+		float v = detail::SpatialHashGridTraits<VecT>::getAxis( p, a );
+		minCell[a] = static_cast<int>( std::floor( ( v - radius ) * mInvCellSize ) );
+		maxCell[a] = static_cast<int>( std::floor( ( v + radius ) * mInvCellSize ) );
+	}
+
+	const float radiusSqrd = radius * radius;
+	int cell[3];
+	for( cell[2] = minCell[2]; cell[2] <= maxCell[2]; ++cell[2] ) {
+		for( cell[1] = minCell[1]; cell[1] <= maxCell[1]; ++cell[1] ) {
+			for( cell[0] = minCell[0]; cell[0] <= maxCell[0]; ++cell[0] ) {
+				uint32_t bucket = hashCell( cell );
+				for( uint32_t i = mBucketStart[bucket]; i < mBucketStart[bucket+1]; ++i ) {
+					float distSqrd = mSortedPoints[i].distanceSquared( p );
+					if( distSqrd >= radiusSqrd )
+						continue;
+					// Other cells can hash to this bucket; only report points that belong to the cell being visited so none is reported twice
+					int pointCell[3];
+					getCell( mSortedPoints[i], pointCell );
+					if( pointCell[0] == cell[0] && pointCell[1] == cell[1] && pointCell[2] == cell[2] )
+						fn( mSortedIndices[i], distSqrd );
+				}
+			}
+		}
+	}
+}
+
+template<typename VecT>
+uint32_t SpatialHashGrid<VecT>::findNeighbors( const VecT &p, float radius, uint32_t *resultIndices, float *resultDistSqrd, uint32_t maxResults ) const
+{
+	FindNeighborsFn fn( resultIndices, resultDistSqrd, maxResults );
+	forEachNeighbor( p, radius, fn );
+	return fn.mCount;
+}
+
+template<typename VecT>
+void SpatialHashGrid<VecT>::findNeighborsBatch( const VecT *points, size_t numPoints, float radius, uint32_t *resultIndices, float *resultDistSqrd, uint32_t maxResultsPerPoint, uint32_t *resultCounts ) const
+{
+	BatchFn fn;
+	fn.mGrid = this;
+	fn.mPoints = points;
+	fn.mRadius = radius;
+	fn.mResultIndices = resultIndices;
+	fn.mResultDistSqrd = resultDistSqrd;
+	fn.mMaxResults = maxResultsPerPoint;
+	fn.mResultCounts = resultCounts;
+	parallelFor( numPoints, fn, 256 );
+}
+
+} // namespace cinder
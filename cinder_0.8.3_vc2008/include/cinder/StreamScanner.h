@@ -0,0 +1,87 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Stream.h"
+
+#include <string>
+#include <vector>
+
+namespace cinder {
+
+/*! Character-level reader over an IStream with a fixed-size read-ahead buffer, used by the streaming JsonReader and XmlReader.
+	Memory use is bounded by the chunk size plus whatever the caller asks to be captured. **/
+class StreamScanner {
+  public:
+	//! Set of delimiting characters for readUntil(), stored as a lookup table. Build once and reuse.
+	class Delimiters {
+	  public:
+		explicit Delimiters( const char *characters );
+		bool	contains( char c ) const { return mTable[(uint8_t)c]; }
+	  private:
+		bool	mTable[256];
+	};
+
+	explicit StreamScanner( IStreamRef stream, size_t chunkSize = 64 * 1024 );
+
+	//! Returns the next byte without consuming it, or -1 at the end of the stream
+	int			peek() { return ( mPos < mEnd || refill() ) ? (uint8_t)*mPos : -1; }
+	//! Consumes and returns the next byte, or -1 at the end of the stream
+	int			get() { return ( mPos < mEnd || refill() ) ? (uint8_t)*mPos++ : -1; }
+	//! Returns whether the stream has been consumed entirely
+	bool		isEof() { return peek() < 0; }
+
+	//! Consumes spaces, tabs and line breaks
+	void		skipWhitespace();
+	/*! Consumes bytes up to, but not including, the first occurrence of any character in \a delimiters, appending them to \a out unless it is NULL.
+		Returns the delimiter found, or -1 if the stream ended first. **/
+	int			readUntil( const Delimiters &delimiters, std::string *out );
+	//! Consumes bytes up to and including the string \a terminator. Returns \c false if the stream ended first.
+	bool		skipPast( const char *terminator );
+	//! Consumes \a literal if the stream continues with it. Returns whether it did.
+	bool		match( const char *literal );
+
+	//! Starts appending every consumed byte to \a capture, until endCapture() is called
+	void		beginCapture( std::string *capture );
+	void		endCapture();
+
+	//! Returns the number of bytes consumed so far
+	uint64_t	getOffset() const { return mBufferOffset + ( mPos - &mBuffer[0] ); }
+
+  private:
+	//! Reads more data after any unconsumed bytes. Returns \c false at the end of the stream.
+	bool		refill();
+	//! Ensures at least \a count bytes are buffered. Returns \c false if the stream ends first.
+	bool		ensure( size_t count );
+
+	IStreamRef			mStream;
+	std::vector<char>	mBuffer;
+	const char			*mPos, *mEnd;
+	uint64_t			mBufferOffset;
+	std::string			*mCapture;
+	const char			*mCaptureStart;
+};
+
+} // namespace cinder
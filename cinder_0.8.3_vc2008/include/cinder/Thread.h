@@ -31,6 +31,7 @@
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/thread/condition_variable.hpp>
+#include <algorithm>
 
 // Promote classes from boost which will be part of std:: in C++1x where necessary
 namespace std {
@@ -59,4 +60,72 @@ class ThreadSetup {
 #endif
 };
 
+//! A task run concurrently by runOnThreads(), once per thread
+class ThreadTask {
+  public:
+	virtual ~ThreadTask() {}
+	//! Runs the share of the task that belongs to thread \a threadIndex, in [0, numThreads)
+	virtual void run( size_t threadIndex ) const = 0;
+};
+
+/*! Calls \a task.run( i ) for every i in [0, \a numThreads) at the same time, each on its own thread, and returns once all have completed.
+	The calling thread runs index 0. The others run on a pool of worker threads that are started on first use and reused by later calls,
+	so the threads can synchronize with each other, e.g. on a barrier. While the pool is in use by another call, including a nested one
+	from inside a task, this call falls back to starting its own threads. If an index throws, the exception is rethrown on the calling thread once
+	every index has finished. Index 0's exception is rethrown as is; one from another thread is rethrown through boost::rethrow_exception(),
+	which preserves the standard exception types and turns others into boost::unknown_exception. */
+void runOnThreads( const ThreadTask &task, size_t numThreads );
+
+namespace detail {
+template<typename Fn>
+class ParallelForTask : public ThreadTask {
+  public:
+	ParallelForTask( const Fn *fn, size_t count, size_t grainSize )
+		: mFn( fn ), mCount( count ), mGrainSize( grainSize ), mNext( 0 )
+	{}
+
+	void run( size_t /*threadIndex*/ ) const
+	{
+		while( true ) {
+			size_t begin, end;
+			{
+				std::lock_guard<std::mutex> lock( mMutex );
+				begin = mNext;
+				end = std::min( begin + mGrainSize, mCount );
+				mNext = end;
+			}
+			if( begin >= end )
+				return;
+			(*mFn)( begin, end );
+		}
+	}
+
+  private:
+	const Fn				*mFn;
+	size_t					mCount, mGrainSize;
+	mutable size_t			mNext;
+	mutable std::mutex		mMutex;
+};
+} // namespace detail
+
+/*! Calls \a fn( begin, end ) over sub-ranges of [0, \a count) of at most \a grainSize elements, spread across one thread per core, and returns once every sub-range has completed.
+	The calling thread participates and the others come from the worker pool of runOnThreads(). A \a grainSize of 0 picks roughly 8 sub-ranges per thread.
+	\a fn must be safe to invoke concurrently on disjoint ranges. An exception thrown by \a fn is rethrown as described for runOnThreads(). */
+template<typename Fn>
+void parallelFor( size_t count, const Fn &fn, size_t grainSize = 0 )
+{
+	if( count == 0 )
+		return;
+	size_t numThreads = std::max<size_t>( 1, std::thread::hardware_concurrency() );
+	if( grainSize == 0 )
+		grainSize = std::max<size_t>( 1, count / ( numThreads * 8 ) );
+	numThreads = std::min( numThreads, ( count + grainSize - 1 ) / grainSize );
+	if( numThreads <= 1 ) {
+		fn( 0, count );
+		return;
+	}
+
+	runOnThreads( detail::ParallelForTask<Fn>( &fn, count, grainSize ), numThreads );
+}
+
 } // namespace cinder
\ No newline at end of file
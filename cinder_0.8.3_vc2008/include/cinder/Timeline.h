@@ -28,11 +28,13 @@
 #include "cinder/TimelineItem.h"
 #include "cinder/Easing.h"
 #include "cinder/Tween.h"
+#include "cinder/TweenPool.h"
 #include "cinder/Function.h"
 
 #include <vector>
 #include <list>
 #include <map>
+#include <typeinfo>
 
 namespace cinder {
 
@@ -54,7 +56,23 @@ class Timeline : public TimelineItem {
 	
 	//! Replaces any existing tweens on the \a target with a new tween at the timeline's current time
 	template<typename T>
-	typename Tween<T>::Options apply( Anim<T> *target, T endValue, float duration, EaseFn easeFunction = easeNone, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
+	typename Tween<T>::Options apply( Anim<T> *target, T endValue, float duration )
+	{
+		target->setParentTimeline( thisRef() );
+		return applyPtr( target->ptr(), endValue, duration );
+	}
+
+	//! Replaces any existing tweens on the \a target with a new tween at the timeline's current time. The ease functor or function \a easeFunction is called directly by a TweenT rather than through EaseFn.
+	template<typename T, typename EaseT>
+	typename TweenEaseEnable<EaseT, typename Tween<T>::Options>::type apply( Anim<T> *target, T endValue, float duration, EaseT easeFunction )
+	{
+		target->setParentTimeline( thisRef() );
+		return applyPtr( target->ptr(), endValue, duration, easeFunction );
+	}
+
+	//! Replaces any existing tweens on the \a target with a new tween at the timeline's current time
+	template<typename T>
+	typename Tween<T>::Options apply( Anim<T> *target, T endValue, float duration, EaseFn easeFunction, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
 	{
 		target->setParentTimeline( thisRef() );
 		return applyPtr( target->ptr(), endValue, duration, easeFunction, lerpFunction );
@@ -62,7 +80,23 @@ class Timeline : public TimelineItem {
 
 	//! Replaces any existing tweens on the \a target with a new tween at the timeline's current time
 	template<typename T>
-	typename Tween<T>::Options apply( Anim<T> *target, T startValue, T endValue, float duration, EaseFn easeFunction = easeNone, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
+	typename Tween<T>::Options apply( Anim<T> *target, T startValue, T endValue, float duration )
+	{
+		target->setParentTimeline( thisRef() );
+		return applyPtr( target->ptr(), startValue, endValue, duration );
+	}
+
+	//! Replaces any existing tweens on the \a target with a new tween at the timeline's current time. The ease functor or function \a easeFunction is called directly by a TweenT rather than through EaseFn.
+	template<typename T, typename EaseT>
+	typename TweenEaseEnable<EaseT, typename Tween<T>::Options>::type apply( Anim<T> *target, T startValue, T endValue, float duration, EaseT easeFunction )
+	{
+		target->setParentTimeline( thisRef() );
+		return applyPtr( target->ptr(), startValue, endValue, duration, easeFunction );
+	}
+
+	//! Replaces any existing tweens on the \a target with a new tween at the timeline's current time
+	template<typename T>
+	typename Tween<T>::Options apply( Anim<T> *target, T startValue, T endValue, float duration, EaseFn easeFunction, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
 	{
 		target->setParentTimeline( thisRef() );
 		return applyPtr( target->ptr(), startValue, endValue, duration, easeFunction, lerpFunction );
@@ -70,7 +104,23 @@ class Timeline : public TimelineItem {
 
 	//! Creates a new tween and adds it to the end of the last tween on \a target, or if no existing tween matches the target, the current time.
 	template<typename T>
-	typename Tween<T>::Options appendTo( Anim<T> *target, T endValue, float duration, EaseFn easeFunction = easeNone, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
+	typename Tween<T>::Options appendTo( Anim<T> *target, T endValue, float duration )
+	{
+		target->setParentTimeline( thisRef() );
+		return appendToPtr( target->ptr(), endValue, duration );
+	}
+
+	//! Creates a new tween and adds it to the end of the last tween on \a target, or if no existing tween matches the target, the current time. The ease functor or function \a easeFunction is called directly by a TweenT rather than through EaseFn.
+	template<typename T, typename EaseT>
+	typename TweenEaseEnable<EaseT, typename Tween<T>::Options>::type appendTo( Anim<T> *target, T endValue, float duration, EaseT easeFunction )
+	{
+		target->setParentTimeline( thisRef() );
+		return appendToPtr( target->ptr(), endValue, duration, easeFunction );
+	}
+
+	//! Creates a new tween and adds it to the end of the last tween on \a target, or if no existing tween matches the target, the current time.
+	template<typename T>
+	typename Tween<T>::Options appendTo( Anim<T> *target, T endValue, float duration, EaseFn easeFunction, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
 	{
 		target->setParentTimeline( thisRef() );
 		return appendToPtr( target->ptr(), endValue, duration, easeFunction, lerpFunction );
@@ -78,7 +128,23 @@ class Timeline : public TimelineItem {
 
 	//! Creates a new tween and adds it to the end of the last tween on \a target, or if no existing tween matches the target, the current time.
 	template<typename T>
-	typename Tween<T>::Options appendTo( Anim<T> *target, T startValue, T endValue, float duration, EaseFn easeFunction = easeNone, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
+	typename Tween<T>::Options appendTo( Anim<T> *target, T startValue, T endValue, float duration )
+	{
+		target->setParentTimeline( thisRef() );
+		return appendToPtr( target->ptr(), startValue, endValue, duration );
+	}
+
+	//! Creates a new tween and adds it to the end of the last tween on \a target, or if no existing tween matches the target, the current time. The ease functor or function \a easeFunction is called directly by a TweenT rather than through EaseFn.
+	template<typename T, typename EaseT>
+	typename TweenEaseEnable<EaseT, typename Tween<T>::Options>::type appendTo( Anim<T> *target, T startValue, T endValue, float duration, EaseT easeFunction )
+	{
+		target->setParentTimeline( thisRef() );
+		return appendToPtr( target->ptr(), startValue, endValue, duration, easeFunction );
+	}
+
+	//! Creates a new tween and adds it to the end of the last tween on \a target, or if no existing tween matches the target, the current time.
+	template<typename T>
+	typename Tween<T>::Options appendTo( Anim<T> *target, T startValue, T endValue, float duration, EaseFn easeFunction, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
 	{
 		target->setParentTimeline( thisRef() );
 		return appendToPtr( target->ptr(), startValue, endValue, duration, easeFunction, lerpFunction );
@@ -86,41 +152,122 @@ class Timeline : public TimelineItem {
 
 	//! Replaces any existing tweens on the \a target with a new tween at the timeline's current time. Consider the apply( Anim<T>* ) variant unless you have an advanced use case.
 	template<typename T>
-	typename Tween<T>::Options applyPtr( T *target, T endValue, float duration, EaseFn easeFunction = easeNone, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
+	typename Tween<T>::Options applyPtr( T *target, T endValue, float duration )
 	{
-		TweenRef<T> newTween( new Tween<T>( target, endValue, mCurrentTime, duration, easeFunction, lerpFunction ) );
-		newTween->setAutoRemove( mDefaultAutoRemove );
-		apply( newTween );
-		return typename Tween<T>::Options( newTween, thisRef() );
+		return applyTween<T>( new TweenT<T>( target, endValue, mCurrentTime, duration ) );
 	}
-	
+
+	//! Replaces any existing tweens on the \a target with a new tween at the timeline's current time. Consider the apply( Anim<T>* ) variant unless you have an advanced use case.
+	template<typename T, typename EaseT>
+	typename TweenEaseEnable<EaseT, typename Tween<T>::Options>::type applyPtr( T *target, T endValue, float duration, EaseT easeFunction )
+	{
+		return applyTween<T>( new TweenT<T,EaseT>( target, endValue, mCurrentTime, duration, easeFunction ) );
+	}
+
 	//! Replaces any existing tweens on the \a target with a new tween at the timeline's current time. Consider the apply( Anim<T>* ) variant unless you have an advanced use case.
 	template<typename T>
-	typename Tween<T>::Options applyPtr( T *target, T startValue, T endValue, float duration, EaseFn easeFunction = easeNone, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> ) {
-		TweenRef<T> newTween( new Tween<T>( target, startValue, endValue, mCurrentTime, duration, easeFunction, lerpFunction ) );
-		newTween->setAutoRemove( mDefaultAutoRemove );
-		apply( newTween );
-		return typename Tween<T>::Options( newTween, thisRef() );
+	typename Tween<T>::Options applyPtr( T *target, T endValue, float duration, EaseFn easeFunction, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
+	{
+		return applyTween<T>( new Tween<T>( target, endValue, mCurrentTime, duration, easeFunction, lerpFunction ) );
+	}
+
+	//! Replaces any existing tweens on the \a target with a new tween at the timeline's current time. Consider the apply( Anim<T>* ) variant unless you have an advanced use case.
+	template<typename T>
+	typename Tween<T>::Options applyPtr( T *target, T startValue, T endValue, float duration )
+	{
+		return applyTween<T>( new TweenT<T>( target, startValue, endValue, mCurrentTime, duration ) );
+	}
+
+	//! Replaces any existing tweens on the \a target with a new tween at the timeline's current time. Consider the apply( Anim<T>* ) variant unless you have an advanced use case.
+	template<typename T, typename EaseT>
+	typename TweenEaseEnable<EaseT, typename Tween<T>::Options>::type applyPtr( T *target, T startValue, T endValue, float duration, EaseT easeFunction )
+	{
+		return applyTween<T>( new TweenT<T,EaseT>( target, startValue, endValue, mCurrentTime, duration, easeFunction ) );
+	}
+
+	//! Replaces any existing tweens on the \a target with a new tween at the timeline's current time. Consider the apply( Anim<T>* ) variant unless you have an advanced use case.
+	template<typename T>
+	typename Tween<T>::Options applyPtr( T *target, T startValue, T endValue, float duration, EaseFn easeFunction, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
+	{
+		return applyTween<T>( new Tween<T>( target, startValue, endValue, mCurrentTime, duration, easeFunction, lerpFunction ) );
 	}
 
 	//! Creates a new tween and adds it to the end of the last tween on \a target, or if no existing tween matches the target, the current time. Consider the appendTo( Anim<T>* ) variant unless you have an advanced use case.
 	template<typename T>
-	typename Tween<T>::Options appendToPtr( T *target, T endValue, float duration, EaseFn easeFunction = easeNone, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> ) {
-		float startTime = findEndTimeOf( target );
-		TweenRef<T> newTween( new Tween<T>( target, endValue, std::max( mCurrentTime, startTime ), duration, easeFunction, lerpFunction ) );
-		newTween->setAutoRemove( mDefaultAutoRemove );
-		insert( newTween );
-		return typename Tween<T>::Options( newTween, thisRef() );
+	typename Tween<T>::Options appendToPtr( T *target, T endValue, float duration )
+	{
+		return appendTween<T>( new TweenT<T>( target, endValue, findAppendTime( target ), duration ) );
 	}
-	
+
+	//! Creates a new tween and adds it to the end of the last tween on \a target, or if no existing tween matches the target, the current time. Consider the appendTo( Anim<T>* ) variant unless you have an advanced use case.
+	template<typename T, typename EaseT>
+	typename TweenEaseEnable<EaseT, typename Tween<T>::Options>::type appendToPtr( T *target, T endValue, float duration, EaseT easeFunction )
+	{
+		return appendTween<T>( new TweenT<T,EaseT>( target, endValue, findAppendTime( target ), duration, easeFunction ) );
+	}
+
 	//! Creates a new tween and adds it to the end of the last tween on \a target, or if no existing tween matches the target, the current time. Consider the appendTo( Anim<T>* ) variant unless you have an advanced use case.
 	template<typename T>
-	typename Tween<T>::Options appendToPtr( T *target, T startValue, T endValue, float duration, EaseFn easeFunction = easeNone, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> ) {
-		float startTime = findEndTimeOf( target );
-		TweenRef<T> newTween( new Tween<T>( target, startValue, endValue, std::max( mCurrentTime, startTime ), duration, easeFunction, lerpFunction ) );
-		newTween->setAutoRemove( mDefaultAutoRemove );
-		insert( newTween );
-		return typename Tween<T>::Options( newTween, thisRef() );
+	typename Tween<T>::Options appendToPtr( T *target, T endValue, float duration, EaseFn easeFunction, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
+	{
+		return appendTween<T>( new Tween<T>( target, endValue, findAppendTime( target ), duration, easeFunction, lerpFunction ) );
+	}
+
+	//! Creates a new tween and adds it to the end of the last tween on \a target, or if no existing tween matches the target, the current time. Consider the appendTo( Anim<T>* ) variant unless you have an advanced use case.
+	template<typename T>
+	typename Tween<T>::Options appendToPtr( T *target, T startValue, T endValue, float duration )
+	{
+		return appendTween<T>( new TweenT<T>( target, startValue, endValue, findAppendTime( target ), duration ) );
+	}
+
+	//! Creates a new tween and adds it to the end of the last tween on \a target, or if no existing tween matches the target, the current time. Consider the appendTo( Anim<T>* ) variant unless you have an advanced use case.
+	template<typename T, typename EaseT>
+	typename TweenEaseEnable<EaseT, typename Tween<T>::Options>::type appendToPtr( T *target, T startValue, T endValue, float duration, EaseT easeFunction )
+	{
+		return appendTween<T>( new TweenT<T,EaseT>( target, startValue, endValue, findAppendTime( target ), duration, easeFunction ) );
+	}
+
+	//! Creates a new tween and adds it to the end of the last tween on \a target, or if no existing tween matches the target, the current time. Consider the appendTo( Anim<T>* ) variant unless you have an advanced use case.
+	template<typename T>
+	typename Tween<T>::Options appendToPtr( T *target, T startValue, T endValue, float duration, EaseFn easeFunction, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
+	{
+		return appendTween<T>( new Tween<T>( target, startValue, endValue, findAppendTime( target ), duration, easeFunction, lerpFunction ) );
+	}
+
+	//! Replaces any existing tweens on the \a target with a pooled tween at the timeline's current time plus \a delay. Pooled tweens are evaluated in batches and are much cheaper than apply() when animating many targets, but support no callbacks, looping or custom lerp functions. See TweenPool.
+	template<typename T>
+	void applyPooled( Anim<T> *target, T endValue, float duration, EaseFnPtr easeFunction = easeNone, float delay = 0 )
+	{
+		target->setParentTimeline( thisRef() );
+		applyPooledPtr( target->ptr(), *target->ptr(), endValue, true, duration, easeFunction, delay );
+	}
+
+	//! Replaces any existing tweens on the \a target with a pooled tween from \a startValue to \a endValue at the timeline's current time plus \a delay. See TweenPool.
+	template<typename T>
+	void applyPooled( Anim<T> *target, T startValue, T endValue, float duration, EaseFnPtr easeFunction = easeNone, float delay = 0 )
+	{
+		target->setParentTimeline( thisRef() );
+		applyPooledPtr( target->ptr(), startValue, endValue, false, duration, easeFunction, delay );
+	}
+
+	//! Replaces any existing tweens on the \a target with a pooled tween. If \a copyStartValue is \c true the tween starts from the target's value when it begins rather than \a startValue. Consider the applyPooled( Anim<T>* ) variants unless you have an advanced use case.
+	template<typename T>
+	void applyPooledPtr( T *target, T startValue, T endValue, bool copyStartValue, float duration, EaseFnPtr easeFunction = easeNone, float delay = 0 )
+	{
+		removeTarget( target );
+		getTweenPool<T>().add( target, startValue, endValue, copyStartValue, mCurrentTime + delay, duration, easeFunction );
+	}
+
+	//! Returns the pool which stores the pooled tweens on targets of type \a T, creating it if necessary
+	template<typename T>
+	TweenPool<T>&	getTweenPool()
+	{
+		for( std::vector<std::pair<const std::type_info*,TweenPoolBaseRef> >::const_iterator poolIt = mTweenPools.begin(); poolIt != mTweenPools.end(); ++poolIt ) {
+			if( *poolIt->first == typeid(T) )
+				return static_cast<TweenPool<T>&>( *poolIt->second );
+		}
+		mTweenPools.push_back( std::make_pair( &typeid(T), TweenPoolBaseRef( new TweenPool<T>() ) ) );
+		return static_cast<TweenPool<T>&>( *mTweenPools.back().second );
 	}
 
 	//! add a cue to the Timeline add the start-time \a atTime
@@ -149,6 +296,8 @@ class Timeline : public TimelineItem {
 
 	//! Returns the number of items in the Timeline
 	size_t				getNumItems() const { return mItems.size(); }
+	//! Returns the number of pooled tweens in the Timeline
+	size_t				getNumPooledTweens() const;
 	//! Returns the first item in the timeline the target of which matches \a target
 	TimelineItemRef		find( void *target );
 	//! Returns the latest-starting item in the timeline the target of which matches \a target
@@ -157,14 +306,14 @@ class Timeline : public TimelineItem {
 	float				findEndTimeOf( void *target, bool *found = NULL );
 	//! Removes the TimelineItem \a item from the Timeline. Safe to use from callback fn's.
 	void				remove( TimelineItemRef item );
-	//! Removes all TimelineItems whose target matches \a target
+	//! Removes all TimelineItems and pooled tweens whose target matches \a target
 	void				removeTarget( void *target );
 	//! Clones all TimelineItems whose target matches \a target, but replacing their target with \a replacementTarget
 	void				cloneAndReplaceTarget( void *target, void *replacementTarget );
 	//! Replaces the target of all TimelineItems whose target matches \a target, with \a replacementTarget
 	void				replaceTarget( void *target, void *replacementTarget );
 	
-	//! Remove all tweens from the Timeline. Do not call from callback fn's.
+	//! Remove all tweens, including pooled tweens, from the Timeline. Do not call from callback fn's.
 	void clear();
 	//! Sets the time to zero, marks all tweens as not completed, and if \a unsetStarted, marks the tweens as not started. Do not call from callback fn's.
 	void reset( bool unsetStarted = false );
@@ -199,12 +348,36 @@ class Timeline : public TimelineItem {
 	virtual void complete( bool reverse ) {} // no-op
 
 	void						eraseMarked();
+
+	// sets up and replaces the existing tweens on the target of a newly created tween
+	template<typename T>
+	typename Tween<T>::Options	applyTween( Tween<T> *tween )
+	{
+		TweenRef<T> newTween( tween );
+		newTween->setAutoRemove( mDefaultAutoRemove );
+		apply( newTween );
+		return typename Tween<T>::Options( newTween, thisRef() );
+	}
+
+	// sets up and inserts a newly created tween without disturbing existing tweens on its target
+	template<typename T>
+	typename Tween<T>::Options	appendTween( Tween<T> *tween )
+	{
+		TweenRef<T> newTween( tween );
+		newTween->setAutoRemove( mDefaultAutoRemove );
+		insert( newTween );
+		return typename Tween<T>::Options( newTween, thisRef() );
+	}
+
+	// returns the time at which a tween appended to \a target should start
+	float						findAppendTime( void *target ) { return std::max( mCurrentTime, findEndTimeOf( target ) ); }
 	virtual float				calcDuration() const;
 
 	bool						mDefaultAutoRemove;
 	float						mCurrentTime;
 	
 	std::multimap<void*,TimelineItemRef>		mItems;
+	std::vector<std::pair<const std::type_info*,TweenPoolBaseRef> >	mTweenPools;
 	
   private:
 	Timeline( const Timeline &rhs ); // private to prevent copying; use clone() method instead
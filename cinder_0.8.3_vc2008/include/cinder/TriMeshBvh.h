@@ -0,0 +1,106 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/TriMesh.h"
+#include "cinder/Ray.h"
+#include "cinder/AxisAlignedBox.h"
+
+#include <vector>
+#include <cfloat>
+
+namespace cinder {
+
+/*! A bounding volume hierarchy over the triangles of a TriMesh, for ray picking and visibility queries against large meshes.
+	The tree is built top-down with binned surface area heuristic splits, with the larger subtrees built in parallel, and stored depth-first in a flat node array.
+	Triangle tests use the same arithmetic as Ray::calcTriangleIntersection(), so distances match a linear scan exactly; only hits in front of the ray origin count.
+	The vertex positions are copied at build time. After the mesh's vertices move, refit() updates the bounds without rebuilding, which suits animated meshes
+	whose topology stays fixed, although the tree's quality degrades as the triangles drift from where they were when it was built. **/
+class TriMeshBvh {
+  public:
+	static const uint32_t NO_HIT = 0xFFFFFFFF;
+
+	struct Hit {
+		Hit() : mTriangle( NO_HIT ), mDistance( FLT_MAX ), mU( 0 ), mV( 0 ) {}
+
+		bool		isHit() const { return mTriangle != NO_HIT; }
+
+		//! Index of the triangle hit in the source TriMesh, or NO_HIT
+		uint32_t	mTriangle;
+		//! Ray parameter of the hit, so the hit point is <tt>ray.calcPosition( mDistance )</tt>
+		float		mDistance;
+		//! Barycentric coordinates of the hit; the hit point is <tt>v0 * ( 1 - mU - mV ) + v1 * mU + v2 * mV</tt>
+		float		mU, mV;
+	};
+
+	TriMeshBvh() {}
+	//! Builds the tree over the triangles of \a mesh, with at most \a maxLeafSize triangles per leaf
+	TriMeshBvh( const TriMesh &mesh, size_t maxLeafSize = 4 );
+
+	//! Rebuilds the tree over the triangles of \a mesh, with at most \a maxLeafSize triangles per leaf
+	void	build( const TriMesh &mesh, size_t maxLeafSize = 4 );
+	//! Updates the bounds of every node from the current vertices of \a mesh, which must have the same triangles as the mesh the tree was built from
+	void	refit( const TriMesh &mesh );
+
+	//! Finds the closest triangle hit by \a ray closer than \a maxDistance. Returns whether there was one and writes it to \a hit.
+	bool	intersect( const Ray &ray, Hit *hit, float maxDistance = FLT_MAX ) const;
+	//! Returns whether \a ray hits any triangle closer than \a maxDistance, stopping at the first one found. Suited to shadow and line of sight tests.
+	bool	intersectAny( const Ray &ray, float maxDistance = FLT_MAX ) const;
+	/*! Finds the closest hit of each of the \a count rays in \a rays, writing it to \a hits. Groups of four rays traverse the tree together using SSE where available,
+		which pays off when neighboring rays are coherent, for instance when generated from adjacent pixels. Large batches are spread across all cores. **/
+	void	intersect( const Ray *rays, size_t count, Hit *hits, float maxDistance = FLT_MAX ) const;
+
+	size_t				getNumTriangles() const { return mTriangles.size(); }
+	size_t				getNumNodes() const { return mNodes.size(); }
+	//! Returns the bounds of the whole mesh, as of the last build() or refit()
+	AxisAlignedBox3f	getBounds() const;
+
+  protected:
+	// Leaves hold mCount triangles starting at mTriangles[mOffset]. Interior nodes have an mCount of 0; their left child follows them and
+	// their right child is at mOffset. mAxis is the axis the children were split along.
+	struct Node {
+		Vec3f		mMin;
+		uint32_t	mOffset;
+		Vec3f		mMax;
+		uint16_t	mCount, mAxis;
+	};
+
+	struct BuildState;
+	struct BuildTask;
+	struct ParallelBuild;
+	struct ParallelIntersect;
+	struct ParallelRefit;
+
+	uint32_t	buildNode( const BuildState &state, std::vector<Node> &nodes, uint32_t begin, uint32_t end, int depth, std::vector<BuildTask> *tasks );
+	void		copyNodes( const std::vector<Node> &topNodes, const std::vector<BuildTask> &tasks, uint32_t node );
+	void		intersectPacket( const Ray *rays, size_t count, Hit *hits, float maxDistance ) const;
+
+	std::vector<Node>		mNodes;
+	//! triangle indices into the source mesh, in leaf order
+	std::vector<uint32_t>	mTriangles;
+	//! the three vertices of each triangle, in leaf order
+	std::vector<Vec3f>		mVertices;
+};
+
+} // namespace cinder
@@ -0,0 +1,71 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/TriMesh.h"
+#include "cinder/Camera.h"
+
+#include <vector>
+#include <cfloat>
+
+namespace cinder {
+
+/*! Simplifies \a source into \a result using quadric error metric edge collapses, until at most \a targetTriangles remain or the next collapse's error would exceed \a maxError.
+	\a maxError is compared against a collapse's quadric cost, the area weighted RMS distance in object space units from the new position to the planes of the triangles merged into the vertex.
+	Collapses only ever move a vertex onto one of its neighbors, so no new attributes are interpolated. All vertices sharing a position move together.
+	Vertices on UV or color seams only collapse along the seam, onto the neighbor's vertices on each side of it. Vertices whose copies differ only in their normals,
+	as in flat shaded meshes and on hard edges, may collapse onto any neighbor and keep their attributes at the new position. Vertices on open borders are never removed, which preserves silhouettes exactly.
+	Connected components are simplified in parallel, each toward a share of \a targetTriangles proportional to its size. The result is reordered with optimizeTriMesh() and unreferenced vertices are dropped.
+	\return the largest distance from any remaining vertex to the plane of a source triangle merged into it, in object space units. */
+float	simplifyTriMesh( const TriMesh &source, TriMesh *result, size_t targetTriangles, float maxError = FLT_MAX );
+
+/*! A chain of progressively simplified versions of a TriMesh, for distance based level of detail. Level 0 is the source mesh. */
+class TriMeshLodChain {
+  public:
+	TriMeshLodChain() {}
+	/*! Builds up to \a numLevels levels from \a source, each simplified from the previous one toward \a reduction times its triangle count.
+		Generation stops early once a level no longer shrinks meaningfully, for instance when borders lock most of the mesh. */
+	TriMeshLodChain( const TriMesh &source, size_t numLevels, float reduction = 0.5f );
+
+	size_t			getNumLevels() const { return mLevels.size(); }
+	const TriMesh&	getLevel( size_t level ) const { return mLevels[level].mMesh; }
+	//! Returns the object space error of \a level relative to level 0, the sum of the plane distances simplifyTriMesh() reported while building each level up to \a level
+	float			getLevelError( size_t level ) const { return mLevels[level].mError; }
+	size_t			getLevelNumTriangles( size_t level ) const { return mLevels[level].mMesh.getNumTriangles(); }
+
+	//! Returns the size in pixels of \a objectSpaceError for an object at \a worldCenter scaled uniformly by \a worldScale, as seen by \a cam in a viewport \a viewportHeight pixels tall
+	static float	calcScreenSpaceError( float objectSpaceError, const CameraPersp &cam, const Vec3f &worldCenter, float worldScale, float viewportHeight );
+	//! Returns the coarsest level whose projected error stays within \a maxPixelError. \sa calcScreenSpaceError()
+	size_t			selectLevel( const CameraPersp &cam, const Vec3f &worldCenter, float worldScale, float viewportHeight, float maxPixelError = 1.0f ) const;
+
+  private:
+	struct Level {
+		TriMesh		mMesh;
+		float		mError;
+	};
+
+	std::vector<Level>	mLevels;
+};
+
+} // namespace cinder
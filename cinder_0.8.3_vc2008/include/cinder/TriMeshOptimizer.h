@@ -0,0 +1,68 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/TriMesh.h"
+
+namespace cinder {
+
+//! Post-transform vertex cache statistics for an indexed triangle list, as computed by calcVertexCacheStats()
+struct VertexCacheStats {
+	VertexCacheStats() : mCacheSize( 0 ), mNumTriangles( 0 ), mNumVertices( 0 ), mNumTransformed( 0 ), mAcmr( 0 ), mAtvr( 0 ) {}
+
+	//! Size of the simulated FIFO cache
+	size_t		mCacheSize;
+	size_t		mNumTriangles;
+	//! Number of unique vertices referenced by the index list
+	size_t		mNumVertices;
+	//! Number of vertex shader invocations, which is the number of cache misses
+	size_t		mNumTransformed;
+	//! Average cache miss ratio: transformed vertices per triangle. 3.0 is the worst case and roughly 0.5 the best case for regular grids
+	float		mAcmr;
+	//! Average transform to vertex ratio: transformed vertices per unique vertex. 1.0 is optimal
+	float		mAtvr;
+};
+
+//! Simulates a FIFO post-transform cache of \a cacheSize entries over the indices of \a mesh
+VertexCacheStats	calcVertexCacheStats( const TriMesh &mesh, size_t cacheSize = 16 );
+//! Simulates a FIFO post-transform cache of \a cacheSize entries over \a numIndices triangle list indices
+VertexCacheStats	calcVertexCacheStats( const uint32_t *indices, size_t numIndices, size_t numVertices, size_t cacheSize = 16 );
+
+//! Reorders the triangles of \a mesh for post-transform vertex cache efficiency using Tom Forsyth's linear-speed algorithm. Vertex data is untouched.
+void	optimizeVertexCache( TriMesh *mesh );
+//! Reorders \a numIndices triangle list indices in place for vertex cache efficiency. \a numVertices must be larger than the largest index.
+void	optimizeVertexCache( uint32_t *indices, size_t numIndices, size_t numVertices );
+
+/*! Reorders clusters of triangles of an already cache-optimized \a mesh so that outward-facing clusters come first, reducing overdraw.
+	Clusters are split wherever the cache is restarted, so the ACMR never increases by more than \a threshold (1.05 allows a 5% loss). */
+void	optimizeOverdraw( TriMesh *mesh, float threshold = 1.05f );
+
+/*! Reorders the vertices of \a mesh into the order in which they are first referenced by the index list, remapping the indices along with every per-vertex attribute array.
+	Vertices which are not referenced by any triangle are moved to the end. */
+void	optimizeVertexFetch( TriMesh *mesh );
+
+//! Convenience which runs optimizeVertexCache(), optimizeOverdraw() and optimizeVertexFetch() on \a mesh, in that order
+void	optimizeTriMesh( TriMesh *mesh );
+
+} // namespace cinder
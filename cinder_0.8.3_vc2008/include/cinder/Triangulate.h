@@ -28,12 +28,14 @@
 #include "cinder/Shape2d.h"
 #include "cinder/Path2d.h"
 
+#include <boost/noncopyable.hpp>
+
 struct TESStesselator;
 
 namespace cinder {
 
-//! Converts an arbitrary Shape2d into a TriMesh2d
-class Triangulator {
+//! Converts an arbitrary Shape2d into a TriMesh2d. All memory used by the tesselator comes from an internal arena which is recycled after calcMesh() and by reset(), so a single Triangulator can be reused every frame without touching the heap. Since the arena belongs to one tesselator, Triangulators are not copyable.
+class Triangulator : private boost::noncopyable {
   public:
 	typedef enum Winding { WINDING_ODD, WINDING_NONZERO, WINDING_POSITIVE, WINDING_NEGATIVE, WINDING_ABS_GEQ_TWO } Winding;
 
@@ -53,17 +55,29 @@ class Triangulator {
 	//! Adds a PolyLine2f to the tesselation.
 	void		addPolyLine( const PolyLine2f &polyLine );
 
-	//! Performs the tesselation, returning a TriMesh2d
+	//! Performs the tesselation, returning a TriMesh2d. Afterwards the Triangulator is empty and ready for new contours; its memory is recycled lazily by the next add, so a one-shot Triangulator pays nothing for it.
 	TriMesh2d		calcMesh( Winding winding = WINDING_ODD );
+	//! Discards any contours added so far while keeping the Triangulator's memory for reuse
+	void			reset();
+
+	//! Triangulates each of \a shapes independently, spread across all cores, and returns the results combined into a single TriMesh2d in the order of \a shapes
+	static TriMesh2d	calcMeshBatch( const std::vector<Shape2d> &shapes, float approximationScale = 1.0f, Winding winding = WINDING_ODD );
+	//! Triangulates each of \a paths independently, spread across all cores, and returns the results combined into a single TriMesh2d in the order of \a paths
+	static TriMesh2d	calcMeshBatch( const std::vector<Path2d> &paths, float approximationScale = 1.0f, Winding winding = WINDING_ODD );
 	
 	class Exception : public ci::Exception {
 	};
 	
   protected:	
+	class Arena;
+
 	void			allocate();
+	//! Recycles the tesselator if calcMesh() has consumed it since the last allocate()
+	void			allocateIfDirty() { if( mDirty ) allocate(); }
 	
-	int									mAllocated;
+	std::shared_ptr<Arena>				mArena;
 	std::shared_ptr<TESStesselator>		mTess;
+	bool								mDirty; // set by calcMesh(), cleared by allocate()
 };
 
 } // namespace cinder
\ No newline at end of file
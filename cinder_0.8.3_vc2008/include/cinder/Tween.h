@@ -32,6 +32,8 @@
 
 #include <list>
 #include <boost/utility.hpp>
+#include <boost/type_traits/is_convertible.hpp>
+#include <boost/type_traits/is_same.hpp>
 
 namespace cinder {
 
@@ -51,6 +53,16 @@ T tweenLerp( const T &start, const T &end, float time )
 	return start * ( 1 - time ) + end * time;
 }
 
+//! Functor edition of tweenLerp(), used as the default lerp of TweenT
+template<typename T>
+struct TweenLerp { T operator()( const T &start, const T &end, float time ) const { return tweenLerp<T>( start, end, time ); } };
+
+//! \cond
+// Enables the TweenT overloads of Timeline::apply() and friends for ease functors and function pointers. Numeric arguments are left to the startValue overloads and EaseFn to the std::function overloads.
+template<typename EaseT, typename R>
+struct TweenEaseEnable : public boost::disable_if_c<boost::is_convertible<EaseT,float>::value || boost::is_same<EaseT,EaseFn>::value, R> {};
+//! \endcond
+
 class TweenBase : public TimelineItem {
   public:
 	typedef std::function<void ()>		StartFn;
@@ -61,7 +73,7 @@ class TweenBase : public TimelineItem {
 	virtual ~TweenBase() {}
 
 	//! change how the tween moves through time
-	void	setEaseFn( EaseFn easeFunction ) { mEaseFunction = easeFunction; }
+	virtual void	setEaseFn( EaseFn easeFunction ) { mEaseFunction = easeFunction; }
 	EaseFn	getEaseFn() const { return mEaseFunction; }
 
 	void			setStartFn( StartFn startFunction ) { mStartFunction = startFunction; }
@@ -157,7 +169,7 @@ class Tween : public TweenBase {
 	//! Returns whether the tween will copy its target's value upon starting
 	bool	isCopyStartValue() { return mCopyStartValue; }
 
-	void	setLerpFn( const LerpFn &lerpFn ) { mLerpFunction = lerpFn; }
+	virtual void	setLerpFn( const LerpFn &lerpFn ) { mLerpFunction = lerpFn; }
 
 	//! Returns a TweenRef<T> to \a this
 	TweenRef<T>		getThisRef(){ return TweenRef<T>( std::static_pointer_cast<Tween<T> >( shared_from_this() ) ); }
@@ -238,6 +250,58 @@ class Tween : public TweenBase {
 	LerpFn				mLerpFunction;
 };
 
+/*! Tween which calls its \a Ease and \a Lerp functors directly instead of through std::function, so the compiler can inline them.
+	Timeline::apply() and appendTo() create these automatically when given one of the ease functors or functions from Easing.h.
+	Calling setEaseFn() or setLerpFn() afterwards switches the tween back to the std::function path. **/
+template<typename T, typename Ease = EaseNone, typename Lerp = TweenLerp<T> >
+class TweenT : public Tween<T> {
+  public:
+	TweenT( T *target, T endValue, float startTime, float duration, const Ease &easeFunction = Ease(), const Lerp &lerpFunction = Lerp() )
+		: Tween<T>( target, endValue, startTime, duration, easeFunction, lerpFunction ), mEase( easeFunction ), mLerp( lerpFunction ), mInline( true )
+	{
+	}
+
+	TweenT( T *target, T startValue, T endValue, float startTime, float duration, const Ease &easeFunction = Ease(), const Lerp &lerpFunction = Lerp() )
+		: Tween<T>( target, startValue, endValue, startTime, duration, easeFunction, lerpFunction ), mEase( easeFunction ), mLerp( lerpFunction ), mInline( true )
+	{
+	}
+
+	virtual void	setEaseFn( EaseFn easeFunction ) { Tween<T>::setEaseFn( easeFunction ); mInline = false; }
+	virtual void	setLerpFn( const typename Tween<T>::LerpFn &lerpFn ) { Tween<T>::setLerpFn( lerpFn ); mInline = false; }
+
+  protected:
+	virtual TimelineItemRef	clone() const
+	{
+		std::shared_ptr<TweenT<T,Ease,Lerp> > result( new TweenT<T,Ease,Lerp>( *this ) );
+		result->mCopyStartValue = false;
+		return result;
+	}
+	
+	virtual TimelineItemRef	cloneReverse() const
+	{
+		std::shared_ptr<TweenT<T,Ease,Lerp> > result( new TweenT<T,Ease,Lerp>( *this ) );
+		std::swap( result->mStartValue, result->mEndValue );
+		result->mCopyStartValue = false;
+		return result;
+	}
+
+	virtual void update( float relativeTime )
+	{
+		if( ! mInline ) {
+			Tween<T>::update( relativeTime );
+			return;
+		}
+
+		*reinterpret_cast<T*>( this->mTarget ) = mLerp( this->mStartValue, this->mEndValue, mEase( relativeTime ) );
+		if( this->mUpdateFunction )
+			this->mUpdateFunction();
+	}
+
+	Ease		mEase;
+	Lerp		mLerp;
+	bool		mInline;
+};
+
 template<typename T>
 class FnTween : public Tween<T> {
   public:
@@ -0,0 +1,308 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Tween.h"
+
+#include <vector>
+#include <algorithm>
+
+namespace cinder {
+
+//! Plain function pointer form of an easing function, as used by pooled tweens. The single-parameter ease*() functions in Easing.h convert to it directly.
+typedef float (*EaseFnPtr)( float );
+
+/*! Open-addressing hash table which maps a tween target to its slot in a TweenPool.
+	Keys are pointers and the table uses linear probing with backward-shift deletion, so lookups touch a single contiguous array. **/
+class TweenTargetMap {
+  public:
+	struct Location {
+		Location() : mGroup( 0 ), mIndex( 0 ) {}
+		Location( uint32_t group, uint32_t index ) : mGroup( group ), mIndex( index ) {}
+		uint32_t	mGroup, mIndex;
+	};
+
+	TweenTargetMap();
+
+	//! Returns the Location stored for \a target, or NULL if \a target is not in the map
+	Location*		find( const void *target );
+	const Location*	find( const void *target ) const;
+	//! Stores \a location for \a target, replacing any existing entry. \a target must be non-NULL.
+	void			insert( const void *target, const Location &location );
+	//! Removes \a target from the map. Returns \c false if it was not present.
+	bool			erase( const void *target );
+	void			clear();
+
+	size_t			size() const { return mSize; }
+	bool			empty() const { return mSize == 0; }
+
+  private:
+	struct Slot {
+		Slot() : mKey( 0 ) {}
+		const void	*mKey;
+		Location	mLocation;
+	};
+
+	size_t	home( const void *key ) const;
+	size_t	findSlot( const void *key ) const;
+	void	grow();
+
+	std::vector<Slot>	mSlots;
+	size_t				mSize;
+};
+
+//! Base class for the per-type tween pools held by a Timeline. Virtual dispatch happens once per pool per step, never per tween.
+class TweenPoolBase {
+  public:
+	virtual ~TweenPoolBase() {}
+
+	//! Evaluates every tween which has started by \a time. Completed tweens are written with their final value and removed. Returns whether any tween was removed.
+	virtual bool	stepTo( float time ) = 0;
+
+	//! Returns the number of tweens in the pool
+	size_t			getNumTweens() const { return mTargets.size(); }
+	//! Returns whether the pool holds a tween on \a target
+	bool			hasTarget( const void *target ) const { return mTargets.find( target ) != 0; }
+	//! Returns the end time of the tween on \a target, or \a defaultTime if there is none
+	float			findEndTimeOf( const void *target, float defaultTime ) const;
+	//! Returns the latest end time of any tween in the pool, or 0 if it is empty
+	virtual float	calcEndTime() const = 0;
+
+	//! Removes the tween on \a target, if any. Returns whether a tween was removed.
+	virtual bool	removeTarget( void *target ) = 0;
+	//! Adds a copy of the tween on \a target which animates \a replacementTarget instead
+	virtual void	cloneAndReplaceTarget( void *target, void *replacementTarget ) = 0;
+	//! Moves the tween on \a target to \a replacementTarget
+	virtual void	replaceTarget( void *target, void *replacementTarget ) = 0;
+	virtual void	clear() = 0;
+
+	virtual std::shared_ptr<TweenPoolBase>	clone() const = 0;
+
+  protected:
+	virtual float	getEndTime( const TweenTargetMap::Location &location ) const = 0;
+
+	TweenTargetMap		mTargets;
+};
+
+typedef std::shared_ptr<TweenPoolBase>	TweenPoolBaseRef;
+
+/*! Contiguous storage for many tweens on targets of type \a T.
+	Tweens are grouped by easing function and kept as parallel arrays, so stepTo() evaluates each group in a tight loop which calls
+	the ease function through a plain pointer and tweenLerp<T>() inline. Each target holds at most one pooled tween. Pooled tweens
+	support a start value, end value, start time, duration and ease function; they have no callbacks, don't loop and aren't reversed. **/
+template<typename T>
+class TweenPool : public TweenPoolBase {
+  public:
+	//! Adds a tween on \a target, replacing any existing pooled tween on it. If \a copyStartValue is \c true, \a startValue is replaced by the target's value when the tween starts.
+	void add( T *target, const T &startValue, const T &endValue, bool copyStartValue, float startTime, float duration, EaseFnPtr easeFunction )
+	{
+		removeTarget( target );
+		uint32_t groupIdx = findGroup( easeFunction );
+		Group &group = mGroups[groupIdx];
+		mTargets.insert( target, TweenTargetMap::Location( groupIdx, (uint32_t)group.mTargets.size() ) );
+		group.push( target, startValue, endValue, copyStartValue, startTime, duration );
+	}
+
+	virtual bool stepTo( float time )
+	{
+		bool removed = false;
+		for( uint32_t g = 0; g < (uint32_t)mGroups.size(); ++g )
+			removed = stepGroup( g, time ) || removed;
+		return removed;
+	}
+
+	virtual float calcEndTime() const
+	{
+		float result = 0;
+		for( typename std::vector<Group>::const_iterator groupIt = mGroups.begin(); groupIt != mGroups.end(); ++groupIt ) {
+			for( size_t i = 0; i < groupIt->mEndTimes.size(); ++i )
+				result = std::max( result, groupIt->mEndTimes[i] );
+		}
+		return result;
+	}
+
+	virtual bool removeTarget( void *target )
+	{
+		const TweenTargetMap::Location *location = mTargets.find( target );
+		if( ! location )
+			return false;
+		uint32_t groupIdx = location->mGroup, index = location->mIndex;
+		mTargets.erase( target );
+		removeAt( groupIdx, index );
+		return true;
+	}
+
+	virtual void cloneAndReplaceTarget( void *target, void *replacementTarget )
+	{
+		const TweenTargetMap::Location *location = mTargets.find( target );
+		if( ( ! location ) || ( target == replacementTarget ) )
+			return;
+		removeTarget( replacementTarget );
+		location = mTargets.find( target ); // removal may have moved the source tween
+		uint32_t groupIdx = location->mGroup, index = location->mIndex;
+		Group &group = mGroups[groupIdx];
+		mTargets.insert( replacementTarget, TweenTargetMap::Location( groupIdx, (uint32_t)group.mTargets.size() ) );
+		group.pushCopy( index, reinterpret_cast<T*>( replacementTarget ) );
+	}
+
+	virtual void replaceTarget( void *target, void *replacementTarget )
+	{
+		const TweenTargetMap::Location *location = mTargets.find( target );
+		if( ( ! location ) || ( target == replacementTarget ) )
+			return;
+		removeTarget( replacementTarget );
+		location = mTargets.find( target );
+		TweenTargetMap::Location moved = *location;
+		mTargets.erase( target );
+		mTargets.insert( replacementTarget, moved );
+		mGroups[moved.mGroup].mTargets[moved.mIndex] = reinterpret_cast<T*>( replacementTarget );
+	}
+
+	virtual void clear()
+	{
+		mGroups.clear();
+		mTargets.clear();
+	}
+
+	virtual TweenPoolBaseRef clone() const
+	{
+		return TweenPoolBaseRef( new TweenPool<T>( *this ) );
+	}
+
+  protected:
+	virtual float getEndTime( const TweenTargetMap::Location &location ) const
+	{
+		return mGroups[location.mGroup].mEndTimes[location.mIndex];
+	}
+
+	// Parallel arrays for all tweens sharing one ease function
+	struct Group {
+		Group( EaseFnPtr easeFunction ) : mEaseFunction( easeFunction ) {}
+
+		void push( T *target, const T &startValue, const T &endValue, bool copyStartValue, float startTime, float duration )
+		{
+			mTargets.push_back( target );
+			mStartValues.push_back( startValue );
+			mEndValues.push_back( endValue );
+			mStartTimes.push_back( startTime );
+			mEndTimes.push_back( startTime + std::max( duration, 0.0f ) );
+			mInvDurations.push_back( duration <= 0 ? 0 : ( 1 / duration ) );
+			mCopyStartValues.push_back( copyStartValue ? 1 : 0 );
+		}
+
+		void pushCopy( size_t index, T *target )
+		{
+			mTargets.push_back( target );
+			mStartValues.push_back( mStartValues[index] );
+			mEndValues.push_back( mEndValues[index] );
+			mStartTimes.push_back( mStartTimes[index] );
+			mEndTimes.push_back( mEndTimes[index] );
+			mInvDurations.push_back( mInvDurations[index] );
+			mCopyStartValues.push_back( 0 ); // matches Tween<T>::clone()
+		}
+
+		// swaps the last tween into \a index; returns the target which was moved, or NULL if \a index was last
+		T* swapRemove( size_t index )
+		{
+			size_t last = mTargets.size() - 1;
+			T *moved = 0;
+			if( index != last ) {
+				moved = mTargets[index] = mTargets[last];
+				mStartValues[index] = mStartValues[last];
+				mEndValues[index] = mEndValues[last];
+				mStartTimes[index] = mStartTimes[last];
+				mEndTimes[index] = mEndTimes[last];
+				mInvDurations[index] = mInvDurations[last];
+				mCopyStartValues[index] = mCopyStartValues[last];
+			}
+			mTargets.pop_back();
+			mStartValues.pop_back();
+			mEndValues.pop_back();
+			mStartTimes.pop_back();
+			mEndTimes.pop_back();
+			mInvDurations.pop_back();
+			mCopyStartValues.pop_back();
+			return moved;
+		}
+
+		EaseFnPtr				mEaseFunction;
+		std::vector<T*>			mTargets;
+		std::vector<T>			mStartValues, mEndValues;
+		std::vector<float>		mStartTimes, mEndTimes, mInvDurations;
+		std::vector<uint8_t>	mCopyStartValues;
+	};
+
+	uint32_t findGroup( EaseFnPtr easeFunction )
+	{
+		for( size_t g = 0; g < mGroups.size(); ++g ) {
+			if( mGroups[g].mEaseFunction == easeFunction )
+				return (uint32_t)g;
+		}
+		mGroups.push_back( Group( easeFunction ) );
+		return (uint32_t)mGroups.size() - 1;
+	}
+
+	void removeAt( uint32_t groupIdx, uint32_t index )
+	{
+		T *moved = mGroups[groupIdx].swapRemove( index );
+		if( moved )
+			mTargets.find( moved )->mIndex = index;
+	}
+
+	bool stepGroup( uint32_t groupIdx, float time )
+	{
+		Group &group = mGroups[groupIdx];
+		const EaseFnPtr ease = group.mEaseFunction;
+		bool removed = false;
+		for( size_t i = 0; i < group.mTargets.size(); ) {
+			const float startTime = group.mStartTimes[i];
+			if( time < startTime ) {
+				++i;
+				continue;
+			}
+
+			if( group.mCopyStartValues[i] ) {
+				group.mStartValues[i] = *group.mTargets[i];
+				group.mCopyStartValues[i] = 0;
+			}
+
+			const float invDuration = group.mInvDurations[i];
+			float relTime = ( invDuration <= 0 ) ? 1.0f : std::min( ( time - startTime ) * invDuration, 1.0f );
+			*group.mTargets[i] = tweenLerp<T>( group.mStartValues[i], group.mEndValues[i], ease( relTime ) );
+
+			if( time >= group.mEndTimes[i] ) {
+				mTargets.erase( group.mTargets[i] );
+				removeAt( groupIdx, (uint32_t)i );
+				removed = true;
+			}
+			else
+				++i;
+		}
+		return removed;
+	}
+
+	std::vector<Group>		mGroups;
+};
+
+} // namespace cinder
@@ -0,0 +1,356 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Xml.h"
+
+#include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace cinder {
+
+/*! Read-only XML document stored as flat arrays rather than a tree of XmlTree nodes. Nodes are kept in document order, linked
+	by first-child and next-sibling indices, and reference their tag and attribute names as ids into a table of interned names.
+	Values and attribute values live in a single string pool. Parsing uses RapidXML with the same rules and ParseOptions as
+	XmlTree. Path lookups can be precompiled into an XmlDoc::Query, which resolves each path component to a name id once so
+	that repeated queries compare integers instead of splitting and comparing strings. Nodes are accessed through lightweight
+	XmlDoc::Node handles which mirror the read-only part of the XmlTree interface. Case-insensitive matching folds ASCII only. **/
+class XmlDoc : private boost::noncopyable {
+	static const uint32_t	INVALID_INDEX = 0xFFFFFFFF;
+
+	//! Nodes are stored in document order; a node's attributes run from its mFirstAttr to the next node's
+	struct NodeData {
+		uint32_t	mName;
+		uint32_t	mParent, mFirstChild, mNextSibling;
+		uint32_t	mValueOffset, mValueLength;
+		uint32_t	mFirstAttr;
+		uint32_t	mNodeType;
+	};
+
+	struct AttrData {
+		uint32_t	mName;
+		uint32_t	mValueOffset, mValueLength;
+	};
+
+  public:
+	class Node;
+	class Attr;
+	class Query;
+	class ConstIter;
+
+	//! Parses the XML contained in \a dataSource using the options \a parseOptions
+	explicit XmlDoc( DataSourceRef dataSource, XmlTree::ParseOptions parseOptions = XmlTree::ParseOptions() );
+	//! Parses the XML contained in the string \a xmlString using the options \a parseOptions
+	explicit XmlDoc( const std::string &xmlString, XmlTree::ParseOptions parseOptions = XmlTree::ParseOptions() );
+	//! Builds a document from the contents of \a xmlTree
+	explicit XmlDoc( const XmlTree &xmlTree );
+
+	//! Returns the document's root node, whose type is XmlTree::NODE_DOCUMENT when parsed from XML
+	Node			getRoot() const;
+	//! Returns the number of nodes in the document, including the root
+	size_t			getNumNodes() const { return mNodes.size(); }
+	//! Returns the number of distinct tag and attribute names in the document
+	size_t			getNumNames() const { return mNames.size(); }
+	//! Returns the approximate number of bytes held by the document
+	size_t			getMemoryUsage() const;
+	//! Returns the DOCTYPE string of the document
+	const std::string&	getDocType() const { return mDocType; }
+	//! Returns a copy of the document as an XmlTree
+	XmlTree			toXmlTree() const;
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	/*! Path such as \c "svg/g/path", resolved against the name table of a particular XmlDoc. Empty components are ignored.
+		Queries are cheap to copy and remain valid for the lifetime of the document they were compiled against.
+		<br><tt>XmlDoc::Query itemQuery( doc, "rss/channel/item" );</tt> **/
+	class Query {
+	  public:
+		Query() : mDoc( 0 ), mCaseSensitive( false ) {}
+		//! Compiles \a path against the names of \a doc
+		Query( const XmlDoc &doc, const std::string &path, bool caseSensitive = false, char separator = '/' );
+
+		//! Returns the number of components in the path
+		size_t			size() const { return mIds ? mIds->size() : 0; }
+		//! Returns whether the path has no components
+		bool			empty() const { return size() == 0; }
+		//! Returns whether every component of the path names a tag present in the document. A query for which this is false never matches.
+		bool			isResolved() const;
+		//! Returns the document the query was compiled against
+		const XmlDoc*	getDoc() const { return mDoc; }
+
+	  private:
+		uint32_t		getId( size_t level ) const { return (*mIds)[level]; }
+
+		const XmlDoc							*mDoc;
+		std::shared_ptr<std::vector<uint32_t> >	mIds;
+		bool									mCaseSensitive;
+
+		friend class XmlDoc;
+	};
+
+	//! Handle to an attribute of a Node
+	class Attr {
+	  public:
+		//! Returns the name of the attribute
+		const std::string&	getName() const { return mDoc->mNames[mDoc->mAttrs[mIndex].mName]; }
+		//! Returns the value of the attribute
+		std::string			getValue() const { return std::string( getValueData(), getValueSize() ); }
+		//! Returns the value of the attribute parsed as a T. Requires T to support the istream>> operator.
+		template<typename T>
+		T					getValue() const { return fromString<T>( getValue() ); }
+		//! Returns the value of the attribute as a null-terminated string owned by the document
+		const char*			getValueData() const { return &mDoc->mStrings[mDoc->mAttrs[mIndex].mValueOffset]; }
+		//! Returns the length of the attribute's value in bytes
+		size_t				getValueSize() const { return mDoc->mAttrs[mIndex].mValueLength; }
+
+	  private:
+		Attr( const XmlDoc *doc, uint32_t index ) : mDoc( doc ), mIndex( index ) {}
+
+		const XmlDoc	*mDoc;
+		uint32_t		mIndex;
+
+		friend class Node;
+	};
+
+	//! Handle to a node of an XmlDoc. Handles are cheap to copy and remain valid for the lifetime of the document.
+	class Node {
+	  public:
+		Node() : mDoc( 0 ), mIndex( 0 ) {}
+
+		//! Returns the type of this node
+		XmlTree::NodeType	getNodeType() const { return (XmlTree::NodeType)getData().mNodeType; }
+		//! Returns whether this node is a document node, meaning it is a root node.
+		bool				isDocument() const { return getNodeType() == XmlTree::NODE_DOCUMENT; }
+		//! Returns whether this node is an element node.
+		bool				isElement() const { return getNodeType() == XmlTree::NODE_ELEMENT; }
+		//! Returns whether this node represents CDATA. Only possible when a document's ParseOptions disabled collapsing CDATA.
+		bool				isCData() const { return getNodeType() == XmlTree::NODE_CDATA; }
+		//! Returns whether this node represents a comment. Only possible when a document's ParseOptions enabled parsing commments.
+		bool				isComment() const { return getNodeType() == XmlTree::NODE_COMMENT; }
+
+		//! Returns the tag or name of the node
+		const std::string&	getTag() const { return mDoc->mNames[getData().mName]; }
+		//! Returns the value of the node as a string.
+		std::string			getValue() const { return std::string( getValueData(), getValueSize() ); }
+		//! Returns the value of the node parsed as a T. Requires T to support the istream>> operator.
+		template<typename T>
+		T					getValue() const { return boost::lexical_cast<T>( getValue() ); }
+		//! Returns the value of the node parsed as a T. If the value is empty or fails to parse \a defaultValue is returned.
+		template<typename T>
+		T					getValue( const T &defaultValue ) const { try { return getValue<T>(); } catch( ... ) { return defaultValue; } }
+		//! Returns the value of the node as a null-terminated string owned by the document
+		const char*			getValueData() const { return &mDoc->mStrings[getData().mValueOffset]; }
+		//! Returns the length of the node's value in bytes
+		size_t				getValueSize() const { return getData().mValueLength; }
+
+		//! Returns whether this node has a parent node.
+		bool				hasParent() const { return getData().mParent != INVALID_INDEX; }
+		//! Returns the node which is the parent of this node. Throws ExcChildNotFound on the root node.
+		Node				getParent() const;
+
+		//! Returns the first child that matches \a relativePath. Throws ExcChildNotFound if none matches.
+		Node				getChild( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const;
+		//! Returns the first child that matches \a query. Throws ExcChildNotFound if none matches.
+		Node				getChild( const Query &query ) const;
+		//! Returns whether at least one child matches \a relativePath
+		bool				hasChild( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const;
+		//! Returns whether at least one child matches \a query
+		bool				hasChild( const Query &query ) const;
+		//! Returns the first child that matches \a relativePath or end() if none matches
+		ConstIter			find( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const { return begin( relativePath, caseSensitive, separator ); }
+		//! Returns the first child that matches \a query or end() if none matches
+		ConstIter			find( const Query &query ) const { return begin( query ); }
+		//! Returns the first child that matches \a childName. Throws ExcChildNotFound if none matches.
+		Node				operator/( const std::string &childName ) const { return getChild( childName ); }
+
+		//! Returns the number of children of this node
+		size_t				getNumChildren() const;
+		//! Returns a ConstIter to the first child of this node
+		ConstIter			begin() const;
+		//! Returns a ConstIter to the children of this node which match the path \a filterPath
+		ConstIter			begin( const std::string &filterPath, bool caseSensitive = false, char separator = '/' ) const;
+		//! Returns a ConstIter to the children of this node which match \a query
+		ConstIter			begin( const Query &query ) const;
+		//! Returns a ConstIter which marks the end of the children of this node
+		ConstIter			end() const;
+
+		//! Returns the number of attributes of this node
+		size_t				getNumAttributes() const { return mDoc->getAttrEnd( mIndex ) - getData().mFirstAttr; }
+		//! Returns the attribute at \a index, in document order
+		Attr				getAttribute( size_t index ) const { return Attr( mDoc, getData().mFirstAttr + (uint32_t)index ); }
+		//! Returns the attribute named \a attrName. Throws ExcAttrNotFound if no attribute exists with that name.
+		Attr				getAttribute( const std::string &attrName ) const;
+		//! Returns whether the node has an attribute named \a attrName
+		bool				hasAttribute( const std::string &attrName ) const;
+		/** \brief Returns the value of the attribute \a attrName parsed as a T. Throws ExcAttrNotFound if no attribute exists with that name.
+			<br><tt>float size = myNode.getAttributeValue<float>( "size" );</tt> **/
+		template<typename T>
+		T					getAttributeValue( const std::string &attrName ) const { return getAttribute( attrName ).getValue<T>(); }
+		//! Returns the value of the attribute \a attrName parsed as a T. Returns \a defaultValue if no attribute exists with that name or the attribute fails to cast to T.
+		template<typename T>
+		T					getAttributeValue( const std::string &attrName, const T &defaultValue ) const {
+			uint32_t attr = findAttr( attrName );
+			if( attr == INVALID_INDEX )
+				return defaultValue;
+			try {
+				return Attr( mDoc, attr ).getValue<T>();
+			}
+			catch( ... ) {
+				return defaultValue;
+			}
+		}
+
+		//! Returns a path to this node, separated by the character \a separator.
+		std::string			getPath( char separator = '/' ) const;
+		//! Returns a copy of this node and its descendants as an XmlTree
+		XmlTree				toXmlTree() const;
+
+		//! Returns the document this node belongs to
+		const XmlDoc*		getDoc() const { return mDoc; }
+
+		bool				operator==( const Node &rhs ) const { return mDoc == rhs.mDoc && mIndex == rhs.mIndex; }
+		bool				operator!=( const Node &rhs ) const { return ! ( *this == rhs ); }
+
+	  private:
+		Node( const XmlDoc *doc, uint32_t index ) : mDoc( doc ), mIndex( index ) {}
+
+		const NodeData&	getData() const { return mDoc->mNodes[mIndex]; }
+		uint32_t						findAttr( const std::string &attrName ) const;
+
+		const XmlDoc	*mDoc;
+		uint32_t		mIndex;
+
+		friend class XmlDoc;
+		friend class ConstIter;
+	};
+
+	//! Forward iterator over the children of a Node, optionally restricted to the descendants matching a Query
+	class ConstIter {
+	  public:
+		typedef std::forward_iterator_tag	iterator_category;
+		typedef Node						value_type;
+		typedef std::ptrdiff_t				difference_type;
+		typedef const Node*					pointer;
+		typedef const Node&					reference;
+
+		ConstIter() {}
+
+		const Node&		operator*() const { return mNode; }
+		const Node*		operator->() const { return &mNode; }
+		ConstIter&		operator++() { increment(); return *this; }
+		ConstIter		operator++( int ) { ConstIter prev( *this ); ++(*this); return prev; }
+
+		bool			operator==( const ConstIter &rhs ) const { return mNode == rhs.mNode; }
+		bool			operator!=( const ConstIter &rhs ) const { return mNode != rhs.mNode; }
+
+	  private:
+		ConstIter( const XmlDoc *doc, uint32_t index, const Query &query = Query() ) : mNode( doc, index ), mQuery( query ) {}
+
+		void	increment();
+
+		Node	mNode;
+		Query	mQuery;
+
+		friend class Node;
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	//! Exception expressing the absence of an expected child node.
+	class ExcChildNotFound : public XmlTree::Exception {
+	  public:
+		ExcChildNotFound( const Node &node, const std::string &childPath ) throw();
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[2048];
+	};
+
+	//! Exception expressing the absence of an expected attribute.
+	class ExcAttrNotFound : public XmlTree::Exception {
+	  public:
+		ExcAttrNotFound( const Node &node, const std::string &attrName ) throw();
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[2048];
+	};
+
+	//! Exception expressing the use of a Query with a document other than the one it was compiled against.
+	class ExcQueryMismatch : public XmlTree::Exception {
+	};
+
+  private:
+	void		init( char *xmlText, const XmlTree::ParseOptions &parseOptions );
+	uint32_t	appendNode( uint32_t parent, uint32_t *prevSibling, uint32_t name, const char *value, size_t valueLength, XmlTree::NodeType type );
+	void		appendAttr( const std::string &name, const char *value, size_t valueLength );
+	void		appendRapidXmlChildren( const rapidxml::xml_node<char> &node, uint32_t index, const XmlTree::ParseOptions &parseOptions );
+	void		appendXmlTreeChildren( const XmlTree &xmlTree, uint32_t index );
+	void		fillXmlTree( uint32_t index, XmlTree *result ) const;
+
+	uint32_t	internName( const char *name, size_t length );
+	uint32_t	findName( const std::string &name, bool caseSensitive ) const;
+	uint32_t	storeString( const char *s, size_t length );
+	static double	toDouble( const char *s );
+	static int64_t	toInt( const char *s );
+
+	uint32_t	getAttrEnd( uint32_t index ) const { return index + 1 < mNodes.size() ? mNodes[index + 1].mFirstAttr : (uint32_t)mAttrs.size(); }
+
+	bool		matches( uint32_t index, const Query &query, size_t level ) const;
+	uint32_t	seek( const Query &query, uint32_t candidate, uint32_t parent, size_t level ) const;
+
+	std::vector<NodeData>		mNodes;
+	std::vector<AttrData>		mAttrs;
+	std::vector<char>			mStrings;
+	std::string					mDocType;
+
+	std::vector<std::string>						mNames;
+	//! Maps each name id to the id of its ASCII lowercase form in mFoldedNameIds
+	std::vector<uint32_t>							mFoldedIds;
+	boost::unordered_map<std::string, uint32_t>		mNameIds, mFoldedNameIds;
+
+	friend class Node;
+	friend class Attr;
+	friend class Query;
+	friend class ConstIter;
+};
+
+//! \cond
+template<> inline std::string	XmlDoc::Attr::getValue<std::string>() const	{ return getValue(); }
+template<> inline float			XmlDoc::Attr::getValue<float>() const		{ return (float)toDouble( getValueData() ); }
+template<> inline double		XmlDoc::Attr::getValue<double>() const		{ return toDouble( getValueData() ); }
+template<> inline int32_t		XmlDoc::Attr::getValue<int32_t>() const		{ return (int32_t)toInt( getValueData() ); }
+template<> inline uint32_t		XmlDoc::Attr::getValue<uint32_t>() const	{ return (uint32_t)toInt( getValueData() ); }
+template<> inline std::string	XmlDoc::Node::getValue<std::string>() const	{ return getValue(); }
+template<> inline float			XmlDoc::Node::getValue<float>() const		{ return (float)toDouble( getValueData() ); }
+template<> inline double		XmlDoc::Node::getValue<double>() const		{ return toDouble( getValueData() ); }
+template<> inline int32_t		XmlDoc::Node::getValue<int32_t>() const		{ return (int32_t)toInt( getValueData() ); }
+template<> inline uint32_t		XmlDoc::Node::getValue<uint32_t>() const	{ return (uint32_t)toInt( getValueData() ); }
+//! \endcond
+
+} // namespace cinder
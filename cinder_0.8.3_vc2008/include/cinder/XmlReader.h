@@ -0,0 +1,159 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/DataSource.h"
+#include "cinder/StreamScanner.h"
+#include "cinder/Xml.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cinder {
+
+/*! Event-based pull parser for XML documents too large to hold in memory. Each call to next() reads a single tag or run of text
+	from the stream, so memory use is bounded by the reader's chunk size and the size of the largest single token. Comments,
+	processing instructions and the DOCTYPE are skipped; whitespace-only text is not reported. nextMatching() skips elements which
+	cannot match a path filter, and readTree() materializes the element at the current event as an XmlTree.
+	\code
+	XmlReader reader( loadFile( "scene.xml" ) );
+	while( reader.nextMatching( "scene/objects/object" ) )
+		objects.push_back( Object( reader.readTree() ) );
+	\endcode **/
+class XmlReader {
+  public:
+	typedef enum {
+		EVENT_NONE, EVENT_START_ELEMENT, EVENT_END_ELEMENT, EVENT_TEXT, EVENT_END_DOCUMENT
+	} Event;
+
+	typedef std::pair<std::string, std::string>	Attribute;
+
+	//! Reads the XML in \a dataSource through a stream, without loading its Buffer
+	explicit XmlReader( DataSourceRef dataSource, size_t chunkSize = 64 * 1024 );
+	explicit XmlReader( IStreamRef stream, size_t chunkSize = 64 * 1024 );
+
+	//! Advances to the next event. Returns \c false once the end of the document has been reached.
+	bool				next();
+	/*! Advances to the start of the next element whose path matches \a pathFilter, skipping elements which cannot contain a match.
+		Tags are separated by \a separator, starting with the root element, and \c * matches any single tag.
+		Returns \c false once the end of the document has been reached. **/
+	bool				nextMatching( const std::string &pathFilter, bool caseSensitive = false, char separator = '/' );
+	//! Skips the remainder of the element just started. Has no effect on other events.
+	void				skip();
+
+	//! Returns the current event
+	Event				getEvent() const { return mEvent; }
+	//! Returns the number of open elements, including the current one for start and end events
+	size_t				getDepth() const { return mTags.size(); }
+	//! Returns the tag of the current start or end event, or of the element containing the current text
+	const std::string&	getTag() const;
+	//! Returns the tags of the open elements joined by \a separator, in the format accepted by XmlTree::getChild()
+	std::string			getPath( char separator = '/' ) const;
+
+	//! Returns the attributes of the current start event
+	const std::vector<Attribute>&	getAttributes() const { return mAttributes; }
+	//! Returns whether the current start event has an attribute named \a name
+	bool				hasAttribute( const std::string &name ) const;
+	//! Returns the value of the attribute named \a name. Throws ExcAttrNotFound if it does not exist.
+	const std::string&	getAttributeValue( const std::string &name ) const;
+	//! Returns the value of the attribute named \a name cast to T using ci::fromString(). Throws ExcAttrNotFound if it does not exist.
+	template<typename T>
+	T					getAttributeValue( const std::string &name ) const { return fromString<T>( getAttributeValue( name ) ); }
+	//! Returns the value of the attribute named \a name cast to T, or \a defaultValue if it does not exist
+	template<typename T>
+	T					getAttributeValue( const std::string &name, const T &defaultValue ) const
+	{
+		return hasAttribute( name ) ? fromString<T>( getAttributeValue( name ) ) : defaultValue;
+	}
+
+	//! Returns the current text with entities decoded
+	const std::string&	getValue() const { return mValue; }
+	//! Returns the current text cast to T. Numbers are converted directly; other types use ci::fromString().
+	template<typename T>
+	T					getValue() const { return fromString<T>( mValue ); }
+
+	/*! Consumes the element at the current start event and returns it as an XmlTree. The value of each element is the
+		concatenation of its text, including CDATA sections. **/
+	XmlTree				readTree();
+
+	//! Returns the number of bytes consumed from the stream
+	uint64_t			getOffset() const { return mScanner.getOffset(); }
+
+	//! Exception expressing malformed XML, reporting the byte offset of the error.
+	class ExcXmlParserError : public XmlTree::Exception {
+	  public:
+		ExcXmlParserError( const std::string &errorMessage, uint64_t offset ) throw();
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[ 2048 ];
+	};
+
+	//! Exception expressing the absence of an expected attribute.
+	class ExcAttrNotFound : public XmlTree::Exception {
+	  public:
+		ExcAttrNotFound( const XmlReader &reader, const std::string &attrName ) throw();
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[ 2048 ];
+	};
+
+  private:
+	void				init();
+	double				toDouble() const;
+	int64_t				toInt() const;
+	void				readStartTag();
+	void				readEndTag();
+	void				readCData();
+	void				readName( std::string *name );
+	void				error( const std::string &message ) const;
+
+	StreamScanner				mScanner;
+	Event						mEvent;
+	//! Tags of the open elements. The last one is popped once its end event has been reported.
+	std::vector<std::string>	mTags;
+	bool						mPopPending, mSelfClosing;
+	//! Whether the root element has started; a document may only have one
+	bool						mRootRead;
+	std::vector<Attribute>		mAttributes;
+	std::string					mValue, mRawText;
+
+	std::string					mFilterString;
+	char						mFilterSeparator;
+	std::vector<std::string>	mFilter;
+};
+
+//! \cond
+template<> inline float		XmlReader::getValue<float>() const		{ return (float)toDouble(); }
+template<> inline double	XmlReader::getValue<double>() const		{ return toDouble(); }
+template<> inline int32_t	XmlReader::getValue<int32_t>() const	{ return (int32_t)toInt(); }
+template<> inline uint32_t	XmlReader::getValue<uint32_t>() const	{ return (uint32_t)toInt(); }
+template<> inline int64_t	XmlReader::getValue<int64_t>() const	{ return toInt(); }
+template<> inline uint64_t	XmlReader::getValue<uint64_t>() const	{ return (uint64_t)toInt(); }
+//! \endcond
+
+} // namespace cinder
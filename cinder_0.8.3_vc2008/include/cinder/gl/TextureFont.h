@@ -25,6 +25,9 @@
 #include "cinder/Cinder.h"
 #include "cinder/Text.h"
 #include "cinder/Font.h"
+#include "cinder/DataSource.h"
+#include "cinder/DataTarget.h"
+#include "cinder/Exception.h"
 #include "cinder/gl/Texture.h"
 
 #include <map>
@@ -38,7 +41,7 @@ class TextureFont {
   public:
 	class Format {
 	  public:
-		Format() : mTextureWidth( 1024 ), mTextureHeight( 1024 ), mPremultiply( false ), mMipmapping( false )
+		Format() : mTextureWidth( 1024 ), mTextureHeight( 1024 ), mPremultiply( false ), mMipmapping( false ), mRetainAtlas( false )
 		{}
 		
 		//! Sets the width of the textures created internally for glyphs. Default \c 1024
@@ -59,11 +62,17 @@ class TextureFont {
 		Format&		enableMipmapping( bool enable = true ) { mMipmapping = enable; return *this; }
 		//! Returns whether the TextureFont texture has mipmapping enabled
 		bool		hasMipmapping() const { return mMipmapping; }
+
+		//! Sets whether the TextureFont keeps a copy of its glyph textures in memory so that it can be saved with TextureFont::save(). Default \c false
+		Format&		retainAtlas( bool retain = true ) { mRetainAtlas = retain; return *this; }
+		//! Returns whether the TextureFont keeps a copy of its glyph textures in memory so that it can be saved with TextureFont::save(). Default \c false
+		bool		getRetainAtlas() const { return mRetainAtlas; }
 		
 	  protected:
 		int32_t		mTextureWidth, mTextureHeight;
 		bool		mPremultiply;
 		bool		mMipmapping;
+		bool		mRetainAtlas;
 	};
 
 	struct DrawOptions {
@@ -100,9 +109,92 @@ class TextureFont {
 		float		mScale;
 	};
 
+  protected:
+	//! Vertex arrays for the glyph quads which use a single glyph texture
+	struct Quads {
+		std::vector<float>		mVerts, mTexCoords;
+		std::vector<ColorA8u>	mColors;
+	};
+
+  public:
+	/** \brief Cached glyph placements and quads for a string, so that static text isn't laid out again every frame
+	 *
+	 * Inputs are set with the chainable setters, and TextureFont::update() recomputes only what they invalidate: changing the text, the
+	 * fit rect's size or ligation repeats line breaking and glyph placement, while moving the layout only regenerates its quads. **/
+	class Layout {
+	  public:
+		Layout();
+
+		//! Sets the string to lay out
+		Layout&		text( const std::string &str );
+		//! Lays the text out on the baseline \a baseline, as drawString( str, baseline ) does. This is the default, at the origin.
+		Layout&		baseline( const Vec2f &baseline );
+		//! Lays the text out inside \a fitRect with internal offset \a offset, as drawString( str, fitRect, offset ) does. If \a wrap, the text is word-wrapped as drawStringWrapped() does.
+		Layout&		fit( const Rectf &fitRect, const Vec2f &offset = Vec2f::zero(), bool wrap = false );
+		//! Sets the DrawOptions used to lay out the text
+		Layout&		options( const DrawOptions &options );
+		//! Sets a color for every glyph in the layout. An uncolored layout is drawn with the current color, or in white when batched with colored layouts.
+		Layout&		color( const ColorA8u &color );
+
+		//! Returns the string being laid out
+		const std::string&		getText() const { return mText; }
+		//! Returns the DrawOptions used to lay out the text
+		const DrawOptions&		getOptions() const { return mOptions; }
+		//! Returns whether the inputs have changed since the last call to TextureFont::update()
+		bool					isDirty() const { return mPlacementsDirty || mQuadsDirty; }
+		//! Returns the glyph/placement pairs computed by the last call to TextureFont::update(), suitable for use with drawGlyphs()
+		const std::vector<std::pair<uint16_t,Vec2f> >&	getGlyphPlacements() const { return mPlacements; }
+		//! Returns the number of glyph quads computed by the last call to TextureFont::update()
+		size_t					getNumQuads() const;
+
+	  private:
+		enum Mode { BASELINE, FIT, FIT_WRAPPED };
+
+		std::string								mText;
+		Mode									mMode;
+		Vec2f									mBaseline, mOffset;
+		Rectf									mFitRect;
+		DrawOptions								mOptions;
+		bool									mHasColor;
+		ColorA8u								mColor;
+
+		const TextureFont						*mTextureFont;
+		bool									mPlacementsDirty, mQuadsDirty;
+		std::vector<std::pair<uint16_t,Vec2f> >	mPlacements;
+		std::vector<Quads>						mQuads;
+
+		friend class TextureFont;
+	};
+
+	//! Merges the quads of many \ref Layout "Layouts" of the same TextureFont into one vertex array per glyph texture, drawn with drawBatch()
+	class Batch {
+	  public:
+		Batch() : mHasColors( false ) {}
+
+		//! Removes all quads from the Batch, retaining its storage
+		void	clear();
+		//! Appends the quads of \a layout, which must be up to date. \sa TextureFont::update()
+		void	append( const Layout &layout );
+		//! Returns the number of glyph quads in the Batch
+		size_t	getNumQuads() const;
+
+	  private:
+		std::vector<Quads>	mQuads;
+		bool				mHasColors;
+
+		friend class TextureFont;
+	};
+
 	//! Creates a new TextureFontRef with font \a font, ensuring that glyphs necessary to render \a supportedChars are renderable, and format \a format
 	static TextureFontRef		create( const Font &font, const Format &format = Format(), const std::string &supportedChars = TextureFont::defaultChars() )
 	{ return TextureFontRef( new TextureFont( font, supportedChars, format ) ); }
+	//! Creates a new TextureFontRef from the glyph atlas \a atlas written by save(), without rasterizing any glyphs. Throws TextureFontAtlasExc unless \a atlas was saved for \a font's name and size, \a supportedChars and the texture size and premultiplication of \a format.
+	static TextureFontRef		create( const Font &font, DataSourceRef atlas, const Format &format = Format(), const std::string &supportedChars = TextureFont::defaultChars() );
+	//! Creates a new TextureFontRef from the glyph atlas file \a atlasPath if it matches \a font, \a supportedChars and \a format. Otherwise rasterizes the glyphs and saves their atlas to \a atlasPath for next time.
+	static TextureFontRef		create( const Font &font, const fs::path &atlasPath, const Format &format = Format(), const std::string &supportedChars = TextureFont::defaultChars() );
+
+	//! Writes the glyph metrics and textures to \a target, to be loaded by create(). Requires a TextureFont created with Format::retainAtlas().
+	void	save( DataTargetRef target ) const;
 	
 	//! Draws string \a str at baseline \a baseline with DrawOptions \a options
 	void	drawString( const std::string &str, const Vec2f &baseline, const DrawOptions &options = DrawOptions() );
@@ -115,6 +207,13 @@ class TextureFont {
 	//! Draws the glyphs in \a glyphMeasures clipped by \a clip, with \a offset added to each of the glyph offsets with DrawOptions \a options. \a glyphMeasures is a vector of pairs of glyph indices and offsets for the glyph baselines.
 	void	drawGlyphs( const std::vector<std::pair<uint16_t,Vec2f> > &glyphMeasures, const Rectf &clip, Vec2f offset, const DrawOptions &options = DrawOptions(), const std::vector<ColorA8u> &colors = std::vector<ColorA8u>() );
 
+	//! Recomputes whatever the inputs of \a layout have invalidated since it was last updated. Returns \c false if \a layout was already up to date.
+	bool	update( Layout *layout ) const;
+	//! Draws \a layout, updating it first if necessary
+	void	drawLayout( Layout *layout );
+	//! Draws every Layout appended to \a batch, using one draw call per glyph texture
+	void	drawBatch( const Batch &batch );
+
 	//! Returns the size in pixels necessary to render the string \a str with DrawOptions \a options.
 	Vec2f	measureString( const std::string &str, const DrawOptions &options = DrawOptions() ) const;
 #if defined( CINDER_COCOA )
@@ -144,17 +243,42 @@ class TextureFont {
 
   protected:
 	TextureFont( const Font &font, const std::string &supportedChars, const Format &format );
+	//! Loads the glyph atlas from \a atlas rather than rasterizing the glyphs
+	TextureFont( const Font &font, const std::string &supportedChars, const Format &format, DataSourceRef atlas );
+
+	//! Adds a glyph texture from the luminance-alpha pixels of \a surface, retaining them when the Format asks for it
+	void	addTexture( const Surface8u &surface );
+	//! Adds a glyph texture from \a lumAlphaData, 2 bytes per pixel, retaining it when the Format asks for it
+	void	addTexture( const std::shared_ptr<uint8_t> &lumAlphaData );
 
 	struct GlyphInfo {
 		uint8_t		mTextureIndex;
 		Area		mTexCoords;
 		Vec2f		mOriginOffset;
 	};
+
+	//! Returns the offset of the upper-left of the text's first line for text drawn on \a baseline
+	Vec2f	calcBaselineOffset( const Vec2f &baseline, const DrawOptions &options ) const;
+	//! Appends the quads for \a glyphMeasures, offset by \a offset and clipped by \a clip unless it's \c NULL, to \a result
+	void	appendQuads( const std::vector<std::pair<uint16_t,Vec2f> > &glyphMeasures, Vec2f offset, const Rectf *clip, const DrawOptions &options,
+						const std::vector<ColorA8u> &colors, std::vector<Quads> *result ) const;
+	void	drawQuads( const std::vector<Quads> &quads, bool useColors );
 	
 	boost::unordered_map<Font::Glyph, GlyphInfo>	mGlyphMap;
 	std::vector<gl::Texture>						mTextures;
+	std::vector<std::shared_ptr<uint8_t> >			mAtlasData;
 	Font											mFont;
 	Format											mFormat;
+	uint32_t										mSupportedCharsHash;
+};
+
+//! Thrown when a glyph atlas can't be read, or was saved for a different font, set of characters or TextureFont::Format
+class TextureFontAtlasExc : public cinder::Exception {
+  public:
+	TextureFontAtlasExc( const std::string &message ) throw();
+	virtual const char* what() const throw() { return mMessage; }
+  private:
+	char mMessage[2048];
 };
 
 } } // namespace cinder::gl
\ No newline at end of file
@@ -74,7 +74,7 @@ class VboMesh {
 	enum { ATTR_MAX_TEXTURE_UNIT = 3 };
 
 	struct Layout {
-		Layout() { initAttributes(); }
+		Layout() : mOptimizeVertexCache( false ) { initAttributes(); }
 
 		//! \return is the Layout unspecified, presumably TBG by a constructor for VboMesh
 		bool	isDefaults() const { for( int a = 0; a < ATTR_TOTAL; ++a ) if( mAttributes[a] != NONE ) return false; return true; }
@@ -127,6 +127,10 @@ class VboMesh {
 		void	setStaticPositions() { mAttributes[ATTR_POSITIONS] = STATIC; }
 		void	setDynamicPositions() { mAttributes[ATTR_POSITIONS] = DYNAMIC; }
 		
+		//! When constructing from a TriMesh, reorders a copy of its triangles and vertices for the post-transform vertex cache before uploading. \sa optimizeTriMesh()
+		bool	getOptimizeVertexCache() const { return mOptimizeVertexCache; }
+		void	setOptimizeVertexCache( bool optimize = true ) { mOptimizeVertexCache = optimize; }
+
 		enum CustomAttr { CUSTOM_ATTR_FLOAT, CUSTOM_ATTR_FLOAT2, CUSTOM_ATTR_FLOAT3, CUSTOM_ATTR_FLOAT4, TOTAL_CUSTOM_ATTR_TYPES };
 		static int sCustomAttrSizes[TOTAL_CUSTOM_ATTR_TYPES];
 		static GLint sCustomAttrNumComponents[TOTAL_CUSTOM_ATTR_TYPES];
@@ -138,6 +142,7 @@ class VboMesh {
 
 		int												mAttributes[ATTR_TOTAL];
 		std::vector<std::pair<CustomAttr,size_t> >		mCustomDynamic, mCustomStatic; // pair of <types,offset>
+		bool											mOptimizeVertexCache;
 		
 	 private:
 		void initAttributes() { for( int a = 0; a < ATTR_TOTAL; ++a ) mAttributes[a] = NONE; }
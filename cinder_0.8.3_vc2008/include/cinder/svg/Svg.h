@@ -30,6 +30,7 @@
 #include "cinder/Color.h"
 #include "cinder/Shape2d.h"
 #include "cinder/PolyLine.h"
+#include "cinder/TriMesh.h"
 #include "cinder/Exception.h"
 #include "cinder/MatrixAffine2.h"
 #include "cinder/Surface.h"
@@ -37,6 +38,7 @@
 #include "cinder/Function.h"
 
 #include <map>
+#include <iosfwd>
 
 namespace cinder { namespace svg {
 
@@ -57,6 +59,7 @@ class Ellipse;
 class Polyline;
 class Polygon;
 class Image;
+class Doc;
 class ExcChildNotFound;
 
 typedef std::function<bool(const Node&, svg::Style *)> RenderVisitor;
@@ -296,6 +299,45 @@ class Style {
   	static Paint						sPaintNone, sPaintBlack;
 };
 
+//! Timings gathered by svg::Doc while parsing and tessellating, broken down by element type
+class DocStats {
+  public:
+	//! Totals for one element type
+	struct NodeType {
+		NodeType() : mNumParsed( 0 ), mParseSeconds( 0 ), mNumTessellated( 0 ), mTessellateSeconds( 0 ) {}
+
+		size_t	mNumParsed;
+		double	mParseSeconds;
+		size_t	mNumTessellated;
+		double	mTessellateSeconds;
+	};
+
+	DocStats() : mXmlSeconds( 0 ), mParseSeconds( 0 ), mTessellateSeconds( 0 ) {}
+
+	//! Returns the totals for each element type, keyed by element name such as \c "path" or \c "g". Times are summed across threads, so they may exceed the wall-clock totals.
+	const std::map<std::string,NodeType>&	getNodeTypes() const { return mNodeTypes; }
+	//! Returns the wall-clock time spent parsing the document's XML
+	double		getXmlSeconds() const { return mXmlSeconds; }
+	//! Returns the wall-clock time spent building svg::Nodes from the XML
+	double		getParseSeconds() const { return mParseSeconds; }
+	//! Returns the wall-clock time spent triangulating and flattening, both in Doc::cacheGeometry() and lazily during rendering
+	double		getTessellateSeconds() const { return mTessellateSeconds; }
+
+	void		addParse( const std::string &nodeType, double seconds );
+	void		addTessellate( const std::string &nodeType, double seconds );
+	//! Adds the per-type totals of \a rhs to this one's, leaving the wall-clock totals untouched
+	void		appendNodeTypes( const DocStats &rhs );
+	void		clear() { *this = DocStats(); }
+
+	friend std::ostream& operator<<( std::ostream &out, const DocStats &stats );
+
+  private:
+	std::map<std::string,NodeType>	mNodeTypes;
+	double							mXmlSeconds, mParseSeconds, mTessellateSeconds;
+
+	friend class Doc;
+};
+
 //! Base class for an element of an SVG Document
 class Node {
   public:
@@ -313,7 +355,7 @@ class Node {
 	//! Returns the style elements defined on this Node but not inherited from ancestors.
 	const Style&		getStyle() const { return mStyle; }
 	//! Sets the style defined on this Node but not inherited from ancestors.
-	void				setStyle( const Style &style ) { mStyle = style; }
+	void				setStyle( const Style &style ) { mStyle = style; invalidateGeometry(); }
 	//! Returns the node's Style, including attributes inherited from its ancestors for attributes it does not specify
 	Style				calcInheritedStyle() const;
 
@@ -333,9 +375,9 @@ class Node {
 	//! Returns the local transformation of this node. Returns identity if the Node's transform isn't specified.
 	MatrixAffine2f		getTransform() const { return mTransform; }
 	//! Sets the local transformation of this node.
-	void				setTransform( const MatrixAffine2f &transform ) { mTransform = transform; mSpecifiesTransform = true; }
+	void				setTransform( const MatrixAffine2f &transform ) { mTransform = transform; mSpecifiesTransform = true; invalidateGeometry(); }
 	//! Removes the local transformation of this node, effectively making it the identity matrix.
-	void				unspecifyTransform() { mSpecifiesTransform = false; }
+	void				unspecifyTransform() { mSpecifiesTransform = false; invalidateGeometry(); }
 	//! Returns the inverse of the local transformation of this node. Returns identity if the Node's transform isn't specified.
 	MatrixAffine2f		getTransformInverse() const { return ( mSpecifiesTransform ) ? mTransform.invertCopy() : MatrixAffine2f::identity(); }
 	//! Returns the absolute transformation of this node, which includes inherited transformations.
@@ -353,6 +395,13 @@ class Node {
 	//! Returns a Shape2d representing the node in absolute coordinates. Not supported for Text.
 	Shape2d			getShapeAbsolute() const { return getShape().transformCopy( getTransformAbsolute() ); }
 
+	//! Returns getShape() triangulated using \a fillRule, in local coordinates. Calculated and cached the first time it is requested for a given \a fillRule and \a approximationScale.
+	const TriMesh2d&				getFillMesh( FillRule fillRule, float approximationScale = 1.0f ) const;
+	//! Returns the contours of getShape() flattened into polylines, in local coordinates. Calculated and cached the first time it is requested for a given \a approximationScale.
+	const std::vector<PolyLine2f>&	getOutlines( float approximationScale = 1.0f ) const;
+	//! Discards the cached fill mesh, outlines and bounding box. Called by setTransform() and setStyle(); call it after modifying a node's geometry directly, such as through Polygon::getPolyLine().
+	void							invalidateGeometry() const { mGeometryCache.reset(); mBoundingBoxCached = false; }
+
 	//! Returns node's fill, or the first among its ancestors when it has none
 	const Paint&	getFill() const;
 	//! Returns node's stroke, or the first among its ancestors when it has none
@@ -393,6 +442,10 @@ class Node {
 	
 	static std::string	findStyleValue( const std::string &styleString, const std::string &key );
 	void				parseStyle( const std::string &value );
+
+	struct GeometryCache;
+	void				cacheFillMesh( FillRule fillRule, float approximationScale, DocStats *stats ) const;
+	void				cacheOutlines( float approximationScale, DocStats *stats ) const;
     
   protected:
 	const Node		*mParent;
@@ -402,12 +455,14 @@ class Node {
 	MatrixAffine2f	mTransform;
 	mutable bool	mBoundingBoxCached;
 	mutable Rectf	mBoundingBox;
+	mutable std::shared_ptr<GeometryCache>	mGeometryCache;
 	
   private:
   	void			firstStartRender( Renderer &renderer ) const;
 
 	friend class Group;
 	friend class Use;
+	friend class Doc;
 };
 
 //! Base class for SVG Gradients. See SVG Gradients: http://www.w3.org/TR/SVG/pservers.html#Gradients
@@ -747,6 +802,20 @@ class Group : public Node {
 	virtual bool	isDrawable() const { return false; }
 	void 			parse( const XmlTree &xml );
 
+	struct PendingGroup;
+	struct ParseTask;
+	typedef std::vector<PendingGroup>	PendingGroups;
+
+	//! Constructs the group without parsing its children when \a parseChildren is false
+	Group( const Node *parent, const XmlTree &xml, bool parseChildren );
+	//! Parses the children of \a xml, recording timings in \a stats when non-NULL. All children are created before any child group is descended into. When \a pending is non-NULL, child groups which are safe to parse on another thread are appended to it unparsed.
+	void			parse( const XmlTree &xml, DocStats *stats, PendingGroups *pending );
+	//! Parses the children of \a xml, spreading sibling \c <g> subtrees across all cores
+	void			parseParallel( const XmlTree &xml, DocStats *stats );
+	//! Creates the node for \a xml. Defs are parsed completely; the children of a \c <g> are left to the caller.
+	Node*			parseChild( const XmlTree &xml, DocStats *stats );
+	void			collectNodes( std::vector<const Node*> *result ) const;
+
 	std::list<Node*>		mChildren;
 	std::shared_ptr<Group>	mDefs;
 };
@@ -783,17 +852,32 @@ class Doc : public Group {
 	
 	//! Utility function to load an image relative to the document. Caches results.
 	std::shared_ptr<Surface8u>	loadImage( fs::path relativePath );
+
+	/*! Triangulates and flattens every drawable node ahead of rendering, spread across all cores. Text is processed on the calling thread since Fonts are not thread-safe. Each node uses its inherited fill rule.
+		Afterwards getFillMesh() and getOutlines() return cached geometry for \a approximationScale until a node's transform or style changes. **/
+	void				cacheGeometry( float approximationScale = 1.0f ) const;
+	//! Returns timings gathered while loading the document and tessellating its nodes
+	const DocStats&		getStats() const { return mStats; }
+
   private:
   	void 	loadDoc( DataSourceRef source, fs::path filePath );
+	void	addTessellateStats( const DocStats &stats, double seconds ) const;
+
+	struct CacheTask;
+	struct IsNotText;
+	static void			cacheNodes( const Node * const *nodes, size_t count, float approximationScale, DocStats *stats );
 
 	virtual void		renderSelf( Renderer &renderer ) const;
   
 	std::shared_ptr<XmlTree>	mXmlTree;
+	mutable DocStats			mStats;
 	std::map<fs::path,std::shared_ptr<Surface8u> >	mImageCache;
 	
 	fs::path		mFilePath;
 	Area			mViewBox;
 	int32_t			mWidth, mHeight;
+
+	friend class Node;
 };
 
 //! SVG Exception base-class
@@ -54,21 +54,20 @@ class SvgRendererGl : public svg::Renderer {
 	void	drawPath( const svg::Path &path ) {
 		if( ! mFillStack.back().isNone() ) {
 			gl::color( getCurFillColor() );
-			Triangulator::Winding winding = ( mFillRuleStack.back() == svg::FILL_RULE_NONZERO ) ? Triangulator::WINDING_NONZERO : Triangulator::WINDING_ODD;
-			gl::draw( Triangulator( path.getShape2d() ).calcMesh( winding ) );
+			gl::draw( path.getFillMesh( mFillRuleStack.back() ) );
 		}
 		if( ! mStrokeStack.back().isNone() ) {
 			gl::color( getCurStrokeColor() );
-			gl::draw( path.getShape2d() );
+			const std::vector<PolyLine2f> &outlines = path.getOutlines();
+			for( std::vector<PolyLine2f>::const_iterator outlineIt = outlines.begin(); outlineIt != outlines.end(); ++outlineIt )
+				gl::draw( *outlineIt );
 		}
 	}
 
 	void	drawPolygon( const svg::Polygon &polygon ) {
 		if( ! mFillStack.back().isNone() ) {
 			gl::color( getCurFillColor() );
-			Triangulator::Winding winding = ( mFillRuleStack.back() == svg::FILL_RULE_NONZERO ) ? Triangulator::WINDING_NONZERO : Triangulator::WINDING_ODD;
-			gl::draw( Triangulator( polygon.getPolyLine() ).calcMesh( winding ) );
-
+			gl::draw( polygon.getFillMesh( mFillRuleStack.back() ) );
 		}
 		if( ! mStrokeStack.back().isNone() ) {
 			gl::color( getCurStrokeColor() );
@@ -79,9 +78,7 @@ class SvgRendererGl : public svg::Renderer {
 	void	drawPolyline( const svg::Polyline &polyline ) {
 		if( ! mFillStack.back().isNone() ) {
 			gl::color( getCurFillColor() );
-			Triangulator::Winding winding = ( mFillRuleStack.back() == svg::FILL_RULE_NONZERO ) ? Triangulator::WINDING_NONZERO : Triangulator::WINDING_ODD;
-			gl::draw( Triangulator( polyline.getPolyLine() ).calcMesh( winding ) );
-
+			gl::draw( polyline.getFillMesh( mFillRuleStack.back() ) );
 		}
 		if( ! mStrokeStack.back().isNone() ) {
 			gl::color( getCurStrokeColor() );
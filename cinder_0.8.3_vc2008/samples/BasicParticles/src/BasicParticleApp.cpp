@@ -4,9 +4,14 @@
 #include "cinder/Perlin.h"
 #include "cinder/Color.h"
 #include "cinder/gl/gl.h"
+#include "cinder/KdTree.h"
+#include "cinder/SpatialHashGrid.h"
+#include "cinder/Timer.h"
 
 #include <list>
+#include <vector>
 using std::list;
+using std::vector;
 
 using namespace ci;
 using namespace ci::app;
@@ -28,6 +33,8 @@ class BasicParticleApp : public AppBasic {
 	void	keyDown( KeyEvent event );
 	
 	bool	isOffscreen( const Vec2f &v );
+	void	benchmarkKdTree();
+	void	benchmarkSpatialHashGrid();
 	
 	void	update();
 	void	draw();	
@@ -69,6 +76,10 @@ void BasicParticleApp::keyDown( KeyEvent event )
 		setFullScreen( ! isFullScreen() );
 	else if( event.getChar() == 'x' )
 		mParticles.clear();
+	else if( event.getChar() == 'k' )
+		benchmarkKdTree();
+	else if( event.getChar() == 'g' )
+		benchmarkSpatialHashGrid();
 }
 
 // Returns whether a given point is visible onscreen or not
@@ -77,6 +88,97 @@ bool BasicParticleApp::isOffscreen( const Vec2f &v )
 	return ( ( v.x < 0 ) || ( v.x > getWindowWidth() ) || ( v.y < 0 ) || ( v.y > getWindowHeight() ) );
 }
 
+// Logs KdTree build and batched 8-nearest-neighbor query throughput for 10k to 1M random points
+void BasicParticleApp::benchmarkKdTree()
+{
+	const int numNeighbors = 8;
+	for( int numPoints = 10000; numPoints <= 1000000; numPoints *= 10 ) {
+		vector<Vec2f> points;
+		points.reserve( numPoints );
+		for( int i = 0; i < numPoints; ++i )
+			points.push_back( Vec2f( Rand::randFloat( getWindowWidth() ), Rand::randFloat( getWindowHeight() ) ) );
+		vector<uint32_t> indices( numPoints * numNeighbors );
+		vector<float> distSqrd( numPoints * numNeighbors );
+
+		Timer timer( true );
+		KdTree<Vec2f, 2> tree( points );
+		double buildSeconds = timer.getSeconds();
+
+		timer.start();
+		tree.findKNearestBatch( &points[0], points.size(), numNeighbors, &indices[0], &distSqrd[0] );
+		double querySeconds = timer.getSeconds();
+
+		timer.start();
+		tree.findKNearestBatch( &points[0], points.size(), numNeighbors, &indices[0], &distSqrd[0], 0, FLT_MAX, 0.5f );
+		double approxSeconds = timer.getSeconds();
+
+		console() << numPoints << " points: build " << buildSeconds * 1000 << "ms, "
+			<< numPoints / querySeconds / 1000000 << " M queries/s exact, "
+			<< numPoints / approxSeconds / 1000000 << " M queries/s epsilon 0.5" << std::endl;
+	}
+}
+
+// Moves \a points by \a velocities for \a numFrames frames, timing a SpatialHashGrid and a KdTree rebuild plus radius query of every point per frame
+template<typename T, unsigned char K>
+static void timeNeighborQueries( vector<T> &points, const vector<T> &velocities, float radius, int numFrames, double *gridSeconds, double *kdTreeSeconds, size_t *gridNeighbors, size_t *kdTreeNeighbors )
+{
+	const uint32_t maxNeighbors = 64;
+	vector<uint32_t> indices( points.size() * maxNeighbors ), counts( points.size() );
+
+	SpatialHashGrid<T> grid( radius );
+	Timer timer;
+	*gridSeconds = *kdTreeSeconds = 0;
+	for( int frame = 0; frame < numFrames; ++frame ) {
+		for( size_t i = 0; i < points.size(); ++i )
+			points[i] += velocities[i];
+
+		timer.start();
+		grid.rebuild( points );
+		grid.findNeighborsBatch( &points[0], points.size(), radius, &indices[0], 0, maxNeighbors, &counts[0] );
+		*gridSeconds += timer.getSeconds();
+		*gridNeighbors = 0;
+		for( size_t i = 0; i < points.size(); ++i )
+			*gridNeighbors += counts[i];
+
+		timer.start();
+		KdTree<T, K> tree( points );
+		tree.findInRadiusBatch( &points[0], points.size(), radius, &indices[0], 0, maxNeighbors, &counts[0] );
+		*kdTreeSeconds += timer.getSeconds();
+		*kdTreeNeighbors = 0;
+		for( size_t i = 0; i < points.size(); ++i )
+			*kdTreeNeighbors += counts[i];
+	}
+}
+
+// Logs the per-frame cost of rebuilding and querying a SpatialHashGrid versus a KdTree for 100k moving points, in 2D and in 3D
+void BasicParticleApp::benchmarkSpatialHashGrid()
+{
+	const int numPoints = 100000;
+	const int numFrames = 10;
+	const float radius = 10.0f;
+	const float depth = 200.0f;
+	double gridSeconds, kdTreeSeconds;
+	size_t gridNeighbors, kdTreeNeighbors;
+
+	vector<Vec2f> points2, velocities2;
+	for( int i = 0; i < numPoints; ++i ) {
+		points2.push_back( Vec2f( Rand::randFloat( getWindowWidth() ), Rand::randFloat( getWindowHeight() ) ) );
+		velocities2.push_back( Rand::randVec2f() * Rand::randFloat( 2.0f ) );
+	}
+	timeNeighborQueries<Vec2f, 2>( points2, velocities2, radius, numFrames, &gridSeconds, &kdTreeSeconds, &gridNeighbors, &kdTreeNeighbors );
+	console() << numPoints << " moving 2D points, radius " << radius << ": SpatialHashGrid " << gridSeconds / numFrames * 1000
+		<< "ms/frame, KdTree " << kdTreeSeconds / numFrames * 1000 << "ms/frame, neighbors " << gridNeighbors << " vs " << kdTreeNeighbors << std::endl;
+
+	vector<Vec3f> points3, velocities3;
+	for( int i = 0; i < numPoints; ++i ) {
+		points3.push_back( Vec3f( Rand::randFloat( getWindowWidth() ), Rand::randFloat( getWindowHeight() ), Rand::randFloat( depth ) ) );
+		velocities3.push_back( Rand::randVec3f() * Rand::randFloat( 2.0f ) );
+	}
+	timeNeighborQueries<Vec3f, 3>( points3, velocities3, radius, numFrames, &gridSeconds, &kdTreeSeconds, &gridNeighbors, &kdTreeNeighbors );
+	console() << numPoints << " moving 3D points, radius " << radius << ": SpatialHashGrid " << gridSeconds / numFrames * 1000
+		<< "ms/frame, KdTree " << kdTreeSeconds / numFrames * 1000 << "ms/frame, neighbors " << gridNeighbors << " vs " << kdTreeNeighbors << std::endl;
+}
+
 void BasicParticleApp::update()
 {
 	mAnimationCounter += 10.0f; // move ahead in time, which becomes the z-axis of our 3D noise
@@ -8,6 +8,7 @@
 #include "cinder/app/AppBasic.h"
 #include "cinder/gl/Texture.h"
 #include "cinder/Rand.h"
+#include "cinder/RandStream.h"
 #include "cinder/ImageIo.h"
 #include "cinder/Utilities.h"
 #include "cinder/gl/GlslProg.h"
@@ -29,6 +30,7 @@ class BuddhabrotApp : public AppBasic {
 	void mouseDrag( MouseEvent event );
 	void mouseUp( MouseEvent event );
 	void keyDown( KeyEvent event );
+	void benchmarkRand();
 	void update();
 	void draw();
 	void runBrot();
@@ -247,6 +249,49 @@ void BuddhabrotApp::keyDown( KeyEvent event )
 	else if( event.getChar() == 'o' ) {
 
 	}
+	else if( event.getChar() == 'b' ) {
+		benchmarkRand();
+	}
+}
+
+// compares the throughput of the static Rand functions with RandStream's bulk fills
+void BuddhabrotApp::benchmarkRand()
+{
+	const size_t COUNT = 4000000;
+	vector<float> floats( COUNT );
+	vector<Vec3f> vecs( COUNT );
+	RandStream stream( 1234 );
+	Timer timer;
+
+	timer.start();
+	for( size_t i = 0; i < COUNT; ++i )
+		floats[i] = Rand::randFloat();
+	timer.stop();
+	console() << "floats: Rand " << COUNT / timer.getSeconds() / 1000000 << " M/s";
+	timer.start();
+	stream.fillFloats( &floats[0], COUNT );
+	timer.stop();
+	console() << ", RandStream " << COUNT / timer.getSeconds() / 1000000 << " M/s" << endl;
+
+	timer.start();
+	for( size_t i = 0; i < COUNT; ++i )
+		vecs[i] = Rand::randVec3f();
+	timer.stop();
+	console() << "Vec3f: Rand " << COUNT / timer.getSeconds() / 1000000 << " M/s";
+	timer.start();
+	stream.fillVec3f( &vecs[0], COUNT );
+	timer.stop();
+	console() << ", RandStream " << COUNT / timer.getSeconds() / 1000000 << " M/s" << endl;
+
+	timer.start();
+	for( size_t i = 0; i < COUNT; ++i )
+		floats[i] = Rand::randGaussian();
+	timer.stop();
+	console() << "Gaussians: Rand " << COUNT / timer.getSeconds() / 1000000 << " M/s";
+	timer.start();
+	stream.fillGaussians( &floats[0], COUNT );
+	timer.stop();
+	console() << ", RandStream " << COUNT / timer.getSeconds() / 1000000 << " M/s" << endl;
 }
 
 void BuddhabrotApp::runBrot()
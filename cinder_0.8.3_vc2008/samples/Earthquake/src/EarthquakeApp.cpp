@@ -6,6 +6,10 @@
 #include "cinder/gl/gl.h"
 #include "cinder/gl/Texture.h"
 #include "cinder/Xml.h"
+#include "cinder/XmlReader.h"
+#include "cinder/Json.h"
+#include "cinder/JsonReader.h"
+#include "cinder/Timer.h"
 #include "cinder/Url.h"
 #include "cinder/Vector.h"
 #include "cinder/gl/GlslProg.h"
@@ -17,6 +21,7 @@ using namespace ci::app;
 
 #include <vector>
 #include <sstream>
+#include <fstream>
 using std::vector;
 using std::string;
 using std::istringstream;
@@ -30,6 +35,7 @@ class EarthquakeApp : public AppBasic {
 	void mouseMove( MouseEvent event );
 	void mouseWheel( MouseEvent event );
 	void parseEarthquakes( const string &url );
+	void benchmarkReaders();
 	void setup();
 	void update();
 	void draw();
@@ -135,6 +141,9 @@ void EarthquakeApp::keyDown( KeyEvent event )
 	else if( event.getCode() == app::KeyEvent::KEY_DOWN ) {
 		mPov.adjustDist( 10.0f );
 	}
+	else if( event.getChar() == 'b' ) {
+		benchmarkReaders();
+	}
 	else if( event.getChar() == ' ' ) {
 // 		gl::TileRender tr( 5000, 5000 );
 // 		CameraPersp cam;
@@ -242,23 +251,101 @@ void EarthquakeApp::draw()
 
 void EarthquakeApp::parseEarthquakes( const string &url )
 {
-	const XmlTree xml( loadUrl( Url( url ) ) );
-	for( XmlTree::ConstIter itemIter = xml.begin( "feed/entry" ); itemIter != xml.end(); ++itemIter ) {
-		string titleLine( itemIter->getChild( "title" ).getValue() );
+	// stream the feed, materializing one entry at a time
+	XmlReader reader( loadUrl( Url( url ) ) );
+	while( reader.nextMatching( "feed/entry" ) ) {
+		const XmlTree entry = reader.readTree();
+		string titleLine( entry.getChild( "title" ).getValue() );
 		size_t firstComma = titleLine.find( ',' );
 		float magnitude = fromString<float>( titleLine.substr( titleLine.find( ' ' ) + 1, firstComma - 2 ) );
 		string title = titleLine.substr( firstComma + 2 );
 
-		istringstream locationString( itemIter->getChild( "georss:point" ).getValue() );
+		istringstream locationString( entry.getChild( "georss:point" ).getValue() );
 		Vec2f locationVector;
 		locationString >> locationVector.x >> locationVector.y;
 		
 		mEarth.addQuake( locationVector.x, locationVector.y, magnitude, title );		
 	}
-	console() << xml << std::endl;
 	
 	//mEarth.addQuake( 37.7f, -122.0f, 8.6f, "San Francisco" );
 }
 
+namespace {
+
+// Writes a synthetic sensor log of roughly targetBytes, as JSON or XML
+void writeSensorLog( const fs::path &path, uint64_t targetBytes, bool json )
+{
+	std::ofstream out( path.string().c_str(), std::ios::binary );
+	out << ( json ? "{\"meta\":{\"version\":1},\"samples\":[\n" : "<?xml version=\"1.0\"?>\n<log><meta version=\"1\"/><samples>\n" );
+	for( uint64_t i = 0; (uint64_t)out.tellp() < targetBytes; ++i ) {
+		if( json )
+			out << ( i ? ",\n" : "" ) << "{\"t\":" << i << ",\"sensor\":\"sensor_" << i % 17 << "\",\"value\":" << i * 0.25 << ",\"xyz\":[" << i % 101 << "," << i % 103 << "," << i % 107 << "]}";
+		else
+			out << "<sample t=\"" << i << "\" sensor=\"sensor_" << i % 17 << "\"><value>" << i * 0.25 << "</value><xyz>" << i % 101 << " " << i % 103 << " " << i % 107 << "</xyz></sample>\n";
+	}
+	out << ( json ? "]}\n" : "</samples></log>\n" );
+}
+
+void logThroughput( const string &name, uint64_t bytes, double seconds, size_t samples, double sum )
+{
+	console() << name << ": " << bytes / ( 1024 * 1024 ) << " MB in " << seconds << " s (" << bytes / ( 1024 * 1024 ) / seconds << " MB/s), " << samples << " samples, sum " << sum << std::endl;
+}
+
+} // anonymous namespace
+
+// Sums the "value" of every sample in 1 GB JSON and XML logs with the streaming readers, which hold a 64 KB chunk at a time,
+// then in 64 MB logs with JsonTree and XmlTree, which hold the whole document and its tree.
+void EarthquakeApp::benchmarkReaders()
+{
+	const uint64_t streamBytes = 1024 * 1024 * 1024, treeBytes = 64 * 1024 * 1024;
+	const fs::path jsonPath = getTemporaryDirectory() / "readerBenchmark.json";
+	const fs::path xmlPath = getTemporaryDirectory() / "readerBenchmark.xml";
+
+	writeSensorLog( jsonPath, streamBytes, true );
+	writeSensorLog( xmlPath, streamBytes, false );
+	{
+		Timer timer( true );
+		JsonReader reader( loadFile( jsonPath ) );
+		double sum = 0;
+		size_t count = 0;
+		for( ; reader.nextMatching( "samples.*.value" ); ++count )
+			sum += reader.getValue<double>();
+		logThroughput( "JsonReader", reader.getOffset(), timer.getSeconds(), count, sum );
+	}
+	{
+		Timer timer( true );
+		XmlReader reader( loadFile( xmlPath ) );
+		double sum = 0;
+		size_t count = 0;
+		for( ; reader.nextMatching( "log/samples/sample/value" ) && reader.next(); ++count )
+			sum += reader.getValue<double>();
+		logThroughput( "XmlReader", reader.getOffset(), timer.getSeconds(), count, sum );
+	}
+
+	writeSensorLog( jsonPath, treeBytes, true );
+	writeSensorLog( xmlPath, treeBytes, false );
+	{
+		Timer timer( true );
+		const JsonTree tree( loadFile( jsonPath ) );
+		double sum = 0;
+		const std::list<JsonTree> &samples = tree.getChild( "samples" ).getChildren();
+		for( std::list<JsonTree>::const_iterator sampleIt = samples.begin(); sampleIt != samples.end(); ++sampleIt )
+			sum += sampleIt->getChild( "value" ).getValue<double>();
+		logThroughput( "JsonTree", fs::file_size( jsonPath ), timer.getSeconds(), samples.size(), sum );
+	}
+	{
+		Timer timer( true );
+		const XmlTree tree( loadFile( xmlPath ) );
+		double sum = 0;
+		size_t count = 0;
+		for( XmlTree::ConstIter sampleIt = tree.begin( "log/samples/sample" ); sampleIt != tree.end(); ++sampleIt, ++count )
+			sum += sampleIt->getChild( "value" ).getValue<double>();
+		logThroughput( "XmlTree", fs::file_size( xmlPath ), timer.getSeconds(), count, sum );
+	}
+
+	fs::remove( jsonPath );
+	fs::remove( xmlPath );
+}
+
 
 CINDER_APP_BASIC( EarthquakeApp, RendererGl )
\ No newline at end of file
@@ -4,10 +4,15 @@
 #include "cinder/Utilities.h"
 #include "cinder/gl/gl.h"
 #include "cinder/ImageIo.h"
+#include "cinder/BatchMath.h"
+#include "cinder/FrustumCuller.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
 #include "InfoPanel.h"
 
 using namespace ci;
 using namespace ci::app;
+using namespace std;
 
 class FrustumCullingApp : public AppBasic {
  private:
@@ -31,6 +36,9 @@ class FrustumCullingApp : public AppBasic {
 	void calcFrustumPlane( Vec3f &fNormal, Vec3f &fPoint, float &fDist, const Vec3f &v1, const Vec3f &v2, const Vec3f &v3 );
 	void calcNearAndFarClipCoordinates( const Camera &cam );	
 	
+	void benchmarkBatchMath();
+	void benchmarkCulling();
+	
 	CameraPersp mCam;
 	CameraPersp mRenderCam;
 	
@@ -382,6 +390,10 @@ void FrustumCullingApp::keyDown( KeyEvent event )
 		mIsWatchingCam = ! mIsWatchingCam;
 	} else if( event.getChar() == '/' || event.getChar() == '?' ){
 		mInfoPanel.toggleState();
+	} else if( event.getChar() == 'b' ){
+		benchmarkBatchMath();
+	} else if( event.getChar() == 'k' ){
+		benchmarkCulling();
 	}
 	
 	
@@ -399,6 +411,157 @@ void FrustumCullingApp::keyDown( KeyEvent event )
 }
 
 
+// compares the cinder::batch kernels against the equivalent per-element loops at 1k, 100k and 1M elements
+void FrustumCullingApp::benchmarkBatchMath()
+{
+	const size_t sizes[] = { 1000, 100000, 1000000 };
+	const Matrix44f &mat = mCam.getModelViewMatrix();
+	Timer timer;
+	
+	console() << "batch math backend: " << batch::getBackendName() << endl;
+	for( int s = 0; s < 3; ++s ) {
+		const size_t count = sizes[s];
+		const int reps = (int)( 10000000 / count );
+		vector<Vec3f> points( count ), results( count ), maxs( count ), resultMaxs( count );
+		vector<Matrix44f> mats( count ), resultMats( count );
+		vector<float> dots( count );
+		for( size_t i = 0; i < count; ++i ) {
+			points[i] = Rand::randVec3f() * Rand::randFloat( 100.0f );
+			maxs[i] = points[i] + Vec3f( 5.0f, 5.0f, 5.0f );
+			mats[i] = Matrix44f::createRotation( Rand::randVec3f(), Rand::randFloat( 6.28f ) );
+		}
+		double loopTime, batchTime;
+		
+		timer.start();
+		for( int r = 0; r < reps; ++r )
+			for( size_t i = 0; i < count; ++i )
+				results[i] = mat.transformPoint( points[i] );
+		loopTime = timer.getSeconds();
+		timer.start();
+		for( int r = 0; r < reps; ++r )
+			batch::transformPoints( mat, &points[0], &results[0], count );
+		batchTime = timer.getSeconds();
+		console() << count << " transformPoints: " << loopTime * 1e9 / ( reps * count ) << " ns loop, " << batchTime * 1e9 / ( reps * count ) << " ns batch" << endl;
+		
+		timer.start();
+		for( int r = 0; r < reps; ++r )
+			for( size_t i = 0; i < count; ++i )
+				resultMats[i] = mat * mats[i];
+		loopTime = timer.getSeconds();
+		timer.start();
+		for( int r = 0; r < reps; ++r )
+			batch::multiply( mat, &mats[0], &resultMats[0], count );
+		batchTime = timer.getSeconds();
+		console() << count << " multiply: " << loopTime * 1e9 / ( reps * count ) << " ns loop, " << batchTime * 1e9 / ( reps * count ) << " ns batch" << endl;
+		
+		timer.start();
+		for( int r = 0; r < reps; ++r )
+			for( size_t i = 0; i < count; ++i )
+				results[i] = points[i].safeNormalized();
+		loopTime = timer.getSeconds();
+		timer.start();
+		for( int r = 0; r < reps; ++r )
+			batch::normalize( &points[0], &results[0], count );
+		batchTime = timer.getSeconds();
+		console() << count << " normalize: " << loopTime * 1e9 / ( reps * count ) << " ns loop, " << batchTime * 1e9 / ( reps * count ) << " ns batch" << endl;
+		
+		timer.start();
+		for( int r = 0; r < reps; ++r )
+			for( size_t i = 0; i < count; ++i )
+				dots[i] = points[i].dot( maxs[i] );
+		loopTime = timer.getSeconds();
+		timer.start();
+		for( int r = 0; r < reps; ++r )
+			batch::dot( &points[0], &maxs[0], &dots[0], count );
+		batchTime = timer.getSeconds();
+		console() << count << " dot: " << loopTime * 1e9 / ( reps * count ) << " ns loop, " << batchTime * 1e9 / ( reps * count ) << " ns batch" << endl;
+		
+		timer.start();
+		for( int r = 0; r < reps; ++r ) {
+			for( size_t i = 0; i < count; ++i ) {
+				AxisAlignedBox3f box = AxisAlignedBox3f( points[i], maxs[i] ).transformed( mat );
+				results[i] = box.getMin();
+				resultMaxs[i] = box.getMax();
+			}
+		}
+		loopTime = timer.getSeconds();
+		timer.start();
+		for( int r = 0; r < reps; ++r )
+			batch::transformBoxes( mat, &points[0], &maxs[0], &results[0], &resultMaxs[0], count );
+		batchTime = timer.getSeconds();
+		console() << count << " transformBoxes: " << loopTime * 1e9 / ( reps * count ) << " ns loop, " << batchTime * 1e9 / ( reps * count ) << " ns batch" << endl;
+	}
+}
+
+
+// culls 1M spheres and boxes scattered around the camera, per object with Frustumf and in bulk with FrustumCuller
+void FrustumCullingApp::benchmarkCulling()
+{
+	const size_t count = 1000000;
+	const int reps = 10;
+	vector<float> x( count ), y( count ), z( count ), radius( count );
+	vector<float> minX( count ), minY( count ), minZ( count ), maxX( count ), maxY( count ), maxZ( count );
+	for( size_t i = 0; i < count; ++i ) {
+		Vec3f center = mCam.getEyePoint() + Rand::randVec3f() * Rand::randFloat( 400.0f );
+		x[i] = center.x;
+		y[i] = center.y;
+		z[i] = center.z;
+		radius[i] = Rand::randFloat( 0.5f, 5.0f );
+		minX[i] = x[i] - radius[i];
+		minY[i] = y[i] - radius[i];
+		minZ[i] = z[i] - radius[i];
+		maxX[i] = x[i] + radius[i];
+		maxY[i] = y[i] + radius[i];
+		maxZ[i] = z[i] + radius[i];
+	}
+	
+	Frustumf frustum( mCam );
+	FrustumCuller culler( frustum );
+	vector<uint32_t> visible( FrustumCuller::getMaskSize( count ) );
+	vector<uint8_t> lastPlane( count, 0 );
+	size_t numVisible = 0;
+	Timer timer;
+	
+	console() << "culling " << count << " objects, backend: " << batch::getBackendName() << endl;
+	timer.start();
+	for( int r = 0; r < reps; ++r ) {
+		numVisible = 0;
+		for( size_t i = 0; i < count; ++i )
+			numVisible += frustum.intersects( Vec3f( x[i], y[i], z[i] ), radius[i] ) ? 1 : 0;
+	}
+	console() << "spheres, Frustumf loop: " << timer.getSeconds() * 1000 / reps << " ms, " << numVisible << " visible" << endl;
+	timer.start();
+	for( int r = 0; r < reps; ++r ) {
+		numVisible = 0;
+		for( size_t i = 0; i < count; ++i )
+			numVisible += frustum.intersects( AxisAlignedBox3f( Vec3f( minX[i], minY[i], minZ[i] ), Vec3f( maxX[i], maxY[i], maxZ[i] ) ) ) ? 1 : 0;
+	}
+	console() << "boxes, Frustumf loop: " << timer.getSeconds() * 1000 / reps << " ms, " << numVisible << " visible" << endl;
+	
+	// the coherent runs are preceded by one untimed pass, as a previous frame would have been
+	const char *modes[] = { "serial", "parallel", "serial coherent", "parallel coherent" };
+	for( int mode = 0; mode < 4; ++mode ) {
+		bool parallel = ( mode % 2 ) == 1;
+		uint8_t *planes = ( mode >= 2 ) ? &lastPlane[0] : 0;
+		culler.cullSpheres( &x[0], &y[0], &z[0], &radius[0], count, &visible[0], planes, parallel );
+		timer.start();
+		for( int r = 0; r < reps; ++r )
+			culler.cullSpheres( &x[0], &y[0], &z[0], &radius[0], count, &visible[0], planes, parallel );
+		console() << "spheres, FrustumCuller " << modes[mode] << ": " << timer.getSeconds() * 1000 / reps << " ms, " << FrustumCuller::countVisible( &visible[0], count ) << " visible" << endl;
+	}
+	std::fill( lastPlane.begin(), lastPlane.end(), 0 );
+	for( int mode = 0; mode < 4; ++mode ) {
+		bool parallel = ( mode % 2 ) == 1;
+		uint8_t *planes = ( mode >= 2 ) ? &lastPlane[0] : 0;
+		culler.cullBoxes( &minX[0], &minY[0], &minZ[0], &maxX[0], &maxY[0], &maxZ[0], count, &visible[0], planes, parallel );
+		timer.start();
+		for( int r = 0; r < reps; ++r )
+			culler.cullBoxes( &minX[0], &minY[0], &minZ[0], &maxX[0], &maxY[0], &maxZ[0], count, &visible[0], planes, parallel );
+		console() << "boxes, FrustumCuller " << modes[mode] << ": " << timer.getSeconds() * 1000 / reps << " ms, " << FrustumCuller::countVisible( &visible[0], count ) << " visible" << endl;
+	}
+}
+
+
 
 
 CINDER_APP_BASIC( FrustumCullingApp, RendererGl )
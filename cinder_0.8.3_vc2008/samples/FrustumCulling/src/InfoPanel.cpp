@@ -27,6 +27,8 @@ void InfoPanel::createTexture()
 	layout.addLine( "2	test cubes" );
 	layout.addLine( "3	test points" );
 	layout.addLine( "c	switches between cameras" );
+	layout.addLine( "b	benchmark batch math (console)" );
+	layout.addLine( "k	benchmark culling 1M objects (console)" );
 	layout.addLine( "f	toggle fullscreen" );
 	layout.addLine( "?	toggle information panel" );
 	
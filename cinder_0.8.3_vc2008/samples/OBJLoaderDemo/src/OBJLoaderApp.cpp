@@ -1,6 +1,9 @@
 #include "Resources.h"
 
 #include "cinder/ObjLoader.h"
+#include "cinder/TriMeshOptimizer.h"
+#include "cinder/TriMeshLod.h"
+#include "cinder/Timer.h"
 #include "cinder/app/AppBasic.h"
 #include "cinder/Arcball.h"
 #include "cinder/MayaCamUI.h"
@@ -28,7 +31,9 @@ class ObjLoaderApp : public AppBasic {
 	void mouseDrag( MouseEvent event );
 	void keyDown( KeyEvent event );
 
+	void	loadObj( DataSourceRef dataSource, boost::tribool loadNormals = boost::logic::indeterminate );
 	void	frameCurrentObject();
+	void	benchmarkLod();
 	void	draw();
 	
 	Arcball			mArcball;
@@ -41,9 +46,7 @@ class ObjLoaderApp : public AppBasic {
 
 void ObjLoaderApp::setup()
 {
-	ObjLoader loader( (DataSourceRef)loadResource( RES_CUBE_OBJ ) );
-	loader.load( &mMesh );
-	mVBO = gl::VboMesh( mMesh );
+	loadObj( loadResource( RES_CUBE_OBJ ) );
 	
 	mTexture = gl::Texture( loadImage( loadResource( RES_IMAGE ) ) );
 	mShader = gl::GlslProg( loadResource( RES_SHADER_VERT ), loadResource( RES_SHADER_FRAG ) );
@@ -57,6 +60,25 @@ void ObjLoaderApp::setup()
 	mShader.uniform( "tex0", 0 );
 }
 
+static void logMeshStats( const char *label, const TriMesh &mesh )
+{
+	VertexCacheStats stats = calcVertexCacheStats( mesh );
+	console() << label << ": " << mesh.getNumVertices() << " vertices, " << mesh.getNumIndices() << " indices, "
+		<< mesh.getNumTriangles() << " triangles, ACMR: " << stats.mAcmr << " ATVR: " << stats.mAtvr << std::endl;
+}
+
+// Loads an OBJ into mMesh, logging its statistics both as read from the file and after ObjLoader's vertex welding and reordering
+void ObjLoaderApp::loadObj( DataSourceRef dataSource, boost::tribool loadNormals )
+{
+	ObjLoader loader( dataSource );
+	TriMesh unoptimized;
+	loader.load( &unoptimized, loadNormals, boost::logic::indeterminate, false );
+	logMeshStats( "before optimizing", unoptimized );
+	loader.load( &mMesh, loadNormals );
+	logMeshStats( "after optimizing", mMesh );
+	mVBO = gl::VboMesh( mMesh );
+}
+
 void ObjLoaderApp::resize( ResizeEvent event )
 {
 	App::resize( event );
@@ -88,15 +110,27 @@ void ObjLoaderApp::frameCurrentObject()
 	mMayaCam.setCurrentCam( mMayaCam.getCamera().getFrameSphere( boundingSphere, 100 ) );
 }
 
+// Builds a TriMeshLodChain of the current mesh and reports each level's size and error
+void ObjLoaderApp::benchmarkLod()
+{
+	Timer timer( true );
+	TriMeshLodChain chain( mMesh, 8 );
+	timer.stop();
+
+	float radius = Sphere::calculateBoundingSphere( mMesh.getVertices() ).getRadius();
+	console() << "LOD chain: " << chain.getNumLevels() << " levels in " << timer.getSeconds() * 1000 << " ms, bounding radius " << radius << std::endl;
+	for( size_t level = 0; level < chain.getNumLevels(); ++level ) {
+		console() << "  level " << level << ": " << chain.getLevelNumTriangles( level ) << " triangles, error " << chain.getLevelError( level )
+			<< " (" << chain.getLevelError( level ) / radius * 100 << "% of radius)" << std::endl;
+	}
+}
+
 void ObjLoaderApp::keyDown( KeyEvent event )
 {
 	if( event.getChar() == 'o' ) {
 		fs::path path = getOpenFilePath();
 		if( ! path.empty() ) {
-			ObjLoader loader( (DataSourceRef)loadFile( path ) );
-			loader.load( &mMesh, true );
-			mVBO = gl::VboMesh( mMesh );
-			console() << "Total verts: " << mMesh.getVertices().size() << std::endl;
+			loadObj( loadFile( path ), true );
 		}
 	}
 	else if( event.getChar() == 's' ) {
@@ -119,6 +153,9 @@ void ObjLoaderApp::keyDown( KeyEvent event )
 	else if( event.getChar() == 'd' ) {
 		gDebug = ! gDebug;
 	}
+	else if( event.getChar() == 'l' ) {
+		benchmarkLod();
+	}
 }
 
 void ObjLoaderApp::draw()
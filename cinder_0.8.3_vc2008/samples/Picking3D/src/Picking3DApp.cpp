@@ -21,6 +21,8 @@
 #include "cinder/MayaCamUI.h"
 #include "cinder/Rand.h"
 #include "cinder/TriMesh.h"
+#include "cinder/TriMeshBvh.h"
+#include "cinder/Timer.h"
 #include "Resources.h"
 
 #include <vector>
@@ -84,7 +86,9 @@ class Picking3DApp : public AppBasic
 	void drawGrid(float size=100.0f, float step=10.0f);
 		
 	bool performPicking( Vec3f *pickedPoint, Vec3f *pickedNormal );
+	void benchmarkPicking();
 		
+	void keyDown( KeyEvent event );
 	void mouseMove( MouseEvent event );
 	void mouseDown( MouseEvent event );
 	void mouseDrag( MouseEvent event );
@@ -97,6 +101,8 @@ class Picking3DApp : public AppBasic
 
 	// the model of a rubber ducky
 	TriMesh		mMesh;
+	// bounding volume hierarchy of the model, for fast picking
+	TriMeshBvh	mBvh;
 
 	// transformations (translate, rotate, scale) of the model
 	Matrix44f	mTransform;
@@ -139,6 +145,10 @@ void Picking3DApp::setup()
 	//  TriMesh::write() method. Reading binary files is much quicker.)
 	mMesh.read( loadResource( RES_DUCKY_MESH ) );
 
+	// build a bounding volume hierarchy over the mesh's triangles
+	//  (note: it is built in object space, so it stays valid while the model moves)
+	mBvh.build( mMesh );
+
 	// set up the camera
 	CameraPersp cam;
 	cam.setEyePoint( Vec3f(5.0f, 10.0f, 10.0f) );
@@ -270,46 +280,129 @@ bool Picking3DApp::performPicking( Vec3f *pickedPoint, Vec3f *pickedNormal )
 	gl::color( Color(0, 1, 1) );
 	gl::drawStrokedCube(worldBounds);
 
-	// set initial distance to something far, far away
-	float result = 1.0e6f;
-
 	// fast detection first - test against the bounding box itself
 	if( ! worldBounds.intersects(ray) )
 		return false;
 
-	// traverse triangle list and find the picked triangle
-	size_t polycount = mMesh.getNumTriangles();
-	float distance = 0.0f;
-	for(size_t i=0;i<polycount;++i)
-	{
-		Vec3f v0, v1, v2;
-		// get a single triangle from the mesh
-		mMesh.getTriangleVertices(i, &v0, &v1, &v2);
-
-		// transform triangle to world space
-		v0 = mTransform.transformPointAffine(v0);
-		v1 = mTransform.transformPointAffine(v1);
-		v2 = mTransform.transformPointAffine(v2);
-
-		// test to see if the ray intersects with this triangle
-		if( ray.calcTriangleIntersection(v0, v1, v2, &distance) ) {
-			// set our result to this if its closer than any intersection we've had so far
-			if( distance < result ) {
-				result = distance;
-				// assuming this is the closest triangle, we'll set our normal
-				// while we've got all the points handy
-				*pickedNormal = ( v1 - v0 ).cross( v2 - v0 ).normalized();
-			}
-		}
+	// transform the ray into object space, where the hierarchy was built. Under an affine
+	// transform the distance along the ray stays the same, so it can be used in world space.
+	Matrix44f inverse = mTransform.affineInverted();
+	Ray objectRay( inverse.transformPointAffine( ray.getOrigin() ), inverse.transformVec( ray.getDirection() ) );
+
+	// find the closest triangle hit by the ray
+	TriMeshBvh::Hit hit;
+	if( ! mBvh.intersect( objectRay, &hit ) )
+		return false;
+
+	// transform the triangle to world space to calculate its normal
+	Vec3f v0, v1, v2;
+	mMesh.getTriangleVertices( hit.mTriangle, &v0, &v1, &v2 );
+	v0 = mTransform.transformPointAffine(v0);
+	v1 = mTransform.transformPointAffine(v1);
+	v2 = mTransform.transformPointAffine(v2);
+	*pickedNormal = ( v1 - v0 ).cross( v2 - v0 ).normalized();
+	*pickedPoint = ray.calcPosition( hit.mDistance );
+	return true;
+}
+
+// measures building the hierarchy and casting rays against it, compared to testing every triangle,
+// on a grid of ducks totalling at least 500,000 triangles
+void Picking3DApp::benchmarkPicking()
+{
+	const size_t minTriangles = 500000;
+	AxisAlignedBox3f bounds = mMesh.calcBoundingBox();
+	Vec3f spacing = bounds.getSize() * 1.2f;
+	int copies = (int)( ( minTriangles + mMesh.getNumTriangles() - 1 ) / mMesh.getNumTriangles() );
+	int side = (int)math<float>::ceil( math<float>::sqrt( (float)copies ) );
+
+	TriMesh scene;
+	for( int c = 0; c < copies; ++c ) {
+		Vec3f offset( ( c % side - side / 2 ) * spacing.x, 0.0f, ( c / side - side / 2 ) * spacing.z );
+		uint32_t base = (uint32_t)scene.getNumVertices();
+		for( size_t v = 0; v < mMesh.getNumVertices(); ++v )
+			scene.appendVertex( mMesh.getVertices()[v] + offset );
+		for( size_t i = 0; i < mMesh.getNumIndices(); i += 3 )
+			scene.appendTriangle( base + mMesh.getIndices()[i], base + mMesh.getIndices()[i + 1], base + mMesh.getIndices()[i + 2] );
 	}
+	console() << "picking benchmark: " << copies << " ducks, " << scene.getNumTriangles() << " triangles" << endl;
 
-	// did we have a hit?
-	if( distance > 0 ) {
-		*pickedPoint = ray.calcPosition( result );
-		return true;
+	Timer timer;
+	timer.start();
+	TriMeshBvh bvh( scene );
+	console() << "build: " << timer.getSeconds() * 1000 << " ms, " << bvh.getNumNodes() << " nodes" << endl;
+	timer.start();
+	bvh.refit( scene );
+	console() << "refit: " << timer.getSeconds() * 1000 << " ms" << endl;
+
+	// one ray per pixel of a 640x480 view looking down at the grid
+	CameraPersp cam;
+	cam.setPerspective( 60.0f, 640.0f / 480.0f, 1.0f, 1000.0f );
+	cam.lookAt( Vec3f( 0.0f, side * spacing.x * 0.5f, side * spacing.z * 0.6f ), Vec3f::zero() );
+	vector<Ray> rays;
+	rays.reserve( 640 * 480 );
+	for( int y = 0; y < 480; ++y )
+		for( int x = 0; x < 640; ++x )
+			rays.push_back( cam.generateRay( ( x + 0.5f ) / 640.0f, ( y + 0.5f ) / 480.0f, cam.getAspectRatio() ) );
+	vector<TriMeshBvh::Hit> hits( rays.size() );
+
+	size_t numHits = 0;
+	timer.start();
+	for( size_t r = 0; r < rays.size(); ++r )
+		numHits += bvh.intersect( rays[r], &hits[r] ) ? 1 : 0;
+	double seconds = timer.getSeconds();
+	console() << "closest hit: " << rays.size() / seconds / 1e6 << " Mrays/s, " << numHits << " hits" << endl;
+
+	timer.start();
+	for( size_t r = 0; r < rays.size(); ++r )
+		bvh.intersectAny( rays[r] );
+	seconds = timer.getSeconds();
+	console() << "any hit: " << rays.size() / seconds / 1e6 << " Mrays/s" << endl;
+
+	timer.start();
+	bvh.intersect( &rays[0], rays.size(), &hits[0] );
+	seconds = timer.getSeconds();
+	console() << "batched closest hit: " << rays.size() / seconds / 1e6 << " Mrays/s" << endl;
+
+	// testing every triangle is far slower, so only a sample of the rays is cast
+	const size_t numLinearRays = 20;
+	timer.start();
+	for( size_t r = 0; r < numLinearRays; ++r ) {
+		const Ray &ray = rays[r * rays.size() / numLinearRays];
+		float closest = FLT_MAX, distance;
+		for( size_t t = 0; t < scene.getNumTriangles(); ++t ) {
+			Vec3f v0, v1, v2;
+			scene.getTriangleVertices( t, &v0, &v1, &v2 );
+			if( ray.calcTriangleIntersection( v0, v1, v2, &distance ) && distance > 0 && distance < closest )
+				closest = distance;
+		}
 	}
-	else
-		return false;
+	seconds = timer.getSeconds();
+	console() << "linear scan: " << numLinearRays / seconds << " rays/s" << endl;
+
+	// vertical rays dropped through vertices lie exactly on the bounds of the nodes around them, and have zero x and z direction
+	size_t numMismatches = 0;
+	for( size_t r = 0; r < numLinearRays; ++r ) {
+		Vec3f vertex = scene.getVertices()[r * scene.getNumVertices() / numLinearRays];
+		Ray ray( Vec3f( vertex.x, bounds.getMax().y + 1.0f, vertex.z ), Vec3f( 0.0f, -1.0f, 0.0f ) );
+		float closest = FLT_MAX, distance;
+		for( size_t t = 0; t < scene.getNumTriangles(); ++t ) {
+			Vec3f v0, v1, v2;
+			scene.getTriangleVertices( t, &v0, &v1, &v2 );
+			if( ray.calcTriangleIntersection( v0, v1, v2, &distance ) && distance > 0 && distance < closest )
+				closest = distance;
+		}
+		TriMeshBvh::Hit hit;
+		bool isHit = bvh.intersect( ray, &hit );
+		if( isHit != ( closest < FLT_MAX ) || ( isHit && hit.mDistance != closest ) || bvh.intersectAny( ray ) != isHit )
+			++numMismatches;
+	}
+	console() << "axis-aligned rays through vertices: " << numMismatches << " of " << numLinearRays << " differ from the linear scan" << endl;
+}
+
+void Picking3DApp::keyDown( KeyEvent event )
+{
+	if( event.getChar() == 'b' )
+		benchmarkPicking();
 }
 
 void Picking3DApp::mouseMove( MouseEvent event )
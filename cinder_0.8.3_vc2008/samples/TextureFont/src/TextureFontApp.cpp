@@ -5,6 +5,7 @@
 #include "cinder/Rand.h"
 #include "cinder/gl/TextureFont.h"
 #include "cinder/Utilities.h"
+#include "cinder/Timer.h"
 
 using namespace ci;
 using namespace ci::app;
@@ -17,9 +18,12 @@ class TextureFontApp : public AppNative {
 	void mouseDown( MouseEvent event );
 	void keyDown( KeyEvent event );
 	void draw();
+	void benchmarkLayouts();
+	void benchmarkAtlas();
 
-	Font				mFont;
-	gl::TextureFontRef	mTextureFont;
+	Font						mFont;
+	gl::TextureFontRef			mTextureFont;
+	gl::TextureFont::Layout		mTextLayout;
 };
 
 void TextureFontApp::setup()
@@ -46,7 +50,83 @@ void TextureFontApp::keyDown( KeyEvent event )
 			mFont = Font( mFont.getName(), mFont.getSize() - 1 );
 			mTextureFont = gl::TextureFont::create( mFont );
 		break;
+		case 'b':
+			benchmarkLayouts();
+		break;
+		case 'a':
+			benchmarkAtlas();
+		break;
+	}
+}
+
+// Times the CPU side of laying out many short labels: from scratch, after moving them, and when unchanged
+void TextureFontApp::benchmarkLayouts()
+{
+	const size_t numLabels = 500;
+	vector<gl::TextureFont::Layout> layouts( numLabels );
+	Timer timer( true );
+	for( size_t i = 0; i < numLabels; ++i ) {
+		layouts[i].text( "Platform " + toString( i ) + " - Departing 12:" + toString( i % 60 ) ).baseline( Vec2f( 10, 20.0f * i ) );
+		mTextureFont->update( &layouts[i] );
 	}
+	double fullSeconds = timer.getSeconds();
+
+	timer.start();
+	for( size_t i = 0; i < numLabels; ++i ) {
+		layouts[i].baseline( Vec2f( 20, 20.0f * i ) );
+		mTextureFont->update( &layouts[i] );
+	}
+	double moveSeconds = timer.getSeconds();
+
+	timer.start();
+	for( size_t i = 0; i < numLabels; ++i )
+		mTextureFont->update( &layouts[i] );
+	double cachedSeconds = timer.getSeconds();
+
+	timer.start();
+	gl::TextureFont::Batch batch;
+	for( size_t i = 0; i < numLabels; ++i )
+		batch.append( layouts[i] );
+	double batchSeconds = timer.getSeconds();
+
+	console() << numLabels << " labels: layout " << fullSeconds * 1000 << "ms, move " << moveSeconds * 1000 << "ms, unchanged " << cachedSeconds * 1000
+		<< "ms, batch of " << batch.getNumQuads() << " quads " << batchSeconds * 1000 << "ms" << std::endl;
+}
+
+// Compares rasterizing a 6,000 glyph CJK TextureFont against loading its saved atlas
+void TextureFontApp::benchmarkAtlas()
+{
+#if defined( CINDER_COCOA )
+	Font font( "HiraKakuProN-W3", 24 );
+#else
+	Font font( "SimSun", 24 );
+#endif
+	// the first 6,000 CJK Unified Ideographs, U+4E00 onwards, as UTF-8
+	string chars;
+	for( uint32_t codePoint = 0x4E00; codePoint < 0x4E00 + 6000; ++codePoint ) {
+		chars += (char)( 0xE0 | ( codePoint >> 12 ) );
+		chars += (char)( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) );
+		chars += (char)( 0x80 | ( codePoint & 0x3F ) );
+	}
+
+	fs::path atlasPath = getTemporaryDirectory() / "TextureFontBenchmark.atlas";
+	if( fs::exists( atlasPath ) )
+		fs::remove( atlasPath );
+
+	Timer timer( true );
+	gl::TextureFontRef rasterized = gl::TextureFont::create( font, gl::TextureFont::Format(), chars );
+	double rasterizeSeconds = timer.getSeconds();
+
+	timer.start();
+	gl::TextureFont::create( font, atlasPath, gl::TextureFont::Format(), chars );
+	double rasterizeAndSaveSeconds = timer.getSeconds();
+
+	timer.start();
+	gl::TextureFontRef loaded = gl::TextureFont::create( font, loadFile( atlasPath ), gl::TextureFont::Format(), chars );
+	double loadSeconds = timer.getSeconds();
+
+	console() << "6000 glyphs: rasterize " << rasterizeSeconds * 1000 << "ms, rasterize and save " << rasterizeAndSaveSeconds * 1000
+		<< "ms, load atlas (" << fs::file_size( atlasPath ) / 1024 << "kB) " << loadSeconds * 1000 << "ms" << std::endl;
 }
 
 void TextureFontApp::mouseDown( MouseEvent event )
@@ -67,11 +147,13 @@ void TextureFontApp::draw()
 
 	gl::color( ColorA( 1, 0.5f, 0.25f, 1.0f ) );
 
+	// the layout is only recomputed when the font or window size changes
 #if defined( CINDER_COCOA )
-	mTextureFont->drawStringWrapped( str, boundsRect );
+	mTextLayout.text( str ).fit( boundsRect, Vec2f::zero(), true );
 #else
-	mTextureFont->drawString( str, boundsRect );
+	mTextLayout.text( str ).fit( boundsRect );
 #endif	
+	mTextureFont->drawLayout( &mTextLayout );
 
 	// Draw FPS
 	gl::color( Color::white() );
@@ -2,8 +2,12 @@
 #include "cinder/Font.h"
 #include "cinder/TriMesh.h"
 #include "cinder/Triangulate.h"
+#include "cinder/DynamicDelaunay.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
 #include "cinder/gl/Vbo.h"
 #include "cinder/params/Params.h"
+#include "../../../src/cinder/delaunay/triangle/del_interface.hpp"
 
 using namespace ci;
 using namespace ci::app;
@@ -17,12 +21,15 @@ class TriangulationApp : public AppBasic {
 	void		keyDown( KeyEvent event ) { setRandomGlyph(); }
 
 	void		recalcMesh();
+	void		benchmark();
+	void		benchmarkDelaunay();
 	
 	void		setRandomFont();
 	void		setRandomGlyph();
 	
 	Font				mFont;
 	Shape2d				mShape;
+	Triangulator		mTriangulator;
 	vector<string>		mFontNames;
 	gl::VboMesh			mVboMesh;
 	params::InterfaceGl	mParams;
@@ -41,6 +48,8 @@ void TriangulationApp::setup()
 	mParams.addParam( "Draw Wireframe", &mDrawWireframe, "min=1 max=2000 keyIncr== keyDecr=-" );
 	mParams.addButton( "Random Font", bind( &TriangulationApp::setRandomFont, this ), "key=f" );
 	mParams.addButton( "Random Glyph", bind( &TriangulationApp::setRandomGlyph, this ) );
+	mParams.addButton( "Benchmark", bind( &TriangulationApp::benchmark, this ) );
+	mParams.addButton( "Delaunay Benchmark", bind( &TriangulationApp::benchmarkDelaunay, this ) );
 	mZoom = 1.0f;
 	mParams.addParam( "Zoom", &mZoom, "min=0.01 max=20 keyIncr=z keyDecr=Z" );
 	mOldPrecision = mPrecision = 1.0f;
@@ -60,12 +69,102 @@ void TriangulationApp::setup()
 
 void TriangulationApp::recalcMesh()
 {
-	TriMesh2d mesh = Triangulator( mShape, mPrecision ).calcMesh( Triangulator::WINDING_ODD );
+	mTriangulator.addShape( mShape, mPrecision );
+	TriMesh2d mesh = mTriangulator.calcMesh( Triangulator::WINDING_ODD );
 	mNumPoints = mesh.getNumIndices();
 	mVboMesh = gl::VboMesh( mesh ); 
 	mOldPrecision = mPrecision;
 }
 
+// Re-triangulates the first 256 glyphs of the current font as if every frame, logging the per-frame cost of
+// a new Triangulator per glyph, one reused Triangulator, and Triangulator::calcMeshBatch()
+void TriangulationApp::benchmark()
+{
+	vector<Shape2d> shapes;
+	for( size_t g = 0; g < std::min<size_t>( mFont.getNumGlyphs(), 256 ); ++g ) {
+		try {
+			shapes.push_back( mFont.getGlyphShape( (Font::Glyph)g ) );
+		}
+		catch( FontGlyphFailureExc & ) {
+		}
+	}
+
+	const int numFrames = 10;
+	Timer timer;
+	double freshSeconds = 0, reusedSeconds = 0, batchSeconds = 0;
+	size_t numTriangles = 0;
+	for( int frame = 0; frame < numFrames; ++frame ) {
+		timer.start();
+		for( size_t s = 0; s < shapes.size(); ++s )
+			Triangulator( shapes[s], mPrecision ).calcMesh();
+		freshSeconds += timer.getSeconds();
+
+		timer.start();
+		for( size_t s = 0; s < shapes.size(); ++s ) {
+			mTriangulator.addShape( shapes[s], mPrecision );
+			mTriangulator.calcMesh();
+		}
+		reusedSeconds += timer.getSeconds();
+
+		timer.start();
+		numTriangles = Triangulator::calcMeshBatch( shapes, mPrecision ).getNumTriangles();
+		batchSeconds += timer.getSeconds();
+	}
+
+	console() << shapes.size() << " glyphs, " << numTriangles << " triangles per frame: new Triangulator " << freshSeconds / numFrames * 1000
+		<< "ms, reused Triangulator " << reusedSeconds / numFrames * 1000 << "ms, calcMeshBatch " << batchSeconds / numFrames * 1000 << "ms" << std::endl;
+}
+
+// Jitters 1k, 10k and 100k points as if every frame, logging the per-frame cost of a full tpp::Delaunay rebuild,
+// a full DynamicDelaunay::build() and updating a persistent DynamicDelaunay with move()
+void TriangulationApp::benchmarkDelaunay()
+{
+	const int numFrames = 10;
+	Rand rnd( 1234 );
+	for( size_t numPoints = 1000; numPoints <= 100000; numPoints *= 10 ) {
+		const Rectf bounds( 0, 0, 1000, 1000 );
+		const float jitter = 0.2f * bounds.getWidth() / math<float>::sqrt( (float)numPoints );
+		vector<Vec2f> points( numPoints );
+		for( size_t p = 0; p < numPoints; ++p )
+			points[p] = Vec2f( rnd.nextFloat( bounds.x1, bounds.x2 ), rnd.nextFloat( bounds.y1, bounds.y2 ) );
+
+		DynamicDelaunay dynamic( bounds );
+		dynamic.build( points );
+
+		Timer timer;
+		double rebuildSeconds = 0, buildSeconds = 0, moveSeconds = 0;
+		vector<tpp::Delaunay::Point> tppPoints( numPoints );
+		for( int frame = 0; frame < numFrames; ++frame ) {
+			for( size_t p = 0; p < numPoints; ++p ) {
+				points[p].x = constrain( points[p].x + rnd.nextFloat( -jitter, jitter ), bounds.x1, bounds.x2 );
+				points[p].y = constrain( points[p].y + rnd.nextFloat( -jitter, jitter ), bounds.y1, bounds.y2 );
+			}
+
+			timer.start();
+			for( size_t p = 0; p < numPoints; ++p ) {
+				tppPoints[p][0] = points[p].x;
+				tppPoints[p][1] = points[p].y;
+			}
+			tpp::Delaunay tppDelaunay( tppPoints );
+			tppDelaunay.Triangulate();
+			rebuildSeconds += timer.getSeconds();
+
+			timer.start();
+			DynamicDelaunay rebuilt( bounds );
+			rebuilt.build( points );
+			buildSeconds += timer.getSeconds();
+
+			timer.start();
+			for( size_t p = 0; p < numPoints; ++p )
+				dynamic.move( (uint32_t)p, points[p] );
+			moveSeconds += timer.getSeconds();
+		}
+
+		console() << numPoints << " moving points, " << dynamic.getNumTriangles() << " triangles per frame: tpp rebuild " << rebuildSeconds / numFrames * 1000
+			<< "ms, DynamicDelaunay::build " << buildSeconds / numFrames * 1000 << "ms, DynamicDelaunay::move " << moveSeconds / numFrames * 1000 << "ms" << std::endl;
+	}
+}
+
 void TriangulationApp::setRandomFont()
 {
 	// select a random font from those available on the system
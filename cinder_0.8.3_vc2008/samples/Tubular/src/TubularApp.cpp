@@ -61,6 +61,9 @@ http://http://forum.libcinder.org
 #include "cinder/TriMesh.h"
 #include "cinder/Utilities.h"
 #include "cinder/params/Params.h"
+#include "cinder/BSplineFit.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
 
 #include "Tube.h"
 
@@ -78,6 +81,8 @@ class TubularApp : public AppBasic {
 	void resize( ResizeEvent event );
 	void update();
 	void draw();
+
+	void benchmark();
 	
   private:
 	Tube					mTube;
@@ -167,6 +172,43 @@ void TubularApp::keyDown( KeyEvent event )
 		case ' ':
 			mPause = ! mPause;
 		break;
+		case 'b':
+			benchmark();
+		break;
+	}
+}
+
+// Logs the cost of sampling the current spline densely one parameter at a time and with BSpline::getPositions(),
+// and of fitting a spline to a large noisy point cloud
+void TubularApp::benchmark()
+{
+	const size_t numSamples = 100000;
+	vector<float> params( numSamples );
+	vector<Vec3f> positions( numSamples ), derivatives( numSamples );
+	for( size_t i = 0; i < numSamples; ++i )
+		params[i] = i / (float)( numSamples - 1 );
+
+	Timer timer;
+	timer.start();
+	for( size_t i = 0; i < numSamples; ++i ) {
+		positions[i] = mBSpline.getPosition( params[i] );
+		derivatives[i] = mBSpline.getDerivative( params[i] );
+	}
+	double singleSeconds = timer.getSeconds();
+
+	timer.start();
+	mBSpline.getPositions( &params[0], numSamples, &positions[0], &derivatives[0] );
+	double batchSeconds = timer.getSeconds();
+
+	console() << numSamples << " samples with derivatives: getPosition/getDerivative " << singleSeconds * 1000 << "ms, getPositions " << batchSeconds * 1000 << "ms" << std::endl;
+
+	Rand rnd( 1234 );
+	for( size_t i = 0; i < numSamples; ++i )
+		positions[i] += rnd.nextVec3f() * 0.05f;
+	for( int numControlPoints = 100; numControlPoints <= 1000; numControlPoints *= 10 ) {
+		timer.start();
+		BSpline3f fitted = fitBSpline( positions, 3, numControlPoints );
+		console() << "fitBSpline " << numSamples << " samples to " << fitted.getNumControlPoints() << " control points: " << timer.getSeconds() * 1000 << "ms" << std::endl;
 	}
 }
 
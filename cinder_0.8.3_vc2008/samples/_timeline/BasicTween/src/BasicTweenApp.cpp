@@ -1,5 +1,6 @@
 #include "cinder/app/AppBasic.h"
 #include "cinder/Timeline.h"
+#include "cinder/Timer.h"
 
 using namespace std;
 using namespace ci;
@@ -9,8 +10,11 @@ class BasicTweenApp : public AppBasic {
   public:
 	void setup();
 	void mouseDown( MouseEvent event );
+	void keyDown( KeyEvent event );
 	void draw();
   
+	void benchmarkTimeline();
+  
 	Anim<Vec2f>		mBlackPos, mWhitePos;
 };
 
@@ -27,6 +31,48 @@ void BasicTweenApp::mouseDown( MouseEvent event )
 	timeline().apply( &mWhitePos, (Vec2f)event.getPos(), 0.35f, EaseOutQuint() ).appendTo( &mBlackPos );
 }
 
+void BasicTweenApp::keyDown( KeyEvent event )
+{
+	if( event.getChar() == 'b' )
+		benchmarkTimeline();
+}
+
+// compares the per-tween cost of stepping 100k tweens which use EaseFn, an inlined ease functor (TweenT) and pooled tweens
+void BasicTweenApp::benchmarkTimeline()
+{
+	const size_t COUNT = 100000;
+	const int STEPS = 100;
+	vector<Anim<float> > values( COUNT );
+	TimelineRef benchTimeline = Timeline::create();
+	Timer timer;
+
+	for( size_t i = 0; i < COUNT; ++i )
+		benchTimeline->apply( &values[i], 1.0f, 1000.0f, EaseFn( EaseInOutQuad() ) );
+	timer.start();
+	for( int s = 0; s < STEPS; ++s )
+		benchTimeline->step( 1 / 60.0f );
+	timer.stop();
+	console() << COUNT << " tweens: EaseFn " << timer.getSeconds() * 1e9 / ( STEPS * COUNT ) << " ns/tween";
+
+	benchTimeline->clear();
+	for( size_t i = 0; i < COUNT; ++i )
+		benchTimeline->apply( &values[i], 1.0f, 1000.0f, EaseInOutQuad() );
+	timer.start();
+	for( int s = 0; s < STEPS; ++s )
+		benchTimeline->step( 1 / 60.0f );
+	timer.stop();
+	console() << ", TweenT " << timer.getSeconds() * 1e9 / ( STEPS * COUNT ) << " ns/tween";
+
+	benchTimeline->clear();
+	for( size_t i = 0; i < COUNT; ++i )
+		benchTimeline->applyPooled( &values[i], 1.0f, 1000.0f, easeInOutQuad );
+	timer.start();
+	for( int s = 0; s < STEPS; ++s )
+		benchTimeline->step( 1 / 60.0f );
+	timer.stop();
+	console() << ", applyPooled() " << timer.getSeconds() * 1e9 / ( STEPS * COUNT ) << " ns/tween" << endl;
+}
+
 void BasicTweenApp::draw()
 {
 	gl::clear( Color( 0.5f, 0.5f, 0.5f ) );
@@ -1,5 +1,7 @@
 #include "cinder/app/AppBasic.h"
 #include "cinder/Path2d.h"
+#include "cinder/Path2dSampler.h"
+#include "cinder/Timer.h"
 #include "cinder/gl/gl.h"
 
 #include <vector>
@@ -10,16 +12,19 @@ using namespace std;
 
 class Path2dApp : public AppBasic {
  public:
-	Path2dApp() : mTrackedPoint( -1 ) {}
+	Path2dApp() : mTrackedPoint( -1 ) { mSampler.setPath( mPath ); }
 	
 	void mouseDown( MouseEvent event );
 	void mouseUp( MouseEvent event );
 	void mouseDrag( MouseEvent event );
 	void keyDown( KeyEvent event );
 	void draw();
+
+	void benchmark();
 	
-	Path2d	mPath;
-	int		mTrackedPoint;
+	Path2d			mPath;
+	Path2dSampler	mSampler;
+	int				mTrackedPoint;
 };
 
 void Path2dApp::mouseDown( MouseEvent event )
@@ -83,6 +88,51 @@ void Path2dApp::keyDown( KeyEvent event )
 {
 	if( event.getChar() == 'x' )
 		mPath.clear();
+	else if( event.getChar() == 'b' )
+		benchmark();
+}
+
+// Moves 10k sprites along the current path (or a wavy test path if none has been drawn) as if every frame, logging the per-frame cost
+// of Path2d::getPosition(), Path2dSampler::getPosition() and the batched Path2dSampler::getPositions() which also returns tangents
+void Path2dApp::benchmark()
+{
+	Path2d path = mPath;
+	if( path.getNumSegments() == 0 ) {
+		path.clear();
+		path.moveTo( 0, 0 );
+		for( int s = 0; s < 200; ++s )
+			path.curveTo( s * 10.0f + 3, 50, s * 10.0f + 7, -50, s * 10.0f + 10, 0 );
+	}
+
+	const size_t numSprites = 10000;
+	const int numFrames = 100;
+	vector<float> params( numSprites );
+	vector<Vec2f> positions( numSprites ), tangents( numSprites );
+	for( size_t i = 0; i < numSprites; ++i )
+		params[i] = i / (float)numSprites;
+
+	Path2dSampler sampler( path );
+	Timer timer;
+	double pathSeconds = 0, samplerSeconds = 0, batchSeconds = 0;
+	for( int frame = 0; frame < numFrames; ++frame ) {
+		timer.start();
+		for( size_t i = 0; i < numSprites; ++i )
+			positions[i] = path.getPosition( params[i] );
+		pathSeconds += timer.getSeconds();
+
+		timer.start();
+		for( size_t i = 0; i < numSprites; ++i )
+			positions[i] = sampler.getPosition( params[i] );
+		samplerSeconds += timer.getSeconds();
+
+		timer.start();
+		sampler.getPositions( &params[0], numSprites, &positions[0], &tangents[0] );
+		batchSeconds += timer.getSeconds();
+	}
+
+	console() << numSprites << " sprites on a path of " << path.getNumSegments() << " segments (" << sampler.getPoints().size() << " flattened points) per frame: Path2d::getPosition "
+		<< pathSeconds / numFrames * 1000 << "ms, Path2dSampler::getPosition " << samplerSeconds / numFrames * 1000 << "ms, Path2dSampler::getPositions with tangents "
+		<< batchSeconds / numFrames * 1000 << "ms" << std::endl;
 }
 
 void Path2dApp::draw()
@@ -97,6 +147,17 @@ void Path2dApp::draw()
 	// draw the curve itself
 	gl::color( Color( 1.0f, 0.5f, 0.25f ) );
 	gl::draw( mPath );
+
+	// draw sprites travelling along the curve at constant speed
+	float length = mSampler.getLength();
+	if( length > 0 ) {
+		const int numSprites = 32;
+		gl::color( Color( 0.25f, 1.0f, 0.5f ) );
+		for( int s = 0; s < numSprites; ++s ) {
+			float distance = math<float>::fmod( (float)getElapsedSeconds() * 100.0f + s * length / numSprites, length );
+			gl::drawSolidCircle( mSampler.getPositionAtLength( distance ), 3.0f );
+		}
+	}
 }
 
 
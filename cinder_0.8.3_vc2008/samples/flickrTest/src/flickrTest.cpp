@@ -2,6 +2,8 @@
 #include "cinder/app/AppBasic.h"
 #include "cinder/URL.h"
 #include "cinder/Xml.h"
+#include "cinder/XmlDoc.h"
+#include "cinder/Timer.h"
 #include "cinder/gl/gl.h"
 #include "cinder/gl/Texture.h"
 #include "cinder/ImageIo.h"
@@ -9,6 +11,7 @@
 
 #include <iostream>
 #include <map>
+#include <sstream>
 #include <string>
 
 using namespace ci;
@@ -22,6 +25,7 @@ class FlickrTestApp : public AppBasic {
 	void draw();
 	void keyDown( KeyEvent event );
 	void createTextureFromURL();
+	void benchmarkXmlDoc();
 
 	vector<gl::Texture>		mTexts;
 	vector<Url>				mUrls;
@@ -35,9 +39,10 @@ void FlickrTestApp::setup()
 {
 	glEnable( GL_TEXTURE_2D );
 
-	const XmlTree xml( loadUrl( Url( "http://api.flickr.com/services/feeds/groups_pool.gne?id=1423039@N24&lang=en-us&format=rss_200" ) ) );
-	for( XmlTree::ConstIter item = xml.begin( "rss/channel/item" ); item != xml.end(); ++item ) {
-		mUrls.push_back( item->getChild( "media:content" ).getAttributeValue<Url>( "url" ) );
+	const XmlDoc xml( loadUrl( Url( "http://api.flickr.com/services/feeds/groups_pool.gne?id=1423039@N24&lang=en-us&format=rss_200" ) ) );
+	const XmlDoc::Query itemQuery( xml, "rss/channel/item" ), contentQuery( xml, "media:content" );
+	for( XmlDoc::ConstIter item = xml.getRoot().begin( itemQuery ); item != xml.getRoot().end(); ++item ) {
+		mUrls.push_back( Url( item->getChild( contentQuery ).getAttributeValue<string>( "url" ) ) );
 	}
 
 	createTextureFromURL();
@@ -70,6 +75,9 @@ void FlickrTestApp::keyDown( KeyEvent event )
 	if( event.getCode() == KeyEvent::KEY_f ) {
 		setFullScreen( ! isFullScreen() );
 	}
+	else if( event.getCode() == KeyEvent::KEY_b ) {
+		benchmarkXmlDoc();
+	}
 }
 
 void FlickrTestApp::createTextureFromURL() 
@@ -80,5 +88,56 @@ void FlickrTestApp::createTextureFromURL()
 	mTexts.push_back( tex );
 }
 
+// Compares XmlTree and XmlDoc on an SVG-like document of ~100,000 nodes: load time, iterating a path, and repeated path lookups
+void FlickrTestApp::benchmarkXmlDoc()
+{
+	ostringstream svg;
+	svg << "<svg width=\"1000\" height=\"1000\">";
+	for( int group = 0; group < 2000; ++group ) {
+		svg << "<g id=\"g" << group << "\" transform=\"translate(" << group << ",0)\">";
+		for( int path = 0; path < 50; ++path )
+			svg << "<path d=\"M0 0 L" << path << " " << group << "\" fill=\"#ff0000\" stroke-width=\"" << path * 0.5f << "\"/>";
+		svg << "<text x=\"0\" y=\"0\">label " << group << "</text></g>";
+	}
+	svg << "</svg>";
+	const string svgString = svg.str();
+	const int numLookups = 20000;
+
+	Timer timer( true );
+	const XmlTree tree( svgString );
+	double treeLoad = timer.getSeconds();
+	timer.start();
+	float treeSum = 0;
+	for( XmlTree::ConstIter pathIt = tree.begin( "svg/g/path" ); pathIt != tree.end(); ++pathIt )
+		treeSum += pathIt->getAttributeValue<float>( "stroke-width" );
+	double treeIterate = timer.getSeconds();
+	timer.start();
+	size_t treeLength = 0;
+	for( int i = 0; i < numLookups; ++i )
+		treeLength += tree.getChild( "svg/g/text" ).getValue().size();
+	double treeLookup = timer.getSeconds();
+
+	timer.start();
+	const XmlDoc doc( svgString );
+	double docLoad = timer.getSeconds();
+	timer.start();
+	float docSum = 0;
+	const XmlDoc::Query pathQuery( doc, "svg/g/path" );
+	for( XmlDoc::ConstIter pathIt = doc.getRoot().begin( pathQuery ); pathIt != doc.getRoot().end(); ++pathIt )
+		docSum += pathIt->getAttributeValue<float>( "stroke-width" );
+	double docIterate = timer.getSeconds();
+	timer.start();
+	size_t docLength = 0;
+	const XmlDoc::Query textQuery( doc, "svg/g/text" );
+	for( int i = 0; i < numLookups; ++i )
+		docLength += doc.getRoot().getChild( textQuery ).getValueSize();
+	double docLookup = timer.getSeconds();
+
+	console() << svgString.size() / 1024 << " KB, " << doc.getNumNodes() << " nodes, XmlDoc holds " << doc.getMemoryUsage() / 1024 << " KB" << endl;
+	console() << "load:    XmlTree " << treeLoad << "s, XmlDoc " << docLoad << "s" << endl;
+	console() << "iterate: XmlTree " << treeIterate << "s, XmlDoc " << docIterate << "s (" << treeSum << ", " << docSum << ")" << endl;
+	console() << numLookups << " lookups: XmlTree " << treeLookup << "s, XmlDoc " << docLookup << "s (" << treeLength << ", " << docLength << ")" << endl;
+}
+
 
 CINDER_APP_BASIC( FlickrTestApp, RendererGl )
\ No newline at end of file
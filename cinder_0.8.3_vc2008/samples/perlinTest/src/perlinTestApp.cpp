@@ -2,6 +2,7 @@
 #include "cinder/cairo/Cairo.h"
 #include "cinder/Perlin.h"
 #include "cinder/Rand.h"
+#include "cinder/Timer.h"
 
 using namespace ci;
 using namespace ci::app;
@@ -18,8 +19,10 @@ class perlinTestApp : public AppBasic {
 	void		draw();
 
 	void		renderNoise();
+	void		benchmark();
 
 	cairo::SurfaceImage		*mNoiseSurface;
+	Channel32f				mNoiseChannel;
 	int						mSeed;
 	int						mOctaves;
 	float					mTime;
@@ -31,6 +34,7 @@ class perlinTestApp : public AppBasic {
 	bool	mDrawLines;
 	bool	mDrawNormalized;
 	bool	mPaused;
+	bool	mSimplex;
 };
 
 void perlinTestApp::renderNoise()
@@ -38,10 +42,15 @@ void perlinTestApp::renderNoise()
 	Surface8u &s = mNoiseSurface->getSurface();
 	mPerlin = Perlin( mOctaves, mSeed );
 
+	if( mSimplex )
+		mPerlin.simplexFbm( &mNoiseChannel, Vec3f( 0, 0, mTime ) * mFrequency, Vec2f( mFrequency, mFrequency ) );
+	else
+		mPerlin.fBm( &mNoiseChannel, Vec3f( 0, 0, mTime ) * mFrequency, Vec2f( mFrequency, mFrequency ) );
+
 	Surface8u::Iter iter = s.getIter();
 	while( iter.line() ) {
 		while( iter.pixel() ) {
-			float v = ( mPerlin.fBm( Vec3f( iter.x(), iter.y(), mTime ) * mFrequency ) + 1.0f ) / 2.0f;
+			float v = ( mNoiseChannel.getValue( iter.getPos() ) + 1.0f ) / 2.0f;
 			v *= v * v;
 			uint8_t val = v * 255;
 			iter.r() = iter.g() = iter.b() = val;
@@ -49,6 +58,39 @@ void perlinTestApp::renderNoise()
 	}
 }
 
+// compares filling the window one point at a time with the batch functions
+void perlinTestApp::benchmark()
+{
+	const int32_t width = mNoiseChannel.getWidth(), height = mNoiseChannel.getHeight();
+	const double mpoints = width * height / 1000000.0;
+	const Vec3f origin = Vec3f( 0, 0, mTime ) * mFrequency;
+	const Vec2f step( mFrequency, mFrequency );
+	Timer timer;
+	float sum = 0;
+
+	timer.start();
+	for( int32_t y = 0; y < height; ++y )
+		for( int32_t x = 0; x < width; ++x )
+			sum += mPerlin.fBm( Vec3f( x, y, mTime ) * mFrequency );
+	timer.stop();
+	console() << "fBm: " << mpoints / timer.getSeconds() << " Mpoints/s";
+	timer.start();
+	mPerlin.fBm( &mNoiseChannel, origin, step );
+	timer.stop();
+	console() << ", batch " << mpoints / timer.getSeconds() << " Mpoints/s" << std::endl;
+
+	timer.start();
+	for( int32_t y = 0; y < height; ++y )
+		for( int32_t x = 0; x < width; ++x )
+			sum += mPerlin.simplexFbm( Vec3f( x, y, mTime ) * mFrequency );
+	timer.stop();
+	console() << "simplexFbm: " << mpoints / timer.getSeconds() << " Mpoints/s";
+	timer.start();
+	mPerlin.simplexFbm( &mNoiseChannel, origin, step );
+	timer.stop();
+	console() << ", batch " << mpoints / timer.getSeconds() << " Mpoints/s (checksum " << sum << ")" << std::endl;
+}
+
 void perlinTestApp::prepareSettings( Settings *settings )
 {
 	settings->setResizable( false );
@@ -63,10 +105,12 @@ void perlinTestApp::setup()
 	mDrawNormalized = false;
 	mPaused = false;
 	mDrawLines = true;
+	mSimplex = false;
 	
 	mGradientPos = Vec2f( getWindowWidth(), getWindowHeight() ) / 2.0f;
 
 	mNoiseSurface = new cairo::SurfaceImage( getWindowWidth(), getWindowHeight(), false );
+	mNoiseChannel = Channel32f( getWindowWidth(), getWindowHeight() );
 	renderNoise();
 }
 
@@ -119,6 +163,13 @@ void perlinTestApp::keyDown( KeyEvent event )
 	else if( event.getChar() == 'l' ) {
 		mDrawLines = ! mDrawLines;
 	}
+	else if( event.getChar() == 'p' ) {
+		mSimplex = ! mSimplex;
+		renderNoise();
+	}
+	else if( event.getChar() == 'b' ) {
+		benchmark();
+	}
 }
 
 void perlinTestApp::update()
@@ -34,9 +34,16 @@
 #include <limits>
 
 #include "cinder/Vector.h"
+#include "cinder/CinderMath.h"
+#include "cinder/Thread.h"
 
 namespace cinder {
 
+namespace {
+// batch evaluation keeps per-span coefficients on the stack; higher degrees fall back to get()
+const int MAX_BATCH_DEGREE = 7;
+} // anonymous namespace
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 // BSplineBasis
 template <class T>
@@ -703,6 +710,158 @@ T BSpline<T>::getThirdDerivative( float t ) const
 	return kDer3;
 }
 
+template<typename T>
+void BSpline<T>::computeSpanPolynomial( int span, T *coeffs ) const
+{
+	// The k-th derivative of the curve is itself a B-spline of degree d-k whose control points are scaled differences of the
+	// previous level's. Evaluating each level at the span's first knot with de Boor's algorithm gives the Taylor coefficients.
+	const int d = mBasis.getDegree();
+	const float *knots = mBasis.getKnots();
+	const float t0 = knots[span];
+	T level[MAX_BATCH_DEGREE+1], work[MAX_BATCH_DEGREE+1];
+	for( int j = 0; j <= d; ++j )
+		level[j] = mCtrlPoints[span - d + j];
+
+	float invFactorial = 1;
+	for( int k = 0; k <= d; ++k ) {
+		const int p = d - k;
+		for( int j = 0; j <= p; ++j )
+			work[j] = level[j];
+		for( int r = 1; r <= p; ++r ) {
+			for( int j = p; j >= r; --j ) {
+				float lo = knots[span - d + j + k], hi = knots[span + j + 1 - r];
+				float alpha = ( t0 - lo ) / ( hi - lo );
+				work[j] = work[j-1] * ( 1 - alpha ) + work[j] * alpha;
+			}
+		}
+		coeffs[k] = work[p] * invFactorial;
+
+		// differentiate: control points of the next level
+		for( int j = 0; j < p; ++j )
+			level[j] = ( level[j+1] - level[j] ) * ( p / ( knots[span + j + 1] - knots[span - d + j + k + 1] ) );
+		invFactorial /= k + 1;
+	}
+}
+
+template<typename T>
+void BSpline<T>::evalBatch( const float *t, float t0, float dt, size_t begin, size_t end, T *positions, T *derivatives ) const
+{
+	const int d = mBasis.getDegree();
+	const int lastSpan = mBasis.getNumControlPoints() - 1;
+	const float *knots = mBasis.getKnots();
+	const bool open = mBasis.isOpen(), uniform = mBasis.isUniform();
+
+	T coeffs[MAX_BATCH_DEGREE+1];
+	int span = -1;
+	for( size_t i = begin; i < end; ++i ) {
+		float x = t ? t[i] : t0 + dt * i;
+		if( open )
+			x = constrain( x, 0.0f, 1.0f );
+		else if( x < 0 || x >= 1 )
+			x -= floorf( x );
+
+		if( span < 0 || x < knots[span] || ( x >= knots[span+1] && span < lastSpan ) ) {
+			int key = span;
+			if( ( ! uniform ) && span >= 0 && x >= knots[span+1] ) {
+				// sorted input: step forward instead of searching all the knots again
+				while( key < lastSpan && x >= knots[key+1] )
+					++key;
+			}
+			else
+				key = mBasis.getKey( x );
+
+			if( key != span ) {
+				span = key;
+				computeSpanPolynomial( span, coeffs );
+			}
+		}
+
+		const float u = x - knots[span];
+		if( positions ) {
+			T p = coeffs[d];
+			for( int k = d - 1; k >= 0; --k )
+				p = p * u + coeffs[k];
+			positions[i] = p;
+		}
+		if( derivatives ) {
+			T q = coeffs[d] * (float)d;
+			for( int k = d - 1; k >= 1; --k )
+				q = q * u + coeffs[k] * (float)k;
+			derivatives[i] = q;
+		}
+	}
+}
+
+template<typename T>
+void BSpline<T>::evalSerial( const float *t, float t0, float dt, size_t count, T *positions, T *derivatives ) const
+{
+	// a copy of the basis holds this call's scratch, as get() writes the spline's own
+	BSplineBasis basis( mBasis );
+	for( size_t i = 0; i < count; ++i ) {
+		int iMin, iMax;
+		basis.compute( t ? t[i] : t0 + dt * i, derivatives ? 1 : 0, iMin, iMax );
+		if( positions ) {
+			positions[i] = T::zero();
+			for( int j = iMin; j <= iMax; ++j )
+				positions[i] += mCtrlPoints[j] * basis.getD0( j );
+		}
+		if( derivatives ) {
+			derivatives[i] = T::zero();
+			for( int j = iMin; j <= iMax; ++j )
+				derivatives[i] += mCtrlPoints[j] * basis.getD1( j );
+		}
+	}
+}
+
+template<typename T>
+struct BSpline<T>::EvalBatch {
+	void operator()( size_t begin, size_t end ) const
+	{
+		mSpline->evalBatch( mT, mT0, mDt, begin, end, mPositions, mDerivatives );
+	}
+
+	const BSpline<T>	*mSpline;
+	const float			*mT;
+	float				mT0, mDt;
+	T					*mPositions, *mDerivatives;
+};
+
+template<typename T>
+void BSpline<T>::getPositions( const float *t, size_t count, T *positions, T *derivatives ) const
+{
+	if( getDegree() > MAX_BATCH_DEGREE ) {
+		evalSerial( t, 0, 0, count, positions, derivatives );
+		return;
+	}
+
+	EvalBatch fn;
+	fn.mSpline = this;
+	fn.mT = t;
+	fn.mT0 = fn.mDt = 0;
+	fn.mPositions = positions;
+	fn.mDerivatives = derivatives;
+	parallelFor( count, fn, 8192 );
+}
+
+template<typename T>
+void BSpline<T>::getPositions( float t0, float t1, size_t count, T *positions, T *derivatives ) const
+{
+	const float dt = ( count > 1 ) ? ( t1 - t0 ) / ( count - 1 ) : 0;
+	if( getDegree() > MAX_BATCH_DEGREE ) {
+		evalSerial( 0, t0, dt, count, positions, derivatives );
+		return;
+	}
+
+	EvalBatch fn;
+	fn.mSpline = this;
+	fn.mT = 0;
+	fn.mT0 = t0;
+	fn.mDt = dt;
+	fn.mPositions = positions;
+	fn.mDerivatives = derivatives;
+	parallelFor( count, fn, 8192 );
+}
+
 // explicit template instantiations
 template class BSpline<Vec2f>;
 template class BSpline<Vec3f>;
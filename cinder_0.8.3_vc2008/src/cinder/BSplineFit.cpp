@@ -33,9 +33,11 @@
 #include "cinder/CinderMath.h"
 #include "cinder/Vector.h"
 #include "cinder/BSpline.h"
+#include "cinder/Thread.h"
 
 #include <string.h>
 #include <assert.h>
+#include <algorithm>
 
 using std::vector;
 
@@ -242,6 +244,50 @@ T BSplineFitBasis<T>::getValue( int i ) const
 
 //----------------------------------------------------------------------------
 
+// Accumulates the band of A^T*A followed by A^T*B for a range of sample chunks
+template<typename T>
+struct BSplineFitAccumulate {
+	void operator()( size_t begin, size_t end ) const
+	{
+		const int iQuantity = m_pkFit->getControlQuantity(), iDegree = m_pkFit->getDegree(), iDimension = m_pkFit->getDimension();
+		const int iSampleQuantity = m_pkFit->getSampleQuantity(), iBandWidth = iDegree + 1;
+		const double dTMultiplier = 1.0/(double)(iSampleQuantity - 1);
+		BSplineFitBasisd kDBasis( iQuantity, iDegree );
+		vector<double> adBasis( iBandWidth );
+
+		for( size_t iChunk = begin; iChunk < end; ++iChunk ) {
+			vector<double> &kPartial = (*m_pkPartials)[iChunk];
+			kPartial.assign( iQuantity*( iBandWidth + iDimension ), 0.0 );
+			double *adBand = &kPartial[0];
+			double *adRhs = adBand + iQuantity*iBandWidth;
+
+			const int iFirst = (int)iChunk * m_iChunkSize;
+			const int iLast = std::min( iFirst + m_iChunkSize, iSampleQuantity );
+			for( int iSample = iFirst; iSample < iLast; ++iSample ) {
+				int iMin, iMax;
+				kDBasis.compute( dTMultiplier*(double)iSample, iMin, iMax );
+				for( int i = 0; i <= iDegree; ++i )
+					adBasis[i] = kDBasis.getValue( i );
+
+				const T *pfSample = m_pkFit->getSampleData() + iDimension*iSample;
+				for( int i = 0; i <= iDegree; ++i ) {
+					double *adRow = &adBand[( iMin + i )*iBandWidth];
+					for( int k = i; k <= iDegree; ++k )
+						adRow[k - i] += adBasis[i]*adBasis[k];
+
+					double *adTarget = &adRhs[( iMin + i )*iDimension];
+					for( int j = 0; j < iDimension; ++j )
+						adTarget[j] += adBasis[i]*(double)pfSample[j];
+				}
+			}
+		}
+	}
+
+	const BSplineFit<T>				*m_pkFit;
+	int								m_iChunkSize;
+	vector<vector<double> >			*m_pkPartials;
+};
+
 template<typename T>
 BSplineFit<T>::BSplineFit( int iDimension, int iSampleQuantity, const T* afSampleData, int iDegree, int iControlQuantity )
     : m_kBasis( iControlQuantity, iDegree )
@@ -262,83 +308,42 @@ BSplineFit<T>::BSplineFit( int iDimension, int iSampleQuantity, const T* afSampl
 	m_afControlData = new T[m_iDimension*iControlQuantity];
 
 	// Fit the data points with a B-spline curve using a least-squares error
-	// metric.  The problem is of the form A^T*A*X = A^T*B.
-	BSplineFitBasisd kDBasis(m_iControlQuantity,m_iDegree);
-	double dTMultiplier = 1.0/(double)(m_iSampleQuantity - 1);
-	double dT;
-	int i0, i1, i2, iMin, iMax, j;
-
-	// Construct the matrix A (depends only on the output basis function).
+	// metric.  The problem is of the form A^T*A*X = A^T*B.  Each sample only
+	// touches the degree+1 basis functions which are nonzero at its time, so
+	// both sides are accumulated in a single pass over the samples.  Large
+	// sample sets are split into chunks which are accumulated in parallel and
+	// summed in order, so the result doesn't depend on the number of threads.
+	const int iBandWidth = m_iDegree + 1;
+	const int iChunkSize = std::max( 8192, ( m_iSampleQuantity + 63 ) / 64 );
+	const int iNumChunks = ( m_iSampleQuantity + iChunkSize - 1 ) / iChunkSize;
+	vector<vector<double> > kPartials( iNumChunks );
+
+	BSplineFitAccumulate<T> kAccumulate;
+	kAccumulate.m_pkFit = this;
+	kAccumulate.m_iChunkSize = iChunkSize;
+	kAccumulate.m_pkPartials = &kPartials;
+	parallelFor( iNumChunks, kAccumulate, 1 );
+
+	int i0, i1, j;
 	BandedMatrixd* pkAMat = new BandedMatrixd( m_iControlQuantity, m_iDegree+1, m_iDegree + 1 );
-
-	for (i0 = 0; i0 < m_iControlQuantity; i0++) {
-		for ( i1 = 0; i1 < i0; i1++ ) {
-			(*pkAMat)(i0,i1) = (*pkAMat)(i1,i0);
-		}
-
-		int i1Max = i0 + m_iDegree;
-		if (i1Max >= m_iControlQuantity)
-		{
-			i1Max = m_iControlQuantity - 1;
-		}
-
-		for (i1 = i0; i1 <= i1Max; i1++)
-		{
-			double dValue = 0.0;
-			for (i2 = 0; i2 < m_iSampleQuantity; i2++)
-			{
-				dT = dTMultiplier*(double)i2;
-				kDBasis.compute(dT,iMin,iMax);
-				if (iMin <= i0 && i0 <= iMax && iMin <= i1 && i1 <= iMax)
-				{
-					double dB0 = kDBasis.getValue(i0 - iMin);
-					double dB1 = kDBasis.getValue(i1 - iMin);
-					dValue += dB0*dB1;
-				}
-			}
-			(*pkAMat)(i0,i1) = dValue;
-		}
-	}
-
-	// Construct the matrix B.
-	double** aadBMat;
-	aadBMat = new double*[m_iControlQuantity];
-	aadBMat[0] = new double[m_iControlQuantity*m_iSampleQuantity];
-	for( int iRow = 1; iRow < m_iControlQuantity; iRow++ ) {
-		aadBMat[iRow] = &aadBMat[0][m_iSampleQuantity*iRow];
-	}
-
-	memset( aadBMat[0],0,m_iControlQuantity*m_iSampleQuantity*sizeof(double) );
-	for (i0 = 0; i0 < m_iControlQuantity; i0++)
-	{
-		for (i1 = 0; i1 < m_iSampleQuantity; i1++)
-		{
-			dT = dTMultiplier*(double)i1;
-			kDBasis.compute(dT,iMin,iMax);
-			if (iMin <= i0 && i0 <= iMax)
-			{
-				aadBMat[i0][i1] = kDBasis.getValue(i0 - iMin);
-			}
-		}
-	}
-
-	// Construct the control points for the least-squares curve.
 	double* adControlData = new double[m_iDimension*m_iControlQuantity];
 	memset( adControlData,0,m_iDimension*m_iControlQuantity*sizeof(double) );
-	double* pdBaseTarget = adControlData;
-	for (i0 = 0; i0 < m_iControlQuantity; i0++)
-	{
-		const T* pfSource = m_afSampleData;
-		double* adTarget = pdBaseTarget;
-		for (i1 = 0; i1 < m_iSampleQuantity; i1++)
-		{
-			double dBValue = aadBMat[i0][i1];
-			for (j = 0; j < m_iDimension; j++)
-			{
-				adTarget[j] += dBValue*(double)(*pfSource++);
-			}
+	vector<double> kBand( m_iControlQuantity*iBandWidth, 0.0 );
+	for( int iChunk = 0; iChunk < iNumChunks; ++iChunk ) {
+		const double *adBand = &kPartials[iChunk][0];
+		const double *adRhs = adBand + m_iControlQuantity*iBandWidth;
+		for( i0 = 0; i0 < m_iControlQuantity*iBandWidth; i0++ )
+			kBand[i0] += adBand[i0];
+		for( i0 = 0; i0 < m_iDimension*m_iControlQuantity; i0++ )
+			adControlData[i0] += adRhs[i0];
+	}
+
+	for( i0 = 0; i0 < m_iControlQuantity; i0++ ) {
+		int i1Max = std::min( i0 + m_iDegree, m_iControlQuantity - 1 );
+		for( i1 = i0; i1 <= i1Max; i1++ ) {
+			(*pkAMat)(i0,i1) = kBand[i0*iBandWidth + i1 - i0];
+			(*pkAMat)(i1,i0) = kBand[i0*iBandWidth + i1 - i0];
 		}
-		pdBaseTarget += m_iDimension;
 	}
 
 	// Solve A^T*A*ControlData = A^T*B*SampleData.
@@ -373,11 +378,6 @@ BSplineFit<T>::BSplineFit( int iDimension, int iSampleQuantity, const T* afSampl
 	}
 
 	delete [] adControlData;
-	if( aadBMat ) {
-        delete [] aadBMat[0];
-        delete [] aadBMat;
-        aadBMat = 0;
-    }
 	delete pkAMat;
 }
 
@@ -0,0 +1,410 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/BatchMath.h"
+#include "cinder/System.h"
+#include "cinder/CinderMath.h"
+
+#include <algorithm>
+
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+#	include <emmintrin.h>
+#	include <xmmintrin.h>
+#endif
+
+namespace cinder { namespace batch {
+
+namespace {
+
+// number of boxes gathered into local min/max arrays at a time by the AxisAlignedBox3f variant of transformBoxes()
+const size_t BOX_BATCH = 256;
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Scalar kernels
+void transformPointsScalar( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count )
+{
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = mat.transformPoint( src[i] );
+}
+
+void transformPointsAffineScalar( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count )
+{
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = mat.transformPointAffine( src[i] );
+}
+
+void transformVecsScalar( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count )
+{
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = mat.transformVec( src[i] );
+}
+
+void transformVec4Scalar( const Matrix44f &mat, const Vec4f *src, Vec4f *dst, size_t count )
+{
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = mat * src[i];
+}
+
+// \a aStride is 1 to step through \a a alongside \a b, or 0 to use a single left-hand matrix
+void multiplyScalar( const Matrix44f *a, size_t aStride, const Matrix44f *b, Matrix44f *dst, size_t count )
+{
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = a[i * aStride] * b[i];
+}
+
+void normalizeScalar( const Vec3f *src, Vec3f *dst, size_t count )
+{
+	for( size_t i = 0; i < count; ++i ) {
+		Vec3f v = src[i];
+		v.safeNormalize();
+		dst[i] = v;
+	}
+}
+
+void dotScalar( const Vec3f *a, const Vec3f *b, float *dst, size_t count )
+{
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = a[i].dot( b[i] );
+}
+
+// transforms each box's center and projects its half-extents onto the absolute values of the rotation/scale axes (Arvo's method)
+void transformBoxesScalar( const Matrix44f &mat, const Vec3f *srcMin, const Vec3f *srcMax, Vec3f *dstMin, Vec3f *dstMax, size_t count )
+{
+	float a[9];
+	for( int r = 0; r < 3; ++r )
+		for( int c = 0; c < 3; ++c )
+			a[r * 3 + c] = math<float>::abs( mat.at( r, c ) );
+
+	for( size_t i = 0; i < count; ++i ) {
+		Vec3f center = ( srcMin[i] + srcMax[i] ) * 0.5f;
+		Vec3f extents = ( srcMax[i] - srcMin[i] ) * 0.5f;
+		Vec3f newCenter = mat.transformPointAffine( center );
+		Vec3f newExtents( a[0] * extents.x + a[1] * extents.y + a[2] * extents.z,
+							a[3] * extents.x + a[4] * extents.y + a[5] * extents.z,
+							a[6] * extents.x + a[7] * extents.y + a[8] * extents.z );
+		dstMin[i] = newCenter - newExtents;
+		dstMax[i] = newCenter + newExtents;
+	}
+}
+
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+
+////////////////////////////////////////////////////////////////////////////////////////
+// SSE2 kernels. Each processes four elements at a time in structure-of-arrays form and
+// hands any remainder to the scalar kernel, so results match it exactly.
+
+// loads four consecutive Vec3f and transposes them into x, y and z lanes
+inline void loadVec3x4( const Vec3f *v, __m128 &x, __m128 &y, __m128 &z )
+{
+	const float *f = reinterpret_cast<const float*>( v );
+	__m128 a = _mm_loadu_ps( f );		// x0 y0 z0 x1
+	__m128 b = _mm_loadu_ps( f + 4 );	// y1 z1 x2 y2
+	__m128 c = _mm_loadu_ps( f + 8 );	// z2 x3 y3 z3
+	__m128 x2y2x3y3 = _mm_shuffle_ps( b, c, _MM_SHUFFLE( 2, 1, 3, 2 ) );
+	__m128 y0z0y1z1 = _mm_shuffle_ps( a, b, _MM_SHUFFLE( 1, 0, 2, 1 ) );
+	x = _mm_shuffle_ps( a, x2y2x3y3, _MM_SHUFFLE( 2, 0, 3, 0 ) );
+	y = _mm_shuffle_ps( y0z0y1z1, x2y2x3y3, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+	z = _mm_shuffle_ps( y0z0y1z1, c, _MM_SHUFFLE( 3, 0, 3, 1 ) );
+}
+
+// inverse of loadVec3x4()
+inline void storeVec3x4( Vec3f *v, __m128 x, __m128 y, __m128 z )
+{
+	float *f = reinterpret_cast<float*>( v );
+	__m128 x0y0x1y1 = _mm_unpacklo_ps( x, y );
+	__m128 x2y2x3y3 = _mm_unpackhi_ps( x, y );
+	__m128 z0z0x1x1 = _mm_shuffle_ps( z, x0y0x1y1, _MM_SHUFFLE( 2, 2, 0, 0 ) );
+	__m128 y1y1z1z1 = _mm_shuffle_ps( x0y0x1y1, z, _MM_SHUFFLE( 1, 1, 3, 3 ) );
+	__m128 z2z2x3x3 = _mm_shuffle_ps( z, x2y2x3y3, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+	__m128 y3y3z3z3 = _mm_shuffle_ps( x2y2x3y3, z, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+	_mm_storeu_ps( f, _mm_shuffle_ps( x0y0x1y1, z0z0x1x1, _MM_SHUFFLE( 2, 0, 1, 0 ) ) );
+	_mm_storeu_ps( f + 4, _mm_shuffle_ps( y1y1z1z1, x2y2x3y3, _MM_SHUFFLE( 1, 0, 2, 0 ) ) );
+	_mm_storeu_ps( f + 8, _mm_shuffle_ps( z2z2x3x3, y3y3z3z3, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+}
+
+// each element of \a mat broadcast across a register
+struct SplatMatrix {
+	SplatMatrix( const Matrix44f &mat )
+	{
+		for( int i = 0; i < 16; ++i )
+			m[i] = _mm_set1_ps( mat.m[i] );
+	}
+
+	// computes row \a r of mat * [x y z 1], in the same order as Matrix44f::transformPoint()
+	__m128 point( int r, __m128 x, __m128 y, __m128 z ) const
+	{
+		return _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( m[r], x ), _mm_mul_ps( m[r + 4], y ) ), _mm_mul_ps( m[r + 8], z ) ), m[r + 12] );
+	}
+
+	// computes row \a r of mat * [x y z 0]
+	__m128 vec( int r, __m128 x, __m128 y, __m128 z ) const
+	{
+		return _mm_add_ps( _mm_add_ps( _mm_mul_ps( m[r], x ), _mm_mul_ps( m[r + 4], y ) ), _mm_mul_ps( m[r + 8], z ) );
+	}
+
+	__m128 m[16];
+};
+
+void transformPointsSse( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count )
+{
+	const SplatMatrix m( mat );
+	size_t i = 0;
+	for( ; i + 4 <= count; i += 4 ) {
+		__m128 x, y, z;
+		loadVec3x4( src + i, x, y, z );
+		__m128 w = m.point( 3, x, y, z );
+		storeVec3x4( dst + i, _mm_div_ps( m.point( 0, x, y, z ), w ), _mm_div_ps( m.point( 1, x, y, z ), w ), _mm_div_ps( m.point( 2, x, y, z ), w ) );
+	}
+	transformPointsScalar( mat, src + i, dst + i, count - i );
+}
+
+void transformPointsAffineSse( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count )
+{
+	const SplatMatrix m( mat );
+	size_t i = 0;
+	for( ; i + 4 <= count; i += 4 ) {
+		__m128 x, y, z;
+		loadVec3x4( src + i, x, y, z );
+		storeVec3x4( dst + i, m.point( 0, x, y, z ), m.point( 1, x, y, z ), m.point( 2, x, y, z ) );
+	}
+	transformPointsAffineScalar( mat, src + i, dst + i, count - i );
+}
+
+void transformVecsSse( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count )
+{
+	const SplatMatrix m( mat );
+	size_t i = 0;
+	for( ; i + 4 <= count; i += 4 ) {
+		__m128 x, y, z;
+		loadVec3x4( src + i, x, y, z );
+		storeVec3x4( dst + i, m.vec( 0, x, y, z ), m.vec( 1, x, y, z ), m.vec( 2, x, y, z ) );
+	}
+	transformVecsScalar( mat, src + i, dst + i, count - i );
+}
+
+// Vec4f already fills a register, so these work one vector at a time against the matrix columns
+void transformVec4Sse( const Matrix44f &mat, const Vec4f *src, Vec4f *dst, size_t count )
+{
+	const __m128 c0 = _mm_loadu_ps( &mat.m[0] ), c1 = _mm_loadu_ps( &mat.m[4] ), c2 = _mm_loadu_ps( &mat.m[8] ), c3 = _mm_loadu_ps( &mat.m[12] );
+	for( size_t i = 0; i < count; ++i ) {
+		__m128 v = _mm_loadu_ps( &src[i].x );
+		__m128 r = _mm_add_ps( _mm_mul_ps( c0, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 0, 0, 0, 0 ) ) ), _mm_mul_ps( c1, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) );
+		r = _mm_add_ps( r, _mm_mul_ps( c2, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 2, 2, 2, 2 ) ) ) );
+		r = _mm_add_ps( r, _mm_mul_ps( c3, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 3, 3, 3, 3 ) ) ) );
+		_mm_storeu_ps( &dst[i].x, r );
+	}
+}
+
+void multiplySse( const Matrix44f *a, size_t aStride, const Matrix44f *b, Matrix44f *dst, size_t count )
+{
+	for( size_t i = 0; i < count; ++i ) {
+		const float *am = a[i * aStride].m;
+		const float *bm = b[i].m;
+		const __m128 c0 = _mm_loadu_ps( am ), c1 = _mm_loadu_ps( am + 4 ), c2 = _mm_loadu_ps( am + 8 ), c3 = _mm_loadu_ps( am + 12 );
+		// load all of b before storing, so that dst may alias a or b
+		__m128 bc[4];
+		for( int j = 0; j < 4; ++j )
+			bc[j] = _mm_loadu_ps( bm + j * 4 );
+		for( int j = 0; j < 4; ++j ) {
+			__m128 r = _mm_add_ps( _mm_mul_ps( c0, _mm_shuffle_ps( bc[j], bc[j], _MM_SHUFFLE( 0, 0, 0, 0 ) ) ), _mm_mul_ps( c1, _mm_shuffle_ps( bc[j], bc[j], _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) );
+			r = _mm_add_ps( r, _mm_mul_ps( c2, _mm_shuffle_ps( bc[j], bc[j], _MM_SHUFFLE( 2, 2, 2, 2 ) ) ) );
+			r = _mm_add_ps( r, _mm_mul_ps( c3, _mm_shuffle_ps( bc[j], bc[j], _MM_SHUFFLE( 3, 3, 3, 3 ) ) ) );
+			_mm_storeu_ps( dst[i].m + j * 4, r );
+		}
+	}
+}
+
+inline __m128 select( __m128 mask, __m128 a, __m128 b )
+{
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+
+void normalizeSse( const Vec3f *src, Vec3f *dst, size_t count )
+{
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 zero = _mm_setzero_ps();
+	size_t i = 0;
+	for( ; i + 4 <= count; i += 4 ) {
+		__m128 x, y, z;
+		loadVec3x4( src + i, x, y, z );
+		__m128 s = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, x ), _mm_mul_ps( y, y ) ), _mm_mul_ps( z, z ) );
+		__m128 nonZero = _mm_cmpgt_ps( s, zero );
+		__m128 invS = _mm_div_ps( one, _mm_sqrt_ps( s ) );
+		storeVec3x4( dst + i, select( nonZero, _mm_mul_ps( x, invS ), x ), select( nonZero, _mm_mul_ps( y, invS ), y ), select( nonZero, _mm_mul_ps( z, invS ), z ) );
+	}
+	normalizeScalar( src + i, dst + i, count - i );
+}
+
+void dotSse( const Vec3f *a, const Vec3f *b, float *dst, size_t count )
+{
+	size_t i = 0;
+	for( ; i + 4 <= count; i += 4 ) {
+		__m128 ax, ay, az, bx, by, bz;
+		loadVec3x4( a + i, ax, ay, az );
+		loadVec3x4( b + i, bx, by, bz );
+		_mm_storeu_ps( dst + i, _mm_add_ps( _mm_add_ps( _mm_mul_ps( ax, bx ), _mm_mul_ps( ay, by ) ), _mm_mul_ps( az, bz ) ) );
+	}
+	dotScalar( a + i, b + i, dst + i, count - i );
+}
+
+void transformBoxesSse( const Matrix44f &mat, const Vec3f *srcMin, const Vec3f *srcMax, Vec3f *dstMin, Vec3f *dstMax, size_t count )
+{
+	const SplatMatrix m( mat );
+	const __m128 absMask = _mm_castsi128_ps( _mm_set1_epi32( 0x7fffffff ) );
+	__m128 a[12];
+	for( int c = 0; c < 12; ++c )
+		a[c] = _mm_and_ps( m.m[c], absMask );
+	const __m128 half = _mm_set1_ps( 0.5f );
+
+	size_t i = 0;
+	for( ; i + 4 <= count; i += 4 ) {
+		__m128 minX, minY, minZ, maxX, maxY, maxZ;
+		loadVec3x4( srcMin + i, minX, minY, minZ );
+		loadVec3x4( srcMax + i, maxX, maxY, maxZ );
+		__m128 cx = _mm_mul_ps( _mm_add_ps( minX, maxX ), half ), cy = _mm_mul_ps( _mm_add_ps( minY, maxY ), half ), cz = _mm_mul_ps( _mm_add_ps( minZ, maxZ ), half );
+		__m128 ex = _mm_mul_ps( _mm_sub_ps( maxX, minX ), half ), ey = _mm_mul_ps( _mm_sub_ps( maxY, minY ), half ), ez = _mm_mul_ps( _mm_sub_ps( maxZ, minZ ), half );
+		__m128 tc[3], te[3];
+		for( int r = 0; r < 3; ++r ) {
+			tc[r] = m.point( r, cx, cy, cz );
+			te[r] = _mm_add_ps( _mm_add_ps( _mm_mul_ps( a[r], ex ), _mm_mul_ps( a[r + 4], ey ) ), _mm_mul_ps( a[r + 8], ez ) );
+		}
+		storeVec3x4( dstMin + i, _mm_sub_ps( tc[0], te[0] ), _mm_sub_ps( tc[1], te[1] ), _mm_sub_ps( tc[2], te[2] ) );
+		storeVec3x4( dstMax + i, _mm_add_ps( tc[0], te[0] ), _mm_add_ps( tc[1], te[1] ), _mm_add_ps( tc[2], te[2] ) );
+	}
+	transformBoxesScalar( mat, srcMin + i, srcMax + i, dstMin + i, dstMax + i, count - i );
+}
+
+#endif // defined( CINDER_MSW ) || defined( CINDER_MAC )
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Dispatch
+struct Kernels {
+	const char	*mName;
+	void		(*mTransformPoints)( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count );
+	void		(*mTransformPointsAffine)( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count );
+	void		(*mTransformVecs)( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count );
+	void		(*mTransformVec4)( const Matrix44f &mat, const Vec4f *src, Vec4f *dst, size_t count );
+	void		(*mMultiply)( const Matrix44f *a, size_t aStride, const Matrix44f *b, Matrix44f *dst, size_t count );
+	void		(*mNormalize)( const Vec3f *src, Vec3f *dst, size_t count );
+	void		(*mDot)( const Vec3f *a, const Vec3f *b, float *dst, size_t count );
+	void		(*mTransformBoxes)( const Matrix44f &mat, const Vec3f *srcMin, const Vec3f *srcMax, Vec3f *dstMin, Vec3f *dstMax, size_t count );
+};
+
+const Kernels sScalarKernels = { "scalar", &transformPointsScalar, &transformPointsAffineScalar, &transformVecsScalar, &transformVec4Scalar,
+									&multiplyScalar, &normalizeScalar, &dotScalar, &transformBoxesScalar };
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+const Kernels sSseKernels = { "SSE2", &transformPointsSse, &transformPointsAffineSse, &transformVecsSse, &transformVec4Sse,
+									&multiplySse, &normalizeSse, &dotSse, &transformBoxesSse };
+#endif
+
+// read without synchronization by kernels() on any thread, which is why setSimdEnabled() may only be called while no batch call is running
+bool sSimdEnabled = true;
+
+const Kernels& kernels()
+{
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+	static const bool sHasSse2 = System::hasSse2();
+	if( sSimdEnabled && sHasSse2 )
+		return sSseKernels;
+#endif
+	return sScalarKernels;
+}
+
+} // anonymous namespace
+
+void transformPoints( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count )
+{
+	kernels().mTransformPoints( mat, src, dst, count );
+}
+
+void transformPointsAffine( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count )
+{
+	kernels().mTransformPointsAffine( mat, src, dst, count );
+}
+
+void transformVecs( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count )
+{
+	kernels().mTransformVecs( mat, src, dst, count );
+}
+
+void transform( const Matrix44f &mat, const Vec4f *src, Vec4f *dst, size_t count )
+{
+	kernels().mTransformVec4( mat, src, dst, count );
+}
+
+void multiply( const Matrix44f *a, const Matrix44f *b, Matrix44f *dst, size_t count )
+{
+	kernels().mMultiply( a, 1, b, dst, count );
+}
+
+void multiply( const Matrix44f &a, const Matrix44f *b, Matrix44f *dst, size_t count )
+{
+	kernels().mMultiply( &a, 0, b, dst, count );
+}
+
+void normalize( const Vec3f *src, Vec3f *dst, size_t count )
+{
+	kernels().mNormalize( src, dst, count );
+}
+
+void dot( const Vec3f *a, const Vec3f *b, float *dst, size_t count )
+{
+	kernels().mDot( a, b, dst, count );
+}
+
+void transformBoxes( const Matrix44f &mat, const Vec3f *srcMin, const Vec3f *srcMax, Vec3f *dstMin, Vec3f *dstMax, size_t count )
+{
+	kernels().mTransformBoxes( mat, srcMin, srcMax, dstMin, dstMax, count );
+}
+
+void transformBoxes( const Matrix44f &mat, const AxisAlignedBox3f *src, AxisAlignedBox3f *dst, size_t count )
+{
+	const Kernels &k = kernels();
+	Vec3f mins[BOX_BATCH], maxs[BOX_BATCH];
+	for( size_t start = 0; start < count; start += BOX_BATCH ) {
+		size_t batch = std::min( BOX_BATCH, count - start );
+		for( size_t i = 0; i < batch; ++i ) {
+			mins[i] = src[start + i].getMin();
+			maxs[i] = src[start + i].getMax();
+		}
+		k.mTransformBoxes( mat, mins, maxs, mins, maxs, batch );
+		for( size_t i = 0; i < batch; ++i )
+			dst[start + i] = AxisAlignedBox3f( mins[i], maxs[i] );
+	}
+}
+
+void setSimdEnabled( bool enable )
+{
+	sSimdEnabled = enable;
+}
+
+bool isSimdEnabled()
+{
+	return &kernels() != &sScalarKernels;
+}
+
+const char* getBackendName()
+{
+	return kernels().mName;
+}
+
+} } // namespace cinder::batch
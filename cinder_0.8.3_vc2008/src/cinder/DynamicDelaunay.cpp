@@ -0,0 +1,534 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/DynamicDelaunay.h"
+
+#include <algorithm>
+#include <utility>
+
+using std::vector;
+
+namespace cinder {
+
+namespace {
+
+inline int32_t nextEdge( int32_t e ) { return ( e % 3 == 2 ) ? e - 2 : e + 1; }
+inline int32_t prevEdge( int32_t e ) { return ( e % 3 == 0 ) ? e + 2 : e - 1; }
+
+// Positive when a, b, c are counter-clockwise
+inline double orient( const Vec2d &a, const Vec2d &b, const Vec2d &c )
+{
+	return ( b.x - a.x ) * ( c.y - a.y ) - ( b.y - a.y ) * ( c.x - a.x );
+}
+
+// Positive when d lies inside the circumcircle of the counter-clockwise triangle a, b, c
+inline double inCircleDet( const Vec2d &a, const Vec2d &b, const Vec2d &c, const Vec2d &d )
+{
+	double adx = a.x - d.x, ady = a.y - d.y;
+	double bdx = b.x - d.x, bdy = b.y - d.y;
+	double cdx = c.x - d.x, cdy = c.y - d.y;
+	return ( adx * adx + ady * ady ) * ( bdx * cdy - cdx * bdy )
+		- ( bdx * bdx + bdy * bdy ) * ( adx * cdy - cdx * ady )
+		+ ( cdx * cdx + cdy * cdy ) * ( adx * bdy - bdx * ady );
+}
+
+// Interleaves the bits of x and y, so that sorting by the result visits points along a Z-order curve
+inline uint32_t mortonCode( uint32_t x, uint32_t y )
+{
+	uint32_t result = 0;
+	for( int b = 0; b < 16; ++b )
+		result |= ( ( x >> b ) & 1 ) << ( 2 * b ) | ( ( y >> b ) & 1 ) << ( 2 * b + 1 );
+	return result;
+}
+
+} // anonymous namespace
+
+DynamicDelaunay::DynamicDelaunay( const Rectf &bounds )
+	: mMarkStamp( 0 )
+{
+	clear( bounds );
+}
+
+void DynamicDelaunay::clear( const Rectf &bounds )
+{
+	mPositions.clear();
+	mVertexState.clear();
+	mVertexEdge.clear();
+	mFreeIds.clear();
+	mNumPoints = 0;
+	mTriVertices.clear();
+	mHalfEdges.clear();
+	mFreeTriangles.clear();
+	mTriangleMarks.clear();
+
+	// The enclosing triangle is treated as infinitely large by inCircle(); its actual size only matters for orientation tests
+	Vec2d center( bounds.getCenter() );
+	double radius = 1000.0 * std::max<double>( std::max( bounds.getWidth(), bounds.getHeight() ), 1.0 );
+	for( int k = 0; k < NUM_SUPER_VERTICES; ++k ) {
+		double angle = M_PI / 2 + k * 2 * M_PI / 3;
+		mPositions.push_back( center + Vec2d( cos( angle ), sin( angle ) ) * radius );
+		mVertexState.push_back( VERTEX_TRIANGULATED );
+		mVertexEdge.push_back( k );
+	}
+
+	mLastTriangle = allocateTriangle();
+	for( int k = 0; k < 3; ++k ) {
+		mTriVertices[k] = k;
+		mHalfEdges[k] = -1;
+	}
+}
+
+void DynamicDelaunay::build( const vector<Vec2f> &points )
+{
+	Rectf bounds( 0, 0, 1, 1 );
+	if( ! points.empty() ) {
+		bounds = Rectf( points[0], points[0] );
+		for( size_t i = 1; i < points.size(); ++i )
+			bounds.include( points[i] );
+	}
+	clear( bounds );
+
+	mPositions.reserve( points.size() + NUM_SUPER_VERTICES );
+	mVertexState.reserve( points.size() + NUM_SUPER_VERTICES );
+	mVertexEdge.reserve( points.size() + NUM_SUPER_VERTICES );
+	mTriVertices.reserve( 6 * points.size() + 3 );
+	mHalfEdges.reserve( 6 * points.size() + 3 );
+	mTriangleMarks.reserve( 2 * points.size() + 1 );
+
+	vector<std::pair<uint32_t, uint32_t> > order;
+	order.reserve( points.size() );
+	float scaleX = 65535.0f / std::max( bounds.getWidth(), 1e-20f );
+	float scaleY = 65535.0f / std::max( bounds.getHeight(), 1e-20f );
+	for( size_t i = 0; i < points.size(); ++i ) {
+		mPositions.push_back( Vec2d( points[i] ) );
+		mVertexState.push_back( VERTEX_DETACHED );
+		mVertexEdge.push_back( -1 );
+		uint32_t x = (uint32_t)( ( points[i].x - bounds.x1 ) * scaleX );
+		uint32_t y = (uint32_t)( ( points[i].y - bounds.y1 ) * scaleY );
+		order.push_back( std::make_pair( mortonCode( x, y ), (uint32_t)i ) );
+	}
+	mNumPoints = points.size();
+	std::sort( order.begin(), order.end() );
+
+	for( size_t i = 0; i < order.size(); ++i ) {
+		int32_t v = order[i].second + NUM_SUPER_VERTICES;
+		if( insertVertex( v ) )
+			mVertexState[v] = VERTEX_TRIANGULATED;
+	}
+}
+
+uint32_t DynamicDelaunay::insert( const Vec2f &pos )
+{
+	int32_t v;
+	if( ! mFreeIds.empty() ) {
+		v = mFreeIds.back() + NUM_SUPER_VERTICES;
+		mFreeIds.pop_back();
+		mPositions[v] = Vec2d( pos );
+	}
+	else {
+		v = (int32_t)mPositions.size();
+		mPositions.push_back( Vec2d( pos ) );
+		mVertexState.push_back( VERTEX_DETACHED );
+		mVertexEdge.push_back( -1 );
+	}
+	++mNumPoints;
+
+	mVertexState[v] = insertVertex( v ) ? VERTEX_TRIANGULATED : VERTEX_DETACHED;
+	return v - NUM_SUPER_VERTICES;
+}
+
+void DynamicDelaunay::remove( uint32_t id )
+{
+	int32_t v = id + NUM_SUPER_VERTICES;
+	if( mVertexState[v] == VERTEX_REMOVED )
+		return;
+	if( mVertexState[v] == VERTEX_TRIANGULATED )
+		removeVertex( v );
+	mVertexState[v] = VERTEX_REMOVED;
+	mFreeIds.push_back( id );
+	--mNumPoints;
+}
+
+void DynamicDelaunay::move( uint32_t id, const Vec2f &pos )
+{
+	int32_t v = id + NUM_SUPER_VERTICES;
+	Vec2d p( pos );
+	if( mVertexState[v] == VERTEX_TRIANGULATED ) {
+		if( moveVertexInPlace( v, p ) )
+			return;
+		removeVertex( v );
+	}
+	mPositions[v] = p;
+	mVertexState[v] = insertVertex( v ) ? VERTEX_TRIANGULATED : VERTEX_DETACHED;
+}
+
+size_t DynamicDelaunay::getNumTriangles() const
+{
+	size_t result = 0;
+	for( size_t e = 0; e < mTriVertices.size(); e += 3 ) {
+		if( mTriVertices[e] >= NUM_SUPER_VERTICES && mTriVertices[e+1] >= NUM_SUPER_VERTICES && mTriVertices[e+2] >= NUM_SUPER_VERTICES )
+			++result;
+	}
+	return result;
+}
+
+void DynamicDelaunay::getTriangleIndices( vector<uint32_t> *result ) const
+{
+	for( size_t e = 0; e < mTriVertices.size(); e += 3 ) {
+		if( mTriVertices[e] >= NUM_SUPER_VERTICES && mTriVertices[e+1] >= NUM_SUPER_VERTICES && mTriVertices[e+2] >= NUM_SUPER_VERTICES ) {
+			result->push_back( mTriVertices[e] - NUM_SUPER_VERTICES );
+			result->push_back( mTriVertices[e+1] - NUM_SUPER_VERTICES );
+			result->push_back( mTriVertices[e+2] - NUM_SUPER_VERTICES );
+		}
+	}
+}
+
+TriMesh2d DynamicDelaunay::calcMesh() const
+{
+	TriMesh2d result;
+	vector<Vec2f> &vertices = result.getVertices();
+	vertices.reserve( mPositions.size() - NUM_SUPER_VERTICES );
+	for( size_t v = NUM_SUPER_VERTICES; v < mPositions.size(); ++v )
+		vertices.push_back( Vec2f( mPositions[v] ) );
+
+	vector<uint32_t> indices;
+	getTriangleIndices( &indices );
+	if( ! indices.empty() )
+		result.appendIndices( &indices[0], indices.size() );
+	return result;
+}
+
+int32_t DynamicDelaunay::allocateTriangle()
+{
+	if( ! mFreeTriangles.empty() ) {
+		int32_t t = mFreeTriangles.back();
+		mFreeTriangles.pop_back();
+		return t;
+	}
+
+	int32_t t = (int32_t)mTriangleMarks.size();
+	mTriVertices.resize( mTriVertices.size() + 3, -1 );
+	mHalfEdges.resize( mHalfEdges.size() + 3, -1 );
+	mTriangleMarks.push_back( 0 );
+	return t;
+}
+
+void DynamicDelaunay::freeTriangle( int32_t t )
+{
+	mTriVertices[3*t] = mTriVertices[3*t+1] = mTriVertices[3*t+2] = -1;
+	mFreeTriangles.push_back( t );
+}
+
+void DynamicDelaunay::link( int32_t e, int32_t twin )
+{
+	mHalfEdges[e] = twin;
+	if( twin >= 0 )
+		mHalfEdges[twin] = e;
+}
+
+// Walks from mLastTriangle towards p, crossing any edge p lies to the right of. Returns -1 when p is outside the enclosing triangle.
+int32_t DynamicDelaunay::locate( const Vec2d &p )
+{
+	int32_t t = mLastTriangle;
+	size_t maxSteps = mTriangleMarks.size() + 16;
+	for( size_t step = 0; step < maxSteps; ++step ) {
+		int32_t first = 3 * t;
+		int32_t next = -1;
+		// rotating the first edge tested keeps the walk from cycling on degenerate input
+		for( int i = 0; i < 3; ++i ) {
+			int32_t e = first + ( i + step ) % 3;
+			if( orient( mPositions[mTriVertices[e]], mPositions[mTriVertices[nextEdge( e )]], p ) < 0 ) {
+				next = mHalfEdges[e];
+				break;
+			}
+		}
+		if( next == -1 ) {
+			for( int i = 0; i < 3; ++i ) {
+				int32_t e = first + i;
+				if( orient( mPositions[mTriVertices[e]], mPositions[mTriVertices[nextEdge( e )]], p ) < 0 )
+					return -1;
+			}
+			return t;
+		}
+		t = next / 3;
+	}
+
+	// the walk failed to converge; fall back to testing every triangle
+	for( int32_t e = 0; e < (int32_t)mTriVertices.size(); e += 3 ) {
+		if( mTriVertices[e] >= 0 && orient( mPositions[mTriVertices[e]], mPositions[mTriVertices[e+1]], p ) >= 0
+				&& orient( mPositions[mTriVertices[e+1]], mPositions[mTriVertices[e+2]], p ) >= 0
+				&& orient( mPositions[mTriVertices[e+2]], mPositions[mTriVertices[e]], p ) >= 0 )
+			return e / 3;
+	}
+	return -1;
+}
+
+/* The vertices of the enclosing triangle are treated as infinitely far away, each in its own direction, so that they never
+	affect the triangulation of the actual points: the circumcircle of a triangle with one such vertex becomes the open half-plane
+	left of its finite edge, and with two such vertices the half-plane through its finite vertex facing away from the enclosing triangle. */
+bool DynamicDelaunay::inCircle( int32_t a, int32_t b, int32_t c, const Vec2d &p, bool pIsSuper ) const
+{
+	int numSuper = ( a < NUM_SUPER_VERTICES ) + ( b < NUM_SUPER_VERTICES ) + ( c < NUM_SUPER_VERTICES );
+	if( numSuper == 0 ) {
+		if( pIsSuper )
+			return false;
+		return inCircleDet( mPositions[a], mPositions[b], mPositions[c], p ) > 0;
+	}
+	else if( numSuper == 1 ) {
+		while( c >= NUM_SUPER_VERTICES ) {
+			int32_t t = a; a = b; b = c; c = t;
+		}
+		double o = orient( mPositions[a], mPositions[b], p );
+		if( o != 0 )
+			return o > 0;
+		// on the line through a and b, inside only between them
+		return ( p - mPositions[a] ).dot( mPositions[b] - mPositions[a] ) > 0 && ( p - mPositions[b] ).dot( mPositions[a] - mPositions[b] ) > 0;
+	}
+	else if( numSuper == 2 ) {
+		while( a < NUM_SUPER_VERTICES ) {
+			int32_t t = a; a = b; b = c; c = t;
+		}
+		Vec2d edge = mPositions[c] - mPositions[b];
+		return Vec2d( edge.y, -edge.x ).dot( p - mPositions[a] ) > 0;
+	}
+	else
+		return true;
+}
+
+// Bowyer-Watson insertion: removes every triangle whose circumcircle contains v and connects v to the boundary of the resulting cavity
+bool DynamicDelaunay::insertVertex( int32_t v )
+{
+	const Vec2d p = mPositions[v];
+	int32_t t = locate( p );
+	if( t < 0 )
+		return false;
+	for( int i = 0; i < 3; ++i ) {
+		if( mPositions[mTriVertices[3*t+i]] == p )
+			return false;
+	}
+
+	++mMarkStamp;
+	mCavity.clear();
+	mBoundary.clear();
+	mStack.clear();
+	mTriangleMarks[t] = mMarkStamp;
+	mStack.push_back( t );
+	while( ! mStack.empty() ) {
+		int32_t c = mStack.back();
+		mStack.pop_back();
+		mCavity.push_back( c );
+		for( int i = 0; i < 3; ++i ) {
+			int32_t e = 3 * c + i;
+			int32_t twin = mHalfEdges[e];
+			if( twin < 0 ) {
+				mBoundary.push_back( e );
+				continue;
+			}
+			int32_t n = twin / 3;
+			if( mTriangleMarks[n] == mMarkStamp )
+				continue;
+			if( inCircle( mTriVertices[3*n], mTriVertices[3*n+1], mTriVertices[3*n+2], p, false ) ) {
+				mTriangleMarks[n] = mMarkStamp;
+				mStack.push_back( n );
+			}
+			else
+				mBoundary.push_back( e );
+		}
+	}
+
+	// gather the boundary before the cavity's triangles are recycled; mStack holds origin, destination and outer half-edge
+	for( size_t b = 0; b < mBoundary.size(); ++b ) {
+		int32_t e = mBoundary[b];
+		mStack.push_back( mTriVertices[e] );
+		mStack.push_back( mTriVertices[nextEdge( e )] );
+		mStack.push_back( mHalfEdges[e] );
+	}
+	for( size_t c = 0; c < mCavity.size(); ++c )
+		freeTriangle( mCavity[c] );
+
+	if( mVertexTriangle.size() < mPositions.size() )
+		mVertexTriangle.resize( mPositions.size() );
+	for( size_t b = 0; b < mStack.size(); b += 3 ) {
+		int32_t nt = allocateTriangle();
+		int32_t e = 3 * nt;
+		mTriVertices[e] = mStack[b];
+		mTriVertices[e+1] = mStack[b+1];
+		mTriVertices[e+2] = v;
+		link( e, mStack[b+2] );
+		mVertexTriangle[mStack[b]] = nt;
+		mVertexEdge[mStack[b]] = e;
+		mLastTriangle = nt;
+	}
+	// each new triangle a, b, v shares its edge b-v with the new triangle starting at b
+	for( size_t b = 0; b < mStack.size(); b += 3 ) {
+		int32_t e = 3 * mVertexTriangle[mStack[b]];
+		link( e + 1, 3 * mVertexTriangle[mStack[b+1]] + 2 );
+	}
+	mVertexEdge[v] = 3 * mLastTriangle + 2;
+	mStack.clear();
+
+	return true;
+}
+
+// Removes v and fills the star-shaped hole around it by repeatedly cutting off ears whose circumcircles contain no other vertex of the hole
+void DynamicDelaunay::removeVertex( int32_t v )
+{
+	mPolygon.clear();
+	mPolygonOuter.clear();
+	mCavity.clear();
+	int32_t start = mVertexEdge[v];
+	int32_t e = start;
+	do {
+		int32_t en = nextEdge( e );
+		mPolygon.push_back( mTriVertices[en] );
+		mPolygonOuter.push_back( mHalfEdges[en] );
+		mCavity.push_back( e / 3 );
+		e = mHalfEdges[prevEdge( e )];
+	} while( e != start );
+
+	for( size_t c = 0; c < mCavity.size(); ++c )
+		freeTriangle( mCavity[c] );
+	mVertexEdge[v] = -1;
+
+	mStack.clear();
+	while( mPolygon.size() >= 3 ) {
+		size_t n = mPolygon.size();
+		size_t ear = n;
+		if( n > 3 ) {
+			size_t firstConvex = n;
+			for( size_t i = 0; i < n && ear == n; ++i ) {
+				int32_t a = mPolygon[( i + n - 1 ) % n], b = mPolygon[i], c = mPolygon[( i + 1 ) % n];
+				if( orient( mPositions[a], mPositions[b], mPositions[c] ) <= 0 )
+					continue;
+				if( firstConvex == n )
+					firstConvex = i;
+				bool empty = true;
+				for( size_t j = 0; j < n - 3 && empty; ++j ) {
+					int32_t d = mPolygon[( i + 2 + j ) % n];
+					empty = ! inCircle( a, b, c, mPositions[d], d < NUM_SUPER_VERTICES );
+				}
+				if( empty )
+					ear = i;
+			}
+			// only reachable through round-off; any convex ear will do, as the flips below repair the result
+			if( ear == n )
+				ear = ( firstConvex < n ) ? firstConvex : 0;
+		}
+		else
+			ear = 1;
+
+		size_t prev = ( ear + n - 1 ) % n, next = ( ear + 1 ) % n;
+		int32_t t = allocateTriangle();
+		int32_t te = 3 * t;
+		mTriVertices[te] = mPolygon[prev];
+		mTriVertices[te+1] = mPolygon[ear];
+		mTriVertices[te+2] = mPolygon[next];
+		link( te, mPolygonOuter[prev] );
+		link( te + 1, mPolygonOuter[ear] );
+		mHalfEdges[te+2] = -1;
+		for( int i = 0; i < 3; ++i )
+			mVertexEdge[mTriVertices[te+i]] = te + i;
+		mLastTriangle = t;
+
+		if( n == 3 ) {
+			link( te + 2, mPolygonOuter[next] );
+			break;
+		}
+		// the ear's third edge becomes the edge from prev to next of the remaining polygon
+		mPolygonOuter[prev] = te + 2;
+		mPolygon.erase( mPolygon.begin() + ear );
+		mPolygonOuter.erase( mPolygonOuter.begin() + ear );
+		mStack.push_back( te + 2 );
+	}
+
+	legalize();
+}
+
+// Moves v to pos if none of its triangles fold over, then restores the Delaunay property with edge flips. Returns false if v must be reinserted instead.
+bool DynamicDelaunay::moveVertexInPlace( int32_t v, const Vec2d &pos )
+{
+	int32_t start = mVertexEdge[v];
+	int32_t e = start;
+	do {
+		int32_t en = nextEdge( e );
+		if( orient( pos, mPositions[mTriVertices[en]], mPositions[mTriVertices[nextEdge( en )]] ) <= 0 )
+			return false;
+		e = mHalfEdges[prevEdge( e )];
+	} while( e != start );
+
+	mPositions[v] = pos;
+	mStack.clear();
+	e = start;
+	do {
+		mStack.push_back( e );
+		mStack.push_back( nextEdge( e ) );
+		e = mHalfEdges[prevEdge( e )];
+	} while( e != start );
+	legalize();
+	return true;
+}
+
+// Flips every non-Delaunay edge reachable from the half-edges in mStack
+void DynamicDelaunay::legalize()
+{
+	size_t maxFlips = 64 + 16 * mStack.size();
+	for( size_t flips = 0; ! mStack.empty() && flips < maxFlips; ) {
+		int32_t e = mStack.back();
+		mStack.pop_back();
+		int32_t f = mHalfEdges[e];
+		if( f < 0 )
+			continue;
+
+		int32_t e1 = nextEdge( e ), e2 = prevEdge( e );
+		int32_t f1 = nextEdge( f ), f2 = prevEdge( f );
+		int32_t a = mTriVertices[e], b = mTriVertices[e1], c = mTriVertices[e2], d = mTriVertices[f2];
+		if( ! inCircle( a, b, c, mPositions[d], d < NUM_SUPER_VERTICES ) )
+			continue;
+		if( orient( mPositions[c], mPositions[a], mPositions[d] ) <= 0 || orient( mPositions[d], mPositions[b], mPositions[c] ) <= 0 )
+			continue;
+
+		// triangles a, b, c and b, a, d become c, a, d and d, b, c
+		int32_t outerBC = mHalfEdges[e1], outerCA = mHalfEdges[e2], outerAD = mHalfEdges[f1], outerDB = mHalfEdges[f2];
+		mTriVertices[e] = c; mTriVertices[e1] = a; mTriVertices[e2] = d;
+		mTriVertices[f] = d; mTriVertices[f1] = b; mTriVertices[f2] = c;
+		link( e, outerCA );
+		link( e1, outerAD );
+		link( e2, f2 );
+		link( f, outerDB );
+		link( f1, outerBC );
+		mVertexEdge[a] = e1;
+		mVertexEdge[b] = f1;
+		mVertexEdge[c] = e;
+		mVertexEdge[d] = f;
+		mLastTriangle = e / 3;
+
+		mStack.push_back( e );
+		mStack.push_back( e1 );
+		mStack.push_back( f );
+		mStack.push_back( f1 );
+		++flips;
+	}
+	mStack.clear();
+}
+
+} // namespace cinder
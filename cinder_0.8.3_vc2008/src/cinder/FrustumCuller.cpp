@@ -0,0 +1,296 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/FrustumCuller.h"
+#include "cinder/BatchMath.h"
+#include "cinder/Thread.h"
+
+#include <algorithm>
+
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+#	include <xmmintrin.h>
+#endif
+
+namespace cinder {
+
+namespace {
+
+// visibility mask words handed to each task by a parallel cull, so each task covers 32768 volumes
+const size_t WORDS_PER_TASK = 1024;
+
+typedef const float (*PlaneArrays)[6];
+
+struct SphereVolumes {
+	SphereVolumes( const float *x, const float *y, const float *z, const float *radius )
+		: mX( x ), mY( y ), mZ( z ), mRadius( radius )
+	{}
+
+	// mirrors Frustumf::intersects( center, radius )
+	bool outside( PlaneArrays planes, int p, size_t i ) const
+	{
+		return planes[0][p] * mX[i] + planes[1][p] * mY[i] + planes[2][p] * mZ[i] - planes[3][p] < -mRadius[i];
+	}
+
+	const float		*mX, *mY, *mZ, *mRadius;
+};
+
+struct BoxVolumes {
+	BoxVolumes( const float *minX, const float *minY, const float *minZ, const float *maxX, const float *maxY, const float *maxZ )
+		: mMinX( minX ), mMinY( minY ), mMinZ( minZ ), mMaxX( maxX ), mMaxY( maxY ), mMaxZ( maxZ )
+	{}
+
+	// mirrors Frustumf::intersects( box ), including AxisAlignedBox3f::getPositive()'s min + size
+	bool outside( PlaneArrays planes, int p, size_t i ) const
+	{
+		float x = ( planes[0][p] > 0 ) ? mMinX[i] + ( mMaxX[i] - mMinX[i] ) : mMinX[i];
+		float y = ( planes[1][p] > 0 ) ? mMinY[i] + ( mMaxY[i] - mMinY[i] ) : mMinY[i];
+		float z = ( planes[2][p] > 0 ) ? mMinZ[i] + ( mMaxZ[i] - mMinZ[i] ) : mMinZ[i];
+		return planes[0][p] * x + planes[1][p] * y + planes[2][p] * z - planes[3][p] < 0;
+	}
+
+	const float		*mMinX, *mMinY, *mMinZ, *mMaxX, *mMaxY, *mMaxZ;
+};
+
+// Kernels set the bits of the visible volumes in [begin, end) and leave the others alone; the caller clears the mask words first.
+// \a begin is always a multiple of 32. \a lastPlane may be NULL.
+template<typename Volumes>
+void cullScalar( PlaneArrays planes, const Volumes &volumes, size_t begin, size_t end, uint32_t *visible, uint8_t *lastPlane )
+{
+	for( size_t i = begin; i < end; ++i ) {
+		int cached = lastPlane ? lastPlane[i] : -1;
+		if( cached >= 0 && volumes.outside( planes, cached, i ) )
+			continue;
+		int rejected = -1;
+		for( int p = 0; p < 6 && rejected < 0; ++p ) {
+			if( p != cached && volumes.outside( planes, p, i ) )
+				rejected = p;
+		}
+		if( rejected < 0 )
+			visible[i / 32] |= 1u << ( i % 32 );
+		else if( lastPlane )
+			lastPlane[i] = (uint8_t)rejected;
+	}
+}
+
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+
+// one plane per lane; the pos* masks are set where the normal component is positive, for picking a box's positive vertex
+struct PlaneX4 {
+	PlaneX4() {}
+	PlaneX4( PlaneArrays planes, int p0, int p1, int p2, int p3 )
+	{
+		nx = _mm_setr_ps( planes[0][p0], planes[0][p1], planes[0][p2], planes[0][p3] );
+		ny = _mm_setr_ps( planes[1][p0], planes[1][p1], planes[1][p2], planes[1][p3] );
+		nz = _mm_setr_ps( planes[2][p0], planes[2][p1], planes[2][p2], planes[2][p3] );
+		d = _mm_setr_ps( planes[3][p0], planes[3][p1], planes[3][p2], planes[3][p3] );
+		const __m128 zero = _mm_setzero_ps();
+		posX = _mm_cmpgt_ps( nx, zero );
+		posY = _mm_cmpgt_ps( ny, zero );
+		posZ = _mm_cmpgt_ps( nz, zero );
+	}
+
+	__m128	nx, ny, nz, d;
+	__m128	posX, posY, posZ;
+};
+
+inline __m128 select( __m128 mask, __m128 a, __m128 b )
+{
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+
+struct SphereX4 {
+	typedef SphereVolumes	Volumes;
+
+	void load( const SphereVolumes &v, size_t i )
+	{
+		x = _mm_loadu_ps( v.mX + i );
+		y = _mm_loadu_ps( v.mY + i );
+		z = _mm_loadu_ps( v.mZ + i );
+		negRadius = _mm_xor_ps( _mm_loadu_ps( v.mRadius + i ), _mm_set1_ps( -0.0f ) );
+	}
+
+	__m128 outside( const PlaneX4 &p ) const
+	{
+		__m128 dist = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( p.nx, x ), _mm_mul_ps( p.ny, y ) ), _mm_mul_ps( p.nz, z ) ), p.d );
+		return _mm_cmplt_ps( dist, negRadius );
+	}
+
+	__m128	x, y, z, negRadius;
+};
+
+struct BoxX4 {
+	typedef BoxVolumes		Volumes;
+
+	void load( const BoxVolumes &v, size_t i )
+	{
+		minX = _mm_loadu_ps( v.mMinX + i );
+		minY = _mm_loadu_ps( v.mMinY + i );
+		minZ = _mm_loadu_ps( v.mMinZ + i );
+		maxX = _mm_add_ps( minX, _mm_sub_ps( _mm_loadu_ps( v.mMaxX + i ), minX ) );
+		maxY = _mm_add_ps( minY, _mm_sub_ps( _mm_loadu_ps( v.mMaxY + i ), minY ) );
+		maxZ = _mm_add_ps( minZ, _mm_sub_ps( _mm_loadu_ps( v.mMaxZ + i ), minZ ) );
+	}
+
+	__m128 outside( const PlaneX4 &p ) const
+	{
+		__m128 x = select( p.posX, maxX, minX ), y = select( p.posY, maxY, minY ), z = select( p.posZ, maxZ, minZ );
+		__m128 dist = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( p.nx, x ), _mm_mul_ps( p.ny, y ) ), _mm_mul_ps( p.nz, z ) ), p.d );
+		return _mm_cmplt_ps( dist, _mm_setzero_ps() );
+	}
+
+	// max is stored as min + size, as AxisAlignedBox3f::getPositive() computes it
+	__m128	minX, minY, minZ, maxX, maxY, maxZ;
+};
+
+// Tests four volumes at a time. Without \a lastPlane all six planes are tested branch-free; with it, each lane's cached plane is tested first
+// and the group is skipped when all four are rejected, otherwise the six planes are tested in order as cullScalar() does.
+template<typename GroupX4>
+void cullSse( PlaneArrays planes, const typename GroupX4::Volumes &volumes, size_t begin, size_t end, uint32_t *visible, uint8_t *lastPlane )
+{
+	PlaneX4 splat[6];
+	for( int p = 0; p < 6; ++p )
+		splat[p] = PlaneX4( planes, p, p, p, p );
+
+	const size_t simdEnd = begin + ( ( end - begin ) & ~(size_t)3 );
+	GroupX4 group;
+	for( size_t i = begin; i < simdEnd; i += 4 ) {
+		group.load( volumes, i );
+		int outBits;
+		if( lastPlane ) {
+			const uint8_t *cached = lastPlane + i;
+			outBits = _mm_movemask_ps( group.outside( PlaneX4( planes, cached[0], cached[1], cached[2], cached[3] ) ) );
+			for( int p = 0; p < 6 && outBits != 0xF; ++p ) {
+				int newlyOut = _mm_movemask_ps( group.outside( splat[p] ) ) & ~outBits;
+				outBits |= newlyOut;
+				for( int lane = 0; newlyOut; ++lane, newlyOut >>= 1 ) {
+					if( newlyOut & 1 )
+						lastPlane[i + lane] = (uint8_t)p;
+				}
+			}
+		}
+		else {
+			__m128 out = group.outside( splat[0] );
+			for( int p = 1; p < 6; ++p )
+				out = _mm_or_ps( out, group.outside( splat[p] ) );
+			outBits = _mm_movemask_ps( out );
+		}
+		visible[i / 32] |= (uint32_t)( ~outBits & 0xF ) << ( i % 32 );
+	}
+	cullScalar( planes, volumes, simdEnd, end, visible, lastPlane );
+}
+
+#endif // defined( CINDER_MSW ) || defined( CINDER_MAC )
+
+template<typename Volumes>
+struct CullRange {
+	typedef void (*KernelFn)( PlaneArrays planes, const Volumes &volumes, size_t begin, size_t end, uint32_t *visible, uint8_t *lastPlane );
+
+	CullRange( KernelFn kernel, PlaneArrays planes, const Volumes *volumes, size_t count, uint32_t *visible, uint8_t *lastPlane )
+		: mKernel( kernel ), mPlanes( planes ), mVolumes( volumes ), mCount( count ), mVisible( visible ), mLastPlane( lastPlane )
+	{}
+
+	// works in whole mask words so that concurrent ranges never share one
+	void operator()( size_t beginWord, size_t endWord ) const
+	{
+		std::fill( mVisible + beginWord, mVisible + endWord, 0 );
+		mKernel( mPlanes, *mVolumes, beginWord * 32, std::min( endWord * 32, mCount ), mVisible, mLastPlane );
+	}
+
+	KernelFn		mKernel;
+	PlaneArrays		mPlanes;
+	const Volumes	*mVolumes;
+	size_t			mCount;
+	uint32_t		*mVisible;
+	uint8_t			*mLastPlane;
+};
+
+template<typename Volumes>
+void cull( typename CullRange<Volumes>::KernelFn kernel, PlaneArrays planes, const Volumes &volumes, size_t count, uint32_t *visible, uint8_t *lastPlane, bool parallel )
+{
+	CullRange<Volumes> range( kernel, planes, &volumes, count, visible, lastPlane );
+	size_t numWords = FrustumCuller::getMaskSize( count );
+	if( parallel )
+		parallelFor( numWords, range, WORDS_PER_TASK );
+	else
+		range( 0, numWords );
+}
+
+} // anonymous namespace
+
+FrustumCuller::FrustumCuller()
+{
+	std::fill( &mPlanes[0][0], &mPlanes[0][0] + 4 * 6, 0.0f );
+}
+
+FrustumCuller::FrustumCuller( const Frustumf &frustum )
+{
+	set( frustum );
+}
+
+void FrustumCuller::set( const Frustumf &frustum )
+{
+	for( int p = 0; p < 6; ++p ) {
+		const Planef &plane = frustum.getPlane( p );
+		mPlanes[0][p] = plane.getNormal().x;
+		mPlanes[1][p] = plane.getNormal().y;
+		mPlanes[2][p] = plane.getNormal().z;
+		mPlanes[3][p] = plane.getDistance();
+	}
+}
+
+void FrustumCuller::cullSpheres( const float *centerX, const float *centerY, const float *centerZ, const float *radius, size_t count,
+									uint32_t *visible, uint8_t *lastPlane, bool parallel ) const
+{
+	CullRange<SphereVolumes>::KernelFn kernel = &cullScalar<SphereVolumes>;
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+	if( batch::isSimdEnabled() )
+		kernel = &cullSse<SphereX4>;
+#endif
+	cull( kernel, mPlanes, SphereVolumes( centerX, centerY, centerZ, radius ), count, visible, lastPlane, parallel );
+}
+
+void FrustumCuller::cullBoxes( const float *minX, const float *minY, const float *minZ, const float *maxX, const float *maxY, const float *maxZ, size_t count,
+								uint32_t *visible, uint8_t *lastPlane, bool parallel ) const
+{
+	CullRange<BoxVolumes>::KernelFn kernel = &cullScalar<BoxVolumes>;
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+	if( batch::isSimdEnabled() )
+		kernel = &cullSse<BoxX4>;
+#endif
+	cull( kernel, mPlanes, BoxVolumes( minX, minY, minZ, maxX, maxY, maxZ ), count, visible, lastPlane, parallel );
+}
+
+size_t FrustumCuller::countVisible( const uint32_t *visible, size_t count )
+{
+	size_t result = 0;
+	for( size_t w = 0; w < getMaskSize( count ); ++w ) {
+		uint32_t bits = visible[w];
+		if( ( w + 1 ) * 32 > count )
+			bits &= ( 1u << ( count % 32 ) ) - 1;
+		bits = bits - ( ( bits >> 1 ) & 0x55555555 );
+		bits = ( bits & 0x33333333 ) + ( ( bits >> 2 ) & 0x33333333 );
+		result += ( ( ( bits + ( bits >> 4 ) ) & 0x0F0F0F0F ) * 0x01010101 ) >> 24;
+	}
+	return result;
+}
+
+} // namespace cinder
@@ -0,0 +1,715 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/JsonDoc.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+using std::string;
+using std::vector;
+
+namespace cinder {
+
+namespace {
+
+const int		MAX_DEPTH = 512;
+const size_t	MAX_NUMBER_LENGTH = 64;
+
+inline bool isWhitespace( char c )
+{
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+inline bool isDigit( char c )
+{
+	return c >= '0' && c <= '9';
+}
+
+inline char toLowerAscii( char c )
+{
+	return ( c >= 'A' && c <= 'Z' ) ? char( c - 'A' + 'a' ) : c;
+}
+
+int hexValue( char c )
+{
+	if( c >= '0' && c <= '9' ) return c - '0';
+	if( c >= 'a' && c <= 'f' ) return c - 'a' + 10;
+	if( c >= 'A' && c <= 'F' ) return c - 'A' + 10;
+	return -1;
+}
+
+uint32_t parseHex4( const char *s, const char *end )
+{
+	if( end - s < 4 )
+		return 0xFFFD;
+	uint32_t result = 0;
+	for( int i = 0; i < 4; ++i ) {
+		int v = hexValue( s[i] );
+		if( v < 0 )
+			return 0xFFFD;
+		result = ( result << 4 ) | v;
+	}
+	return result;
+}
+
+void appendUtf8( string *out, uint32_t cp )
+{
+	if( cp < 0x80 )
+		out->push_back( char( cp ) );
+	else if( cp < 0x800 ) {
+		out->push_back( char( 0xC0 | ( cp >> 6 ) ) );
+		out->push_back( char( 0x80 | ( cp & 0x3F ) ) );
+	}
+	else if( cp < 0x10000 ) {
+		out->push_back( char( 0xE0 | ( cp >> 12 ) ) );
+		out->push_back( char( 0x80 | ( ( cp >> 6 ) & 0x3F ) ) );
+		out->push_back( char( 0x80 | ( cp & 0x3F ) ) );
+	}
+	else {
+		out->push_back( char( 0xF0 | ( cp >> 18 ) ) );
+		out->push_back( char( 0x80 | ( ( cp >> 12 ) & 0x3F ) ) );
+		out->push_back( char( 0x80 | ( ( cp >> 6 ) & 0x3F ) ) );
+		out->push_back( char( 0x80 | ( cp & 0x3F ) ) );
+	}
+}
+
+// Decodes the JSON escape sequences in the string body [s,s+length)
+string unescape( const char *s, size_t length )
+{
+	string result;
+	result.reserve( length );
+	const char *end = s + length;
+	while( s < end ) {
+		if( *s != '\\' || s + 1 >= end ) {
+			result.push_back( *s++ );
+			continue;
+		}
+		++s;
+		switch( *s++ ) {
+			case '"': result.push_back( '"' ); break;
+			case '\\': result.push_back( '\\' ); break;
+			case '/': result.push_back( '/' ); break;
+			case 'b': result.push_back( '\b' ); break;
+			case 'f': result.push_back( '\f' ); break;
+			case 'n': result.push_back( '\n' ); break;
+			case 'r': result.push_back( '\r' ); break;
+			case 't': result.push_back( '\t' ); break;
+			case 'u': {
+				uint32_t cp = parseHex4( s, end );
+				s += std::min<ptrdiff_t>( 4, end - s );
+				if( cp >= 0xD800 && cp < 0xDC00 && end - s >= 6 && s[0] == '\\' && s[1] == 'u' ) {
+					uint32_t low = parseHex4( s + 2, end );
+					if( low >= 0xDC00 && low < 0xE000 ) {
+						cp = 0x10000 + ( ( cp - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+						s += 6;
+					}
+				}
+				appendUtf8( &result, cp );
+			}
+			break;
+			default:
+				result.push_back( s[-1] );
+		}
+	}
+	return result;
+}
+
+// Compares a path component to a raw key, decoding the key first only when it contains escapes
+bool keysMatch( const char *key, size_t keyLength, bool keyEscaped, const string &component, bool caseSensitive )
+{
+	string decoded;
+	if( keyEscaped ) {
+		decoded = unescape( key, keyLength );
+		key = decoded.data();
+		keyLength = decoded.size();
+	}
+	if( keyLength != component.size() )
+		return false;
+	if( caseSensitive )
+		return std::memcmp( key, component.data(), keyLength ) == 0;
+	for( size_t i = 0; i < keyLength; ++i )
+		if( toLowerAscii( key[i] ) != toLowerAscii( component[i] ) )
+			return false;
+	return true;
+}
+
+bool isIndex( const string &s )
+{
+	if( s.empty() )
+		return false;
+	for( size_t i = 0; i < s.size(); ++i )
+		if( ! isDigit( s[i] ) )
+			return false;
+	return true;
+}
+
+} // anonymous namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// JsonDoc::Parser
+
+class JsonDoc::Parser {
+  public:
+	Parser( const char *source, size_t length, vector<NodeData> *nodes )
+		: mBegin( source ), mPos( source ), mEnd( source + length ), mNodes( nodes )
+	{}
+
+	void parse()
+	{
+		// skip a UTF-8 byte order mark
+		if( mEnd - mPos >= 3 && (uint8_t)mPos[0] == 0xEF && (uint8_t)mPos[1] == 0xBB && (uint8_t)mPos[2] == 0xBF )
+			mPos += 3;
+
+		// every value but the first in a container follows a comma, so this bounds the node count from above
+		size_t maxNodes = 1;
+		for( const char *c = mPos; c < mEnd; ++c )
+			maxNodes += ( *c == ',' ) | ( *c == '[' ) | ( *c == '{' );
+		mNodes->clear();
+		mNodes->reserve( maxNodes );
+
+		skipWhitespace();
+		parseValue( 0, 0, 0, 0, 0 );
+		skipWhitespace();
+		// tolerate the null terminator some sources carry
+		while( mPos < mEnd && *mPos == 0 )
+			++mPos;
+		if( mPos != mEnd )
+			error( "Unexpected data after the root value" );
+	}
+
+  private:
+	void skipWhitespace()
+	{
+		while( mPos < mEnd && isWhitespace( *mPos ) )
+			++mPos;
+	}
+
+	char peek() const
+	{
+		return mPos < mEnd ? *mPos : 0;
+	}
+
+	void expect( char c, const char *message )
+	{
+		if( peek() != c )
+			error( message );
+		++mPos;
+	}
+
+	void error( const string &message ) const
+	{
+		int line = 1, column = 1;
+		for( const char *c = mBegin; c < mPos && c < mEnd; ++c ) {
+			if( *c == '\n' ) {
+				++line;
+				column = 1;
+			}
+			else
+				++column;
+		}
+		char location[64];
+		sprintf( location, " at line %d, column %d", line, column );
+		throw JsonDoc::ExcJsonParserError( message + location );
+	}
+
+	// Scans the string starting at the opening quote, returning the offset and length of its body
+	void parseString( uint32_t *offset, uint32_t *length, bool *escaped )
+	{
+		++mPos;
+		const char *start = mPos;
+		*escaped = false;
+		while( mPos < mEnd && *mPos != '"' ) {
+			if( *mPos == '\\' ) {
+				*escaped = true;
+				++mPos;
+			}
+			++mPos;
+		}
+		if( mPos >= mEnd )
+			error( "Unterminated string" );
+		*offset = uint32_t( start - mBegin );
+		*length = uint32_t( mPos - start );
+		++mPos;
+	}
+
+	JsonTree::ValueType parseNumber()
+	{
+		bool negative = false, isDouble = false;
+		if( peek() == '-' ) {
+			negative = true;
+			++mPos;
+		}
+		if( ! isDigit( peek() ) )
+			error( "Invalid number" );
+		uint64_t value = 0;
+		bool overflow = false;
+		while( isDigit( peek() ) ) {
+			uint64_t next = value * 10 + uint64_t( *mPos - '0' );
+			overflow = overflow || next / 10 != value;
+			value = next;
+			++mPos;
+		}
+		if( peek() == '.' ) {
+			isDouble = true;
+			++mPos;
+			if( ! isDigit( peek() ) )
+				error( "Invalid number" );
+			while( isDigit( peek() ) )
+				++mPos;
+		}
+		if( peek() == 'e' || peek() == 'E' ) {
+			isDouble = true;
+			++mPos;
+			if( peek() == '+' || peek() == '-' )
+				++mPos;
+			if( ! isDigit( peek() ) )
+				error( "Invalid number" );
+			while( isDigit( peek() ) )
+				++mPos;
+		}
+
+		// classify the same way JsonTree does: integers which don't fit 64 bits become doubles, and
+		// non-negative integers beyond the int range are unsigned
+		if( isDouble || overflow || ( negative && value > uint64_t( 1 ) << 63 ) )
+			return JsonTree::VALUE_DOUBLE;
+		if( negative || value <= 0x7FFFFFFF )
+			return JsonTree::VALUE_INT;
+		return JsonTree::VALUE_UINT;
+	}
+
+	void parseLiteral( const char *literal, size_t length )
+	{
+		if( size_t( mEnd - mPos ) < length || std::memcmp( mPos, literal, length ) != 0 )
+			error( "Invalid value" );
+		mPos += length;
+	}
+
+	void parseValue( uint32_t parent, uint32_t keyOffset, uint32_t keyLength, uint8_t keyFlags, int depth )
+	{
+		if( depth > MAX_DEPTH )
+			error( "Maximum nesting depth exceeded" );
+
+		uint32_t index = uint32_t( mNodes->size() );
+		mNodes->push_back( NodeData() );
+		{
+			NodeData &node = mNodes->back();
+			node.mKeyOffset = keyOffset;
+			node.mKeyLength = keyLength;
+			node.mValueOffset = uint32_t( mPos - mBegin );
+			node.mValueLength = 0;
+			node.mParent = parent;
+			node.mNumChildren = 0;
+			node.mNodeType = JsonTree::NODE_VALUE;
+			node.mValueType = JsonTree::VALUE_STRING;
+			node.mFlags = keyFlags;
+		}
+
+		// nodes are re-fetched by index rather than held by reference across the recursive calls below
+		switch( peek() ) {
+			case '{': {
+				(*mNodes)[index].mNodeType = JsonTree::NODE_OBJECT;
+				++mPos;
+				skipWhitespace();
+				uint32_t numChildren = 0;
+				if( peek() == '}' )
+					++mPos;
+				else {
+					for( ;; ) {
+						skipWhitespace();
+						if( peek() != '"' )
+							error( "Expected a member name" );
+						uint32_t childKeyOffset, childKeyLength;
+						bool childKeyEscaped;
+						parseString( &childKeyOffset, &childKeyLength, &childKeyEscaped );
+						skipWhitespace();
+						expect( ':', "Expected ':' after member name" );
+						skipWhitespace();
+						parseValue( index, childKeyOffset, childKeyLength, childKeyEscaped ? FLAG_KEY_ESCAPED : 0, depth + 1 );
+						++numChildren;
+						skipWhitespace();
+						if( peek() == ',' ) {
+							++mPos;
+							continue;
+						}
+						expect( '}', "Expected ',' or '}' in object" );
+						break;
+					}
+				}
+				(*mNodes)[index].mNumChildren = numChildren;
+			}
+			break;
+			case '[': {
+				(*mNodes)[index].mNodeType = JsonTree::NODE_ARRAY;
+				++mPos;
+				skipWhitespace();
+				uint32_t numChildren = 0;
+				if( peek() == ']' )
+					++mPos;
+				else {
+					for( ;; ) {
+						skipWhitespace();
+						parseValue( index, 0, 0, 0, depth + 1 );
+						++numChildren;
+						skipWhitespace();
+						if( peek() == ',' ) {
+							++mPos;
+							continue;
+						}
+						expect( ']', "Expected ',' or ']' in array" );
+						break;
+					}
+				}
+				(*mNodes)[index].mNumChildren = numChildren;
+			}
+			break;
+			case '"': {
+				uint32_t offset, length;
+				bool escaped;
+				parseString( &offset, &length, &escaped );
+				NodeData &node = (*mNodes)[index];
+				node.mValueOffset = offset;
+				node.mValueLength = length;
+				if( escaped )
+					node.mFlags |= FLAG_VALUE_ESCAPED;
+			}
+			break;
+			case 't':
+				parseLiteral( "true", 4 );
+				(*mNodes)[index].mValueType = JsonTree::VALUE_BOOL;
+			break;
+			case 'f':
+				parseLiteral( "false", 5 );
+				(*mNodes)[index].mValueType = JsonTree::VALUE_BOOL;
+			break;
+			case 'n':
+				parseLiteral( "null", 4 );
+				(*mNodes)[index].mNodeType = JsonTree::NODE_NULL;
+			break;
+			default:
+				if( peek() == '-' || isDigit( peek() ) )
+					(*mNodes)[index].mValueType = parseNumber();
+				else
+					error( "Expected a value" );
+		}
+
+		NodeData &node = (*mNodes)[index];
+		if( node.mNodeType != JsonTree::NODE_VALUE || node.mValueType != JsonTree::VALUE_STRING )
+			node.mValueLength = uint32_t( mPos - mBegin ) - node.mValueOffset;
+		node.mNext = uint32_t( mNodes->size() );
+	}
+
+	const char			*mBegin, *mPos, *mEnd;
+	vector<NodeData>	*mNodes;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// JsonDoc
+
+JsonDoc::JsonDoc( DataSourceRef dataSource )
+	: mBuffer( dataSource->getBuffer() )
+{
+	parse();
+}
+
+JsonDoc::JsonDoc( const Buffer &buffer )
+	: mBuffer( buffer )
+{
+	parse();
+}
+
+JsonDoc::JsonDoc( const std::string &jsonString )
+	: mBuffer( jsonString.size() )
+{
+	mBuffer.copyFrom( jsonString.data(), jsonString.size() );
+	parse();
+}
+
+void JsonDoc::parse()
+{
+	mSource = static_cast<const char*>( mBuffer.getData() );
+	mSourceLength = mBuffer.getDataSize();
+	if( mSourceLength >= 0xFFFFFFFF )
+		throw ExcJsonParserError( "Document exceeds 4GB" );
+
+	Parser parser( mSource, mSourceLength, &mNodes );
+	parser.parse();
+}
+
+JsonDoc::Node JsonDoc::getRoot() const
+{
+	return Node( this, 0 );
+}
+
+size_t JsonDoc::getMemoryUsage() const
+{
+	return mSourceLength + mNodes.capacity() * sizeof(NodeData);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// JsonDoc::Node
+
+JsonDoc::Node JsonDoc::Node::getChild( const std::string &relativePath, bool caseSensitive, char separator ) const
+{
+	uint32_t current = mIndex;
+	string component;
+	size_t i = 0;
+	// follows JsonTree's path syntax: components are split at the separator and at '[', while ']' and '\'' are ignored
+	while( i <= relativePath.size() ) {
+		char c = ( i < relativePath.size() ) ? relativePath[i] : separator;
+		++i;
+		if( c == ']' || c == '\'' )
+			continue;
+		if( c != separator && c != '[' ) {
+			component.push_back( c );
+			continue;
+		}
+		if( component.empty() )
+			continue;
+
+		const NodeData &parent = mDoc->getData( current );
+		uint32_t child = current + 1, childIndex = 0;
+		if( isIndex( component ) ) {
+			size_t index = (size_t)std::strtoul( component.c_str(), 0, 10 );
+			for( ; child != parent.mNext && childIndex != index; child = mDoc->getData( child ).mNext )
+				++childIndex;
+		}
+		else {
+			for( ; child != parent.mNext; child = mDoc->getData( child ).mNext ) {
+				const NodeData &data = mDoc->getData( child );
+				if( keysMatch( mDoc->getSource() + data.mKeyOffset, data.mKeyLength, ( data.mFlags & FLAG_KEY_ESCAPED ) != 0, component, caseSensitive ) )
+					break;
+			}
+		}
+		if( child == parent.mNext )
+			throw ExcChildNotFound( *this, relativePath );
+
+		current = child;
+		component.clear();
+	}
+
+	return Node( mDoc, current );
+}
+
+JsonDoc::Node JsonDoc::Node::getChild( size_t index ) const
+{
+	const NodeData &parent = mDoc->getData( mIndex );
+	uint32_t child = mIndex + 1;
+	for( size_t i = 0; i < index && child != parent.mNext; ++i )
+		child = mDoc->getData( child ).mNext;
+	if( child == parent.mNext )
+		throw ExcChildNotFound( *this, toString( index ) );
+	return Node( mDoc, child );
+}
+
+bool JsonDoc::Node::hasChild( const std::string &relativePath, bool caseSensitive, char separator ) const
+{
+	try {
+		getChild( relativePath, caseSensitive, separator );
+		return true;
+	}
+	catch( ExcChildNotFound & ) {
+		return false;
+	}
+}
+
+size_t JsonDoc::Node::getNumChildren() const
+{
+	return mDoc->getData( mIndex ).mNumChildren;
+}
+
+JsonDoc::ConstIter JsonDoc::Node::begin() const
+{
+	return ConstIter( mDoc, mIndex + 1 );
+}
+
+JsonDoc::ConstIter JsonDoc::Node::end() const
+{
+	return ConstIter( mDoc, mDoc->getData( mIndex ).mNext );
+}
+
+JsonDoc::Node::Children JsonDoc::Node::getChildren() const
+{
+	return Children( *this );
+}
+
+JsonDoc::Node JsonDoc::Node::getParent() const
+{
+	if( mIndex == 0 )
+		throw ExcChildNotFound( *this, ".." );
+	return Node( mDoc, mDoc->getData( mIndex ).mParent );
+}
+
+bool JsonDoc::Node::hasParent() const
+{
+	return mIndex != 0;
+}
+
+std::string JsonDoc::Node::getKey() const
+{
+	const NodeData &data = mDoc->getData( mIndex );
+	const char *key = mDoc->getSource() + data.mKeyOffset;
+	if( data.mFlags & FLAG_KEY_ESCAPED )
+		return unescape( key, data.mKeyLength );
+	return string( key, data.mKeyLength );
+}
+
+std::string JsonDoc::Node::getPath( char separator ) const
+{
+	string result;
+	bool prevWasArrayIndex = false;
+	for( uint32_t index = mIndex; ; ) {
+		const NodeData &data = mDoc->getData( index );
+		bool isArrayIndex = false;
+		string name = Node( mDoc, index ).getKey();
+		if( index != 0 && mDoc->getData( data.mParent ).mNodeType == JsonTree::NODE_ARRAY ) {
+			size_t childIndex = 0;
+			for( uint32_t sibling = data.mParent + 1; sibling != index; sibling = mDoc->getData( sibling ).mNext )
+				++childIndex;
+			name = '[' + toString( childIndex ) + ']';
+			isArrayIndex = true;
+		}
+		if( ! prevWasArrayIndex && ! name.empty() && index != mIndex )
+			result = name + separator + result;
+		else if( ! name.empty() )
+			result = name + result;
+		if( index == 0 )
+			break;
+		index = data.mParent;
+		prevWasArrayIndex = isArrayIndex;
+	}
+	return result;
+}
+
+std::string JsonDoc::Node::getValue() const
+{
+	const NodeData &data = mDoc->getData( mIndex );
+	if( data.mNodeType != JsonTree::NODE_VALUE )
+		return string();
+	const char *value = mDoc->getSource() + data.mValueOffset;
+	if( data.mFlags & FLAG_VALUE_ESCAPED )
+		return unescape( value, data.mValueLength );
+	return string( value, data.mValueLength );
+}
+
+const char* JsonDoc::Node::getValueData() const
+{
+	return mDoc->getSource() + mDoc->getData( mIndex ).mValueOffset;
+}
+
+size_t JsonDoc::Node::getValueSize() const
+{
+	return mDoc->getData( mIndex ).mValueLength;
+}
+
+JsonTree::NodeType JsonDoc::Node::getNodeType() const
+{
+	return JsonTree::NodeType( mDoc->getData( mIndex ).mNodeType );
+}
+
+JsonTree::ValueType JsonDoc::Node::getValueType() const
+{
+	return JsonTree::ValueType( mDoc->getData( mIndex ).mValueType );
+}
+
+double JsonDoc::Node::toDouble() const
+{
+	const NodeData &data = mDoc->getData( mIndex );
+	if( data.mNodeType != JsonTree::NODE_VALUE )
+		throw ExcNonConvertible( *this );
+	if( data.mValueType == JsonTree::VALUE_BOOL )
+		return toBool() ? 1.0 : 0.0;
+	if( data.mValueLength >= MAX_NUMBER_LENGTH || ( data.mFlags & FLAG_VALUE_ESCAPED ) ) {
+		try {
+			return fromString<double>( getValue() );
+		} catch( boost::bad_lexical_cast & ) {
+			throw ExcNonConvertible( *this );
+		}
+	}
+
+	// strtod needs a terminated string, and the source buffer is not
+	char number[MAX_NUMBER_LENGTH];
+	std::memcpy( number, mDoc->getSource() + data.mValueOffset, data.mValueLength );
+	number[data.mValueLength] = 0;
+	char *end;
+	double result = std::strtod( number, &end );
+	if( end == number || *end != 0 )
+		throw ExcNonConvertible( *this );
+	return result;
+}
+
+int64_t JsonDoc::Node::toInt() const
+{
+	const NodeData &data = mDoc->getData( mIndex );
+	if( data.mNodeType != JsonTree::NODE_VALUE )
+		throw ExcNonConvertible( *this );
+	if( data.mValueType == JsonTree::VALUE_BOOL )
+		return toBool() ? 1 : 0;
+
+	const char *s = mDoc->getSource() + data.mValueOffset, *end = s + data.mValueLength;
+	bool negative = false;
+	if( s < end && ( *s == '-' || *s == '+' ) )
+		negative = *s++ == '-';
+	if( s == end )
+		throw ExcNonConvertible( *this );
+	uint64_t value = 0;
+	for( ; s < end; ++s ) {
+		if( ! isDigit( *s ) )
+			throw ExcNonConvertible( *this );
+		value = value * 10 + uint64_t( *s - '0' );
+	}
+	return negative ? -int64_t( value ) : int64_t( value );
+}
+
+bool JsonDoc::Node::toBool() const
+{
+	const NodeData &data = mDoc->getData( mIndex );
+	const char *s = mDoc->getSource() + data.mValueOffset;
+	if( data.mNodeType == JsonTree::NODE_VALUE ) {
+		if( ( data.mValueLength == 4 && std::memcmp( s, "true", 4 ) == 0 ) || ( data.mValueLength == 1 && *s == '1' ) )
+			return true;
+		if( ( data.mValueLength == 5 && std::memcmp( s, "false", 5 ) == 0 ) || ( data.mValueLength == 1 && *s == '0' ) )
+			return false;
+	}
+	throw ExcNonConvertible( *this );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+JsonDoc::ExcChildNotFound::ExcChildNotFound( const Node &node, const string &childPath ) throw()
+{
+	sprintf( mMessage, "Could not find child: %s for node: %s", childPath.substr( 0, 1000 ).c_str(), node.getPath().substr( 0, 1000 ).c_str() );
+}
+
+JsonDoc::ExcNonConvertible::ExcNonConvertible( const Node &node ) throw()
+{
+	sprintf( mMessage, "Unable to convert value for node: %s", node.getPath().substr( 0, 2000 ).c_str() );
+}
+
+JsonDoc::ExcJsonParserError::ExcJsonParserError( const string &errorMessage ) throw()
+{
+	sprintf( mMessage, "Unable to parse JSON\n: %s", errorMessage.substr( 0, 2000 ).c_str() );
+}
+
+} // namespace cinder
@@ -0,0 +1,538 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/JsonReader.h"
+#include "cinder/Utilities.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using std::string;
+using std::vector;
+
+namespace cinder {
+
+namespace {
+
+const StreamScanner::Delimiters sStringDelimiters( "\"\\" );
+const StreamScanner::Delimiters sTokenDelimiters( ",]} \t\r\n" );
+const StreamScanner::Delimiters sContainerDelimiters( "\"[]{}" );
+
+int hexValue( int c )
+{
+	if( c >= '0' && c <= '9' ) return c - '0';
+	if( c >= 'a' && c <= 'f' ) return c - 'a' + 10;
+	if( c >= 'A' && c <= 'F' ) return c - 'A' + 10;
+	return -1;
+}
+
+void appendUtf8( string *out, uint32_t cp )
+{
+	if( cp < 0x80 )
+		out->push_back( char( cp ) );
+	else if( cp < 0x800 ) {
+		out->push_back( char( 0xC0 | ( cp >> 6 ) ) );
+		out->push_back( char( 0x80 | ( cp & 0x3F ) ) );
+	}
+	else if( cp < 0x10000 ) {
+		out->push_back( char( 0xE0 | ( cp >> 12 ) ) );
+		out->push_back( char( 0x80 | ( ( cp >> 6 ) & 0x3F ) ) );
+		out->push_back( char( 0x80 | ( cp & 0x3F ) ) );
+	}
+	else {
+		out->push_back( char( 0xF0 | ( cp >> 18 ) ) );
+		out->push_back( char( 0x80 | ( ( cp >> 12 ) & 0x3F ) ) );
+		out->push_back( char( 0x80 | ( ( cp >> 6 ) & 0x3F ) ) );
+		out->push_back( char( 0x80 | ( cp & 0x3F ) ) );
+	}
+}
+
+// Validates a JSON number and classifies it the same way JsonTree does
+bool classifyNumber( const string &s, JsonTree::ValueType *type )
+{
+	size_t i = 0, n = s.size();
+	bool negative = false, isDouble = false;
+	if( i < n && s[i] == '-' ) {
+		negative = true;
+		++i;
+	}
+	if( i == n || s[i] < '0' || s[i] > '9' )
+		return false;
+	uint64_t value = 0;
+	bool overflow = false;
+	for( ; i < n && s[i] >= '0' && s[i] <= '9'; ++i ) {
+		uint64_t next = value * 10 + uint64_t( s[i] - '0' );
+		overflow = overflow || next / 10 != value;
+		value = next;
+	}
+	if( i < n && s[i] == '.' ) {
+		isDouble = true;
+		if( ++i == n || s[i] < '0' || s[i] > '9' )
+			return false;
+		while( i < n && s[i] >= '0' && s[i] <= '9' )
+			++i;
+	}
+	if( i < n && ( s[i] == 'e' || s[i] == 'E' ) ) {
+		isDouble = true;
+		if( ++i < n && ( s[i] == '+' || s[i] == '-' ) )
+			++i;
+		if( i == n || s[i] < '0' || s[i] > '9' )
+			return false;
+		while( i < n && s[i] >= '0' && s[i] <= '9' )
+			++i;
+	}
+	if( i != n )
+		return false;
+
+	if( isDouble || overflow || ( negative && value > uint64_t( 1 ) << 63 ) )
+		*type = JsonTree::VALUE_DOUBLE;
+	else if( negative || value <= 0x7FFFFFFF )
+		*type = JsonTree::VALUE_INT;
+	else
+		*type = JsonTree::VALUE_UINT;
+	return true;
+}
+
+string quoteString( const string &s )
+{
+	string result( 1, '"' );
+	for( size_t i = 0; i < s.size(); ++i ) {
+		const char c = s[i];
+		switch( c ) {
+			case '"': result += "\\\""; break;
+			case '\\': result += "\\\\"; break;
+			case '\n': result += "\\n"; break;
+			case '\r': result += "\\r"; break;
+			case '\t': result += "\\t"; break;
+			case '\b': result += "\\b"; break;
+			case '\f': result += "\\f"; break;
+			default:
+				if( (uint8_t)c < 0x20 ) {
+					char escaped[8];
+					sprintf( escaped, "\\u%04x", (int)c );
+					result += escaped;
+				}
+				else
+					result.push_back( c );
+		}
+	}
+	result.push_back( '"' );
+	return result;
+}
+
+bool indexEquals( const string &s, size_t index )
+{
+	if( s.empty() )
+		return false;
+	size_t value = 0;
+	for( size_t i = 0; i < s.size(); ++i ) {
+		if( s[i] < '0' || s[i] > '9' )
+			return false;
+		value = value * 10 + size_t( s[i] - '0' );
+	}
+	return value == index;
+}
+
+// ASCII case-insensitive comparison; boost::iequals consults the locale for every character
+bool equalsNoCase( const string &a, const string &b )
+{
+	if( a.size() != b.size() )
+		return false;
+	for( size_t i = 0; i < a.size(); ++i ) {
+		char ca = a[i], cb = b[i];
+		if( ca >= 'A' && ca <= 'Z' ) ca += 'a' - 'A';
+		if( cb >= 'A' && cb <= 'Z' ) cb += 'a' - 'A';
+		if( ca != cb )
+			return false;
+	}
+	return true;
+}
+
+} // anonymous namespace
+
+JsonReader::JsonReader( DataSourceRef dataSource, size_t chunkSize )
+	: mScanner( dataSource->createStream(), chunkSize )
+{
+	init();
+}
+
+JsonReader::JsonReader( IStreamRef stream, size_t chunkSize )
+	: mScanner( stream, chunkSize )
+{
+	init();
+}
+
+void JsonReader::init()
+{
+	mEvent = EVENT_NONE;
+	mPopPending = false;
+	mValueType = JsonTree::VALUE_STRING;
+	mIsNull = false;
+	mFilterSeparator = 0;
+	mFilterCaseSensitive = false;
+	mPath.push_back( PathComponent() );
+	// skip a UTF-8 byte order mark
+	mScanner.match( "\xEF\xBB\xBF" );
+}
+
+bool JsonReader::next()
+{
+	if( mEvent == EVENT_END_DOCUMENT )
+		return false;
+	if( mPopPending ) {
+		mPath.pop_back();
+		mPopPending = false;
+	}
+
+	mScanner.skipWhitespace();
+	if( mEvent == EVENT_NONE ) {
+		readValue();
+		return true;
+	}
+	if( mPath.empty() ) {
+		if( ! mScanner.isEof() )
+			error( "Unexpected data after the root value" );
+		mPath.push_back( PathComponent() );
+		mEvent = EVENT_END_DOCUMENT;
+		return false;
+	}
+
+	PathComponent *parent = &mPath.back();
+	const char close = ( parent->mContainer == '{' ) ? '}' : ']';
+	if( mScanner.peek() == close ) {
+		mScanner.get();
+		closeContainer();
+		return true;
+	}
+	if( parent->mNumChildren > 0 ) {
+		if( mScanner.get() != ',' )
+			error( string( "Expected ',' or '" ) + close + "'" );
+		mScanner.skipWhitespace();
+	}
+
+	mPath.push_back( PathComponent() );
+	parent = &mPath[mPath.size() - 2];
+	PathComponent &child = mPath.back();
+	child.mIndex = parent->mNumChildren++;
+	if( parent->mContainer == '{' ) {
+		if( mScanner.peek() != '"' )
+			error( "Expected a member name" );
+		readString( &child.mKey );
+		mScanner.skipWhitespace();
+		if( mScanner.get() != ':' )
+			error( "Expected ':' after member name" );
+		mScanner.skipWhitespace();
+	}
+	readValue();
+	return true;
+}
+
+bool JsonReader::nextMatching( const string &pathFilter, bool caseSensitive, char separator )
+{
+	mFilterCaseSensitive = caseSensitive;
+	if( pathFilter != mFilterString || separator != mFilterSeparator ) {
+		mFilterString = pathFilter;
+		mFilterSeparator = separator;
+		mFilter.clear();
+		vector<string> components = split( pathFilter, separator );
+		for( vector<string>::const_iterator componentIt = components.begin(); componentIt != components.end(); ++componentIt )
+			if( ! componentIt->empty() )
+				mFilter.push_back( *componentIt );
+	}
+
+	while( next() ) {
+		if( mEvent == EVENT_END_OBJECT || mEvent == EVENT_END_ARRAY )
+			continue;
+		bool canContainMatch;
+		if( matchesFilter( &canContainMatch ) )
+			return true;
+		if( ! canContainMatch )
+			skip();
+	}
+	return false;
+}
+
+bool JsonReader::matchesFilter( bool *canContainMatch ) const
+{
+	const size_t depth = mPath.size() - 1;
+	const size_t count = std::min( depth, mFilter.size() );
+	for( size_t i = 0; i < count; ++i ) {
+		const string &filter = mFilter[i];
+		const PathComponent &component = mPath[i + 1];
+		bool match;
+		if( filter == "*" )
+			match = true;
+		else if( mPath[i].mContainer == '[' )
+			match = indexEquals( filter, component.mIndex );
+		else if( mFilterCaseSensitive )
+			match = filter == component.mKey;
+		else
+			match = equalsNoCase( filter, component.mKey );
+		if( ! match ) {
+			*canContainMatch = false;
+			return false;
+		}
+	}
+	*canContainMatch = depth < mFilter.size();
+	return depth == mFilter.size();
+}
+
+void JsonReader::skip()
+{
+	if( mEvent == EVENT_START_OBJECT || mEvent == EVENT_START_ARRAY )
+		skipContainer( 0 );
+}
+
+string JsonReader::getPath( char separator ) const
+{
+	string result;
+	for( size_t i = 1; i < mPath.size(); ++i ) {
+		if( mPath[i - 1].mContainer == '[' )
+			result += '[' + toString( mPath[i].mIndex ) + ']';
+		else {
+			if( ! result.empty() )
+				result += separator;
+			result += mPath[i].mKey;
+		}
+	}
+	return result;
+}
+
+string JsonReader::readRaw()
+{
+	if( mEvent == EVENT_START_OBJECT || mEvent == EVENT_START_ARRAY ) {
+		string result;
+		skipContainer( &result );
+		return result;
+	}
+	else if( mEvent == EVENT_VALUE ) {
+		if( mIsNull )
+			return "null";
+		return ( mValueType == JsonTree::VALUE_STRING ) ? quoteString( mValue ) : mValue;
+	}
+	return string();
+}
+
+JsonTree JsonReader::readTree()
+{
+	if( mEvent == EVENT_START_OBJECT || mEvent == EVENT_START_ARRAY )
+		return JsonTree( readRaw() );
+
+	const string &key = getKey();
+	switch( mValueType ) {
+		case JsonTree::VALUE_BOOL:
+			return JsonTree( key, getValue<bool>() );
+		case JsonTree::VALUE_DOUBLE:
+			return JsonTree( key, getValue<double>() );
+		case JsonTree::VALUE_INT:
+			return JsonTree( key, getValue<int64_t>() );
+		case JsonTree::VALUE_UINT:
+			return JsonTree( key, getValue<uint64_t>() );
+		default:
+			return JsonTree( key, mValue );
+	}
+}
+
+double JsonReader::toDouble() const
+{
+	if( mValueType == JsonTree::VALUE_BOOL )
+		return toBool() ? 1.0 : 0.0;
+	const char *begin = mValue.c_str();
+	char *end;
+	double result = std::strtod( begin, &end );
+	if( end == begin || *end != 0 )
+		throw ExcNonConvertible( *this );
+	return result;
+}
+
+int64_t JsonReader::toInt() const
+{
+	if( mValueType == JsonTree::VALUE_BOOL )
+		return toBool() ? 1 : 0;
+	const char *s = mValue.c_str();
+	bool negative = false;
+	if( *s == '-' || *s == '+' )
+		negative = *s++ == '-';
+	if( *s == 0 )
+		throw ExcNonConvertible( *this );
+	uint64_t value = 0;
+	for( ; *s; ++s ) {
+		if( *s < '0' || *s > '9' )
+			throw ExcNonConvertible( *this );
+		value = value * 10 + uint64_t( *s - '0' );
+	}
+	return negative ? -int64_t( value ) : int64_t( value );
+}
+
+bool JsonReader::toBool() const
+{
+	if( mValue == "true" || mValue == "1" )
+		return true;
+	if( mValue == "false" || mValue == "0" )
+		return false;
+	throw ExcNonConvertible( *this );
+}
+
+void JsonReader::readValue()
+{
+	mValue.clear();
+	mIsNull = false;
+	mValueType = JsonTree::VALUE_STRING;
+
+	switch( mScanner.peek() ) {
+		case '{':
+		case '[':
+			mPath.back().mContainer = (char)mScanner.get();
+			mEvent = ( mPath.back().mContainer == '{' ) ? EVENT_START_OBJECT : EVENT_START_ARRAY;
+		return;
+		case '"':
+			readString( &mValue );
+		break;
+		default:
+			mScanner.readUntil( sTokenDelimiters, &mValue );
+			if( mValue == "true" || mValue == "false" )
+				mValueType = JsonTree::VALUE_BOOL;
+			else if( mValue == "null" ) {
+				mIsNull = true;
+				mValue.clear();
+			}
+			else if( ! classifyNumber( mValue, &mValueType ) )
+				error( mValue.empty() ? "Expected a value" : "Invalid value '" + mValue.substr( 0, 64 ) + "'" );
+	}
+	mEvent = EVENT_VALUE;
+	mPopPending = true;
+}
+
+void JsonReader::readString( string *out )
+{
+	mScanner.get(); // opening quote
+	for( ;; ) {
+		int c = mScanner.readUntil( sStringDelimiters, out );
+		if( c < 0 )
+			error( "Unterminated string" );
+		mScanner.get();
+		if( c == '"' )
+			return;
+
+		switch( c = mScanner.get() ) {
+			case '"': out->push_back( '"' ); break;
+			case '\\': out->push_back( '\\' ); break;
+			case '/': out->push_back( '/' ); break;
+			case 'b': out->push_back( '\b' ); break;
+			case 'f': out->push_back( '\f' ); break;
+			case 'n': out->push_back( '\n' ); break;
+			case 'r': out->push_back( '\r' ); break;
+			case 't': out->push_back( '\t' ); break;
+			case 'u': {
+				uint32_t cp = 0;
+				for( int i = 0; i < 4; ++i ) {
+					int v = hexValue( mScanner.get() );
+					if( v < 0 )
+						error( "Invalid \\u escape" );
+					cp = ( cp << 4 ) | v;
+				}
+				if( cp >= 0xD800 && cp < 0xDC00 && mScanner.match( "\\u" ) ) {
+					uint32_t low = 0;
+					for( int i = 0; i < 4; ++i ) {
+						int v = hexValue( mScanner.get() );
+						if( v < 0 )
+							error( "Invalid \\u escape" );
+						low = ( low << 4 ) | v;
+					}
+					if( low >= 0xDC00 && low < 0xE000 )
+						cp = 0x10000 + ( ( cp - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+					else {
+						appendUtf8( out, cp );
+						cp = low;
+					}
+				}
+				appendUtf8( out, cp );
+			}
+			break;
+			default:
+				error( "Invalid escape sequence" );
+		}
+	}
+}
+
+void JsonReader::skipContainer( string *capture )
+{
+	if( capture ) {
+		capture->push_back( mPath.back().mContainer );
+		mScanner.beginCapture( capture );
+	}
+
+	// strings are skipped without decoding; only brackets outside of them affect the depth
+	int depth = 1;
+	while( depth > 0 ) {
+		int c = mScanner.readUntil( sContainerDelimiters, 0 );
+		if( c < 0 )
+			error( "Unexpected end of document" );
+		mScanner.get();
+		if( c == '"' ) {
+			for( ;; ) {
+				c = mScanner.readUntil( sStringDelimiters, 0 );
+				if( c < 0 )
+					error( "Unterminated string" );
+				mScanner.get();
+				if( c == '"' )
+					break;
+				mScanner.get();
+			}
+		}
+		else if( c == '[' || c == '{' )
+			++depth;
+		else
+			--depth;
+	}
+
+	if( capture )
+		mScanner.endCapture();
+	closeContainer();
+}
+
+void JsonReader::closeContainer()
+{
+	mEvent = ( mPath.back().mContainer == '{' ) ? EVENT_END_OBJECT : EVENT_END_ARRAY;
+	mPath.back().mContainer = 0;
+	mPopPending = true;
+}
+
+void JsonReader::error( const string &message ) const
+{
+	throw ExcJsonParserError( message, mScanner.getOffset() );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+JsonReader::ExcJsonParserError::ExcJsonParserError( const string &errorMessage, uint64_t offset ) throw()
+{
+	sprintf( mMessage, "Unable to parse JSON\n: %s at byte %llu", errorMessage.substr( 0, 1900 ).c_str(), (unsigned long long)offset );
+}
+
+JsonReader::ExcNonConvertible::ExcNonConvertible( const JsonReader &reader ) throw()
+{
+	sprintf( mMessage, "Unable to convert value for node: %s", reader.getPath().substr( 0, 2000 ).c_str() );
+}
+
+} // namespace cinder
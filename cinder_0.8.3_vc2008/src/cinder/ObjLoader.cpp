@@ -21,6 +21,7 @@
 */
 
 #include "cinder/ObjLoader.h"
+#include "cinder/TriMeshOptimizer.h"
 
 #include <boost/lexical_cast.hpp>
 using boost::lexical_cast;
@@ -253,6 +254,8 @@ void ObjLoader::load( size_t groupIndex, TriMesh *destTriMesh, boost::tribool lo
 		loadInternal( mGroups[groupIndex], uniqueVerts, destTriMesh );
 	}
 
+	if( optimizeVertices )
+		optimizeTriMesh( destTriMesh );
 }
 
 void ObjLoader::load( TriMesh *destTriMesh, boost::tribool loadNormals, boost::tribool loadTexCoords, bool optimizeVertices )
@@ -309,6 +312,9 @@ void ObjLoader::load( TriMesh *destTriMesh, boost::tribool loadNormals, boost::t
 		for( vector<Group>::const_iterator groupIt = mGroups.begin(); groupIt != mGroups.end(); ++groupIt )
 			loadInternal( *groupIt, uniqueVerts, destTriMesh );
 	}
+
+	if( optimizeVertices )
+		optimizeTriMesh( destTriMesh );
 }
 
 void ObjLoader::loadInternalNoOptimize( const Group &group, TriMesh *destTriMesh, bool texCoords, bool normals )
@@ -32,8 +32,10 @@ using std::vector;
 namespace cinder {
 
 const int Path2d::sSegmentTypePointCounts[] = { 0, 1, 2, 3, 0 };
+boost::detail::atomic_count Path2d::sRevisionCounter( 0 );
 
 Path2d::Path2d( const BSpline<Vec2f> &spline, float subdivisionStep )
+	: mRevision( 0 )
 {
 	int numPoints = spline.getNumControlPoints();
 	if( numPoints <= spline.getDegree() )
@@ -143,6 +145,7 @@ void Path2d::moveTo( const Vec2f &p )
 		throw Path2dExc(); // can only moveTo as the first point
 		
 	mPoints.push_back( p );
+	touch();
 }
 
 void Path2d::lineTo( const Vec2f &p )
@@ -152,6 +155,7 @@ void Path2d::lineTo( const Vec2f &p )
 		
 	mPoints.push_back( p );
 	mSegments.push_back( LINETO );
+	touch();
 }
 
 void Path2d::quadTo( const Vec2f &p1, const Vec2f &p2 )
@@ -162,6 +166,7 @@ void Path2d::quadTo( const Vec2f &p1, const Vec2f &p2 )
 	mPoints.push_back( p1 );
 	mPoints.push_back( p2 );
 	mSegments.push_back( QUADTO );
+	touch();
 }
 
 void Path2d::curveTo( const Vec2f &p1, const Vec2f &p2, const Vec2f &p3 )
@@ -173,6 +178,7 @@ void Path2d::curveTo( const Vec2f &p1, const Vec2f &p2, const Vec2f &p3 )
 	mPoints.push_back( p2 );
 	mPoints.push_back( p3 );	
 	mSegments.push_back( CUBICTO );
+	touch();
 }
 
 void Path2d::arc( const Vec2f &center, float radius, float startRadians, float endRadians, bool forward )
@@ -345,6 +351,7 @@ void Path2d::reverse()
             std::reverse( mSegments.begin() + 1, mSegments.end() );
     }
 
+	touch();
 }
 
 void Path2d::removeSegment( size_t segment )
@@ -357,6 +364,7 @@ void Path2d::removeSegment( size_t segment )
 	mPoints.erase( mPoints.begin() + firstPoint, mPoints.begin() + firstPoint + pointCount );
 	
 	mSegments.erase( mSegments.begin() + segment );
+	touch();
 }
 
 Vec2f Path2d::getPosition( float t ) const
@@ -602,12 +610,14 @@ void Path2d::scale( const Vec2f &amount, Vec2f scaleCenter )
 {
 	for( vector<Vec2f>::iterator ptIt = mPoints.begin(); ptIt != mPoints.end(); ++ptIt )
 		*ptIt = scaleCenter + Vec2f( ( ptIt->x - scaleCenter.x ) * amount.x, ( ptIt->y - scaleCenter.y ) * amount.y );
+	touch();
 }
 
 void Path2d::transform( const MatrixAffine2f &matrix )
 {
 	for( vector<Vec2f>::iterator ptIt = mPoints.begin(); ptIt != mPoints.end(); ++ptIt )
 		*ptIt = matrix.transformPoint( *ptIt );
+	touch();
 }
 
 Path2d Path2d::transformCopy( const MatrixAffine2f &matrix ) const
@@ -615,6 +625,7 @@ Path2d Path2d::transformCopy( const MatrixAffine2f &matrix ) const
 	Path2d result = *this;
 	for( vector<Vec2f>::iterator ptIt = result.mPoints.begin(); ptIt != result.mPoints.end(); ++ptIt )
 		*ptIt = matrix.transformPoint( *ptIt );
+	result.touch();
 	return result;
 }
 
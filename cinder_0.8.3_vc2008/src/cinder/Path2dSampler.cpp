@@ -0,0 +1,290 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/Path2dSampler.h"
+#include "cinder/CinderMath.h"
+#include "cinder/Thread.h"
+
+#include <algorithm>
+
+using std::vector;
+
+namespace cinder {
+
+namespace {
+
+const int MAX_SUBDIVISION_LEVEL = 16;
+// curves are always split at least this many times, so an S-shaped segment can't pass the flatness test on its first midpoint
+const int MIN_SUBDIVISION_LEVEL = 2;
+
+Vec2f evalSegment( const Vec2f *pts, const Vec2f &closePoint, Path2d::SegmentType type, float t )
+{
+	const float t1 = 1 - t;
+	switch( type ) {
+		case Path2d::CUBICTO:
+			return pts[0] * ( t1 * t1 * t1 ) + pts[1] * ( 3 * t * t1 * t1 ) + pts[2] * ( 3 * t * t * t1 ) + pts[3] * ( t * t * t );
+		case Path2d::QUADTO:
+			return pts[0] * ( t1 * t1 ) + pts[1] * ( 2 * t * t1 ) + pts[2] * ( t * t );
+		case Path2d::LINETO:
+			return pts[0] * t1 + pts[1] * t;
+		case Path2d::CLOSE:
+			return pts[0] * t1 + closePoint * t;
+		default:
+			throw Path2dExc();
+	}
+}
+
+Vec2f evalSegmentDerivative( const Vec2f *pts, const Vec2f &closePoint, Path2d::SegmentType type, float t )
+{
+	const float t1 = 1 - t;
+	switch( type ) {
+		case Path2d::CUBICTO:
+			return ( ( pts[1] - pts[0] ) * ( t1 * t1 ) + ( pts[2] - pts[1] ) * ( 2 * t * t1 ) + ( pts[3] - pts[2] ) * ( t * t ) ) * 3;
+		case Path2d::QUADTO:
+			return ( ( pts[1] - pts[0] ) * t1 + ( pts[2] - pts[1] ) * t ) * 2;
+		case Path2d::LINETO:
+			return pts[1] - pts[0];
+		case Path2d::CLOSE:
+			return closePoint - pts[0];
+		default:
+			throw Path2dExc();
+	}
+}
+
+// Normalizes \a v, falling back to \a fallback where the curve's derivative vanishes, as it does at a cubic's coincident control points
+Vec2f safeNormalized( const Vec2f &v, const Vec2f &fallback )
+{
+	float lengthSqr = v.lengthSquared();
+	if( lengthSqr > EPSILON_VALUE * EPSILON_VALUE )
+		return v / math<float>::sqrt( lengthSqr );
+	return fallback;
+}
+
+} // anonymous namespace
+
+Path2dSampler::Path2dSampler()
+	: mPath( 0 ), mApproximationScale( 1.0f ), mValid( false ), mRevision( 0 ), mDistanceToleranceSqr( 0.25f ), mClosed( false )
+{
+}
+
+Path2dSampler::Path2dSampler( const Path2d &path, float approximationScale )
+	: mPath( &path ), mApproximationScale( approximationScale ), mValid( false ), mRevision( 0 ), mDistanceToleranceSqr( 0.25f ), mClosed( false )
+{
+}
+
+void Path2dSampler::setPath( const Path2d &path )
+{
+	mPath = &path;
+	mValid = false;
+}
+
+void Path2dSampler::setApproximationScale( float approximationScale )
+{
+	mApproximationScale = approximationScale;
+	mValid = false;
+}
+
+void Path2dSampler::update() const
+{
+	if( mValid && ( ( ! mPath ) || mPath->getRevision() == mRevision ) )
+		return;
+	flatten();
+}
+
+void Path2dSampler::flatten() const
+{
+	mPoints.clear();
+	mLengths.clear();
+	mParams.clear();
+	mTangents.clear();
+	mValid = true;
+	mClosed = false;
+	if( ! mPath )
+		return;
+
+	mRevision = mPath->getRevision();
+	const vector<Vec2f> &points = mPath->getPoints();
+	const vector<Path2d::SegmentType> &segments = mPath->getSegments();
+	if( points.empty() )
+		return;
+
+	// same tolerance as Path2d::subdivide()
+	mDistanceToleranceSqr = 0.5f / mApproximationScale;
+	mDistanceToleranceSqr *= mDistanceToleranceSqr;
+	mClosed = mPath->isClosed();
+
+	mPoints.push_back( points[0] );
+	mLengths.push_back( 0 );
+	mParams.push_back( 0 );
+
+	const float segmentParam = segments.empty() ? 0 : 1.0f / segments.size();
+	size_t firstPoint = 0;
+	for( size_t s = 0; s < segments.size(); ++s ) {
+		const Vec2f *pts = &points[firstPoint];
+		const Path2d::SegmentType type = segments[s];
+		const float t0 = s * segmentParam;
+		if( type == Path2d::LINETO || type == Path2d::CLOSE ) {
+			Vec2f end = ( type == Path2d::CLOSE ) ? points[0] : pts[1];
+			Vec2f tangent = safeNormalized( end - pts[0], mTangents.empty() ? Vec2f::xAxis() : mTangents.back() );
+			addPoint( end, tangent, tangent, t0 + segmentParam );
+		}
+		else
+			flattenSegment( pts, points[0], type, t0, segmentParam, 0, pts[0], 1, evalSegment( pts, points[0], type, 1 ), 0 );
+
+		firstPoint += Path2d::sSegmentTypePointCounts[type];
+	}
+}
+
+void Path2dSampler::flattenSegment( const Vec2f *pts, const Vec2f &closePoint, Path2d::SegmentType type, float paramOffset, float paramScale,
+										float t0, const Vec2f &p0, float t1, const Vec2f &p1, int level ) const
+{
+	const float tm = ( t0 + t1 ) * 0.5f;
+	const Vec2f pm = evalSegment( pts, closePoint, type, tm );
+	if( level >= MAX_SUBDIVISION_LEVEL || ( level >= MIN_SUBDIVISION_LEVEL && pm.distanceSquared( ( p0 + p1 ) * 0.5f ) <= mDistanceToleranceSqr ) ) {
+		const Vec2f chord = safeNormalized( p1 - p0, mTangents.empty() ? Vec2f::xAxis() : mTangents.back() );
+		addPoint( p1, safeNormalized( evalSegmentDerivative( pts, closePoint, type, t0 ), chord ),
+				safeNormalized( evalSegmentDerivative( pts, closePoint, type, t1 ), chord ), paramOffset + t1 * paramScale );
+		return;
+	}
+
+	flattenSegment( pts, closePoint, type, paramOffset, paramScale, t0, p0, tm, pm, level + 1 );
+	flattenSegment( pts, closePoint, type, paramOffset, paramScale, tm, pm, t1, p1, level + 1 );
+}
+
+void Path2dSampler::addPoint( const Vec2f &p, const Vec2f &startTangent, const Vec2f &endTangent, float param ) const
+{
+	mLengths.push_back( mLengths.back() + p.distance( mPoints.back() ) );
+	mPoints.push_back( p );
+	mParams.push_back( param );
+	mTangents.push_back( startTangent );
+	mTangents.push_back( endTangent );
+}
+
+float Path2dSampler::wrapLength( float length ) const
+{
+	const float totalLength = mLengths.back();
+	if( mClosed && totalLength > 0 ) {
+		length = math<float>::fmod( length, totalLength );
+		if( length < 0 )
+			length += totalLength;
+		return length;
+	}
+	return constrain( length, 0.0f, totalLength );
+}
+
+size_t Path2dSampler::findSpan( float length ) const
+{
+	size_t span = std::upper_bound( mLengths.begin(), mLengths.end(), length ) - mLengths.begin();
+	return constrain<size_t>( span, 1, mLengths.size() - 1 ) - 1;
+}
+
+void Path2dSampler::evalSpan( float length, Vec2f *position, Vec2f *tangent ) const
+{
+	if( mPoints.size() < 2 ) {
+		if( position )
+			*position = mPoints.empty() ? Vec2f::zero() : mPoints[0];
+		if( tangent )
+			*tangent = Vec2f::xAxis();
+		return;
+	}
+
+	length = wrapLength( length );
+	const size_t span = findSpan( length );
+	const float spanLength = mLengths[span+1] - mLengths[span];
+	const float f = ( spanLength > 0 ) ? ( length - mLengths[span] ) / spanLength : 0;
+	if( position )
+		*position = mPoints[span] + ( mPoints[span+1] - mPoints[span] ) * f;
+	if( tangent )
+		*tangent = safeNormalized( mTangents[span*2] + ( mTangents[span*2+1] - mTangents[span*2] ) * f, mTangents[span*2] );
+}
+
+Vec2f Path2dSampler::getPositionAtLength( float length ) const
+{
+	update();
+	Vec2f result;
+	evalSpan( length, &result, 0 );
+	return result;
+}
+
+Vec2f Path2dSampler::getTangentAtLength( float length ) const
+{
+	update();
+	Vec2f result;
+	evalSpan( length, 0, &result );
+	return result;
+}
+
+float Path2dSampler::getLengthAtParameter( float t ) const
+{
+	update();
+	if( mPoints.size() < 2 )
+		return 0;
+
+	t = constrain( t, 0.0f, 1.0f );
+	size_t span = std::upper_bound( mParams.begin(), mParams.end(), t ) - mParams.begin();
+	span = constrain<size_t>( span, 1, mParams.size() - 1 ) - 1;
+	const float spanParam = mParams[span+1] - mParams[span];
+	const float f = ( spanParam > 0 ) ? ( t - mParams[span] ) / spanParam : 0;
+	return mLengths[span] + ( mLengths[span+1] - mLengths[span] ) * f;
+}
+
+/////// Batch evaluation
+
+struct Path2dSampler::EvalPositions {
+	void operator()( size_t begin, size_t end ) const
+	{
+		for( size_t i = begin; i < end; ++i )
+			mSampler->evalSpan( mInput[i] * mScale, mPositions + i, mTangents ? mTangents + i : 0 );
+	}
+
+	const Path2dSampler	*mSampler;
+	const float			*mInput;
+	float				mScale;
+	Vec2f				*mPositions, *mTangents;
+};
+
+void Path2dSampler::getPositionsAtLengths( const float *lengths, size_t count, Vec2f *positions, Vec2f *tangents ) const
+{
+	update();
+	EvalPositions fn;
+	fn.mSampler = this;
+	fn.mInput = lengths;
+	fn.mScale = 1;
+	fn.mPositions = positions;
+	fn.mTangents = tangents;
+	parallelFor( count, fn, 4096 );
+}
+
+void Path2dSampler::getPositions( const float *t, size_t count, Vec2f *positions, Vec2f *tangents ) const
+{
+	update();
+	EvalPositions fn;
+	fn.mSampler = this;
+	fn.mInput = t;
+	fn.mScale = mLengths.empty() ? 0 : mLengths.back();
+	fn.mPositions = positions;
+	fn.mTangents = tangents;
+	parallelFor( count, fn, 4096 );
+}
+
+} // namespace cinder
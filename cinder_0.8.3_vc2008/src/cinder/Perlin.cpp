@@ -27,6 +27,15 @@
 #include "cinder/Perlin.h"
 #include "cinder/CinderMath.h"
 #include "cinder/Rand.h"
+#include "cinder/Surface.h"
+#include "cinder/Thread.h"
+
+#include <algorithm>
+
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+#	include <emmintrin.h>
+#	include <xmmintrin.h>
+#endif
 
 namespace cinder {
 
@@ -34,6 +43,206 @@ static inline float fade( float t ) { return t * t * t * (t * (t * 6 - 15) + 10)
 static inline float dfade( float t ) { return 30.0f * t * t * ( t * ( t - 2.0f ) + 1.0f ); }
 inline float nlerp(float t, float a, float b) { return a + t * (b - a); }
 
+// below this many points per thread, starting the threads costs more than the batch functions save
+static const size_t POINTS_PER_TASK = 8192;
+
+static const float SIMPLEX_F3 = 1.0f / 3.0f;
+static const float SIMPLEX_G3 = 1.0f / 6.0f;
+
+// Writes the offsets of the second and third corners of the simplex containing (x0, y0, z0), relative to its first corner
+static inline void simplexCorners( float x0, float y0, float z0, int32_t corners[6] )
+{
+	int32_t i1, j1, k1, i2, j2, k2;
+	if( x0 >= y0 ) {
+		if( y0 >= z0 )		{ i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+		else if( x0 >= z0 )	{ i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1; }
+		else				{ i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1; }
+	}
+	else {
+		if( y0 < z0 )		{ i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1; }
+		else if( x0 < z0 )	{ i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1; }
+		else				{ i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+	}
+	corners[0] = i1; corners[1] = j1; corners[2] = k1;
+	corners[3] = i2; corners[4] = j2; corners[5] = k2;
+}
+
+// Writes the gradient hashes of the four corners of the simplex whose first corner is lattice point (i, j, k)
+static inline void simplexHashes( const uint8_t *perms, int32_t i, int32_t j, int32_t k, const int32_t corners[6], int32_t hashes[4] )
+{
+	hashes[0] = perms[i + perms[j + perms[k]]];
+	hashes[1] = perms[i + corners[0] + perms[j + corners[1] + perms[k + corners[2]]]];
+	hashes[2] = perms[i + corners[3] + perms[j + corners[4] + perms[k + corners[5]]]];
+	hashes[3] = perms[i + 1 + perms[j + 1 + perms[k + 1]]];
+}
+
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+static inline __m128 floor4( __m128 v )
+{
+	// truncation rounds negative values up, so step those back down
+	__m128 t = _mm_cvtepi32_ps( _mm_cvttps_epi32( v ) );
+	return _mm_sub_ps( t, _mm_and_ps( _mm_cmpgt_ps( t, v ), _mm_set1_ps( 1.0f ) ) );
+}
+
+static inline __m128 fade4( __m128 t )
+{
+	__m128 p = _mm_add_ps( _mm_mul_ps( t, _mm_sub_ps( _mm_mul_ps( t, _mm_set1_ps( 6.0f ) ), _mm_set1_ps( 15.0f ) ) ), _mm_set1_ps( 10.0f ) );
+	return _mm_mul_ps( _mm_mul_ps( _mm_mul_ps( t, t ), t ), p );
+}
+
+static inline __m128 nlerp4( __m128 t, __m128 a, __m128 b )
+{
+	return _mm_add_ps( a, _mm_mul_ps( t, _mm_sub_ps( b, a ) ) );
+}
+
+static inline __m128 select4( __m128i mask, __m128 a, __m128 b )
+{
+	__m128 m = _mm_castsi128_ps( mask );
+	return _mm_or_ps( _mm_and_ps( m, a ), _mm_andnot_ps( m, b ) );
+}
+
+// Matches Perlin::grad( hash, x, y, z ), and the 2D version when z is 0
+static inline __m128 grad4( const int32_t *hashes, __m128 x, __m128 y, __m128 z )
+{
+	__m128i h = _mm_and_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( hashes ) ), _mm_set1_epi32( 15 ) );
+	__m128 u = select4( _mm_cmplt_epi32( h, _mm_set1_epi32( 8 ) ), x, y );
+	__m128i xMask = _mm_or_si128( _mm_cmpeq_epi32( h, _mm_set1_epi32( 12 ) ), _mm_cmpeq_epi32( h, _mm_set1_epi32( 14 ) ) );
+	__m128 v = select4( _mm_cmplt_epi32( h, _mm_set1_epi32( 4 ) ), y, select4( xMask, x, z ) );
+	// bits 0 and 1 of the hash flip the signs of u and v
+	__m128 uSign = _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( h, _mm_set1_epi32( 1 ) ), 31 ) );
+	__m128 vSign = _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( h, _mm_set1_epi32( 2 ) ), 30 ) );
+	return _mm_add_ps( _mm_xor_ps( u, uSign ), _mm_xor_ps( v, vSign ) );
+}
+
+// Matches Perlin::noise( x, y, z ) for 4 points, or Perlin::noise( x, y ) when THREE_D is false
+template<bool THREE_D>
+static __m128 noise4( const uint8_t *perms, __m128 x, __m128 y, __m128 z )
+{
+	const __m128i mask = _mm_set1_epi32( 255 );
+	const __m128 one = _mm_set1_ps( 1.0f );
+	int32_t X[4], Y[4], Z[4] = { 0, 0, 0, 0 };
+	__m128 fx = floor4( x ), fy = floor4( y );
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( X ), _mm_and_si128( _mm_cvttps_epi32( fx ), mask ) );
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( Y ), _mm_and_si128( _mm_cvttps_epi32( fy ), mask ) );
+	x = _mm_sub_ps( x, fx );
+	y = _mm_sub_ps( y, fy );
+	if( THREE_D ) {
+		__m128 fz = floor4( z );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( Z ), _mm_and_si128( _mm_cvttps_epi32( fz ), mask ) );
+		z = _mm_sub_ps( z, fz );
+	}
+	else
+		z = _mm_setzero_ps();
+
+	// the permutation lookups are the only scalar part
+	int32_t h[8][4];
+	for( int k = 0; k < 4; ++k ) {
+		int32_t A = perms[X[k]  ]+Y[k], AA = perms[A]+Z[k], AB = perms[A+1]+Z[k],
+			B = perms[X[k]+1]+Y[k], BA = perms[B]+Z[k], BB = perms[B+1]+Z[k];
+		h[0][k] = perms[AA]; h[1][k] = perms[BA]; h[2][k] = perms[AB]; h[3][k] = perms[BB];
+		if( THREE_D ) {
+			h[4][k] = perms[AA+1]; h[5][k] = perms[BA+1]; h[6][k] = perms[AB+1]; h[7][k] = perms[BB+1];
+		}
+	}
+
+	__m128 u = fade4( x ), v = fade4( y );
+	__m128 x1 = _mm_sub_ps( x, one ), y1 = _mm_sub_ps( y, one );
+	__m128 a = grad4( h[0], x , y , z );
+	__m128 b = grad4( h[1], x1, y , z );
+	__m128 c = grad4( h[2], x , y1, z );
+	__m128 d = grad4( h[3], x1, y1, z );
+	__m128 result = nlerp4( v, nlerp4( u, a, b ), nlerp4( u, c, d ) );
+	if( THREE_D ) {
+		__m128 w = fade4( z ), z1 = _mm_sub_ps( z, one );
+		__m128 e = grad4( h[4], x , y , z1 );
+		__m128 f = grad4( h[5], x1, y , z1 );
+		__m128 g = grad4( h[6], x , y1, z1 );
+		__m128 hh = grad4( h[7], x1, y1, z1 );
+		result = nlerp4( w, result, nlerp4( v, nlerp4( u, e, f ), nlerp4( u, g, hh ) ) );
+	}
+	return result;
+}
+
+// The contribution of one simplex corner, matching the scalar version in Perlin::simplex()
+static inline __m128 simplexCorner4( const int32_t *hashes, __m128 x, __m128 y, __m128 z )
+{
+	__m128 t = _mm_sub_ps( _mm_sub_ps( _mm_sub_ps( _mm_set1_ps( 0.6f ), _mm_mul_ps( x, x ) ), _mm_mul_ps( y, y ) ), _mm_mul_ps( z, z ) );
+	t = _mm_max_ps( t, _mm_setzero_ps() );
+	t = _mm_mul_ps( t, t );
+	return _mm_mul_ps( _mm_mul_ps( t, t ), grad4( hashes, x, y, z ) );
+}
+
+// Matches Perlin::simplex( x, y, z ) for 4 points
+static __m128 simplex4( const uint8_t *perms, __m128 x, __m128 y, __m128 z )
+{
+	const __m128 g3 = _mm_set1_ps( SIMPLEX_G3 );
+	__m128 s = _mm_mul_ps( _mm_add_ps( _mm_add_ps( x, y ), z ), _mm_set1_ps( SIMPLEX_F3 ) );
+	__m128 i = floor4( _mm_add_ps( x, s ) ), j = floor4( _mm_add_ps( y, s ) ), k = floor4( _mm_add_ps( z, s ) );
+	__m128 t = _mm_mul_ps( _mm_add_ps( _mm_add_ps( i, j ), k ), g3 );
+	__m128 x0 = _mm_sub_ps( x, _mm_sub_ps( i, t ) ), y0 = _mm_sub_ps( y, _mm_sub_ps( j, t ) ), z0 = _mm_sub_ps( z, _mm_sub_ps( k, t ) );
+
+	float x0s[4], y0s[4], z0s[4];
+	int32_t I[4], J[4], K[4];
+	const __m128i mask = _mm_set1_epi32( 255 );
+	_mm_storeu_ps( x0s, x0 ); _mm_storeu_ps( y0s, y0 ); _mm_storeu_ps( z0s, z0 );
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( I ), _mm_and_si128( _mm_cvttps_epi32( i ), mask ) );
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( J ), _mm_and_si128( _mm_cvttps_epi32( j ), mask ) );
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( K ), _mm_and_si128( _mm_cvttps_epi32( k ), mask ) );
+
+	// picking the simplex and looking up its hashes branches per point, so it stays scalar
+	float offsets[6][4];
+	int32_t h[4][4];
+	for( int p = 0; p < 4; ++p ) {
+		int32_t corners[6], hashes[4];
+		simplexCorners( x0s[p], y0s[p], z0s[p], corners );
+		simplexHashes( perms, I[p], J[p], K[p], corners, hashes );
+		for( int c = 0; c < 6; ++c )
+			offsets[c][p] = (float)corners[c];
+		for( int c = 0; c < 4; ++c )
+			h[c][p] = hashes[c];
+	}
+
+	const __m128 g3x2 = _mm_set1_ps( 2.0f * SIMPLEX_G3 ), g3x3 = _mm_set1_ps( -1.0f + 3.0f * SIMPLEX_G3 );
+	__m128 x1 = _mm_add_ps( _mm_sub_ps( x0, _mm_loadu_ps( offsets[0] ) ), g3 );
+	__m128 y1 = _mm_add_ps( _mm_sub_ps( y0, _mm_loadu_ps( offsets[1] ) ), g3 );
+	__m128 z1 = _mm_add_ps( _mm_sub_ps( z0, _mm_loadu_ps( offsets[2] ) ), g3 );
+	__m128 x2 = _mm_add_ps( _mm_sub_ps( x0, _mm_loadu_ps( offsets[3] ) ), g3x2 );
+	__m128 y2 = _mm_add_ps( _mm_sub_ps( y0, _mm_loadu_ps( offsets[4] ) ), g3x2 );
+	__m128 z2 = _mm_add_ps( _mm_sub_ps( z0, _mm_loadu_ps( offsets[5] ) ), g3x2 );
+	__m128 x3 = _mm_add_ps( x0, g3x3 ), y3 = _mm_add_ps( y0, g3x3 ), z3 = _mm_add_ps( z0, g3x3 );
+
+	__m128 n = _mm_add_ps( _mm_add_ps( simplexCorner4( h[0], x0, y0, z0 ), simplexCorner4( h[1], x1, y1, z1 ) ),
+							_mm_add_ps( simplexCorner4( h[2], x2, y2, z2 ), simplexCorner4( h[3], x3, y3, z3 ) ) );
+	return _mm_mul_ps( n, _mm_set1_ps( 32.0f ) );
+}
+#endif // defined( CINDER_MSW ) || defined( CINDER_MAC )
+
+struct Perlin::LatticeRange {
+	LatticeRange( const Perlin *perlin, const Lattice *lattice )
+		: mPerlin( perlin ), mLattice( lattice )
+	{}
+
+	void operator()( size_t begin, size_t end ) const { mPerlin->fillLatticeRows( *mLattice, begin, end ); }
+
+	const Perlin	*mPerlin;
+	const Lattice	*mLattice;
+};
+
+struct Perlin::PointRange {
+	PointRange( const Perlin *perlin, BatchFn fn, const float *points, int32_t dims, float *dst, int32_t increment )
+		: mPerlin( perlin ), mFn( fn ), mPoints( points ), mDims( dims ), mDst( dst ), mIncrement( increment )
+	{}
+
+	void operator()( size_t begin, size_t end ) const { mPerlin->fillPointRange( mFn, mPoints, mDims, mDst, mIncrement, begin, end ); }
+
+	const Perlin	*mPerlin;
+	BatchFn			mFn;
+	const float		*mPoints;
+	int32_t			mDims;
+	float			*mDst;
+	int32_t			mIncrement;
+};
+
 Perlin::Perlin( uint8_t aOctaves, int32_t aSeed )
 	: mOctaves( aOctaves ), mSeed( aSeed ){
 	initPermutationTable();
@@ -279,6 +488,238 @@ Vec3f Perlin::dnoise( float x, float y, float z ) const
 					dw * ( k3 + k6*u + k5*v + k7*u*v ) );
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// simplex
+float Perlin::simplex( float x, float y, float z ) const
+{
+	// skew the input space to find the simplex cell containing the point
+	float s = ( x + y + z ) * SIMPLEX_F3;
+	float i = floorf( x + s ), j = floorf( y + s ), k = floorf( z + s );
+	float t = ( i + j + k ) * SIMPLEX_G3;
+	float x0 = x - ( i - t ), y0 = y - ( j - t ), z0 = z - ( k - t );
+
+	int32_t corners[6], hashes[4];
+	simplexCorners( x0, y0, z0, corners );
+	simplexHashes( mPerms, ((int32_t)i) & 255, ((int32_t)j) & 255, ((int32_t)k) & 255, corners, hashes );
+
+	float x1 = x0 - corners[0] + SIMPLEX_G3, y1 = y0 - corners[1] + SIMPLEX_G3, z1 = z0 - corners[2] + SIMPLEX_G3;
+	float x2 = x0 - corners[3] + 2.0f * SIMPLEX_G3, y2 = y0 - corners[4] + 2.0f * SIMPLEX_G3, z2 = z0 - corners[5] + 2.0f * SIMPLEX_G3;
+	float x3 = x0 + ( -1.0f + 3.0f * SIMPLEX_G3 ), y3 = y0 + ( -1.0f + 3.0f * SIMPLEX_G3 ), z3 = z0 + ( -1.0f + 3.0f * SIMPLEX_G3 );
+
+	const float px[4] = { x0, x1, x2, x3 }, py[4] = { y0, y1, y2, y3 }, pz[4] = { z0, z1, z2, z3 };
+	float n[4];
+	for( int c = 0; c < 4; ++c ) {
+		float r = 0.6f - px[c] * px[c] - py[c] * py[c] - pz[c] * pz[c];
+		if( r < 0 )
+			n[c] = 0;
+		else {
+			r *= r;
+			n[c] = r * r * grad( hashes[c], px[c], py[c], pz[c] );
+		}
+	}
+
+	// scales the result to roughly [-1,1]
+	return ( ( n[0] + n[1] ) + ( n[2] + n[3] ) ) * 32.0f;
+}
+
+float Perlin::simplexFbm( const Vec3f &v ) const
+{
+	float result = 0.0f;
+	float amp = 0.5f;
+	float x = v.x, y = v.y, z = v.z;
+
+	for( uint8_t i = 0; i < mOctaves; i++ ) {
+		result += simplex( x, y, z ) * amp;
+		x *= 2.0f; y *= 2.0f; z *= 2.0f;
+		amp *= 0.5f;
+	}
+
+	return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// batches
+void Perlin::fBm( Channel32f *dst, const Vec2f &origin, const Vec2f &step ) const
+{
+	fillLattice( &Perlin::batchFbm2d, dst->getData(), dst->getWidth(), dst->getHeight(), 1, Vec3f( origin, 0 ), Vec3f( step, 0 ), dst->getIncrement(), dst->getRowBytes() / sizeof(float) );
+}
+
+void Perlin::fBm( Channel32f *dst, const Vec3f &origin, const Vec2f &step ) const
+{
+	fillLattice( &Perlin::batchFbm3d, dst->getData(), dst->getWidth(), dst->getHeight(), 1, origin, Vec3f( step, 0 ), dst->getIncrement(), dst->getRowBytes() / sizeof(float) );
+}
+
+// copies the red channel of 's' to its green and blue channels
+static void spreadRed( Surface32f *s )
+{
+	Surface32f::Iter iter = s->getIter();
+	while( iter.line() ) {
+		while( iter.pixel() )
+			iter.g() = iter.b() = iter.r();
+	}
+}
+
+void Perlin::fBm( Surface32f *dst, const Vec2f &origin, const Vec2f &step ) const
+{
+	fBm( &dst->getChannelRed(), origin, step );
+	spreadRed( dst );
+}
+
+void Perlin::fBm( Surface32f *dst, const Vec3f &origin, const Vec2f &step ) const
+{
+	fBm( &dst->getChannelRed(), origin, step );
+	spreadRed( dst );
+}
+
+void Perlin::fBm( float *dst, int32_t width, int32_t height, const Vec2f &origin, const Vec2f &step, int32_t increment ) const
+{
+	fillLattice( &Perlin::batchFbm2d, dst, width, height, 1, Vec3f( origin, 0 ), Vec3f( step, 0 ), increment, width * increment );
+}
+
+void Perlin::fBm( float *dst, int32_t width, int32_t height, int32_t depth, const Vec3f &origin, const Vec3f &step, int32_t increment ) const
+{
+	fillLattice( &Perlin::batchFbm3d, dst, width, height, depth, origin, step, increment, width * increment );
+}
+
+void Perlin::fBm( const Vec2f *points, size_t count, float *dst, int32_t increment ) const
+{
+	fillPoints( &Perlin::batchFbm2d, &points->x, 2, count, dst, increment );
+}
+
+void Perlin::fBm( const Vec3f *points, size_t count, float *dst, int32_t increment ) const
+{
+	fillPoints( &Perlin::batchFbm3d, &points->x, 3, count, dst, increment );
+}
+
+void Perlin::simplexFbm( Channel32f *dst, const Vec3f &origin, const Vec2f &step ) const
+{
+	fillLattice( &Perlin::batchSimplexFbm, dst->getData(), dst->getWidth(), dst->getHeight(), 1, origin, Vec3f( step, 0 ), dst->getIncrement(), dst->getRowBytes() / sizeof(float) );
+}
+
+void Perlin::simplexFbm( float *dst, int32_t width, int32_t height, int32_t depth, const Vec3f &origin, const Vec3f &step, int32_t increment ) const
+{
+	fillLattice( &Perlin::batchSimplexFbm, dst, width, height, depth, origin, step, increment, width * increment );
+}
+
+void Perlin::simplexFbm( const Vec3f *points, size_t count, float *dst, int32_t increment ) const
+{
+	fillPoints( &Perlin::batchSimplexFbm, &points->x, 3, count, dst, increment );
+}
+
+void Perlin::batchFbm2d( const float *x, const float *y, const float * /*z*/, float *result ) const
+{
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+	__m128 vx = _mm_loadu_ps( x ), vy = _mm_loadu_ps( y ), sum = _mm_setzero_ps();
+	const __m128 two = _mm_set1_ps( 2.0f );
+	float amp = 0.5f;
+	for( uint8_t i = 0; i < mOctaves; i++ ) {
+		sum = _mm_add_ps( sum, _mm_mul_ps( noise4<false>( mPerms, vx, vy, _mm_setzero_ps() ), _mm_set1_ps( amp ) ) );
+		vx = _mm_mul_ps( vx, two ); vy = _mm_mul_ps( vy, two );
+		amp *= 0.5f;
+	}
+	_mm_storeu_ps( result, sum );
+#else
+	for( int k = 0; k < 4; ++k )
+		result[k] = fBm( Vec2f( x[k], y[k] ) );
+#endif
+}
+
+void Perlin::batchFbm3d( const float *x, const float *y, const float *z, float *result ) const
+{
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+	__m128 vx = _mm_loadu_ps( x ), vy = _mm_loadu_ps( y ), vz = _mm_loadu_ps( z ), sum = _mm_setzero_ps();
+	const __m128 two = _mm_set1_ps( 2.0f );
+	float amp = 0.5f;
+	for( uint8_t i = 0; i < mOctaves; i++ ) {
+		sum = _mm_add_ps( sum, _mm_mul_ps( noise4<true>( mPerms, vx, vy, vz ), _mm_set1_ps( amp ) ) );
+		vx = _mm_mul_ps( vx, two ); vy = _mm_mul_ps( vy, two ); vz = _mm_mul_ps( vz, two );
+		amp *= 0.5f;
+	}
+	_mm_storeu_ps( result, sum );
+#else
+	for( int k = 0; k < 4; ++k )
+		result[k] = fBm( Vec3f( x[k], y[k], z[k] ) );
+#endif
+}
+
+void Perlin::batchSimplexFbm( const float *x, const float *y, const float *z, float *result ) const
+{
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+	__m128 vx = _mm_loadu_ps( x ), vy = _mm_loadu_ps( y ), vz = _mm_loadu_ps( z ), sum = _mm_setzero_ps();
+	const __m128 two = _mm_set1_ps( 2.0f );
+	float amp = 0.5f;
+	for( uint8_t i = 0; i < mOctaves; i++ ) {
+		sum = _mm_add_ps( sum, _mm_mul_ps( simplex4( mPerms, vx, vy, vz ), _mm_set1_ps( amp ) ) );
+		vx = _mm_mul_ps( vx, two ); vy = _mm_mul_ps( vy, two ); vz = _mm_mul_ps( vz, two );
+		amp *= 0.5f;
+	}
+	_mm_storeu_ps( result, sum );
+#else
+	for( int k = 0; k < 4; ++k )
+		result[k] = simplexFbm( Vec3f( x[k], y[k], z[k] ) );
+#endif
+}
+
+void Perlin::fillLattice( BatchFn fn, float *dst, int32_t width, int32_t height, int32_t depth, const Vec3f &origin, const Vec3f &step, int32_t increment, int32_t rowStride ) const
+{
+	if( width <= 0 || height <= 0 || depth <= 0 )
+		return;
+
+	Lattice lattice;
+	lattice.fn = fn;
+	lattice.dst = dst;
+	lattice.width = width;
+	lattice.height = height;
+	lattice.increment = increment;
+	lattice.rowStride = rowStride;
+	lattice.origin = origin;
+	lattice.step = step;
+	parallelFor( (size_t)height * depth, LatticeRange( this, &lattice ), std::max<size_t>( 1, POINTS_PER_TASK / width ) );
+}
+
+void Perlin::fillLatticeRows( const Lattice &lattice, size_t begin, size_t end ) const
+{
+	float x[4], y[4], z[4], result[4];
+	for( size_t row = begin; row < end; ++row ) {
+		const int32_t yi = (int32_t)( row % lattice.height ), zi = (int32_t)( row / lattice.height );
+		std::fill( y, y + 4, lattice.origin.y + yi * lattice.step.y );
+		std::fill( z, z + 4, lattice.origin.z + zi * lattice.step.z );
+		float *dst = lattice.dst + row * lattice.rowStride;
+		for( int32_t xi = 0; xi < lattice.width; xi += 4 ) {
+			// a partial batch at the end of the row repeats its last point
+			const int32_t count = std::min( 4, lattice.width - xi );
+			for( int32_t k = 0; k < 4; ++k )
+				x[k] = lattice.origin.x + ( xi + std::min( k, count - 1 ) ) * lattice.step.x;
+			(this->*lattice.fn)( x, y, z, result );
+			for( int32_t k = 0; k < count; ++k )
+				dst[( xi + k ) * lattice.increment] = result[k];
+		}
+	}
+}
+
+void Perlin::fillPoints( BatchFn fn, const float *points, int32_t dims, size_t count, float *dst, int32_t increment ) const
+{
+	parallelFor( count, PointRange( this, fn, points, dims, dst, increment ), POINTS_PER_TASK );
+}
+
+void Perlin::fillPointRange( BatchFn fn, const float *points, int32_t dims, float *dst, int32_t increment, size_t begin, size_t end ) const
+{
+	float x[4], y[4], z[4] = { 0, 0, 0, 0 }, result[4];
+	for( size_t i = begin; i < end; i += 4 ) {
+		const size_t count = std::min<size_t>( 4, end - i );
+		for( size_t k = 0; k < 4; ++k ) {
+			const float *p = points + ( i + std::min( k, count - 1 ) ) * dims;
+			x[k] = p[0];
+			y[k] = p[1];
+			if( dims > 2 )
+				z[k] = p[2];
+		}
+		(this->*fn)( x, y, z, result );
+		for( size_t k = 0; k < count; ++k )
+			dst[( i + k ) * increment] = result[k];
+	}
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////
 // grad
 
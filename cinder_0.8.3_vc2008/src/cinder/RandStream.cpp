@@ -0,0 +1,365 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/RandStream.h"
+#include "cinder/CinderMath.h"
+#include "cinder/Thread.h"
+
+#include <algorithm>
+
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+#	include <emmintrin.h>
+#	include <xmmintrin.h>
+#endif
+
+namespace cinder {
+
+// Philox4x32 multipliers and Weyl sequence constants
+static const uint32_t PHILOX_M0 = 0xD2511F53;
+static const uint32_t PHILOX_M1 = 0xCD9E8D57;
+static const uint32_t PHILOX_W0 = 0x9E3779B9;
+static const uint32_t PHILOX_W1 = 0xBB67AE85;
+static const int PHILOX_ROUNDS = 10;
+
+static const uint64_t NO_BLOCK = ~(uint64_t)0;
+
+// below this many items per thread, starting the threads costs more than it saves
+static const size_t ITEMS_PER_TASK = 65536;
+// values generated at a time by the fill functions
+static const size_t FILL_BATCH = 1024;
+
+static inline void philox( uint32_t ctr[4], uint32_t key0, uint32_t key1 )
+{
+	for( int r = 0; r < PHILOX_ROUNDS; ++r ) {
+		uint64_t p0 = (uint64_t)PHILOX_M0 * ctr[0];
+		uint64_t p1 = (uint64_t)PHILOX_M1 * ctr[2];
+		uint32_t c0 = (uint32_t)( p1 >> 32 ) ^ ctr[1] ^ key0;
+		uint32_t c2 = (uint32_t)( p0 >> 32 ) ^ ctr[3] ^ key1;
+		ctr[0] = c0;
+		ctr[1] = (uint32_t)p1;
+		ctr[2] = c2;
+		ctr[3] = (uint32_t)p0;
+		key0 += PHILOX_W0;
+		key1 += PHILOX_W1;
+	}
+}
+
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+// 32 x 32 -> 64 bit products of the 4 lanes of 'a' with 'm', split into high and low halves
+static inline void mulHiLo4( __m128i a, __m128i m, __m128i *hi, __m128i *lo )
+{
+	const __m128i lowMask = _mm_set_epi32( 0, -1, 0, -1 );
+	__m128i p02 = _mm_mul_epu32( a, m );
+	__m128i p13 = _mm_mul_epu32( _mm_srli_epi64( a, 32 ), m );
+	*lo = _mm_or_si128( _mm_and_si128( p02, lowMask ), _mm_slli_epi64( p13, 32 ) );
+	*hi = _mm_or_si128( _mm_srli_epi64( p02, 32 ), _mm_andnot_si128( lowMask, p13 ) );
+}
+
+// runs Philox on 4 counters at once, with word i of each counter in ctr[i]
+static inline void philox4( __m128i ctr[4], uint32_t key0, uint32_t key1 )
+{
+	const __m128i m0 = _mm_set1_epi32( (int)PHILOX_M0 ), m1 = _mm_set1_epi32( (int)PHILOX_M1 );
+	for( int r = 0; r < PHILOX_ROUNDS; ++r ) {
+		__m128i hi0, lo0, hi1, lo1;
+		mulHiLo4( ctr[0], m0, &hi0, &lo0 );
+		mulHiLo4( ctr[2], m1, &hi1, &lo1 );
+		ctr[0] = _mm_xor_si128( _mm_xor_si128( hi1, ctr[1] ), _mm_set1_epi32( (int)key0 ) );
+		ctr[1] = lo1;
+		ctr[2] = _mm_xor_si128( _mm_xor_si128( hi0, ctr[3] ), _mm_set1_epi32( (int)key1 ) );
+		ctr[3] = lo0;
+		key0 += PHILOX_W0;
+		key1 += PHILOX_W1;
+	}
+}
+#endif
+
+RandStream::RandStream( uint64_t seed, uint64_t streamId )
+	: mSeed( seed ), mStreamId( streamId ), mPosition( 0 ), mCachedBlock( NO_BLOCK ), mNextGaussian( 0 ), mHaveNextGaussian( false )
+{
+}
+
+void RandStream::generateBlocks( uint64_t block, size_t count, uint32_t *dst ) const
+{
+	const uint32_t key0 = (uint32_t)mSeed, key1 = (uint32_t)( mSeed >> 32 );
+	const uint32_t stream0 = (uint32_t)mStreamId, stream1 = (uint32_t)( mStreamId >> 32 );
+	size_t b = 0;
+
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+	for( ; b + 4 <= count; b += 4 ) {
+		uint32_t lo[4], hi[4];
+		for( int k = 0; k < 4; ++k ) {
+			lo[k] = (uint32_t)( block + b + k );
+			hi[k] = (uint32_t)( ( block + b + k ) >> 32 );
+		}
+		__m128i ctr[4];
+		ctr[0] = _mm_loadu_si128( reinterpret_cast<const __m128i*>( lo ) );
+		ctr[1] = _mm_loadu_si128( reinterpret_cast<const __m128i*>( hi ) );
+		ctr[2] = _mm_set1_epi32( (int)stream0 );
+		ctr[3] = _mm_set1_epi32( (int)stream1 );
+		philox4( ctr, key0, key1 );
+
+		// transpose so that each block's 4 values are contiguous
+		__m128i t0 = _mm_unpacklo_epi32( ctr[0], ctr[1] ), t1 = _mm_unpacklo_epi32( ctr[2], ctr[3] );
+		__m128i t2 = _mm_unpackhi_epi32( ctr[0], ctr[1] ), t3 = _mm_unpackhi_epi32( ctr[2], ctr[3] );
+		__m128i *out = reinterpret_cast<__m128i*>( dst + b * 4 );
+		_mm_storeu_si128( out + 0, _mm_unpacklo_epi64( t0, t1 ) );
+		_mm_storeu_si128( out + 1, _mm_unpackhi_epi64( t0, t1 ) );
+		_mm_storeu_si128( out + 2, _mm_unpacklo_epi64( t2, t3 ) );
+		_mm_storeu_si128( out + 3, _mm_unpackhi_epi64( t2, t3 ) );
+	}
+#endif
+
+	for( ; b < count; ++b ) {
+		uint32_t *ctr = dst + b * 4;
+		ctr[0] = (uint32_t)( block + b );
+		ctr[1] = (uint32_t)( ( block + b ) >> 32 );
+		ctr[2] = stream0;
+		ctr[3] = stream1;
+		philox( ctr, key0, key1 );
+	}
+}
+
+void RandStream::generate( uint64_t position, size_t count, uint32_t *dst ) const
+{
+	uint64_t block = position / 4;
+	const size_t skip = (size_t)( position % 4 );
+	uint32_t partial[4];
+
+	if( skip && count ) {
+		generateBlocks( block++, 1, partial );
+		const size_t n = std::min( count, 4 - skip );
+		std::copy( partial + skip, partial + skip + n, dst );
+		dst += n;
+		count -= n;
+	}
+
+	const size_t fullBlocks = count / 4;
+	generateBlocks( block, fullBlocks, dst );
+	if( count % 4 ) {
+		generateBlocks( block + fullBlocks, 1, partial );
+		std::copy( partial, partial + count % 4, dst + fullBlocks * 4 );
+	}
+}
+
+uint32_t RandStream::nextUint()
+{
+	const uint64_t block = mPosition / 4;
+	if( block != mCachedBlock ) {
+		generateBlocks( block, 1, mCache );
+		mCachedBlock = block;
+	}
+	return mCache[mPosition++ % 4];
+}
+
+Vec2f RandStream::nextVec2f()
+{
+	float theta = nextFloat( (float)M_PI * 2.0f );
+	return Vec2f( math<float>::cos( theta ), math<float>::sin( theta ) );
+}
+
+Vec3f RandStream::nextVec3f()
+{
+	float phi = nextFloat( (float)M_PI * 2.0f );
+	float costheta = nextFloat( -1.0f, 1.0f );
+
+	float rho = math<float>::sqrt( 1.0f - costheta * costheta );
+	return Vec3f( rho * math<float>::cos( phi ), rho * math<float>::sin( phi ), costheta );
+}
+
+// Box-Muller transform of two values into a pair of Gaussians
+static inline void gaussianPair( uint32_t v0, uint32_t v1, float *g0, float *g1 )
+{
+	// offset the first value into (0,1] to keep the log finite
+	float u0 = (float)( ( v0 >> 8 ) + 1 ) * ( 1.0f / 16777216.0f );
+	float theta = RandStream::toFloat( v1 ) * (float)M_PI * 2.0f;
+	float r = math<float>::sqrt( -2.0f * math<float>::log( u0 ) );
+	*g0 = r * math<float>::cos( theta );
+	*g1 = r * math<float>::sin( theta );
+}
+
+float RandStream::nextGaussian()
+{
+	if( mHaveNextGaussian ) {
+		mHaveNextGaussian = false;
+		return mNextGaussian;
+	}
+
+	uint32_t v0 = nextUint(), v1 = nextUint();
+	float result;
+	gaussianPair( v0, v1, &result, &mNextGaussian );
+	mHaveNextGaussian = true;
+	return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Fills
+namespace {
+
+// Each converter turns VALUES values per item into items written at dst[first, first + count)
+struct UintItems {
+	static const size_t VALUES = 1;
+	uint32_t	*mDst;
+
+	void operator()( const uint32_t *values, size_t first, size_t count ) const { std::copy( values, values + count, mDst + first ); }
+};
+
+struct FloatItems {
+	static const size_t VALUES = 1;
+	float	*mDst;
+	float	mMin, mRange;
+
+	void operator()( const uint32_t *values, size_t first, size_t count ) const
+	{
+		float *dst = mDst + first;
+		size_t i = 0;
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+		const __m128 scale = _mm_set1_ps( 1.0f / 16777216.0f ), range = _mm_set1_ps( mRange ), offset = _mm_set1_ps( mMin );
+		for( ; i + 4 <= count; i += 4 ) {
+			__m128i v = _mm_srli_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( values + i ) ), 8 );
+			__m128 f = _mm_mul_ps( _mm_cvtepi32_ps( v ), scale );
+			_mm_storeu_ps( dst + i, _mm_add_ps( _mm_mul_ps( f, range ), offset ) );
+		}
+#endif
+		for( ; i < count; ++i )
+			dst[i] = RandStream::toFloat( values[i] ) * mRange + mMin;
+	}
+};
+
+struct Vec2fItems {
+	static const size_t VALUES = 1;
+	Vec2f	*mDst;
+
+	void operator()( const uint32_t *values, size_t first, size_t count ) const
+	{
+		for( size_t i = 0; i < count; ++i ) {
+			float theta = RandStream::toFloat( values[i] ) * ( (float)M_PI * 2.0f );
+			mDst[first + i] = Vec2f( math<float>::cos( theta ), math<float>::sin( theta ) );
+		}
+	}
+};
+
+struct Vec3fItems {
+	static const size_t VALUES = 2;
+	Vec3f	*mDst;
+
+	void operator()( const uint32_t *values, size_t first, size_t count ) const
+	{
+		for( size_t i = 0; i < count; ++i ) {
+			float phi = RandStream::toFloat( values[i * 2] ) * ( (float)M_PI * 2.0f );
+			float costheta = RandStream::toFloat( values[i * 2 + 1] ) * 2.0f + -1.0f;
+			float rho = math<float>::sqrt( 1.0f - costheta * costheta );
+			mDst[first + i] = Vec3f( rho * math<float>::cos( phi ), rho * math<float>::sin( phi ), costheta );
+		}
+	}
+};
+
+// items are pairs of Gaussians
+struct GaussianPairItems {
+	static const size_t VALUES = 2;
+	float	*mDst;
+	float	mMean, mStdDev;
+
+	void operator()( const uint32_t *values, size_t first, size_t count ) const
+	{
+		float *dst = mDst + first * 2;
+		for( size_t i = 0; i < count; ++i ) {
+			float g0, g1;
+			gaussianPair( values[i * 2], values[i * 2 + 1], &g0, &g1 );
+			dst[i * 2] = g0 * mStdDev + mMean;
+			dst[i * 2 + 1] = g1 * mStdDev + mMean;
+		}
+	}
+};
+
+template<typename Items>
+struct FillRange {
+	FillRange( const RandStream *stream, uint64_t position, const Items &items )
+		: mStream( stream ), mPosition( position ), mItems( items )
+	{}
+
+	void operator()( size_t begin, size_t end ) const
+	{
+		uint32_t values[FILL_BATCH];
+		const size_t itemsPerBatch = FILL_BATCH / Items::VALUES;
+		for( size_t i = begin; i < end; i += itemsPerBatch ) {
+			const size_t count = std::min( itemsPerBatch, end - i );
+			mStream->generate( mPosition + i * Items::VALUES, count * Items::VALUES, values );
+			mItems( values, i, count );
+		}
+	}
+
+	const RandStream	*mStream;
+	uint64_t			mPosition;
+	Items				mItems;
+};
+
+// writes 'count' items using the values from 'position' on; returns the number of values used
+template<typename Items>
+uint64_t fillItems( const RandStream &stream, uint64_t position, size_t count, const Items &items )
+{
+	parallelFor( count, FillRange<Items>( &stream, position, items ), ITEMS_PER_TASK );
+	return (uint64_t)count * Items::VALUES;
+}
+
+} // anonymous namespace
+
+void RandStream::fillUints( uint32_t *dst, size_t count )
+{
+	UintItems items = { dst };
+	mPosition += fillItems( *this, mPosition, count, items );
+}
+
+void RandStream::fillFloats( float *dst, size_t count, float a, float b )
+{
+	FloatItems items = { dst, a, b - a };
+	mPosition += fillItems( *this, mPosition, count, items );
+}
+
+void RandStream::fillVec2f( Vec2f *dst, size_t count )
+{
+	Vec2fItems items = { dst };
+	mPosition += fillItems( *this, mPosition, count, items );
+}
+
+void RandStream::fillVec3f( Vec3f *dst, size_t count )
+{
+	Vec3fItems items = { dst };
+	mPosition += fillItems( *this, mPosition, count, items );
+}
+
+void RandStream::fillGaussians( float *dst, size_t count, float mean, float stdDev )
+{
+	if( count && mHaveNextGaussian ) {
+		*dst++ = mNextGaussian * stdDev + mean;
+		--count;
+		mHaveNextGaussian = false;
+	}
+
+	GaussianPairItems items = { dst, mean, stdDev };
+	mPosition += fillItems( *this, mPosition, count / 2, items );
+
+	// an odd count leaves the second of the last pair for the next call, as nextGaussian() does
+	if( count % 2 )
+		dst[count - 1] = nextGaussian() * stdDev + mean;
+}
+
+} // namespace cinder
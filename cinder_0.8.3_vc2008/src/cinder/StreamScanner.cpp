@@ -0,0 +1,139 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/StreamScanner.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace cinder {
+
+StreamScanner::Delimiters::Delimiters( const char *characters )
+{
+	std::fill( mTable, mTable + 256, false );
+	for( ; *characters; ++characters )
+		mTable[(uint8_t)*characters] = true;
+}
+
+StreamScanner::StreamScanner( IStreamRef stream, size_t chunkSize )
+	: mStream( stream ), mBuffer( std::max<size_t>( chunkSize, 64 ) ), mBufferOffset( 0 ), mCapture( 0 ), mCaptureStart( 0 )
+{
+	mPos = mEnd = &mBuffer[0];
+}
+
+bool StreamScanner::refill()
+{
+	char *begin = &mBuffer[0];
+	if( mCapture ) {
+		mCapture->append( mCaptureStart, mPos );
+		mCaptureStart = begin;
+	}
+
+	// keep the unconsumed tail, which is only non-empty when ensure() asked for more lookahead
+	size_t remaining = mEnd - mPos;
+	mBufferOffset += mPos - begin;
+	std::memmove( begin, mPos, remaining );
+	mPos = begin;
+	mEnd = begin + remaining;
+
+	size_t space = mBuffer.size() - remaining;
+	while( space > 0 && ! mStream->isEof() ) {
+		size_t bytesRead = mStream->readDataAvailable( begin + remaining, space );
+		if( bytesRead > 0 ) {
+			mEnd += bytesRead;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool StreamScanner::ensure( size_t count )
+{
+	while( size_t( mEnd - mPos ) < count )
+		if( ! refill() )
+			return false;
+	return true;
+}
+
+void StreamScanner::skipWhitespace()
+{
+	for( ;; ) {
+		while( mPos < mEnd && ( *mPos == ' ' || *mPos == '\n' || *mPos == '\r' || *mPos == '\t' ) )
+			++mPos;
+		if( mPos < mEnd || ! refill() )
+			return;
+	}
+}
+
+int StreamScanner::readUntil( const Delimiters &delimiters, std::string *out )
+{
+	for( ;; ) {
+		const char *p = mPos;
+		while( p < mEnd && ! delimiters.contains( *p ) )
+			++p;
+		if( out )
+			out->append( mPos, p );
+		mPos = p;
+		if( p < mEnd )
+			return (uint8_t)*p;
+		if( ! refill() )
+			return -1;
+	}
+}
+
+bool StreamScanner::skipPast( const char *terminator )
+{
+	const char first[2] = { terminator[0], 0 };
+	const Delimiters delimiters( first );
+	for( ;; ) {
+		if( readUntil( delimiters, 0 ) < 0 )
+			return false;
+		if( match( terminator ) )
+			return true;
+		++mPos;
+	}
+}
+
+bool StreamScanner::match( const char *literal )
+{
+	const size_t length = std::strlen( literal );
+	if( ! ensure( length ) || std::memcmp( mPos, literal, length ) != 0 )
+		return false;
+	mPos += length;
+	return true;
+}
+
+void StreamScanner::beginCapture( std::string *capture )
+{
+	mCapture = capture;
+	mCaptureStart = mPos;
+}
+
+void StreamScanner::endCapture()
+{
+	if( mCapture )
+		mCapture->append( mCaptureStart, mPos );
+	mCapture = 0;
+}
+
+} // namespace cinder
@@ -0,0 +1,233 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/Thread.h"
+
+#include <boost/exception_ptr.hpp>
+#include <boost/thread/once.hpp>
+#include <vector>
+
+namespace cinder {
+
+namespace {
+
+// Keeps the first exception thrown by any of a task's threads, so that it can be rethrown on the calling thread. An exception
+// escaping a thread's function would otherwise end the process
+class FirstException {
+  public:
+	// call from inside a catch block
+	void capture()
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		if( ! mException )
+			mException = boost::current_exception();
+	}
+
+	// rethrows and clears the captured exception, if any
+	void rethrow()
+	{
+		boost::exception_ptr exception;
+		{
+			std::lock_guard<std::mutex> lock( mMutex );
+			exception = mException;
+			mException = boost::exception_ptr();
+		}
+		if( exception )
+			boost::rethrow_exception( exception );
+	}
+
+	void clear()
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mException = boost::exception_ptr();
+	}
+
+  private:
+	std::mutex				mMutex;
+	boost::exception_ptr	mException;
+};
+
+// Runs one ThreadTask index on a thread of its own, for the calls that can't use the pool
+class TaskThread {
+  public:
+	TaskThread( const ThreadTask *task, size_t threadIndex, FirstException *exception )
+		: mTask( task ), mThreadIndex( threadIndex ), mException( exception )
+	{}
+
+	void operator()() const
+	{
+		ThreadSetup threadSetup;
+		try {
+			mTask->run( mThreadIndex );
+		}
+		catch( ... ) {
+			mException->capture();
+		}
+	}
+
+  private:
+	const ThreadTask	*mTask;
+	size_t				mThreadIndex;
+	FirstException		*mException;
+};
+
+// Worker threads that sleep on a condition variable between tasks. Each call to run() wakes the first numThreads - 1 workers,
+// which run indices 1 and up while the calling thread runs index 0. Only one call uses the workers at a time. An exception thrown
+// by a worker is rethrown from run() once all indices have finished; one thrown by index 0 takes precedence
+class WorkerPool {
+  public:
+	WorkerPool()
+		: mTask( NULL ), mNumThreads( 0 ), mNumPending( 0 ), mGeneration( 0 )
+	{}
+
+	// returns false without running anything when another call is using the workers
+	bool run( const ThreadTask &task, size_t numThreads )
+	{
+		std::unique_lock<std::mutex> runLock( mRunMutex, boost::try_to_lock );
+		if( ! runLock.owns_lock() )
+			return false;
+
+		{
+			std::lock_guard<std::mutex> lock( mMutex );
+			while( mThreads.size() < numThreads - 1 )
+				mThreads.push_back( new std::thread( Worker( this, mThreads.size() + 1 ) ) );
+			mTask = &task;
+			mNumThreads = numThreads;
+			mNumPending = numThreads - 1;
+			++mGeneration;
+		}
+		mWake.notify_all();
+
+		try {
+			task.run( 0 );
+		}
+		catch( ... ) {
+			wait();
+			mException.clear();
+			throw;
+		}
+		wait();
+		mException.rethrow();
+		return true;
+	}
+
+  private:
+	class Worker {
+	  public:
+		Worker( WorkerPool *pool, size_t threadIndex )
+			: mPool( pool ), mThreadIndex( threadIndex )
+		{}
+
+		void operator()() const
+		{
+			mPool->workerLoop( mThreadIndex );
+		}
+
+	  private:
+		WorkerPool	*mPool;
+		size_t		mThreadIndex;
+	};
+
+	void workerLoop( size_t threadIndex )
+	{
+		std::unique_lock<std::mutex> lock( mMutex );
+		// a worker created by a call joins in from that call's generation on
+		size_t generation = mGeneration - 1;
+		while( true ) {
+			while( mGeneration == generation )
+				mWake.wait( lock );
+			generation = mGeneration;
+			if( threadIndex >= mNumThreads )
+				continue;
+
+			const ThreadTask *task = mTask;
+			lock.unlock();
+			{
+				ThreadSetup threadSetup;
+				try {
+					task->run( threadIndex );
+				}
+				catch( ... ) {
+					mException.capture();
+				}
+			}
+			lock.lock();
+			if( --mNumPending == 0 )
+				mDone.notify_all();
+		}
+	}
+
+	void wait()
+	{
+		std::unique_lock<std::mutex> lock( mMutex );
+		while( mNumPending > 0 )
+			mDone.wait( lock );
+	}
+
+	std::mutex					mRunMutex;
+	std::mutex					mMutex;
+	std::condition_variable		mWake, mDone;
+	const ThreadTask			*mTask;
+	size_t						mNumThreads, mNumPending, mGeneration;
+	FirstException				mException;
+	// the workers run until the process exits, so they are never joined
+	std::vector<std::thread*>	mThreads;
+};
+
+WorkerPool	*sWorkerPool = NULL;
+boost::once_flag sWorkerPoolOnce = BOOST_ONCE_INIT;
+
+void createWorkerPool()
+{
+	sWorkerPool = new WorkerPool;
+}
+
+} // anonymous namespace
+
+void runOnThreads( const ThreadTask &task, size_t numThreads )
+{
+	if( numThreads <= 1 ) {
+		task.run( 0 );
+		return;
+	}
+
+	boost::call_once( sWorkerPoolOnce, createWorkerPool );
+	if( sWorkerPool->run( task, numThreads ) )
+		return;
+
+	FirstException exception;
+	boost::thread_group threads;
+	for( size_t t = 1; t < numThreads; ++t )
+		threads.create_thread( TaskThread( &task, t, &exception ) );
+	try {
+		task.run( 0 );
+	}
+	catch( ... ) {
+		threads.join_all();
+		throw;
+	}
+	threads.join_all();
+	exception.rethrow();
+}
+
+} // namespace cinder
@@ -34,6 +34,8 @@ namespace cinder {
 // Timeline
 typedef std::multimap<void*,TimelineItemRef>::iterator s_iter;
 typedef std::multimap<void*,TimelineItemRef>::const_iterator s_const_iter;
+typedef std::vector<std::pair<const std::type_info*,TweenPoolBaseRef> >::iterator pool_iter;
+typedef std::vector<std::pair<const std::type_info*,TweenPoolBaseRef> >::const_iterator pool_const_iter;
 
 Timeline::Timeline()
 	: TimelineItem( 0, 0, 0, 0 ), mDefaultAutoRemove( true ), mCurrentTime( 0 )
@@ -47,6 +49,9 @@ Timeline::Timeline( const Timeline &rhs )
 	for( s_const_iter iter = rhs.mItems.begin(); iter != rhs.mItems.end(); ++iter ) {
 		mItems.insert( make_pair( iter->first, iter->second->clone() ) );
 	}
+	for( pool_const_iter poolIt = rhs.mTweenPools.begin(); poolIt != rhs.mTweenPools.end(); ++poolIt ) {
+		mTweenPools.push_back( make_pair( poolIt->first, poolIt->second->clone() ) );
+	}
 }
 
 void Timeline::step( float timestep )
@@ -71,6 +76,12 @@ void Timeline::stepTo( float absoluteTime )
 		if( iter->second->isComplete() && iter->second->getAutoRemove() )
 			iter->second->mMarkedForRemoval = true;
 	}
+
+	// pooled tweens are evaluated a whole pool at a time
+	for( pool_iter poolIt = mTweenPools.begin(); poolIt != mTweenPools.end(); ++poolIt ) {
+		if( poolIt->second->stepTo( mCurrentTime ) )
+			setDurationDirty();
+	}
 	
 	eraseMarked();	
 }
@@ -86,6 +97,16 @@ CueRef Timeline::add( std::function<void ()> action, float atTime )
 void Timeline::clear()
 {
 	mItems.clear();	
+	for( pool_iter poolIt = mTweenPools.begin(); poolIt != mTweenPools.end(); ++poolIt )
+		poolIt->second->clear();
+}
+
+size_t Timeline::getNumPooledTweens() const
+{
+	size_t result = 0;
+	for( pool_const_iter poolIt = mTweenPools.begin(); poolIt != mTweenPools.end(); ++poolIt )
+		result += poolIt->second->getNumTweens();
+	return result;
 }
 
 void Timeline::appendPingPong()
@@ -152,6 +173,10 @@ float Timeline::calcDuration() const
 	for( s_const_iter iter = mItems.begin(); iter != mItems.end(); ++iter ) {
 		duration = std::max( iter->second->getEndTime(), duration );
 	}
+	for( pool_const_iter poolIt = mTweenPools.begin(); poolIt != mTweenPools.end(); ++poolIt ) {
+		if( poolIt->second->getNumTweens() )
+			duration = std::max( poolIt->second->calcEndTime(), duration );
+	}
 	
 	return duration;
 }
@@ -195,6 +220,15 @@ float Timeline::findEndTimeOf( void *target, bool *found )
 		}
 	}
 	
+	// a target can't have both pooled and regular tweens, since applying either removes the other
+	for( pool_iter poolIt = mTweenPools.begin(); poolIt != mTweenPools.end(); ++poolIt ) {
+		if( poolIt->second->hasTarget( target ) ) {
+			if( found )
+				*found = true;
+			return poolIt->second->findEndTimeOf( target, getCurrentTime() );
+		}
+	}
+	
 	if( result != mItems.end() ) {
 		if( found )
 			*found = true;
@@ -225,6 +259,8 @@ void Timeline::removeTarget( void *target )
 	pair<s_iter,s_iter> range = mItems.equal_range( target );
 	for( s_iter iter = range.first; iter != range.second; ++iter )
 		iter->second->mMarkedForRemoval = true;
+	for( pool_iter poolIt = mTweenPools.begin(); poolIt != mTweenPools.end(); ++poolIt )
+		poolIt->second->removeTarget( target );
 
 	setDurationDirty();
 }
@@ -245,6 +281,8 @@ void Timeline::cloneAndReplaceTarget( void *target, void *replacementTarget )
 
 	for( vector<TimelineItemRef>::iterator newItemIt = newItems.begin(); newItemIt != newItems.end(); ++newItemIt )
 		mItems.insert( make_pair( replacementTarget, *newItemIt ) );
+	for( pool_iter poolIt = mTweenPools.begin(); poolIt != mTweenPools.end(); ++poolIt )
+		poolIt->second->cloneAndReplaceTarget( target, replacementTarget );
 
 	setDurationDirty();
 }
@@ -262,6 +300,8 @@ void Timeline::replaceTarget( void *target, void *replacementTarget )
 		mItems.insert( make_pair( replacementTarget, oldIter->second ) );
 		mItems.erase( oldIter );
 	}
+	for( pool_iter poolIt = mTweenPools.begin(); poolIt != mTweenPools.end(); ++poolIt )
+		poolIt->second->replaceTarget( target, replacementTarget );
 }
 
 void Timeline::reset( bool unsetStarted )
@@ -0,0 +1,679 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/TriMeshBvh.h"
+#include "cinder/BatchMath.h"
+#include "cinder/Thread.h"
+
+#include <algorithm>
+#include <limits>
+
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+#	include <emmintrin.h>
+#	include <xmmintrin.h>
+#endif
+
+namespace cinder {
+
+namespace {
+
+// number of bins per axis for the surface area heuristic
+const int SAH_BINS = 16;
+// below this depth splits fall back to the median, which bounds the depth of the tree and so the size of the traversal stack
+const int MAX_SAH_DEPTH = 32;
+const int MAX_STACK_DEPTH = 64;
+// subtrees of at least this many triangles are split further before the parallel build begins
+const uint32_t MIN_TASK_SIZE = 4096;
+// marks a placeholder for a parallel build task in the top of the tree; its mOffset is the task index
+const uint16_t TASK_AXIS = 3;
+// slightly enlarges the exit distance of ray/box tests, so that rounding never prunes a triangle lying on a box's boundary
+const float BOX_EXIT_SCALE = 1.0000008f;
+// rays per parallel task of the batched intersect()
+const size_t RAYS_PER_TASK = 256;
+
+inline float surfaceArea( const Vec3f &min, const Vec3f &max )
+{
+	Vec3f d = max - min;
+	return d.x * d.y + d.y * d.z + d.z * d.x;
+}
+
+inline void extend( Vec3f &min, Vec3f &max, const Vec3f &p )
+{
+	min.x = std::min( min.x, p.x ); min.y = std::min( min.y, p.y ); min.z = std::min( min.z, p.z );
+	max.x = std::max( max.x, p.x ); max.y = std::max( max.y, p.y ); max.z = std::max( max.z, p.z );
+}
+
+// Ray::calcTriangleIntersection(), which also returns the barycentric coordinates
+inline bool intersectTriangle( const Ray &ray, const Vec3f &vert0, const Vec3f &vert1, const Vec3f &vert2, float *result, float *resultU, float *resultV )
+{
+	const float EPSILON = 0.000001f;
+	Vec3f edge1 = vert1 - vert0;
+	Vec3f edge2 = vert2 - vert0;
+	Vec3f pvec = ray.getDirection().cross( edge2 );
+	float det = edge1.dot( pvec );
+	if( det > -EPSILON && det < EPSILON )
+		return false;
+
+	float inv_det = 1.0f / det;
+	Vec3f tvec = ray.getOrigin() - vert0;
+	float u = tvec.dot( pvec ) * inv_det;
+	if( u < 0.0f || u > 1.0f )
+		return false;
+
+	Vec3f qvec = tvec.cross( edge1 );
+	float v = ray.getDirection().dot( qvec ) * inv_det;
+	if( v < 0.0f || u + v > 1.0f )
+		return false;
+
+	*result = edge2.dot( qvec ) * inv_det;
+	*resultU = u;
+	*resultV = v;
+	return true;
+}
+
+// Ray::getInverseDirection() with infinities replaced by the largest finite float of the ray's sign. A zero direction component
+// otherwise gives an infinite inverse, and a ray starting exactly on a box's slab computes 0 * inf = NaN, which fails the slab test
+inline float safeInverse( const Ray &ray, int axis )
+{
+	const float inv = ray.getInverseDirection()[axis];
+	if( inv >= -std::numeric_limits<float>::max() && inv <= std::numeric_limits<float>::max() )
+		return inv;
+	const char sign = ( axis == 0 ) ? ray.getSignX() : ( ( axis == 1 ) ? ray.getSignY() : ray.getSignZ() );
+	return sign ? -std::numeric_limits<float>::max() : std::numeric_limits<float>::max();
+}
+
+// the parts of a Ray that the slab test reads, with a finite inverse direction
+struct BoxRay {
+	BoxRay( const Ray &ray )
+		: mOrigin( ray.getOrigin() ), mInvDirection( safeInverse( ray, 0 ), safeInverse( ray, 1 ), safeInverse( ray, 2 ) ),
+		mSignX( ray.getSignX() ), mSignY( ray.getSignY() ), mSignZ( ray.getSignZ() )
+	{}
+
+	Vec3f	mOrigin, mInvDirection;
+	int		mSignX, mSignY, mSignZ;
+};
+
+// slab test in the style of AxisAlignedBox3f::intersects( Ray ), limited to distances in [0, maxDistance]
+inline bool intersectBox( const Vec3f &min, const Vec3f &max, const BoxRay &ray, float maxDistance )
+{
+	const Vec3f &o = ray.mOrigin, &inv = ray.mInvDirection;
+	const Vec3f *bounds[2] = { &min, &max };
+	const int signX = ray.mSignX, signY = ray.mSignY, signZ = ray.mSignZ;
+	float tmin = ( bounds[signX]->x - o.x ) * inv.x;
+	float tmax = ( bounds[1 - signX]->x - o.x ) * inv.x;
+	float tymin = ( bounds[signY]->y - o.y ) * inv.y;
+	float tymax = ( bounds[1 - signY]->y - o.y ) * inv.y;
+	float tzmin = ( bounds[signZ]->z - o.z ) * inv.z;
+	float tzmax = ( bounds[1 - signZ]->z - o.z ) * inv.z;
+	tmin = std::max( std::max( tmin, tymin ), std::max( tzmin, 0.0f ) );
+	tmax = std::min( std::min( tmax, tymax ), std::min( tzmax, maxDistance ) ) * BOX_EXIT_SCALE;
+	return tmin <= tmax;
+}
+
+inline char getSign( const Ray &ray, int axis )
+{
+	return ( axis == 0 ) ? ray.getSignX() : ( ( axis == 1 ) ? ray.getSignY() : ray.getSignZ() );
+}
+
+struct TriangleBounds {
+	Vec3f	mMin, mMax, mCentroid;
+};
+
+// maps a centroid to its SAH bin along one axis; used both to fill the bins and to partition, so the two always agree
+struct BinMapping {
+	BinMapping( int axis, float min, float extent )
+		: mAxis( axis ), mMin( min ), mScale( ( extent > 0 ) ? SAH_BINS * ( 1.0f - 1e-6f ) / extent : 0 )
+	{}
+
+	int operator()( const Vec3f &centroid ) const
+	{
+		int bin = (int)( ( centroid[mAxis] - mMin ) * mScale );
+		return std::min( std::max( bin, 0 ), SAH_BINS - 1 );
+	}
+
+	int		mAxis;
+	float	mMin, mScale;
+};
+
+struct BinLess {
+	BinLess( const BinMapping &mapping, const std::vector<TriangleBounds> *triangles, int splitBin )
+		: mMapping( mapping ), mTriangles( triangles ), mSplitBin( splitBin )
+	{}
+
+	bool operator()( uint32_t tri ) const { return mMapping( (*mTriangles)[tri].mCentroid ) < mSplitBin; }
+
+	BinMapping							mMapping;
+	const std::vector<TriangleBounds>	*mTriangles;
+	int							mSplitBin;
+};
+
+struct CentroidLess {
+	CentroidLess( int axis, const std::vector<TriangleBounds> *triangles ) : mAxis( axis ), mTriangles( triangles ) {}
+
+	bool operator()( uint32_t a, uint32_t b ) const { return (*mTriangles)[a].mCentroid[mAxis] < (*mTriangles)[b].mCentroid[mAxis]; }
+
+	int									mAxis;
+	const std::vector<TriangleBounds>	*mTriangles;
+};
+
+} // anonymous namespace
+
+struct TriMeshBvh::BuildState {
+	std::vector<TriangleBounds>	mTriangles;
+	size_t					mMaxLeafSize;
+	// depth at which the top of the tree hands subtrees to parallel tasks
+	int						mTaskDepth;
+};
+
+struct TriMeshBvh::BuildTask {
+	BuildTask( uint32_t begin, uint32_t end, int depth ) : mBegin( begin ), mEnd( end ), mDepth( depth ) {}
+
+	uint32_t			mBegin, mEnd;
+	int					mDepth;
+	std::vector<Node>	mNodes;
+};
+
+struct TriMeshBvh::ParallelBuild {
+	ParallelBuild( TriMeshBvh *bvh, const BuildState *state, std::vector<BuildTask> *tasks ) : mBvh( bvh ), mState( state ), mTasks( tasks ) {}
+
+	void operator()( size_t begin, size_t end ) const
+	{
+		for( size_t t = begin; t < end; ++t ) {
+			BuildTask &task = (*mTasks)[t];
+			mBvh->buildNode( *mState, task.mNodes, task.mBegin, task.mEnd, task.mDepth, 0 );
+		}
+	}
+
+	TriMeshBvh				*mBvh;
+	const BuildState		*mState;
+	std::vector<BuildTask>	*mTasks;
+};
+
+// copies each leaf-order triangle's vertices from the mesh and recomputes the bounds of the leaves
+struct TriMeshBvh::ParallelRefit {
+	ParallelRefit( TriMeshBvh *bvh, const TriMesh *mesh, bool leaves ) : mBvh( bvh ), mMesh( mesh ), mLeaves( leaves ) {}
+
+	void operator()( size_t begin, size_t end ) const
+	{
+		if( ! mLeaves ) {
+			for( size_t i = begin; i < end; ++i )
+				mMesh->getTriangleVertices( mBvh->mTriangles[i], &mBvh->mVertices[i * 3], &mBvh->mVertices[i * 3 + 1], &mBvh->mVertices[i * 3 + 2] );
+			return;
+		}
+		for( size_t n = begin; n < end; ++n ) {
+			Node &node = mBvh->mNodes[n];
+			if( node.mCount == 0 )
+				continue;
+			node.mMin = node.mMax = mBvh->mVertices[node.mOffset * 3];
+			for( size_t v = node.mOffset * 3; v < ( node.mOffset + node.mCount ) * 3; ++v )
+				extend( node.mMin, node.mMax, mBvh->mVertices[v] );
+		}
+	}
+
+	TriMeshBvh		*mBvh;
+	const TriMesh	*mMesh;
+	bool			mLeaves;
+};
+
+struct TriMeshBvh::ParallelIntersect {
+	ParallelIntersect( const TriMeshBvh *bvh, const Ray *rays, size_t count, Hit *hits, float maxDistance, bool packets )
+		: mBvh( bvh ), mRays( rays ), mCount( count ), mHits( hits ), mMaxDistance( maxDistance ), mPackets( packets )
+	{}
+
+	void operator()( size_t begin, size_t end ) const
+	{
+		for( size_t i = begin; i < end; ) {
+			if( mPackets ) {
+				size_t packetSize = std::min<size_t>( 4, end - i );
+				mBvh->intersectPacket( mRays + i, packetSize, mHits + i, mMaxDistance );
+				i += packetSize;
+			}
+			else {
+				mHits[i] = Hit();
+				mBvh->intersect( mRays[i], &mHits[i], mMaxDistance );
+				++i;
+			}
+		}
+	}
+
+	const TriMeshBvh	*mBvh;
+	const Ray			*mRays;
+	size_t				mCount;
+	Hit					*mHits;
+	float				mMaxDistance;
+	bool				mPackets;
+};
+
+TriMeshBvh::TriMeshBvh( const TriMesh &mesh, size_t maxLeafSize )
+{
+	build( mesh, maxLeafSize );
+}
+
+void TriMeshBvh::build( const TriMesh &mesh, size_t maxLeafSize )
+{
+	const uint32_t numTriangles = (uint32_t)mesh.getNumTriangles();
+	mNodes.clear();
+	mTriangles.resize( numTriangles );
+	mVertices.resize( numTriangles * 3 );
+	if( numTriangles == 0 )
+		return;
+
+	BuildState state;
+	state.mMaxLeafSize = std::min<size_t>( std::max<size_t>( maxLeafSize, 1 ), 255 );
+	state.mTriangles.resize( numTriangles );
+	for( uint32_t t = 0; t < numTriangles; ++t ) {
+		TriangleBounds &bounds = state.mTriangles[t];
+		Vec3f a, b, c;
+		mesh.getTriangleVertices( t, &a, &b, &c );
+		bounds.mMin = bounds.mMax = a;
+		extend( bounds.mMin, bounds.mMax, b );
+		extend( bounds.mMin, bounds.mMax, c );
+		bounds.mCentroid = ( bounds.mMin + bounds.mMax ) * 0.5f;
+		mTriangles[t] = t;
+	}
+
+	// split the top of the tree serially into up to 8 subtrees per core, build those in parallel and then splice them into one depth-first array
+	state.mTaskDepth = 0;
+	while( ( 1u << state.mTaskDepth ) < std::max<unsigned>( 1, std::thread::hardware_concurrency() ) * 8 )
+		++state.mTaskDepth;
+	std::vector<Node> topNodes;
+	std::vector<BuildTask> tasks;
+	buildNode( state, topNodes, 0, numTriangles, 0, &tasks );
+	parallelFor( tasks.size(), ParallelBuild( this, &state, &tasks ), 1 );
+
+	size_t numNodes = topNodes.size();
+	for( size_t t = 0; t < tasks.size(); ++t )
+		numNodes += tasks[t].mNodes.size();
+	mNodes.reserve( numNodes );
+	copyNodes( topNodes, tasks, 0 );
+
+	refit( mesh );
+}
+
+// Appends the subtree over mTriangles[begin, end), whose root is \a depth levels down the tree, to \a nodes and returns the index of its root.
+// While building the top of the tree \a tasks is non-NULL, and subtrees below the task depth or too small to be worth splitting further become tasks.
+uint32_t TriMeshBvh::buildNode( const BuildState &state, std::vector<Node> &nodes, uint32_t begin, uint32_t end, int depth, std::vector<BuildTask> *tasks )
+{
+	const uint32_t index = (uint32_t)nodes.size();
+	nodes.push_back( Node() );
+	nodes[index].mOffset = begin;
+	nodes[index].mCount = 0;
+	nodes[index].mAxis = 0;
+	const uint32_t count = end - begin;
+	if( tasks && ( depth >= state.mTaskDepth || count < MIN_TASK_SIZE ) ) {
+		nodes[index].mAxis = TASK_AXIS;
+		nodes[index].mOffset = (uint32_t)tasks->size();
+		tasks->push_back( BuildTask( begin, end, depth ) );
+		return index;
+	}
+	if( count <= state.mMaxLeafSize ) {
+		nodes[index].mCount = (uint16_t)count;
+		return index;
+	}
+
+	Vec3f centroidMin = state.mTriangles[mTriangles[begin]].mCentroid, centroidMax = centroidMin;
+	for( uint32_t i = begin + 1; i < end; ++i )
+		extend( centroidMin, centroidMax, state.mTriangles[mTriangles[i]].mCentroid );
+	Vec3f extent = centroidMax - centroidMin;
+	int longestAxis = ( extent.x >= extent.y && extent.x >= extent.z ) ? 0 : ( ( extent.y >= extent.z ) ? 1 : 2 );
+
+	// bin the triangles along each axis by centroid, in one pass over them, and pick the split minimizing the summed area * count of the two sides
+	int bestAxis = -1, bestBin = 0;
+	float bestCost = FLT_MAX;
+	if( depth < MAX_SAH_DEPTH && ( extent.x > 0 || extent.y > 0 || extent.z > 0 ) ) {
+		BinMapping mappings[3] = { BinMapping( 0, centroidMin.x, extent.x ), BinMapping( 1, centroidMin.y, extent.y ), BinMapping( 2, centroidMin.z, extent.z ) };
+		uint32_t binCounts[3][SAH_BINS] = { { 0 } };
+		Vec3f binMins[3][SAH_BINS], binMaxs[3][SAH_BINS];
+		for( int axis = 0; axis < 3; ++axis ) {
+			for( int b = 0; b < SAH_BINS; ++b ) {
+				binMins[axis][b] = Vec3f( FLT_MAX, FLT_MAX, FLT_MAX );
+				binMaxs[axis][b] = -binMins[axis][b];
+			}
+		}
+		for( uint32_t i = begin; i < end; ++i ) {
+			const TriangleBounds &tri = state.mTriangles[mTriangles[i]];
+			for( int axis = 0; axis < 3; ++axis ) {
+				int b = mappings[axis]( tri.mCentroid );
+				++binCounts[axis][b];
+				extend( binMins[axis][b], binMaxs[axis][b], tri.mMin );
+				extend( binMins[axis][b], binMaxs[axis][b], tri.mMax );
+			}
+		}
+
+		for( int axis = 0; axis < 3; ++axis ) {
+			if( extent[axis] <= 0 )
+				continue;
+			// leftCosts[b] covers bins [0, b), swept forward; the backward sweep adds the right side of each split
+			float leftCosts[SAH_BINS];
+			Vec3f sideMin( FLT_MAX, FLT_MAX, FLT_MAX ), sideMax = -sideMin;
+			uint32_t sideCount = 0;
+			for( int b = 1; b < SAH_BINS; ++b ) {
+				sideCount += binCounts[axis][b - 1];
+				if( binCounts[axis][b - 1] ) {
+					extend( sideMin, sideMax, binMins[axis][b - 1] );
+					extend( sideMin, sideMax, binMaxs[axis][b - 1] );
+				}
+				leftCosts[b] = sideCount ? surfaceArea( sideMin, sideMax ) * sideCount : 0;
+			}
+			sideMin = Vec3f( FLT_MAX, FLT_MAX, FLT_MAX );
+			sideMax = -sideMin;
+			sideCount = 0;
+			for( int b = SAH_BINS - 1; b > 0; --b ) {
+				sideCount += binCounts[axis][b];
+				if( binCounts[axis][b] ) {
+					extend( sideMin, sideMax, binMins[axis][b] );
+					extend( sideMin, sideMax, binMaxs[axis][b] );
+				}
+				if( sideCount == 0 || sideCount == count )
+					continue;
+				float cost = leftCosts[b] + surfaceArea( sideMin, sideMax ) * sideCount;
+				if( cost < bestCost ) {
+					bestCost = cost;
+					bestAxis = axis;
+					bestBin = b;
+				}
+			}
+		}
+	}
+
+	uint32_t mid;
+	if( bestAxis >= 0 ) {
+		BinMapping mapping( bestAxis, centroidMin[bestAxis], extent[bestAxis] );
+		mid = (uint32_t)( std::partition( &mTriangles[0] + begin, &mTriangles[0] + end, BinLess( mapping, &state.mTriangles, bestBin ) ) - &mTriangles[0] );
+	}
+	else {
+		// coincident centroids, or too deep for SAH; split at the median
+		bestAxis = longestAxis;
+		mid = begin + count / 2;
+		std::nth_element( &mTriangles[0] + begin, &mTriangles[0] + mid, &mTriangles[0] + end, CentroidLess( bestAxis, &state.mTriangles ) );
+	}
+
+	nodes[index].mAxis = (uint16_t)bestAxis;
+	buildNode( state, nodes, begin, mid, depth + 1, tasks );
+	uint32_t right = buildNode( state, nodes, mid, end, depth + 1, tasks );
+	nodes[index].mOffset = right;
+	return index;
+}
+
+// appends the subtree rooted at \a node of \a topNodes to mNodes depth-first, substituting each task placeholder with the task's nodes
+void TriMeshBvh::copyNodes( const std::vector<Node> &topNodes, const std::vector<BuildTask> &tasks, uint32_t node )
+{
+	const Node &top = topNodes[node];
+	if( top.mAxis == TASK_AXIS ) {
+		const std::vector<Node> &taskNodes = tasks[top.mOffset].mNodes;
+		const uint32_t base = (uint32_t)mNodes.size();
+		for( size_t n = 0; n < taskNodes.size(); ++n ) {
+			mNodes.push_back( taskNodes[n] );
+			if( taskNodes[n].mCount == 0 )
+				mNodes.back().mOffset += base;
+		}
+		return;
+	}
+
+	const uint32_t index = (uint32_t)mNodes.size();
+	mNodes.push_back( top );
+	if( top.mCount == 0 ) {
+		copyNodes( topNodes, tasks, node + 1 );
+		mNodes[index].mOffset = (uint32_t)mNodes.size();
+		copyNodes( topNodes, tasks, top.mOffset );
+	}
+}
+
+void TriMeshBvh::refit( const TriMesh &mesh )
+{
+	parallelFor( mTriangles.size(), ParallelRefit( this, &mesh, false ), 4096 );
+	parallelFor( mNodes.size(), ParallelRefit( this, &mesh, true ), 4096 );
+	// children always follow their parents, so a backward pass sees both children before their parent
+	for( size_t n = mNodes.size(); n-- > 0; ) {
+		Node &node = mNodes[n];
+		if( node.mCount == 0 ) {
+			node.mMin = mNodes[n + 1].mMin;
+			node.mMax = mNodes[n + 1].mMax;
+			extend( node.mMin, node.mMax, mNodes[node.mOffset].mMin );
+			extend( node.mMin, node.mMax, mNodes[node.mOffset].mMax );
+		}
+	}
+}
+
+AxisAlignedBox3f TriMeshBvh::getBounds() const
+{
+	if( mNodes.empty() )
+		return AxisAlignedBox3f( Vec3f::zero(), Vec3f::zero() );
+	return AxisAlignedBox3f( mNodes[0].mMin, mNodes[0].mMax );
+}
+
+bool TriMeshBvh::intersect( const Ray &ray, Hit *hit, float maxDistance ) const
+{
+	if( mNodes.empty() )
+		return false;
+
+	uint32_t stack[MAX_STACK_DEPTH];
+	int stackSize = 0;
+	uint32_t nodeIndex = 0;
+	Hit best;
+	best.mDistance = maxDistance;
+	const BoxRay boxRay( ray );
+	while( true ) {
+		const Node &node = mNodes[nodeIndex];
+		if( intersectBox( node.mMin, node.mMax, boxRay, best.mDistance ) ) {
+			if( node.mCount == 0 ) {
+				// visit the child on the near side of the split first
+				if( getSign( ray, node.mAxis ) ) {
+					stack[stackSize++] = nodeIndex + 1;
+					nodeIndex = node.mOffset;
+				}
+				else {
+					stack[stackSize++] = node.mOffset;
+					nodeIndex = nodeIndex + 1;
+				}
+				continue;
+			}
+			for( uint32_t i = node.mOffset; i < node.mOffset + node.mCount; ++i ) {
+				float t, u, v;
+				if( intersectTriangle( ray, mVertices[i * 3], mVertices[i * 3 + 1], mVertices[i * 3 + 2], &t, &u, &v ) && t > 0 && t < best.mDistance ) {
+					best.mTriangle = mTriangles[i];
+					best.mDistance = t;
+					best.mU = u;
+					best.mV = v;
+				}
+			}
+		}
+		if( stackSize == 0 )
+			break;
+		nodeIndex = stack[--stackSize];
+	}
+
+	if( ! best.isHit() )
+		return false;
+	*hit = best;
+	return true;
+}
+
+bool TriMeshBvh::intersectAny( const Ray &ray, float maxDistance ) const
+{
+	if( mNodes.empty() )
+		return false;
+
+	uint32_t stack[MAX_STACK_DEPTH];
+	int stackSize = 0;
+	uint32_t nodeIndex = 0;
+	const BoxRay boxRay( ray );
+	while( true ) {
+		const Node &node = mNodes[nodeIndex];
+		if( intersectBox( node.mMin, node.mMax, boxRay, maxDistance ) ) {
+			if( node.mCount == 0 ) {
+				stack[stackSize++] = node.mOffset;
+				nodeIndex = nodeIndex + 1;
+				continue;
+			}
+			for( uint32_t i = node.mOffset; i < node.mOffset + node.mCount; ++i ) {
+				float t, u, v;
+				if( intersectTriangle( ray, mVertices[i * 3], mVertices[i * 3 + 1], mVertices[i * 3 + 2], &t, &u, &v ) && t > 0 && t < maxDistance )
+					return true;
+			}
+		}
+		if( stackSize == 0 )
+			return false;
+		nodeIndex = stack[--stackSize];
+	}
+}
+
+void TriMeshBvh::intersect( const Ray *rays, size_t count, Hit *hits, float maxDistance ) const
+{
+	bool packets = false;
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+	packets = batch::isSimdEnabled();
+#endif
+	parallelFor( count, ParallelIntersect( this, rays, count, hits, maxDistance, packets ), RAYS_PER_TASK );
+}
+
+#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+
+namespace {
+
+inline __m128 select( __m128 mask, __m128 a, __m128 b )
+{
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+
+} // anonymous namespace
+
+// Traverses the tree with up to four rays at once, visiting a node when any of them hits its bounds. The triangle test repeats
+// intersectTriangle()'s arithmetic lane-wise, so each ray's distance matches intersect().
+void TriMeshBvh::intersectPacket( const Ray *rays, size_t count, Hit *hits, float maxDistance ) const
+{
+	for( size_t r = 0; r < count; ++r )
+		hits[r] = Hit();
+	if( mNodes.empty() )
+		return;
+
+	// unused lanes repeat the first ray
+	float o[3][4], d[3][4], inv[3][4];
+	for( int lane = 0; lane < 4; ++lane ) {
+		const Ray &ray = rays[( lane < (int)count ) ? lane : 0];
+		for( int a = 0; a < 3; ++a ) {
+			o[a][lane] = ray.getOrigin()[a];
+			d[a][lane] = ray.getDirection()[a];
+			inv[a][lane] = safeInverse( ray, a );
+		}
+	}
+	const __m128 ox = _mm_loadu_ps( o[0] ), oy = _mm_loadu_ps( o[1] ), oz = _mm_loadu_ps( o[2] );
+	const __m128 dx = _mm_loadu_ps( d[0] ), dy = _mm_loadu_ps( d[1] ), dz = _mm_loadu_ps( d[2] );
+	const __m128 ix = _mm_loadu_ps( inv[0] ), iy = _mm_loadu_ps( inv[1] ), iz = _mm_loadu_ps( inv[2] );
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps( 1.0f ), exitScale = _mm_set1_ps( BOX_EXIT_SCALE );
+	const __m128 epsilon = _mm_set1_ps( 0.000001f ), negEpsilon = _mm_set1_ps( -0.000001f );
+	__m128 bestT = _mm_set1_ps( maxDistance ), bestU = zero, bestV = zero;
+	__m128i bestTri = _mm_set1_epi32( (int)NO_HIT );
+
+	uint32_t stack[MAX_STACK_DEPTH];
+	int stackSize = 0;
+	uint32_t nodeIndex = 0;
+	while( true ) {
+		const Node &node = mNodes[nodeIndex];
+		__m128 t0 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( node.mMin.x ), ox ), ix ), t1 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( node.mMax.x ), ox ), ix );
+		__m128 tmin = _mm_min_ps( t0, t1 ), tmax = _mm_max_ps( t0, t1 );
+		t0 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( node.mMin.y ), oy ), iy );
+		t1 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( node.mMax.y ), oy ), iy );
+		tmin = _mm_max_ps( tmin, _mm_min_ps( t0, t1 ) );
+		tmax = _mm_min_ps( tmax, _mm_max_ps( t0, t1 ) );
+		t0 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( node.mMin.z ), oz ), iz );
+		t1 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( node.mMax.z ), oz ), iz );
+		tmin = _mm_max_ps( tmin, _mm_min_ps( t0, t1 ) );
+		tmax = _mm_mul_ps( _mm_min_ps( tmax, _mm_max_ps( t0, t1 ) ), exitScale );
+		__m128 boxHit = _mm_and_ps( _mm_and_ps( _mm_cmple_ps( tmin, tmax ), _mm_cmpge_ps( tmax, zero ) ), _mm_cmple_ps( tmin, bestT ) );
+
+		if( _mm_movemask_ps( boxHit ) ) {
+			if( node.mCount == 0 ) {
+				// order the children by the first ray's direction
+				if( getSign( rays[0], node.mAxis ) ) {
+					stack[stackSize++] = nodeIndex + 1;
+					nodeIndex = node.mOffset;
+				}
+				else {
+					stack[stackSize++] = node.mOffset;
+					nodeIndex = nodeIndex + 1;
+				}
+				continue;
+			}
+			for( uint32_t i = node.mOffset; i < node.mOffset + node.mCount; ++i ) {
+				const Vec3f &v0 = mVertices[i * 3];
+				const Vec3f edge1 = mVertices[i * 3 + 1] - v0, edge2 = mVertices[i * 3 + 2] - v0;
+				const __m128 e1x = _mm_set1_ps( edge1.x ), e1y = _mm_set1_ps( edge1.y ), e1z = _mm_set1_ps( edge1.z );
+				const __m128 e2x = _mm_set1_ps( edge2.x ), e2y = _mm_set1_ps( edge2.y ), e2z = _mm_set1_ps( edge2.z );
+				__m128 px = _mm_sub_ps( _mm_mul_ps( dy, e2z ), _mm_mul_ps( e2y, dz ) );
+				__m128 py = _mm_sub_ps( _mm_mul_ps( dz, e2x ), _mm_mul_ps( e2z, dx ) );
+				__m128 pz = _mm_sub_ps( _mm_mul_ps( dx, e2y ), _mm_mul_ps( e2x, dy ) );
+				__m128 det = _mm_add_ps( _mm_add_ps( _mm_mul_ps( e1x, px ), _mm_mul_ps( e1y, py ) ), _mm_mul_ps( e1z, pz ) );
+				__m128 valid = _mm_or_ps( _mm_cmple_ps( det, negEpsilon ), _mm_cmpge_ps( det, epsilon ) );
+				__m128 invDet = _mm_div_ps( one, det );
+				__m128 tx = _mm_sub_ps( ox, _mm_set1_ps( v0.x ) ), ty = _mm_sub_ps( oy, _mm_set1_ps( v0.y ) ), tz = _mm_sub_ps( oz, _mm_set1_ps( v0.z ) );
+				__m128 u = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( tx, px ), _mm_mul_ps( ty, py ) ), _mm_mul_ps( tz, pz ) ), invDet );
+				valid = _mm_and_ps( valid, _mm_and_ps( _mm_cmpge_ps( u, zero ), _mm_cmple_ps( u, one ) ) );
+				__m128 qx = _mm_sub_ps( _mm_mul_ps( ty, e1z ), _mm_mul_ps( e1y, tz ) );
+				__m128 qy = _mm_sub_ps( _mm_mul_ps( tz, e1x ), _mm_mul_ps( e1z, tx ) );
+				__m128 qz = _mm_sub_ps( _mm_mul_ps( tx, e1y ), _mm_mul_ps( e1x, ty ) );
+				__m128 v = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( dx, qx ), _mm_mul_ps( dy, qy ) ), _mm_mul_ps( dz, qz ) ), invDet );
+				valid = _mm_and_ps( valid, _mm_and_ps( _mm_cmpge_ps( v, zero ), _mm_cmple_ps( _mm_add_ps( u, v ), one ) ) );
+				__m128 t = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( e2x, qx ), _mm_mul_ps( e2y, qy ) ), _mm_mul_ps( e2z, qz ) ), invDet );
+				valid = _mm_and_ps( valid, _mm_and_ps( _mm_cmpgt_ps( t, zero ), _mm_cmplt_ps( t, bestT ) ) );
+				if( _mm_movemask_ps( valid ) ) {
+					bestT = select( valid, t, bestT );
+					bestU = select( valid, u, bestU );
+					bestV = select( valid, v, bestV );
+					bestTri = _mm_castps_si128( select( valid, _mm_castsi128_ps( _mm_set1_epi32( (int)mTriangles[i] ) ), _mm_castsi128_ps( bestTri ) ) );
+				}
+			}
+		}
+		if( stackSize == 0 )
+			break;
+		nodeIndex = stack[--stackSize];
+	}
+
+	float resultT[4], resultU[4], resultV[4];
+	uint32_t resultTri[4];
+	_mm_storeu_ps( resultT, bestT );
+	_mm_storeu_ps( resultU, bestU );
+	_mm_storeu_ps( resultV, bestV );
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( resultTri ), bestTri );
+	for( size_t r = 0; r < count; ++r ) {
+		if( resultTri[r] != NO_HIT ) {
+			hits[r].mTriangle = resultTri[r];
+			hits[r].mDistance = resultT[r];
+			hits[r].mU = resultU[r];
+			hits[r].mV = resultV[r];
+		}
+	}
+}
+
+#else
+
+void TriMeshBvh::intersectPacket( const Ray *rays, size_t count, Hit *hits, float maxDistance ) const
+{
+	for( size_t r = 0; r < count; ++r ) {
+		hits[r] = Hit();
+		intersect( rays[r], &hits[r], maxDistance );
+	}
+}
+
+#endif // defined( CINDER_MSW ) || defined( CINDER_MAC )
+
+} // namespace cinder
@@ -0,0 +1,645 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/TriMeshLod.h"
+#include "cinder/TriMeshOptimizer.h"
+#include "cinder/CinderMath.h"
+#include "cinder/Thread.h"
+
+#include <algorithm>
+
+using std::vector;
+
+namespace cinder {
+
+namespace {
+
+struct Quadric {
+	Quadric() : a2( 0 ), ab( 0 ), ac( 0 ), ad( 0 ), b2( 0 ), bc( 0 ), bd( 0 ), c2( 0 ), cd( 0 ), d2( 0 ), w( 0 ) {}
+	Quadric( const Vec3d &n, double d, double weight )
+		: a2( n.x * n.x * weight ), ab( n.x * n.y * weight ), ac( n.x * n.z * weight ), ad( n.x * d * weight ),
+		b2( n.y * n.y * weight ), bc( n.y * n.z * weight ), bd( n.y * d * weight ),
+		c2( n.z * n.z * weight ), cd( n.z * d * weight ), d2( d * d * weight ), w( weight )
+	{}
+
+	void operator+=( const Quadric &rhs )
+	{
+		a2 += rhs.a2; ab += rhs.ab; ac += rhs.ac; ad += rhs.ad;
+		b2 += rhs.b2; bc += rhs.bc; bd += rhs.bd;
+		c2 += rhs.c2; cd += rhs.cd; d2 += rhs.d2;
+		w += rhs.w;
+	}
+
+	//! Weighted mean squared distance of \a p to the accumulated planes
+	double eval( const Vec3f &p ) const
+	{
+		double x = p.x, y = p.y, z = p.z;
+		double result = a2 * x * x + b2 * y * y + c2 * z * z + d2
+			+ 2 * ( ab * x * y + ac * x * z + bc * y * z + ad * x + bd * y + cd * z );
+		return ( w > 0 ) ? std::max( result, 0.0 ) / w : 0;
+	}
+
+	double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2, w;
+};
+
+struct Collapse {
+	uint32_t	mFrom, mTo;
+	double		mCost;
+
+	bool operator<( const Collapse &rhs ) const { return mCost < rhs.mCost; }
+};
+
+const uint32_t NO_PLANE = 0xFFFFFFFF;
+
+inline uint64_t edgeKey( uint32_t a, uint32_t b )
+{
+	return ( a < b ) ? ( ( (uint64_t)a << 32 ) | b ) : ( ( (uint64_t)b << 32 ) | a );
+}
+
+// attributes shorter than the vertex list are ignored
+template<typename T>
+inline bool attributeEqual( const vector<T> &attr, uint32_t a, uint32_t b )
+{
+	return std::max( a, b ) >= attr.size() || attr[a] == attr[b];
+}
+
+template<typename T>
+inline void copyAttribute( const vector<T> &source, uint32_t sourceIndex, vector<T> *dest, uint32_t destIndex )
+{
+	if( std::max( sourceIndex, destIndex ) < std::min( source.size(), dest->size() ) )
+		(*dest)[destIndex] = source[sourceIndex];
+}
+
+// Whether vertices \a a and \a b agree in every attribute other than the normal. Vertices which differ only in their normals
+// lie on a hard edge, where faces may carry their vertex to a new position without opening a crack in the texture or colors
+inline bool sameSurfaceAttributes( const TriMesh &mesh, uint32_t a, uint32_t b )
+{
+	return attributeEqual( mesh.getTexCoords(), a, b ) && attributeEqual( mesh.getColorsRGB(), a, b ) && attributeEqual( mesh.getColorsRGBA(), a, b );
+}
+
+// Simplifies one connected component. Works on local position ids; mWedges holds the source vertex index of every triangle corner.
+// A collapse moves all of a position's wedges together: each onto the wedge of the target in a triangle they share, or, for a wedge
+// which shares no triangle with the target, onto the target's position with its own normal and the target's other attributes
+class ComponentSimplifier {
+  public:
+	ComponentSimplifier( const TriMesh &source, const vector<uint32_t> &wedgePositions, vector<uint32_t> *wedges )
+		: mSource( source ), mWedges( *wedges )
+	{
+		const vector<Vec3f> &sourcePositions = source.getVertices();
+		// gather this component's positions and translate into a local id space
+		vector<uint32_t> globalIds;
+		globalIds.reserve( mWedges.size() );
+		for( size_t i = 0; i < mWedges.size(); ++i )
+			globalIds.push_back( wedgePositions[mWedges[i]] );
+		std::sort( globalIds.begin(), globalIds.end() );
+		globalIds.erase( std::unique( globalIds.begin(), globalIds.end() ), globalIds.end() );
+
+		mCorners.resize( mWedges.size() );
+		mPositions.resize( globalIds.size() );
+		for( size_t i = 0; i < mWedges.size(); ++i ) {
+			uint32_t local = (uint32_t)( std::lower_bound( globalIds.begin(), globalIds.end(), wedgePositions[mWedges[i]] ) - globalIds.begin() );
+			mCorners[i] = local;
+			mPositions[local] = sourcePositions[mWedges[i]];
+		}
+
+		classifyVertices();
+		computeQuadrics();
+	}
+
+	/*! Collapses edges until \a targetTriangles remain or the next collapse's quadric error exceeds \a maxError.
+		Returns the largest distance from any remaining vertex to the planes of the source triangles merged into it. */
+	float simplify( size_t targetTriangles, float maxError )
+	{
+		const double maxCost = (double)maxError * maxError;
+		size_t numTris = mCorners.size() / 3;
+		vector<uint8_t> dirty( mPositions.size() );
+		vector<uint32_t> adjacencyOffset, adjacency, stamp( mPositions.size(), 0 );
+		vector<Collapse> candidates;
+		vector<std::pair<uint32_t,uint32_t> > wedgeMap;
+		uint32_t stampId = 0;
+
+		while( numTris > targetTriangles ) {
+			buildAdjacency( &adjacencyOffset, &adjacency );
+
+			candidates.clear();
+			for( size_t i = 0; i < numTris * 3; ++i ) {
+				uint32_t p = mCorners[i], q = mCorners[i - i % 3 + ( i + 1 ) % 3];
+				if( ! mLocked[p] ) {
+					Collapse c = { p, q, mQuadrics[p].eval( mPositions[q] ) };
+					candidates.push_back( c );
+				}
+			}
+			if( candidates.empty() )
+				break;
+			std::sort( candidates.begin(), candidates.end() );
+
+			// limit each pass to roughly the cheapest collapses needed to reach the target, so that costs are refreshed often
+			size_t goal = std::min( candidates.size(), std::max<size_t>( 1, ( numTris - targetTriangles ) / 2 ) );
+			double passLimit = std::min( maxCost, candidates[goal - 1].mCost * 1.5 + 1e-12 );
+
+			std::fill( dirty.begin(), dirty.end(), 0 );
+			size_t removed = 0;
+			for( size_t c = 0; c < candidates.size() && numTris - removed > targetTriangles; ++c ) {
+				const Collapse &collapse = candidates[c];
+				if( collapse.mCost > passLimit )
+					break;
+				uint32_t p = collapse.mFrom, q = collapse.mTo;
+				if( dirty[p] || dirty[q] || mLocked[p] )
+					continue;
+
+				const uint32_t *adj = &adjacency[adjacencyOffset[p]];
+				const size_t numAdj = adjacencyOffset[p + 1] - adjacencyOffset[p];
+
+				// link condition: the one-rings of p and q may only share the vertices opposite to edge pq
+				++stampId;
+				size_t shared = 0;
+				for( size_t a = 0; a < numAdj; ++a ) {
+					const uint32_t *tri = &mCorners[adj[a] * 3];
+					if( tri[0] == q || tri[1] == q || tri[2] == q )
+						++shared;
+					for( int k = 0; k < 3; ++k )
+						stamp[tri[k]] = stampId;
+				}
+				size_t common = 0;
+				++stampId;
+				for( uint32_t a = adjacencyOffset[q]; a < adjacencyOffset[q + 1]; ++a ) {
+					const uint32_t *tri = &mCorners[adjacency[a] * 3];
+					for( int k = 0; k < 3; ++k ) {
+						uint32_t r = tri[k];
+						if( r != p && r != q && stamp[r] == stampId - 1 ) {
+							stamp[r] = stampId;
+							++common;
+						}
+					}
+				}
+				if( shared == 0 || common != shared )
+					continue;
+
+				if( flipsTriangle( adj, numAdj, p, q ) || ! mapWedges( adj, numAdj, p, q, &wedgeMap ) )
+					continue;
+
+				for( size_t a = 0; a < numAdj; ++a ) {
+					uint32_t *tri = &mCorners[adj[a] * 3];
+					for( int k = 0; k < 3; ++k )
+						dirty[tri[k]] = 1;
+					if( tri[0] == q || tri[1] == q || tri[2] == q ) {
+						tri[0] = tri[1] = tri[2] = q; // degenerate; compacted after the pass
+						++removed;
+					}
+					else {
+						for( int k = 0; k < 3; ++k ) {
+							if( tri[k] == p ) {
+								tri[k] = q;
+								uint32_t &wedge = mWedges[adj[a]*3+k];
+								size_t w = 0;
+								while( w < wedgeMap.size() && wedgeMap[w].first != wedge )
+									++w;
+								if( w < wedgeMap.size() )
+									wedge = wedgeMap[w].second;
+								else
+									mMovedWedges.push_back( wedge );
+							}
+						}
+					}
+				}
+				mQuadrics[q] += mQuadrics[p];
+				mergePlanes( p, q );
+				mLocked[p] = 1;
+			}
+
+			if( removed == 0 )
+				break;
+			numTris = compactTriangles();
+		}
+
+		return (float)calcPlaneDistance();
+	}
+
+	//! Writes the final position of every wedge still in use to \a result, and the texture coordinates and colors of the wedges moved away from their position
+	void updateVertices( TriMesh *result )
+	{
+		std::sort( mMovedWedges.begin(), mMovedWedges.end() );
+		for( size_t i = 0; i < mCorners.size(); ++i ) {
+			const uint32_t wedge = mWedges[i], position = mCorners[i];
+			result->getVertices()[wedge] = mPositions[position];
+			if( std::binary_search( mMovedWedges.begin(), mMovedWedges.end(), wedge ) ) {
+				copyAttribute( mSource.getTexCoords(), mSurfaceWedges[position], &result->getTexCoords(), wedge );
+				copyAttribute( mSource.getColorsRGB(), mSurfaceWedges[position], &result->getColorsRGB(), wedge );
+				copyAttribute( mSource.getColorsRGBA(), mSurfaceWedges[position], &result->getColorsRGBA(), wedge );
+			}
+		}
+	}
+
+  private:
+	void classifyVertices()
+	{
+		mLocked.assign( mPositions.size(), 0 );
+
+		mHardEdgesOnly.assign( mPositions.size(), 1 );
+		mSurfaceWedges.resize( mPositions.size() );
+		for( size_t i = 0; i < mCorners.size(); ++i )
+			mSurfaceWedges[mCorners[i]] = mWedges[i];
+
+		// positions which are shared by several source vertices lie on a seam. Seams across which only the normal changes are hard edges
+		vector<std::pair<uint32_t,uint32_t> > wedges;
+		wedges.reserve( mCorners.size() );
+		for( size_t i = 0; i < mCorners.size(); ++i )
+			wedges.push_back( std::make_pair( mCorners[i], mWedges[i] ) );
+		std::sort( wedges.begin(), wedges.end() );
+		wedges.erase( std::unique( wedges.begin(), wedges.end() ), wedges.end() );
+		for( size_t w = 1; w < wedges.size(); ++w ) {
+			if( wedges[w].first == wedges[w - 1].first && ! sameSurfaceAttributes( mSource, wedges[w].second, wedges[w - 1].second ) )
+				mHardEdgesOnly[wedges[w].first] = 0;
+		}
+
+		// open borders and non-manifold edges are used by other than exactly 2 triangles
+		vector<uint64_t> edges;
+		edges.reserve( mCorners.size() );
+		for( size_t i = 0; i < mCorners.size(); ++i )
+			edges.push_back( edgeKey( mCorners[i], mCorners[i - i % 3 + ( i + 1 ) % 3] ) );
+		std::sort( edges.begin(), edges.end() );
+		for( size_t e = 0; e < edges.size(); ) {
+			size_t count = 1;
+			while( e + count < edges.size() && edges[e + count] == edges[e] )
+				++count;
+			if( count != 2 ) {
+				mLocked[(uint32_t)( edges[e] >> 32 )] = 1;
+				mLocked[(uint32_t)( edges[e] & 0xFFFFFFFF )] = 1;
+			}
+			e += count;
+		}
+	}
+
+	// Also records each source triangle's plane and links every corner into its vertex's plane list
+	void computeQuadrics()
+	{
+		const size_t numCorners = mCorners.size();
+		mQuadrics.assign( mPositions.size(), Quadric() );
+		mPlanes.assign( numCorners / 3, Vec4d::zero() );
+		mPlaneHead.assign( mPositions.size(), NO_PLANE );
+		mPlaneTail.assign( mPositions.size(), NO_PLANE );
+		mPlaneNext.assign( numCorners, NO_PLANE );
+		for( size_t t = 0; t < numCorners / 3; ++t ) {
+			Vec3d p0( mPositions[mCorners[t*3+0]] ), p1( mPositions[mCorners[t*3+1]] ), p2( mPositions[mCorners[t*3+2]] );
+			Vec3d normal = ( p1 - p0 ).cross( p2 - p0 );
+			double doubleArea = normal.length();
+			if( doubleArea <= 0 )
+				continue;
+			normal /= doubleArea;
+			mPlanes[t] = Vec4d( normal, -normal.dot( p0 ) );
+			Quadric q( normal, -normal.dot( p0 ), doubleArea * 0.5 );
+			for( int k = 0; k < 3; ++k ) {
+				mQuadrics[mCorners[t*3+k]] += q;
+				uint32_t v = mCorners[t*3+k], corner = (uint32_t)( t * 3 + k );
+				if( mPlaneTail[v] == NO_PLANE )
+					mPlaneHead[v] = corner;
+				else
+					mPlaneNext[mPlaneTail[v]] = corner;
+				mPlaneTail[v] = corner;
+			}
+		}
+	}
+
+	// Appends p's plane list to q's
+	void mergePlanes( uint32_t p, uint32_t q )
+	{
+		if( mPlaneHead[p] == NO_PLANE )
+			return;
+		if( mPlaneTail[q] == NO_PLANE )
+			mPlaneHead[q] = mPlaneHead[p];
+		else
+			mPlaneNext[mPlaneTail[q]] = mPlaneHead[p];
+		mPlaneTail[q] = mPlaneTail[p];
+		mPlaneHead[p] = mPlaneTail[p] = NO_PLANE;
+	}
+
+	double calcPlaneDistance() const
+	{
+		double result = 0;
+		for( size_t v = 0; v < mPositions.size(); ++v ) {
+			const Vec3d pos( mPositions[v] );
+			for( uint32_t corner = mPlaneHead[v]; corner != NO_PLANE; corner = mPlaneNext[corner] ) {
+				const Vec4d &plane = mPlanes[corner / 3];
+				result = std::max( result, math<double>::abs( plane.x * pos.x + plane.y * pos.y + plane.z * pos.z + plane.w ) );
+			}
+		}
+		return result;
+	}
+
+	void buildAdjacency( vector<uint32_t> *offsets, vector<uint32_t> *adjacency ) const
+	{
+		offsets->assign( mPositions.size() + 1, 0 );
+		for( size_t i = 0; i < mCorners.size(); ++i )
+			(*offsets)[mCorners[i] + 1]++;
+		for( size_t p = 0; p < mPositions.size(); ++p )
+			(*offsets)[p + 1] += (*offsets)[p];
+		adjacency->resize( mCorners.size() );
+		vector<uint32_t> fill( offsets->begin(), offsets->end() - 1 );
+		for( size_t i = 0; i < mCorners.size(); ++i )
+			(*adjacency)[fill[mCorners[i]]++] = (uint32_t)( i / 3 );
+	}
+
+	/*! Finds where each of p's wedges goes when p collapses onto q. A wedge on a triangle with q maps to q's wedge there, so that
+		collapses along a seam keep the attributes on both of its sides. A wedge away from q is moved to q's position and takes on q's
+		attributes other than the normal, which is only allowed where the wedges of both p and q differ in nothing but their normals.
+		Returns false if p's wedges can't all be placed. */
+	bool mapWedges( const uint32_t *adj, size_t numAdj, uint32_t p, uint32_t q, vector<std::pair<uint32_t,uint32_t> > *wedgeMap ) const
+	{
+		wedgeMap->clear();
+		for( size_t a = 0; a < numAdj; ++a ) {
+			const uint32_t *tri = &mCorners[adj[a] * 3];
+			int kp = -1, kq = -1;
+			for( int k = 0; k < 3; ++k ) {
+				if( tri[k] == p ) kp = k;
+				else if( tri[k] == q ) kq = k;
+			}
+			if( kq < 0 )
+				continue;
+			const uint32_t from = mWedges[adj[a]*3+kp], to = mWedges[adj[a]*3+kq];
+			bool found = false;
+			for( size_t w = 0; w < wedgeMap->size() && ! found; ++w ) {
+				if( (*wedgeMap)[w].first == from ) {
+					// the seam continues past q on this side, so the wedge would have to split
+					if( (*wedgeMap)[w].second != to )
+						return false;
+					found = true;
+				}
+			}
+			if( ! found )
+				wedgeMap->push_back( std::make_pair( from, to ) );
+		}
+
+		if( mHardEdgesOnly[p] && mHardEdgesOnly[q] )
+			return true;
+		for( size_t a = 0; a < numAdj; ++a ) {
+			const uint32_t *tri = &mCorners[adj[a] * 3];
+			for( int k = 0; k < 3; ++k ) {
+				if( tri[k] != p )
+					continue;
+				const uint32_t from = mWedges[adj[a]*3+k];
+				bool found = false;
+				for( size_t w = 0; w < wedgeMap->size() && ! found; ++w )
+					found = (*wedgeMap)[w].first == from;
+				if( ! found )
+					return false;
+			}
+		}
+		return true;
+	}
+
+	// Returns whether moving p onto q flips or collapses any triangle around p which does not contain q
+	bool flipsTriangle( const uint32_t *adj, size_t numAdj, uint32_t p, uint32_t q ) const
+	{
+		for( size_t a = 0; a < numAdj; ++a ) {
+			const uint32_t *tri = &mCorners[adj[a] * 3];
+			if( tri[0] == q || tri[1] == q || tri[2] == q )
+				continue;
+			Vec3f v[3], moved[3];
+			for( int k = 0; k < 3; ++k ) {
+				v[k] = mPositions[tri[k]];
+				moved[k] = ( tri[k] == p ) ? mPositions[q] : v[k];
+			}
+			Vec3f before = ( v[1] - v[0] ).cross( v[2] - v[0] );
+			Vec3f after = ( moved[1] - moved[0] ).cross( moved[2] - moved[0] );
+			if( before.dot( after ) <= 0 )
+				return true;
+		}
+		return false;
+	}
+
+	size_t compactTriangles()
+	{
+		size_t dest = 0;
+		for( size_t t = 0; t < mCorners.size() / 3; ++t ) {
+			const uint32_t *tri = &mCorners[t * 3];
+			if( tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2] )
+				continue;
+			for( int k = 0; k < 3; ++k ) {
+				mCorners[dest * 3 + k] = mCorners[t * 3 + k];
+				mWedges[dest * 3 + k] = mWedges[t * 3 + k];
+			}
+			++dest;
+		}
+		mCorners.resize( dest * 3 );
+		mWedges.resize( dest * 3 );
+		return dest;
+	}
+
+	const TriMesh		&mSource;
+	vector<uint32_t>	&mWedges;
+	vector<uint32_t>	mCorners;
+	vector<Vec3f>		mPositions;
+	vector<Quadric>		mQuadrics;
+	vector<uint8_t>		mLocked, mHardEdgesOnly;
+	// for each position, a source vertex whose texture coordinates and colors it has; wedges moved onto the position copy them
+	vector<uint32_t>	mSurfaceWedges, mMovedWedges;
+	// source triangle planes, and per vertex singly linked lists of the source corners merged into it
+	vector<Vec4d>		mPlanes;
+	vector<uint32_t>	mPlaneHead, mPlaneTail, mPlaneNext;
+};
+
+struct Component {
+	vector<uint32_t>	mIndices;
+	size_t				mTargetTriangles;
+	float				mError;
+
+	bool operator<( const Component &rhs ) const { return mIndices.size() > rhs.mIndices.size(); }
+};
+
+struct SimplifyComponents {
+	void operator()( size_t begin, size_t end ) const
+	{
+		for( size_t c = begin; c < end; ++c ) {
+			Component &component = (*mComponents)[c];
+			ComponentSimplifier simplifier( *mSource, *mWedgePositions, &component.mIndices );
+			component.mError = simplifier.simplify( component.mTargetTriangles, mMaxError );
+			// components share no vertices, so they can update the result concurrently
+			simplifier.updateVertices( mResult );
+		}
+	}
+
+	const TriMesh			*mSource;
+	const vector<uint32_t>	*mWedgePositions;
+	TriMesh					*mResult;
+	vector<Component>		*mComponents;
+	float					mMaxError;
+};
+
+struct PositionLess {
+	PositionLess( const vector<Vec3f> &positions ) : mPositions( positions ) {}
+	bool operator()( uint32_t a, uint32_t b ) const
+	{
+		const Vec3f &pa = mPositions[a], &pb = mPositions[b];
+		if( pa.x != pb.x ) return pa.x < pb.x;
+		if( pa.y != pb.y ) return pa.y < pb.y;
+		return pa.z < pb.z;
+	}
+	const vector<Vec3f> &mPositions;
+};
+
+uint32_t findRoot( vector<uint32_t> &parents, uint32_t v )
+{
+	while( parents[v] != v ) {
+		parents[v] = parents[parents[v]];
+		v = parents[v];
+	}
+	return v;
+}
+
+template<typename T>
+void truncateAttribute( vector<T> *attr, size_t numVertices, size_t numReferenced )
+{
+	if( attr->size() == numVertices )
+		attr->resize( numReferenced );
+}
+
+} // anonymous namespace
+
+float simplifyTriMesh( const TriMesh &source, TriMesh *result, size_t targetTriangles, float maxError )
+{
+	*result = source;
+	const vector<Vec3f> &positions = source.getVertices();
+	const vector<uint32_t> &indices = source.getIndices();
+	const size_t numVertices = positions.size();
+	const size_t numTris = source.getNumTriangles();
+	if( numTris <= targetTriangles || numVertices == 0 )
+		return 0;
+
+	// weld vertices which share a position; each weld group is one simplification vertex
+	vector<uint32_t> wedgePositions( numVertices );
+	{
+		vector<uint32_t> order( numVertices );
+		for( size_t v = 0; v < numVertices; ++v )
+			order[v] = (uint32_t)v;
+		std::sort( order.begin(), order.end(), PositionLess( positions ) );
+		for( size_t i = 0; i < numVertices; ++i )
+			wedgePositions[order[i]] = ( i > 0 && positions[order[i]] == positions[order[i - 1]] ) ? wedgePositions[order[i - 1]] : order[i];
+	}
+
+	// split into connected components
+	vector<uint32_t> parents( numVertices );
+	for( size_t v = 0; v < numVertices; ++v )
+		parents[v] = (uint32_t)v;
+	for( size_t t = 0; t < numTris; ++t ) {
+		uint32_t root = findRoot( parents, wedgePositions[indices[t*3]] );
+		for( int k = 1; k < 3; ++k ) {
+			uint32_t other = findRoot( parents, wedgePositions[indices[t*3+k]] );
+			if( other != root )
+				parents[other] = root;
+		}
+	}
+
+	vector<uint32_t> componentIds( numVertices, 0xFFFFFFFF );
+	vector<Component> components;
+	for( size_t t = 0; t < numTris; ++t ) {
+		uint32_t root = findRoot( parents, wedgePositions[indices[t*3]] );
+		if( componentIds[root] == 0xFFFFFFFF ) {
+			componentIds[root] = (uint32_t)components.size();
+			components.push_back( Component() );
+		}
+		vector<uint32_t> &componentIndices = components[componentIds[root]].mIndices;
+		componentIndices.insert( componentIndices.end(), indices.begin() + t * 3, indices.begin() + t * 3 + 3 );
+	}
+
+	const double ratio = targetTriangles / (double)numTris;
+	for( size_t c = 0; c < components.size(); ++c ) {
+		components[c].mTargetTriangles = (size_t)math<double>::ceil( components[c].mIndices.size() / 3 * ratio );
+		components[c].mError = 0;
+	}
+	// largest first, so that the biggest jobs start early
+	std::sort( components.begin(), components.end() );
+
+	SimplifyComponents job = { &source, &wedgePositions, result, &components, maxError };
+	parallelFor( components.size(), job, 1 );
+
+	float resultError = 0;
+	vector<uint32_t> &resultIndices = result->getIndices();
+	resultIndices.clear();
+	for( size_t c = 0; c < components.size(); ++c ) {
+		resultIndices.insert( resultIndices.end(), components[c].mIndices.begin(), components[c].mIndices.end() );
+		resultError = std::max( resultError, components[c].mError );
+	}
+
+	optimizeTriMesh( result );
+
+	// optimizeVertexFetch() moved the unreferenced vertices to the end
+	size_t numReferenced = 0;
+	for( size_t i = 0; i < resultIndices.size(); ++i )
+		numReferenced = std::max<size_t>( numReferenced, resultIndices[i] + 1 );
+	truncateAttribute( &result->getVertices(), numVertices, numReferenced );
+	truncateAttribute( &result->getNormals(), numVertices, numReferenced );
+	truncateAttribute( &result->getColorsRGB(), numVertices, numReferenced );
+	truncateAttribute( &result->getColorsRGBA(), numVertices, numReferenced );
+	truncateAttribute( &result->getTexCoords(), numVertices, numReferenced );
+
+	return resultError;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// TriMeshLodChain
+TriMeshLodChain::TriMeshLodChain( const TriMesh &source, size_t numLevels, float reduction )
+{
+	if( numLevels == 0 )
+		return;
+
+	mLevels.reserve( numLevels );
+	mLevels.push_back( Level() );
+	mLevels.back().mMesh = source;
+	mLevels.back().mError = 0;
+
+	while( mLevels.size() < numLevels ) {
+		const Level &prev = mLevels.back();
+		size_t prevTriangles = prev.mMesh.getNumTriangles();
+		size_t target = (size_t)( prevTriangles * reduction );
+		if( target == 0 )
+			break;
+
+		Level level;
+		float error = simplifyTriMesh( prev.mMesh, &level.mMesh, target );
+		// stop when simplification stalls, typically because borders and the corners of seams lock the remaining vertices
+		if( level.mMesh.getNumTriangles() >= prevTriangles - prevTriangles / 20 )
+			break;
+		level.mError = prev.mError + error;
+		mLevels.push_back( level );
+	}
+}
+
+float TriMeshLodChain::calcScreenSpaceError( float objectSpaceError, const CameraPersp &cam, const Vec3f &worldCenter, float worldScale, float viewportHeight )
+{
+	float distance = std::max( worldCenter.distance( cam.getEyePoint() ), cam.getNearClip() );
+	float pixelsPerUnit = viewportHeight / ( 2.0f * math<float>::tan( toRadians( cam.getFov() ) * 0.5f ) * distance );
+	return objectSpaceError * worldScale * pixelsPerUnit;
+}
+
+size_t TriMeshLodChain::selectLevel( const CameraPersp &cam, const Vec3f &worldCenter, float worldScale, float viewportHeight, float maxPixelError ) const
+{
+	size_t result = 0;
+	for( size_t level = 1; level < mLevels.size(); ++level ) {
+		if( calcScreenSpaceError( mLevels[level].mError, cam, worldCenter, worldScale, viewportHeight ) > maxPixelError )
+			break;
+		result = level;
+	}
+	return result;
+}
+
+} // namespace cinder
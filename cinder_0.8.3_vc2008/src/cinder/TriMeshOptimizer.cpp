@@ -0,0 +1,390 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/TriMeshOptimizer.h"
+#include "cinder/CinderMath.h"
+
+#include <algorithm>
+
+using std::vector;
+
+namespace cinder {
+
+namespace {
+
+// Tunables from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+const int	kForsythCacheSize		= 32;
+const float	kForsythCacheDecayPower	= 1.5f;
+const float	kForsythLastTriScore	= 0.75f;
+const float	kForsythValenceScale	= 2.0f;
+const float	kForsythValencePower	= 0.5f;
+const int	kForsythMaxValence		= 32;
+
+struct ForsythScoreTable {
+	ForsythScoreTable()
+	{
+		for( int c = 0; c < kForsythCacheSize; ++c ) {
+			if( c < 3 )
+				mCache[c] = kForsythLastTriScore;
+			else
+				mCache[c] = math<float>::pow( 1.0f - ( c - 3 ) / (float)( kForsythCacheSize - 3 ), kForsythCacheDecayPower );
+		}
+		mValence[0] = 0;
+		for( int v = 1; v <= kForsythMaxValence; ++v )
+			mValence[v] = kForsythValenceScale * math<float>::pow( (float)v, -kForsythValencePower );
+	}
+
+	float score( int cachePosition, uint32_t remainingValence ) const
+	{
+		if( remainingValence == 0 )
+			return -1.0f;
+		float result = ( cachePosition >= 0 ) ? mCache[cachePosition] : 0.0f;
+		result += ( remainingValence <= (uint32_t)kForsythMaxValence ) ? mValence[remainingValence] : kForsythValenceScale * math<float>::pow( (float)remainingValence, -kForsythValencePower );
+		return result;
+	}
+
+	float	mCache[kForsythCacheSize];
+	float	mValence[kForsythMaxValence + 1];
+};
+
+const ForsythScoreTable& getForsythScoreTable()
+{
+	static ForsythScoreTable sTable;
+	return sTable;
+}
+
+// FIFO cache simulation; returns the number of misses for the triangles [firstTri, lastTri)
+size_t simulateFifoCache( const uint32_t *indices, size_t firstTri, size_t lastTri, size_t cacheSize, vector<uint32_t> &timestamps )
+{
+	std::fill( timestamps.begin(), timestamps.end(), 0 );
+	uint32_t time = (uint32_t)cacheSize + 1;
+	size_t misses = 0;
+	for( size_t i = firstTri * 3; i < lastTri * 3; ++i ) {
+		uint32_t v = indices[i];
+		if( time - timestamps[v] > cacheSize ) {
+			timestamps[v] = time++;
+			++misses;
+		}
+	}
+	return misses;
+}
+
+template<typename T>
+void remapAttribute( vector<T> *attr, const vector<uint32_t> &remap )
+{
+	if( attr->size() != remap.size() )
+		return;
+
+	vector<T> result( attr->size() );
+	for( size_t v = 0; v < remap.size(); ++v )
+		result[remap[v]] = (*attr)[v];
+	attr->swap( result );
+}
+
+struct OverdrawCluster {
+	size_t	mFirstTri, mLastTri;
+	float	mSortKey;
+
+	bool operator<( const OverdrawCluster &rhs ) const { return mSortKey > rhs.mSortKey; }
+};
+
+} // anonymous namespace
+
+VertexCacheStats calcVertexCacheStats( const TriMesh &mesh, size_t cacheSize )
+{
+	if( mesh.getIndices().empty() )
+		return VertexCacheStats();
+	return calcVertexCacheStats( &mesh.getIndices()[0], mesh.getNumIndices(), mesh.getNumVertices(), cacheSize );
+}
+
+VertexCacheStats calcVertexCacheStats( const uint32_t *indices, size_t numIndices, size_t numVertices, size_t cacheSize )
+{
+	VertexCacheStats result;
+	result.mCacheSize = cacheSize;
+	result.mNumTriangles = numIndices / 3;
+	if( result.mNumTriangles == 0 )
+		return result;
+
+	vector<uint32_t> timestamps( numVertices, 0 );
+	result.mNumTransformed = simulateFifoCache( indices, 0, result.mNumTriangles, cacheSize, timestamps );
+
+	vector<bool> referenced( numVertices, false );
+	for( size_t i = 0; i < result.mNumTriangles * 3; ++i ) {
+		if( ! referenced[indices[i]] ) {
+			referenced[indices[i]] = true;
+			++result.mNumVertices;
+		}
+	}
+
+	result.mAcmr = result.mNumTransformed / (float)result.mNumTriangles;
+	result.mAtvr = result.mNumTransformed / (float)result.mNumVertices;
+	return result;
+}
+
+void optimizeVertexCache( TriMesh *mesh )
+{
+	if( mesh->getIndices().empty() )
+		return;
+	optimizeVertexCache( &mesh->getIndices()[0], mesh->getNumIndices(), mesh->getNumVertices() );
+}
+
+void optimizeVertexCache( uint32_t *indices, size_t numIndices, size_t numVertices )
+{
+	const size_t numTris = numIndices / 3;
+	if( numTris == 0 )
+		return;
+	const ForsythScoreTable &scoreTable = getForsythScoreTable();
+
+	// build vertex -> triangle adjacency, packed per vertex; mLiveValence[v] entries starting at mAdjacencyOffset[v] are not yet emitted
+	vector<uint32_t> liveValence( numVertices, 0 );
+	for( size_t i = 0; i < numTris * 3; ++i )
+		liveValence[indices[i]]++;
+	vector<uint32_t> adjacencyOffset( numVertices + 1, 0 );
+	for( size_t v = 0; v < numVertices; ++v )
+		adjacencyOffset[v + 1] = adjacencyOffset[v] + liveValence[v];
+	vector<uint32_t> adjacency( numTris * 3 );
+	{
+		vector<uint32_t> fill( adjacencyOffset.begin(), adjacencyOffset.end() - 1 );
+		for( size_t i = 0; i < numTris * 3; ++i )
+			adjacency[fill[indices[i]]++] = (uint32_t)( i / 3 );
+	}
+
+	vector<int> cachePosition( numVertices, -1 );
+	vector<float> vertexScore( numVertices );
+	for( size_t v = 0; v < numVertices; ++v )
+		vertexScore[v] = scoreTable.score( -1, liveValence[v] );
+
+	vector<float> triScore( numTris );
+	vector<bool> emitted( numTris, false );
+	int bestTri = -1;
+	float bestScore = -1.0f;
+	for( size_t t = 0; t < numTris; ++t ) {
+		triScore[t] = vertexScore[indices[t*3+0]] + vertexScore[indices[t*3+1]] + vertexScore[indices[t*3+2]];
+		if( triScore[t] > bestScore ) {
+			bestScore = triScore[t];
+			bestTri = (int)t;
+		}
+	}
+
+	vector<uint32_t> result;
+	result.reserve( numTris * 3 );
+	vector<uint32_t> cache, newCache;
+	cache.reserve( kForsythCacheSize + 3 );
+	newCache.reserve( kForsythCacheSize + 3 );
+	size_t nextUnemitted = 0;
+
+	for( size_t emittedCount = 0; emittedCount < numTris; ++emittedCount ) {
+		if( bestTri < 0 ) { // dead end; resume from the first triangle which hasn't been emitted yet
+			while( emitted[nextUnemitted] )
+				++nextUnemitted;
+			bestTri = (int)nextUnemitted;
+		}
+
+		const uint32_t *tri = &indices[bestTri * 3];
+		emitted[bestTri] = true;
+		newCache.clear();
+		for( int c = 0; c < 3; ++c ) {
+			uint32_t v = tri[c];
+			result.push_back( v );
+			newCache.push_back( v );
+			// remove this triangle from the vertex's live adjacency
+			uint32_t *adj = &adjacency[adjacencyOffset[v]];
+			for( uint32_t a = 0; a < liveValence[v]; ++a ) {
+				if( adj[a] == (uint32_t)bestTri ) {
+					std::swap( adj[a], adj[liveValence[v] - 1] );
+					break;
+				}
+			}
+			liveValence[v]--;
+		}
+
+		for( size_t c = 0; c < cache.size(); ++c ) {
+			uint32_t v = cache[c];
+			if( v != tri[0] && v != tri[1] && v != tri[2] )
+				newCache.push_back( v );
+		}
+
+		// vertices pushed off the end of the cache
+		for( size_t c = kForsythCacheSize; c < newCache.size(); ++c )
+			cachePosition[newCache[c]] = -1;
+		if( newCache.size() > (size_t)kForsythCacheSize )
+			newCache.resize( kForsythCacheSize );
+		for( size_t c = 0; c < newCache.size(); ++c )
+			cachePosition[newCache[c]] = (int)c;
+
+		// rescore every vertex whose cache position or valence may have changed, propagating into its live triangles
+		bestTri = -1;
+		bestScore = -1.0f;
+		for( int pass = 0; pass < 2; ++pass ) {
+			const vector<uint32_t> &touched = ( pass == 0 ) ? newCache : cache;
+			for( size_t c = 0; c < touched.size(); ++c ) {
+				uint32_t v = touched[c];
+				if( pass == 1 && cachePosition[v] >= 0 ) // already handled as part of newCache
+					continue;
+				float newScore = scoreTable.score( cachePosition[v], liveValence[v] );
+				float delta = newScore - vertexScore[v];
+				vertexScore[v] = newScore;
+				const uint32_t *adj = &adjacency[adjacencyOffset[v]];
+				for( uint32_t a = 0; a < liveValence[v]; ++a ) {
+					triScore[adj[a]] += delta;
+					if( pass == 0 && triScore[adj[a]] > bestScore ) {
+						bestScore = triScore[adj[a]];
+						bestTri = (int)adj[a];
+					}
+				}
+			}
+		}
+
+		cache.swap( newCache );
+	}
+
+	std::copy( result.begin(), result.end(), indices );
+}
+
+void optimizeOverdraw( TriMesh *mesh, float threshold )
+{
+	const size_t numTris = mesh->getNumTriangles();
+	if( numTris == 0 )
+		return;
+
+	const vector<Vec3f> &positions = mesh->getVertices();
+	vector<uint32_t> &indices = mesh->getIndices();
+	const size_t cacheSize = 16;
+	vector<uint32_t> timestamps( mesh->getNumVertices(), 0 );
+
+	// hard boundaries are the triangles where the cache-optimized order restarts with 3 misses
+	vector<size_t> hardBoundaries;
+	{
+		uint32_t time = (uint32_t)cacheSize + 1;
+		for( size_t t = 0; t < numTris; ++t ) {
+			size_t misses = 0;
+			for( int c = 0; c < 3; ++c ) {
+				uint32_t v = indices[t*3+c];
+				if( time - timestamps[v] > cacheSize ) {
+					timestamps[v] = time++;
+					++misses;
+				}
+			}
+			if( t == 0 || misses == 3 )
+				hardBoundaries.push_back( t );
+		}
+		hardBoundaries.push_back( numTris );
+	}
+
+	// split each hard cluster further wherever doing so keeps the cluster's ACMR within threshold
+	vector<OverdrawCluster> clusters;
+	for( size_t h = 0; h + 1 < hardBoundaries.size(); ++h ) {
+		size_t start = hardBoundaries[h], end = hardBoundaries[h + 1];
+		float clusterAcmr = simulateFifoCache( &indices[0], start, end, cacheSize, timestamps ) / (float)( end - start );
+
+		std::fill( timestamps.begin(), timestamps.end(), 0 );
+		uint32_t time = (uint32_t)cacheSize + 1;
+		size_t misses = 0, softStart = start;
+		for( size_t t = start; t < end; ++t ) {
+			for( int c = 0; c < 3; ++c ) {
+				uint32_t v = indices[t*3+c];
+				if( time - timestamps[v] > cacheSize ) {
+					timestamps[v] = time++;
+					++misses;
+				}
+			}
+			size_t numClusterTris = t + 1 - softStart;
+			if( t + 1 < end && numClusterTris >= cacheSize && misses / (float)numClusterTris <= clusterAcmr * threshold ) {
+				OverdrawCluster cluster = { softStart, t + 1, 0 };
+				clusters.push_back( cluster );
+				softStart = t + 1;
+				misses = 0;
+				time += (uint32_t)cacheSize + 1; // invalidates the simulated cache
+			}
+		}
+		OverdrawCluster cluster = { softStart, end, 0 };
+		clusters.push_back( cluster );
+	}
+
+	if( clusters.size() < 2 )
+		return;
+
+	// sort key: how far the cluster's centroid lies along its average normal, relative to the mesh centroid
+	Vec3f meshCentroid = Vec3f::zero();
+	for( size_t v = 0; v < positions.size(); ++v )
+		meshCentroid += positions[v];
+	meshCentroid /= (float)positions.size();
+
+	for( size_t c = 0; c < clusters.size(); ++c ) {
+		Vec3f centroid = Vec3f::zero(), normal = Vec3f::zero();
+		float area = 0;
+		for( size_t t = clusters[c].mFirstTri; t < clusters[c].mLastTri; ++t ) {
+			const Vec3f &p0 = positions[indices[t*3+0]], &p1 = positions[indices[t*3+1]], &p2 = positions[indices[t*3+2]];
+			Vec3f faceNormal = ( p1 - p0 ).cross( p2 - p0 ); // length is twice the area
+			float faceArea = faceNormal.length();
+			centroid += ( p0 + p1 + p2 ) * ( faceArea / 3.0f );
+			normal += faceNormal;
+			area += faceArea;
+		}
+		if( area > 0 )
+			centroid /= area;
+		clusters[c].mSortKey = ( centroid - meshCentroid ).dot( normal.safeNormalized() );
+	}
+
+	std::stable_sort( clusters.begin(), clusters.end() );
+
+	vector<uint32_t> result;
+	result.reserve( indices.size() );
+	for( size_t c = 0; c < clusters.size(); ++c )
+		result.insert( result.end(), indices.begin() + clusters[c].mFirstTri * 3, indices.begin() + clusters[c].mLastTri * 3 );
+	indices.swap( result );
+}
+
+void optimizeVertexFetch( TriMesh *mesh )
+{
+	const size_t numVertices = mesh->getNumVertices();
+	vector<uint32_t> &indices = mesh->getIndices();
+
+	const uint32_t unused = 0xFFFFFFFF;
+	vector<uint32_t> remap( numVertices, unused );
+	uint32_t next = 0;
+	for( size_t i = 0; i < indices.size(); ++i ) {
+		if( remap[indices[i]] == unused )
+			remap[indices[i]] = next++;
+		indices[i] = remap[indices[i]];
+	}
+	for( size_t v = 0; v < numVertices; ++v ) {
+		if( remap[v] == unused )
+			remap[v] = next++;
+	}
+
+	remapAttribute( &mesh->getVertices(), remap );
+	remapAttribute( &mesh->getNormals(), remap );
+	remapAttribute( &mesh->getColorsRGB(), remap );
+	remapAttribute( &mesh->getColorsRGBA(), remap );
+	remapAttribute( &mesh->getTexCoords(), remap );
+}
+
+void optimizeTriMesh( TriMesh *mesh )
+{
+	optimizeVertexCache( mesh );
+	optimizeOverdraw( mesh );
+	optimizeVertexFetch( mesh );
+}
+
+} // namespace cinder
@@ -22,24 +22,110 @@
 
 #include "cinder/Triangulate.h"
 #include "cinder/Shape2d.h"
+#include "cinder/Thread.h"
 #include "tesselator.h"
 
 using namespace std;
 
 namespace cinder {
 
-void* stdAlloc( void* userData, unsigned int size )
-{
-	int *allocated = (int*)userData;
-	*allocated += (int)size;
-	return malloc( size );
-}
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Triangulator::Arena
+// Bump allocator backing libtess2. Frees are no-ops; rewind() recycles everything at once and
+// merges the blocks so that steady-state use runs out of a single block.
+class Triangulator::Arena {
+  public:
+	Arena() : mCurrentBlock( 0 ), mOffset( 0 ), mLastAlloc( 0 ) {}
+	~Arena()
+	{
+		for( size_t b = 0; b < mBlocks.size(); ++b )
+			free( mBlocks[b].mData );
+	}
 
-void stdFree( void* userData, void* ptr )
-{
-	free( ptr );
-}
+	void* alloc( size_t size )
+	{
+		size_t needed = HEADER_SIZE + ( ( size + ALIGNMENT - 1 ) & ~( ALIGNMENT - 1 ) );
+		while( mCurrentBlock < mBlocks.size() && mOffset + needed > mBlocks[mCurrentBlock].mSize ) {
+			++mCurrentBlock;
+			mOffset = 0;
+		}
+		if( mCurrentBlock == mBlocks.size() ) {
+			size_t blockSize = std::max<size_t>( needed, mBlocks.empty() ? (size_t)MIN_BLOCK_SIZE : mBlocks.back().mSize * 2 );
+			mBlocks.push_back( Block( (char*)malloc( blockSize ), blockSize ) );
+			if( ! mBlocks.back().mData ) {
+				mBlocks.pop_back();
+				return 0;
+			}
+		}
+
+		char *header = mBlocks[mCurrentBlock].mData + mOffset;
+		*(size_t*)header = needed - HEADER_SIZE;
+		mOffset += needed;
+		mLastAlloc = header + HEADER_SIZE;
+		return mLastAlloc;
+	}
+
+	void* realloc( void *ptr, size_t size )
+	{
+		if( ! ptr )
+			return alloc( size );
+		size_t oldSize = *(size_t*)( (char*)ptr - HEADER_SIZE );
+		if( size <= oldSize )
+			return ptr;
+		// grow the most recent allocation in place when its block has room
+		if( ptr == mLastAlloc ) {
+			size_t grownSize = ( size + ALIGNMENT - 1 ) & ~( ALIGNMENT - 1 );
+			size_t start = (char*)ptr - mBlocks[mCurrentBlock].mData;
+			if( start + grownSize <= mBlocks[mCurrentBlock].mSize ) {
+				*(size_t*)( (char*)ptr - HEADER_SIZE ) = grownSize;
+				mOffset = start + grownSize;
+				return ptr;
+			}
+		}
+		void *result = alloc( size );
+		if( result )
+			memcpy( result, ptr, oldSize );
+		return result;
+	}
+
+	void rewind()
+	{
+		if( mBlocks.size() > 1 ) {
+			size_t totalSize = 0;
+			for( size_t b = 0; b < mBlocks.size(); ++b ) {
+				totalSize += mBlocks[b].mSize;
+				free( mBlocks[b].mData );
+			}
+			mBlocks.clear();
+			char *data = (char*)malloc( totalSize );
+			if( data )
+				mBlocks.push_back( Block( data, totalSize ) );
+		}
+		mCurrentBlock = 0;
+		mOffset = 0;
+		mLastAlloc = 0;
+	}
+
+	static void* tessAlloc( void *userData, unsigned int size ) { return ((Arena*)userData)->alloc( size ); }
+	static void* tessRealloc( void *userData, void *ptr, unsigned int size ) { return ((Arena*)userData)->realloc( ptr, size ); }
+	static void tessFree( void * /*userData*/, void * /*ptr*/ ) {}
+
+  private:
+	enum { ALIGNMENT = 16, HEADER_SIZE = 16, MIN_BLOCK_SIZE = 64 * 1024 };
+
+	struct Block {
+		Block( char *data, size_t size ) : mData( data ), mSize( size ) {}
+		char		*mData;
+		size_t		mSize;
+	};
+
+	vector<Block>	mBlocks;
+	size_t			mCurrentBlock, mOffset;
+	void			*mLastAlloc;
+};
 
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Triangulator
 Triangulator::Triangulator( const Path2d &path, float approximationScale )
 {	
 	allocate();
@@ -65,18 +151,30 @@ Triangulator::Triangulator()
 
 void Triangulator::allocate()
 {
-	mAllocated = 0;
+	// the tesselator lives in the arena too, so release it before recycling the arena's memory
+	mTess.reset();
+	if( mArena )
+		mArena->rewind();
+	else
+		mArena = shared_ptr<Arena>( new Arena );
 	
 	TESSalloc ma;
 	memset( &ma, 0, sizeof(ma) );
-	ma.memalloc = stdAlloc;
-	ma.memfree = stdFree;
-	ma.userData = (void*)&mAllocated;
-	ma.extraVertices = 2560; // realloc not provided, allow 256 extra vertices.
+	ma.memalloc = Arena::tessAlloc;
+	ma.memrealloc = Arena::tessRealloc;
+	ma.memfree = Arena::tessFree;
+	ma.userData = (void*)mArena.get();
+	ma.extraVertices = 256; // the priority queue can grow through memrealloc, so only a little headroom is needed
 
 	mTess = shared_ptr<TESStesselator>( tessNewTess( &ma ), tessDeleteTess );
 	if( ! mTess )
 		throw Triangulator::Exception();
+	mDirty = false;
+}
+
+void Triangulator::reset()
+{
+	allocate();
 }
 
 void Triangulator::addShape( const Shape2d &shape, float approximationScale )
@@ -89,12 +187,18 @@ void Triangulator::addShape( const Shape2d &shape, float approximationScale )
 
 void Triangulator::addPath( const Path2d &path, float approximationScale )
 {
+	allocateIfDirty();
 	vector<Vec2f> subdivided = path.subdivide( approximationScale );
+	if( subdivided.empty() )
+		return;
 	tessAddContour( mTess.get(), 2, &subdivided[0], sizeof(float) * 2, subdivided.size() );
 }
 
 void Triangulator::addPolyLine( const PolyLine2f &polyLine )
 {
+	allocateIfDirty();
+	if( polyLine.size() == 0 )
+		return;
 	tessAddContour( mTess.get(), 2, &polyLine.getPoints()[0], sizeof(float) * 2, polyLine.size() );
 }
 
@@ -102,11 +206,90 @@ TriMesh2d Triangulator::calcMesh( Winding winding )
 {
 	TriMesh2d result;
 	
-	tessTesselate( mTess.get(), (int)winding, TESS_POLYGONS, 3, 2, 0 );
-	result.appendVertices( (Vec2f*)tessGetVertices( mTess.get() ), tessGetVertexCount( mTess.get() ) );
-	result.appendIndices( (uint32_t*)( tessGetElements( mTess.get() ) ), tessGetElementCount( mTess.get() ) * 3 );
-	
+	// nothing has been added since the last calcMesh(), so tesselate an empty contour set
+	allocateIfDirty();
+	if( tessTesselate( mTess.get(), (int)winding, TESS_POLYGONS, 3, 2, 0 ) ) {
+		result.appendVertices( (Vec2f*)tessGetVertices( mTess.get() ), tessGetVertexCount( mTess.get() ) );
+		result.appendIndices( (uint32_t*)( tessGetElements( mTess.get() ) ), tessGetElementCount( mTess.get() ) * 3 );
+	}
+
+	// the tesselator is spent; recycle it on the next add rather than now, so temporaries don't pay for it
+	mDirty = true;
+	return result;
+}
+
+namespace {
+
+void addToTriangulator( Triangulator *triangulator, const Shape2d &shape, float approximationScale )
+{
+	triangulator->addShape( shape, approximationScale );
+}
+
+void addToTriangulator( Triangulator *triangulator, const Path2d &path, float approximationScale )
+{
+	triangulator->addPath( path, approximationScale );
+}
+
+// Each range of items gets its own Triangulator, whose arena is recycled from one item to the next
+template<typename T>
+struct TriangulateRange {
+	TriangulateRange( const vector<T> *items, float approximationScale, Triangulator::Winding winding, vector<TriMesh2d> *results )
+		: mItems( items ), mApproximationScale( approximationScale ), mWinding( winding ), mResults( results )
+	{}
+
+	void operator()( size_t begin, size_t end ) const
+	{
+		Triangulator triangulator;
+		for( size_t i = begin; i < end; ++i ) {
+			addToTriangulator( &triangulator, (*mItems)[i], mApproximationScale );
+			(*mResults)[i] = triangulator.calcMesh( mWinding );
+		}
+	}
+
+	const vector<T>			*mItems;
+	float					mApproximationScale;
+	Triangulator::Winding	mWinding;
+	vector<TriMesh2d>		*mResults;
+};
+
+template<typename T>
+TriMesh2d calcMeshBatchImpl( const vector<T> &items, float approximationScale, Triangulator::Winding winding )
+{
+	vector<TriMesh2d> meshes( items.size() );
+	parallelFor( items.size(), TriangulateRange<T>( &items, approximationScale, winding, &meshes ) );
+
+	size_t numVertices = 0, numIndices = 0;
+	for( size_t m = 0; m < meshes.size(); ++m ) {
+		numVertices += meshes[m].getNumVertices();
+		numIndices += meshes[m].getNumIndices();
+	}
+
+	TriMesh2d result;
+	vector<Vec2f> &vertices = result.getVertices();
+	vector<size_t> &indices = result.getIndices();
+	vertices.reserve( numVertices );
+	indices.reserve( numIndices );
+	for( size_t m = 0; m < meshes.size(); ++m ) {
+		size_t offset = vertices.size();
+		const vector<size_t> &meshIndices = meshes[m].getIndices();
+		vertices.insert( vertices.end(), meshes[m].getVertices().begin(), meshes[m].getVertices().end() );
+		for( size_t i = 0; i < meshIndices.size(); ++i )
+			indices.push_back( meshIndices[i] + offset );
+	}
+
 	return result;
 }
 
+} // anonymous namespace
+
+TriMesh2d Triangulator::calcMeshBatch( const vector<Shape2d> &shapes, float approximationScale, Winding winding )
+{
+	return calcMeshBatchImpl( shapes, approximationScale, winding );
+}
+
+TriMesh2d Triangulator::calcMeshBatch( const vector<Path2d> &paths, float approximationScale, Winding winding )
+{
+	return calcMeshBatchImpl( paths, approximationScale, winding );
+}
+
 } // namespace cinder
@@ -0,0 +1,135 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/TweenPool.h"
+
+namespace cinder {
+
+////////////////////////////////////////////////////////////////////////////////////////
+// TweenTargetMap
+namespace {
+const size_t MIN_CAPACITY = 16;
+} // anonymous namespace
+
+TweenTargetMap::TweenTargetMap()
+	: mSize( 0 )
+{
+}
+
+// Fibonacci hashing of the pointer; the low bits are dropped since targets are at least 4-byte aligned
+size_t TweenTargetMap::home( const void *key ) const
+{
+	uint32_t h = (uint32_t)( reinterpret_cast<size_t>( key ) >> 2 ) * 2654435769u;
+	return ( h ^ ( h >> 16 ) ) & ( mSlots.size() - 1 );
+}
+
+// returns the slot holding \a key, or the empty slot which ends its probe sequence
+size_t TweenTargetMap::findSlot( const void *key ) const
+{
+	const size_t mask = mSlots.size() - 1;
+	size_t i = home( key );
+	while( mSlots[i].mKey && ( mSlots[i].mKey != key ) )
+		i = ( i + 1 ) & mask;
+	return i;
+}
+
+TweenTargetMap::Location* TweenTargetMap::find( const void *target )
+{
+	if( ( mSize == 0 ) || ( ! target ) )
+		return 0;
+	Slot &slot = mSlots[findSlot( target )];
+	return ( slot.mKey == target ) ? &slot.mLocation : 0;
+}
+
+const TweenTargetMap::Location* TweenTargetMap::find( const void *target ) const
+{
+	if( ( mSize == 0 ) || ( ! target ) )
+		return 0;
+	const Slot &slot = mSlots[findSlot( target )];
+	return ( slot.mKey == target ) ? &slot.mLocation : 0;
+}
+
+void TweenTargetMap::insert( const void *target, const Location &location )
+{
+	// keep the load factor at or below one half so probe sequences stay short
+	if( ( mSize + 1 ) * 2 > mSlots.size() )
+		grow();
+
+	Slot &slot = mSlots[findSlot( target )];
+	if( ! slot.mKey ) {
+		slot.mKey = target;
+		++mSize;
+	}
+	slot.mLocation = location;
+}
+
+bool TweenTargetMap::erase( const void *target )
+{
+	if( ( mSize == 0 ) || ( ! target ) )
+		return false;
+
+	const size_t mask = mSlots.size() - 1;
+	size_t hole = findSlot( target );
+	if( mSlots[hole].mKey != target )
+		return false;
+
+	// backward-shift deletion: pull later entries of the cluster into the hole unless their home lies cyclically in (hole, j]
+	for( size_t j = ( hole + 1 ) & mask; mSlots[j].mKey; j = ( j + 1 ) & mask ) {
+		size_t k = home( mSlots[j].mKey );
+		bool stays = ( hole <= j ) ? ( ( hole < k ) && ( k <= j ) ) : ( ( hole < k ) || ( k <= j ) );
+		if( ! stays ) {
+			mSlots[hole] = mSlots[j];
+			hole = j;
+		}
+	}
+
+	mSlots[hole] = Slot();
+	--mSize;
+	return true;
+}
+
+void TweenTargetMap::clear()
+{
+	mSlots.clear();
+	mSize = 0;
+}
+
+void TweenTargetMap::grow()
+{
+	std::vector<Slot> oldSlots;
+	oldSlots.swap( mSlots );
+	mSlots.resize( std::max( oldSlots.size() * 2, MIN_CAPACITY ) );
+	for( std::vector<Slot>::const_iterator slotIt = oldSlots.begin(); slotIt != oldSlots.end(); ++slotIt ) {
+		if( slotIt->mKey )
+			mSlots[findSlot( slotIt->mKey )] = *slotIt;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// TweenPoolBase
+float TweenPoolBase::findEndTimeOf( const void *target, float defaultTime ) const
+{
+	const TweenTargetMap::Location *location = mTargets.find( target );
+	return location ? getEndTime( *location ) : defaultTime;
+}
+
+} // namespace cinder
@@ -0,0 +1,510 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/XmlDoc.h"
+
+#include "rapidxml/rapidxml.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+using std::string;
+using std::vector;
+
+namespace cinder {
+
+namespace {
+
+inline bool isWhitespace( char c )
+{
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+string toLowerAscii( const string &s )
+{
+	string result( s );
+	for( string::iterator it = result.begin(); it != result.end(); ++it )
+		if( *it >= 'A' && *it <= 'Z' )
+			*it = char( *it - 'A' + 'a' );
+	return result;
+}
+
+} // anonymous namespace
+
+XmlDoc::XmlDoc( DataSourceRef dataSource, XmlTree::ParseOptions parseOptions )
+{
+	Buffer buf = dataSource->getBuffer();
+	vector<char> text( buf.getDataSize() + 1 );
+	memcpy( &text[0], buf.getData(), buf.getDataSize() );
+	text.back() = 0;
+	init( &text[0], parseOptions );
+}
+
+XmlDoc::XmlDoc( const std::string &xmlString, XmlTree::ParseOptions parseOptions )
+{
+	vector<char> text( xmlString.begin(), xmlString.end() );
+	text.push_back( 0 );
+	init( &text[0], parseOptions );
+}
+
+XmlDoc::XmlDoc( const XmlTree &xmlTree )
+{
+	mStrings.push_back( 0 ); // offset 0 is shared by every empty string
+	mDocType = xmlTree.getDocType();
+	uint32_t root = appendNode( INVALID_INDEX, 0, internName( xmlTree.getTag().c_str(), xmlTree.getTag().size() ), xmlTree.getValue().c_str(), xmlTree.getValue().size(), xmlTree.getNodeType() );
+	for( std::list<XmlTree::Attr>::const_iterator attrIt = xmlTree.getAttributes().begin(); attrIt != xmlTree.getAttributes().end(); ++attrIt )
+		appendAttr( attrIt->getName(), attrIt->getValue().c_str(), attrIt->getValue().size() );
+	appendXmlTreeChildren( xmlTree, root );
+}
+
+// RapidXML parses in place; its nodes point into xmlText, so everything we keep is copied out before returning
+void XmlDoc::init( char *xmlText, const XmlTree::ParseOptions &parseOptions )
+{
+	rapidxml::xml_document<> doc;
+	if( parseOptions.getParseComments() )
+		doc.parse<rapidxml::parse_comment_nodes | rapidxml::parse_doctype_node>( xmlText );
+	else
+		doc.parse<rapidxml::parse_doctype_node>( xmlText );
+
+	// the pool can't outgrow the source except when CDATA is collapsed into an element's value
+	mStrings.reserve( strlen( xmlText ) + 1 );
+	mStrings.push_back( 0 ); // offset 0 is shared by every empty string
+
+	uint32_t root = appendNode( INVALID_INDEX, 0, internName( "", 0 ), "", 0, XmlTree::NODE_DOCUMENT );
+	appendRapidXmlChildren( doc, root, parseOptions );
+
+	vector<NodeData>( mNodes ).swap( mNodes );
+	vector<AttrData>( mAttrs ).swap( mAttrs );
+	vector<char>( mStrings ).swap( mStrings );
+}
+
+uint32_t XmlDoc::appendNode( uint32_t parent, uint32_t *prevSibling, uint32_t name, const char *value, size_t valueLength, XmlTree::NodeType type )
+{
+	uint32_t index = (uint32_t)mNodes.size();
+	NodeData data;
+	data.mName = name;
+	data.mParent = parent;
+	data.mFirstChild = data.mNextSibling = INVALID_INDEX;
+	data.mValueOffset = storeString( value, valueLength );
+	data.mValueLength = (uint32_t)valueLength;
+	data.mFirstAttr = (uint32_t)mAttrs.size();
+	data.mNodeType = type;
+	mNodes.push_back( data );
+
+	if( prevSibling ) {
+		if( *prevSibling == INVALID_INDEX )
+			mNodes[parent].mFirstChild = index;
+		else
+			mNodes[*prevSibling].mNextSibling = index;
+		*prevSibling = index;
+	}
+
+	return index;
+}
+
+void XmlDoc::appendAttr( const std::string &name, const char *value, size_t valueLength )
+{
+	AttrData data;
+	data.mName = internName( name.c_str(), name.size() );
+	data.mValueOffset = storeString( value, valueLength );
+	data.mValueLength = (uint32_t)valueLength;
+	mAttrs.push_back( data );
+}
+
+// Mirrors parseItem() in Xml.cpp so that an XmlDoc and an XmlTree parsed with the same options hold the same nodes
+void XmlDoc::appendRapidXmlChildren( const rapidxml::xml_node<char> &node, uint32_t index, const XmlTree::ParseOptions &parseOptions )
+{
+	uint32_t prevChild = INVALID_INDEX;
+	for( const rapidxml::xml_node<> *item = node.first_node(); item; item = item->next_sibling() ) {
+		XmlTree::NodeType type;
+		switch( item->type() ) {
+			case rapidxml::node_element:
+				type = XmlTree::NODE_ELEMENT;
+			break;
+			case rapidxml::node_cdata:
+				if( parseOptions.getCollapseCData() )
+					continue; // already folded into this node's value by the caller
+				type = XmlTree::NODE_CDATA;
+			break;
+			case rapidxml::node_comment:
+				type = XmlTree::NODE_COMMENT;
+			break;
+			case rapidxml::node_doctype:
+				mDocType.assign( item->value(), item->value_size() );
+			continue;
+			case rapidxml::node_data:
+				if( parseOptions.getIgnoreDataChildren() )
+					continue;
+				type = XmlTree::NODE_DATA;
+			break;
+			default:
+				continue;
+		}
+
+		const rapidxml::xml_node<> *cdata = 0;
+		if( parseOptions.getCollapseCData() && type == XmlTree::NODE_ELEMENT ) {
+			for( cdata = item->first_node(); cdata; cdata = cdata->next_sibling() )
+				if( cdata->type() == rapidxml::node_cdata )
+					break;
+		}
+
+		uint32_t child, name = internName( item->name(), item->name_size() );
+		if( cdata ) {
+			string value( item->value(), item->value_size() );
+			for( ; cdata; cdata = cdata->next_sibling() )
+				if( cdata->type() == rapidxml::node_cdata )
+					value.append( cdata->value(), cdata->value_size() );
+			child = appendNode( index, &prevChild, name, value.c_str(), value.size(), type );
+		}
+		else
+			child = appendNode( index, &prevChild, name, item->value(), item->value_size(), type );
+
+		for( const rapidxml::xml_attribute<> *attr = item->first_attribute(); attr; attr = attr->next_attribute() )
+			appendAttr( string( attr->name(), attr->name_size() ), attr->value(), attr->value_size() );
+
+		appendRapidXmlChildren( *item, child, parseOptions );
+	}
+}
+
+void XmlDoc::appendXmlTreeChildren( const XmlTree &xmlTree, uint32_t index )
+{
+	uint32_t prevChild = INVALID_INDEX;
+	for( XmlTree::ConstIter childIt = xmlTree.begin(); childIt != xmlTree.end(); ++childIt ) {
+		const string &tag = childIt->getTag();
+		const string value = childIt->getValue();
+		uint32_t child = appendNode( index, &prevChild, internName( tag.c_str(), tag.size() ), value.c_str(), value.size(), childIt->getNodeType() );
+		for( std::list<XmlTree::Attr>::const_iterator attrIt = childIt->getAttributes().begin(); attrIt != childIt->getAttributes().end(); ++attrIt )
+			appendAttr( attrIt->getName(), attrIt->getValue().c_str(), attrIt->getValue().size() );
+		appendXmlTreeChildren( *childIt, child );
+	}
+}
+
+void XmlDoc::fillXmlTree( uint32_t index, XmlTree *result ) const
+{
+	for( uint32_t attr = mNodes[index].mFirstAttr; attr < getAttrEnd( index ); ++attr )
+		result->getAttributes().push_back( XmlTree::Attr( result, mNames[mAttrs[attr].mName], &mStrings[mAttrs[attr].mValueOffset] ) );
+
+	for( uint32_t child = mNodes[index].mFirstChild; child != INVALID_INDEX; child = mNodes[child].mNextSibling ) {
+		const NodeData &data = mNodes[child];
+		result->push_back( XmlTree( mNames[data.mName], string( &mStrings[data.mValueOffset], data.mValueLength ), 0, (XmlTree::NodeType)data.mNodeType ) );
+		fillXmlTree( child, &result->getChildren().back() );
+	}
+}
+
+uint32_t XmlDoc::internName( const char *name, size_t length )
+{
+	string key( name, length );
+	boost::unordered_map<string, uint32_t>::const_iterator nameIt = mNameIds.find( key );
+	if( nameIt != mNameIds.end() )
+		return nameIt->second;
+
+	uint32_t id = (uint32_t)mNames.size();
+	mNames.push_back( key );
+	mNameIds[key] = id;
+
+	string folded = toLowerAscii( key );
+	boost::unordered_map<string, uint32_t>::const_iterator foldedIt = mFoldedNameIds.find( folded );
+	if( foldedIt != mFoldedNameIds.end() )
+		mFoldedIds.push_back( foldedIt->second );
+	else {
+		uint32_t foldedId = (uint32_t)mFoldedNameIds.size();
+		mFoldedNameIds[folded] = foldedId;
+		mFoldedIds.push_back( foldedId );
+	}
+
+	return id;
+}
+
+uint32_t XmlDoc::findName( const std::string &name, bool caseSensitive ) const
+{
+	if( caseSensitive ) {
+		boost::unordered_map<string, uint32_t>::const_iterator nameIt = mNameIds.find( name );
+		return ( nameIt != mNameIds.end() ) ? nameIt->second : INVALID_INDEX;
+	}
+	else {
+		boost::unordered_map<string, uint32_t>::const_iterator foldedIt = mFoldedNameIds.find( toLowerAscii( name ) );
+		return ( foldedIt != mFoldedNameIds.end() ) ? foldedIt->second : INVALID_INDEX;
+	}
+}
+
+uint32_t XmlDoc::storeString( const char *s, size_t length )
+{
+	if( length == 0 )
+		return 0;
+	uint32_t offset = (uint32_t)mStrings.size();
+	mStrings.insert( mStrings.end(), s, s + length );
+	mStrings.push_back( 0 );
+	return offset;
+}
+
+bool XmlDoc::matches( uint32_t index, const Query &query, size_t level ) const
+{
+	uint32_t id = query.getId( level );
+	if( query.mCaseSensitive )
+		return mNodes[index].mName == id;
+	else
+		return mFoldedIds[mNodes[index].mName] == id;
+}
+
+// Returns the first node in document order at the query's last level, starting from the sibling 'candidate' at 'level', whose ancestors match the query.
+// When a level is exhausted the search resumes from the next sibling of its parent.
+uint32_t XmlDoc::seek( const Query &query, uint32_t candidate, uint32_t parent, size_t level ) const
+{
+	const size_t lastLevel = query.size() - 1;
+	for( ;; ) {
+		while( candidate != INVALID_INDEX && ! matches( candidate, query, level ) )
+			candidate = mNodes[candidate].mNextSibling;
+
+		if( candidate == INVALID_INDEX ) {
+			if( level == 0 )
+				return INVALID_INDEX;
+			candidate = mNodes[parent].mNextSibling;
+			parent = mNodes[parent].mParent;
+			--level;
+		}
+		else if( level == lastLevel )
+			return candidate;
+		else {
+			parent = candidate;
+			candidate = mNodes[candidate].mFirstChild;
+			++level;
+		}
+	}
+}
+
+double XmlDoc::toDouble( const char *s )
+{
+	char *end;
+	double result = std::strtod( s, &end );
+	while( isWhitespace( *end ) )
+		++end;
+	if( end == s || *end != 0 )
+		throw boost::bad_lexical_cast();
+	return result;
+}
+
+int64_t XmlDoc::toInt( const char *s )
+{
+	while( isWhitespace( *s ) )
+		++s;
+	bool negative = false;
+	if( *s == '-' || *s == '+' )
+		negative = *s++ == '-';
+	if( *s < '0' || *s > '9' )
+		throw boost::bad_lexical_cast();
+	uint64_t value = 0;
+	for( ; *s >= '0' && *s <= '9'; ++s )
+		value = value * 10 + uint64_t( *s - '0' );
+	while( isWhitespace( *s ) )
+		++s;
+	if( *s != 0 )
+		throw boost::bad_lexical_cast();
+	return negative ? -int64_t( value ) : int64_t( value );
+}
+
+XmlDoc::Node XmlDoc::getRoot() const
+{
+	return Node( this, 0 );
+}
+
+size_t XmlDoc::getMemoryUsage() const
+{
+	size_t result = sizeof( XmlDoc ) + mNodes.capacity() * sizeof( NodeData ) + mAttrs.capacity() * sizeof( AttrData ) + mStrings.capacity() + mFoldedIds.capacity() * sizeof( uint32_t );
+	for( vector<string>::const_iterator nameIt = mNames.begin(); nameIt != mNames.end(); ++nameIt )
+		result += sizeof( string ) + nameIt->capacity();
+	// the hash tables hold a copy of each key plus a node and bucket per entry
+	result += ( mNameIds.size() + mFoldedNameIds.size() ) * ( sizeof( string ) + sizeof( uint32_t ) + 2 * sizeof( void* ) ) + ( mNameIds.bucket_count() + mFoldedNameIds.bucket_count() ) * sizeof( void* );
+	return result;
+}
+
+XmlTree XmlDoc::toXmlTree() const
+{
+	return getRoot().toXmlTree();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// XmlDoc::Query
+
+XmlDoc::Query::Query( const XmlDoc &doc, const std::string &path, bool caseSensitive, char separator )
+	: mDoc( &doc ), mIds( new vector<uint32_t>() ), mCaseSensitive( caseSensitive )
+{
+	vector<string> components = split( path, separator );
+	for( vector<string>::const_iterator compIt = components.begin(); compIt != components.end(); ++compIt )
+		if( ! compIt->empty() )
+			mIds->push_back( doc.findName( *compIt, caseSensitive ) );
+}
+
+bool XmlDoc::Query::isResolved() const
+{
+	for( size_t level = 0; level < size(); ++level )
+		if( getId( level ) == INVALID_INDEX )
+			return false;
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// XmlDoc::Node
+
+XmlDoc::Node XmlDoc::Node::getParent() const
+{
+	if( ! hasParent() )
+		throw ExcChildNotFound( *this, ".." );
+	return Node( mDoc, getData().mParent );
+}
+
+XmlDoc::Node XmlDoc::Node::getChild( const std::string &relativePath, bool caseSensitive, char separator ) const
+{
+	ConstIter child = begin( relativePath, caseSensitive, separator );
+	if( child == end() ) {
+		if( Query( *mDoc, relativePath, caseSensitive, separator ).empty() ) // matches XmlTree, where an empty path refers to the node itself
+			return *this;
+		throw ExcChildNotFound( *this, relativePath );
+	}
+	return *child;
+}
+
+XmlDoc::Node XmlDoc::Node::getChild( const Query &query ) const
+{
+	if( query.empty() )
+		return *this;
+	ConstIter child = begin( query );
+	if( child == end() )
+		throw ExcChildNotFound( *this, "<query>" );
+	return *child;
+}
+
+bool XmlDoc::Node::hasChild( const std::string &relativePath, bool caseSensitive, char separator ) const
+{
+	return hasChild( Query( *mDoc, relativePath, caseSensitive, separator ) );
+}
+
+bool XmlDoc::Node::hasChild( const Query &query ) const
+{
+	return query.empty() || begin( query ) != end();
+}
+
+size_t XmlDoc::Node::getNumChildren() const
+{
+	size_t result = 0;
+	for( uint32_t child = getData().mFirstChild; child != INVALID_INDEX; child = mDoc->mNodes[child].mNextSibling )
+		++result;
+	return result;
+}
+
+XmlDoc::ConstIter XmlDoc::Node::begin() const
+{
+	return ConstIter( mDoc, getData().mFirstChild );
+}
+
+XmlDoc::ConstIter XmlDoc::Node::begin( const std::string &filterPath, bool caseSensitive, char separator ) const
+{
+	return begin( Query( *mDoc, filterPath, caseSensitive, separator ) );
+}
+
+XmlDoc::ConstIter XmlDoc::Node::begin( const Query &query ) const
+{
+	if( query.getDoc() != mDoc )
+		throw ExcQueryMismatch();
+	if( query.empty() ) // empty filter means nothing matches
+		return end();
+	return ConstIter( mDoc, mDoc->seek( query, getData().mFirstChild, mIndex, 0 ), query );
+}
+
+XmlDoc::ConstIter XmlDoc::Node::end() const
+{
+	return ConstIter( mDoc, INVALID_INDEX );
+}
+
+uint32_t XmlDoc::Node::findAttr( const std::string &attrName ) const
+{
+	uint32_t name = mDoc->findName( attrName, true );
+	if( name == INVALID_INDEX )
+		return INVALID_INDEX;
+	for( uint32_t attr = getData().mFirstAttr; attr < mDoc->getAttrEnd( mIndex ); ++attr )
+		if( mDoc->mAttrs[attr].mName == name )
+			return attr;
+	return INVALID_INDEX;
+}
+
+XmlDoc::Attr XmlDoc::Node::getAttribute( const std::string &attrName ) const
+{
+	uint32_t attr = findAttr( attrName );
+	if( attr == INVALID_INDEX )
+		throw ExcAttrNotFound( *this, attrName );
+	return Attr( mDoc, attr );
+}
+
+bool XmlDoc::Node::hasAttribute( const std::string &attrName ) const
+{
+	return findAttr( attrName ) != INVALID_INDEX;
+}
+
+std::string XmlDoc::Node::getPath( char separator ) const
+{
+	string result;
+	for( Node node = *this; ; node = node.getParent() ) {
+		string nodeName = node.getTag();
+		if( node != *this )
+			nodeName += separator;
+		result = nodeName + result;
+		if( ! node.hasParent() )
+			break;
+	}
+	return result;
+}
+
+XmlTree XmlDoc::Node::toXmlTree() const
+{
+	XmlTree result( getTag(), getValue(), 0, getNodeType() );
+	if( isDocument() )
+		result.setDocType( mDoc->mDocType );
+	mDoc->fillXmlTree( mIndex, &result );
+	return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// XmlDoc::ConstIter
+
+void XmlDoc::ConstIter::increment()
+{
+	const NodeData &data = mNode.getData();
+	if( mQuery.empty() )
+		mNode.mIndex = data.mNextSibling;
+	else
+		mNode.mIndex = mNode.mDoc->seek( mQuery, data.mNextSibling, data.mParent, mQuery.size() - 1 );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+XmlDoc::ExcChildNotFound::ExcChildNotFound( const Node &node, const string &childPath ) throw()
+{
+	sprintf( mMessage, "Could not find child: %s for node: %s", childPath.substr( 0, 1000 ).c_str(), node.getPath().substr( 0, 1000 ).c_str() );
+}
+
+XmlDoc::ExcAttrNotFound::ExcAttrNotFound( const Node &node, const string &attrName ) throw()
+{
+	sprintf( mMessage, "Could not find attribute: %s for node: %s", attrName.substr( 0, 1000 ).c_str(), node.getPath().substr( 0, 1000 ).c_str() );
+}
+
+} // namespace cinder
@@ -0,0 +1,462 @@
+/*
+ Copyright (c) 2010, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/XmlReader.h"
+#include "cinder/Utilities.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using std::string;
+using std::vector;
+
+namespace cinder {
+
+namespace {
+
+const StreamScanner::Delimiters sTextDelimiters( "<" );
+const StreamScanner::Delimiters sNameDelimiters( " \t\r\n/>=" );
+const StreamScanner::Delimiters sDoubleQuoteDelimiters( "\"" );
+const StreamScanner::Delimiters sSingleQuoteDelimiters( "'" );
+const StreamScanner::Delimiters sCDataDelimiters( "]" );
+const StreamScanner::Delimiters sDocTypeDelimiters( "[>" );
+
+void appendUtf8( string *out, uint32_t cp )
+{
+	if( cp < 0x80 )
+		out->push_back( char( cp ) );
+	else if( cp < 0x800 ) {
+		out->push_back( char( 0xC0 | ( cp >> 6 ) ) );
+		out->push_back( char( 0x80 | ( cp & 0x3F ) ) );
+	}
+	else if( cp < 0x10000 ) {
+		out->push_back( char( 0xE0 | ( cp >> 12 ) ) );
+		out->push_back( char( 0x80 | ( ( cp >> 6 ) & 0x3F ) ) );
+		out->push_back( char( 0x80 | ( cp & 0x3F ) ) );
+	}
+	else {
+		out->push_back( char( 0xF0 | ( cp >> 18 ) ) );
+		out->push_back( char( 0x80 | ( ( cp >> 12 ) & 0x3F ) ) );
+		out->push_back( char( 0x80 | ( ( cp >> 6 ) & 0x3F ) ) );
+		out->push_back( char( 0x80 | ( cp & 0x3F ) ) );
+	}
+}
+
+// Appends \a raw to \a out, replacing the predefined entities and character references. Unknown entities are kept as they are.
+void decodeEntities( const string &raw, string *out )
+{
+	size_t start = 0;
+	for( ;; ) {
+		size_t amp = raw.find( '&', start );
+		if( amp == string::npos ) {
+			out->append( raw, start, string::npos );
+			return;
+		}
+		out->append( raw, start, amp - start );
+		size_t semicolon = raw.find( ';', amp );
+		if( semicolon == string::npos || semicolon - amp > 10 ) {
+			out->push_back( '&' );
+			start = amp + 1;
+			continue;
+		}
+
+		const string entity = raw.substr( amp + 1, semicolon - amp - 1 );
+		if( entity == "lt" ) out->push_back( '<' );
+		else if( entity == "gt" ) out->push_back( '>' );
+		else if( entity == "amp" ) out->push_back( '&' );
+		else if( entity == "quot" ) out->push_back( '"' );
+		else if( entity == "apos" ) out->push_back( '\'' );
+		else if( entity.size() > 1 && entity[0] == '#' ) {
+			const bool hex = entity[1] == 'x' || entity[1] == 'X';
+			const char *digits = entity.c_str() + ( hex ? 2 : 1 );
+			char *end;
+			unsigned long cp = std::strtoul( digits, &end, hex ? 16 : 10 );
+			if( *end == 0 && end != digits && cp <= 0x10FFFF )
+				appendUtf8( out, uint32_t( cp ) );
+			else
+				out->append( raw, amp, semicolon + 1 - amp );
+		}
+		else
+			out->append( raw, amp, semicolon + 1 - amp );
+		start = semicolon + 1;
+	}
+}
+
+bool isWhitespace( const string &s )
+{
+	for( size_t i = 0; i < s.size(); ++i )
+		if( s[i] != ' ' && s[i] != '\t' && s[i] != '\r' && s[i] != '\n' )
+			return false;
+	return true;
+}
+
+// Tags are compared case-insensitively like XmlTree::getChild(), but ASCII only, which avoids a locale lookup per character
+bool equalsNoCase( const string &a, const string &b )
+{
+	if( a.size() != b.size() )
+		return false;
+	for( size_t i = 0; i < a.size(); ++i ) {
+		char ca = a[i], cb = b[i];
+		if( ca >= 'A' && ca <= 'Z' ) ca += 'a' - 'A';
+		if( cb >= 'A' && cb <= 'Z' ) cb += 'a' - 'A';
+		if( ca != cb )
+			return false;
+	}
+	return true;
+}
+
+} // anonymous namespace
+
+XmlReader::XmlReader( DataSourceRef dataSource, size_t chunkSize )
+	: mScanner( dataSource->createStream(), chunkSize )
+{
+	init();
+}
+
+XmlReader::XmlReader( IStreamRef stream, size_t chunkSize )
+	: mScanner( stream, chunkSize )
+{
+	init();
+}
+
+void XmlReader::init()
+{
+	mEvent = EVENT_NONE;
+	mPopPending = mSelfClosing = mRootRead = false;
+	mFilterSeparator = 0;
+	// skip a UTF-8 byte order mark
+	mScanner.match( "\xEF\xBB\xBF" );
+}
+
+bool XmlReader::next()
+{
+	if( mEvent == EVENT_END_DOCUMENT )
+		return false;
+	if( mPopPending ) {
+		mTags.pop_back();
+		mPopPending = false;
+	}
+	if( mSelfClosing ) {
+		mSelfClosing = false;
+		mAttributes.clear();
+		mEvent = EVENT_END_ELEMENT;
+		mPopPending = true;
+		return true;
+	}
+
+	for( ;; ) {
+		int c = mScanner.peek();
+		if( c < 0 ) {
+			if( ! mTags.empty() )
+				error( "Unexpected end of document inside <" + mTags.back() + ">" );
+			mEvent = EVENT_END_DOCUMENT;
+			return false;
+		}
+
+		if( c != '<' ) {
+			mRawText.clear();
+			mScanner.readUntil( sTextDelimiters, &mRawText );
+			if( mTags.empty() || isWhitespace( mRawText ) )
+				continue;
+			mValue.clear();
+			decodeEntities( mRawText, &mValue );
+			mEvent = EVENT_TEXT;
+			return true;
+		}
+
+		mScanner.get();
+		const int marker = mScanner.peek();
+		if( marker == '/' ) {
+			mScanner.get();
+			readEndTag();
+			return true;
+		}
+		else if( marker == '!' ) {
+			if( mScanner.match( "!--" ) ) {
+				if( ! mScanner.skipPast( "-->" ) )
+					error( "Unterminated comment" );
+			}
+			else if( mScanner.match( "![CDATA[" ) ) {
+				readCData();
+				mEvent = EVENT_TEXT;
+				return true;
+			}
+			else {
+				// DOCTYPE, possibly with an internal subset in brackets
+				if( mScanner.readUntil( sDocTypeDelimiters, 0 ) == '[' && ! mScanner.skipPast( "]" ) )
+					error( "Unterminated DOCTYPE" );
+				if( ! mScanner.skipPast( ">" ) )
+					error( "Unterminated DOCTYPE" );
+			}
+		}
+		else if( marker == '?' ) {
+			if( ! mScanner.skipPast( "?>" ) )
+				error( "Unterminated processing instruction" );
+		}
+		else {
+			readStartTag();
+			return true;
+		}
+	}
+}
+
+void XmlReader::readName( string *name )
+{
+	name->clear();
+	mScanner.readUntil( sNameDelimiters, name );
+	if( name->empty() )
+		error( "Expected a name" );
+}
+
+void XmlReader::readStartTag()
+{
+	const bool isRoot = mTags.empty();
+	mTags.push_back( string() );
+	readName( &mTags.back() );
+	if( isRoot ) {
+		if( mRootRead )
+			error( "Unexpected second root element <" + mTags.back() + ">" );
+		mRootRead = true;
+	}
+	mAttributes.clear();
+
+	for( ;; ) {
+		mScanner.skipWhitespace();
+		int c = mScanner.get();
+		if( c == '>' )
+			break;
+		if( c == '/' ) {
+			if( mScanner.get() != '>' )
+				error( "Expected '>' after '/'" );
+			mSelfClosing = true;
+			break;
+		}
+		if( c < 0 )
+			error( "Unexpected end of document in <" + mTags.back() + ">" );
+
+		mAttributes.push_back( Attribute( string( 1, char( c ) ), string() ) );
+		Attribute &attr = mAttributes.back();
+		mScanner.readUntil( sNameDelimiters, &attr.first );
+		mScanner.skipWhitespace();
+		if( mScanner.get() != '=' )
+			error( "Expected '=' after attribute " + attr.first );
+		mScanner.skipWhitespace();
+		const int quote = mScanner.get();
+		if( quote != '"' && quote != '\'' )
+			error( "Expected a quoted value for attribute " + attr.first );
+		mRawText.clear();
+		if( mScanner.readUntil( quote == '"' ? sDoubleQuoteDelimiters : sSingleQuoteDelimiters, &mRawText ) < 0 )
+			error( "Unterminated value for attribute " + attr.first );
+		mScanner.get();
+		decodeEntities( mRawText, &attr.second );
+	}
+
+	mEvent = EVENT_START_ELEMENT;
+}
+
+void XmlReader::readEndTag()
+{
+	mValue.clear();
+	readName( &mValue );
+	mScanner.skipWhitespace();
+	if( mScanner.get() != '>' )
+		error( "Expected '>' in </" + mValue + ">" );
+	if( mTags.empty() || mTags.back() != mValue )
+		error( "Mismatched </" + mValue + ">" + ( mTags.empty() ? string() : ", expected </" + mTags.back() + ">" ) );
+
+	mAttributes.clear();
+	mEvent = EVENT_END_ELEMENT;
+	mPopPending = true;
+}
+
+void XmlReader::readCData()
+{
+	mValue.clear();
+	for( ;; ) {
+		if( mScanner.readUntil( sCDataDelimiters, &mValue ) < 0 )
+			error( "Unterminated CDATA section" );
+		if( mScanner.match( "]]>" ) )
+			return;
+		mValue.push_back( (char)mScanner.get() );
+	}
+}
+
+bool XmlReader::nextMatching( const string &pathFilter, bool caseSensitive, char separator )
+{
+	if( pathFilter != mFilterString || separator != mFilterSeparator ) {
+		mFilterString = pathFilter;
+		mFilterSeparator = separator;
+		mFilter.clear();
+		vector<string> components = split( pathFilter, separator );
+		for( vector<string>::const_iterator componentIt = components.begin(); componentIt != components.end(); ++componentIt )
+			if( ! componentIt->empty() )
+				mFilter.push_back( *componentIt );
+	}
+
+	while( next() ) {
+		if( mEvent != EVENT_START_ELEMENT )
+			continue;
+		// only the newest tag needs checking, as its ancestors matched or they would have been skipped
+		const size_t depth = mTags.size();
+		if( depth > mFilter.size() ) {
+			skip();
+			continue;
+		}
+		const string &filter = mFilter[depth - 1];
+		bool match = filter == "*" || ( caseSensitive ? filter == mTags.back() : equalsNoCase( filter, mTags.back() ) );
+		if( ! match )
+			skip();
+		else if( depth == mFilter.size() )
+			return true;
+	}
+	return false;
+}
+
+void XmlReader::skip()
+{
+	if( mEvent != EVENT_START_ELEMENT )
+		return;
+	const size_t depth = mTags.size();
+	while( next() )
+		if( mEvent == EVENT_END_ELEMENT && mTags.size() == depth )
+			return;
+}
+
+const string& XmlReader::getTag() const
+{
+	static const string sEmpty;
+	return mTags.empty() ? sEmpty : mTags.back();
+}
+
+string XmlReader::getPath( char separator ) const
+{
+	string result;
+	for( size_t i = 0; i < mTags.size(); ++i ) {
+		if( i > 0 )
+			result += separator;
+		result += mTags[i];
+	}
+	return result;
+}
+
+bool XmlReader::hasAttribute( const string &name ) const
+{
+	for( vector<Attribute>::const_iterator attrIt = mAttributes.begin(); attrIt != mAttributes.end(); ++attrIt )
+		if( attrIt->first == name )
+			return true;
+	return false;
+}
+
+const string& XmlReader::getAttributeValue( const string &name ) const
+{
+	for( vector<Attribute>::const_iterator attrIt = mAttributes.begin(); attrIt != mAttributes.end(); ++attrIt )
+		if( attrIt->first == name )
+			return attrIt->second;
+	throw ExcAttrNotFound( *this, name );
+}
+
+// Surrounding whitespace is ignored, and anything else which is not part of the number throws like boost::lexical_cast would
+double XmlReader::toDouble() const
+{
+	const char *begin = mValue.c_str();
+	char *end;
+	double result = std::strtod( begin, &end );
+	while( *end == ' ' || *end == '\t' || *end == '\r' || *end == '\n' )
+		++end;
+	if( end == begin || *end != 0 )
+		throw boost::bad_lexical_cast();
+	return result;
+}
+
+int64_t XmlReader::toInt() const
+{
+	const char *s = mValue.c_str();
+	while( *s == ' ' || *s == '\t' || *s == '\r' || *s == '\n' )
+		++s;
+	bool negative = false;
+	if( *s == '-' || *s == '+' )
+		negative = *s++ == '-';
+	if( *s < '0' || *s > '9' )
+		throw boost::bad_lexical_cast();
+	uint64_t value = 0;
+	for( ; *s >= '0' && *s <= '9'; ++s )
+		value = value * 10 + uint64_t( *s - '0' );
+	while( *s == ' ' || *s == '\t' || *s == '\r' || *s == '\n' )
+		++s;
+	if( *s != 0 )
+		throw boost::bad_lexical_cast();
+	return negative ? -int64_t( value ) : int64_t( value );
+}
+
+XmlTree XmlReader::readTree()
+{
+	XmlTree result;
+	if( mEvent != EVENT_START_ELEMENT )
+		return result;
+
+	result.setTag( mTags.back() );
+	for( vector<Attribute>::const_iterator attrIt = mAttributes.begin(); attrIt != mAttributes.end(); ++attrIt )
+		result.setAttribute( attrIt->first, attrIt->second );
+
+	// children are appended in place, so the stack can point into their parents' lists
+	vector<XmlTree*> stack( 1, &result );
+	// text is gathered alongside each open element and handed over once it closes, keeping long values linear
+	vector<string> values( 1 );
+	while( ! stack.empty() && next() ) {
+		if( mEvent == EVENT_START_ELEMENT ) {
+			stack.back()->push_back( XmlTree( mTags.back(), "" ) );
+			XmlTree *child = &stack.back()->getChildren().back();
+			for( vector<Attribute>::const_iterator attrIt = mAttributes.begin(); attrIt != mAttributes.end(); ++attrIt )
+				child->setAttribute( attrIt->first, attrIt->second );
+			stack.push_back( child );
+			values.push_back( string() );
+		}
+		else if( mEvent == EVENT_TEXT )
+			values.back() += mValue;
+		else if( mEvent == EVENT_END_ELEMENT ) {
+			stack.back()->setValue( values.back() );
+			stack.pop_back();
+			values.pop_back();
+		}
+	}
+	return result;
+}
+
+void XmlReader::error( const string &message ) const
+{
+	throw ExcXmlParserError( message, mScanner.getOffset() );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+XmlReader::ExcXmlParserError::ExcXmlParserError( const string &errorMessage, uint64_t offset ) throw()
+{
+	sprintf( mMessage, "Unable to parse XML\n: %s at byte %llu", errorMessage.substr( 0, 1900 ).c_str(), (unsigned long long)offset );
+}
+
+XmlReader::ExcAttrNotFound::ExcAttrNotFound( const XmlReader &reader, const string &attrName ) throw()
+{
+	sprintf( mMessage, "Could not find attribute: %s for node: %s", attrName.substr( 0, 1000 ).c_str(), reader.getPath().substr( 0, 1000 ).c_str() );
+}
+
+} // namespace cinder
@@ -25,6 +25,7 @@
 #include "cinder/Text.h"
 #include "cinder/ip/Fill.h"
 #include "cinder/ip/Premultiply.h"
+#include "cinder/Stream.h"
 	#include "cinder/ImageIo.h"
 	#include "cinder/Rand.h"
 	#include "cinder/Utilities.h"
@@ -41,9 +42,27 @@ using namespace std;
 
 namespace cinder { namespace gl {
 
+namespace {
+
+const uint32_t	ATLAS_MAGIC = 0x41465443; // "CTFA"
+const uint8_t	ATLAS_VERSION = 1;
+
+// FNV-1a hash of the supported characters, identifying the glyphs in a saved atlas
+uint32_t hashSupportedChars( const string &supportedChars )
+{
+	uint32_t result = 2166136261U;
+	for( string::const_iterator charIt = supportedChars.begin(); charIt != supportedChars.end(); ++charIt ) {
+		result ^= static_cast<uint8_t>( *charIt );
+		result *= 16777619U;
+	}
+	return result;
+}
+
+} // anonymous namespace
+
 #if defined( CINDER_COCOA )
 TextureFont::TextureFont( const Font &font, const string &supportedChars, const TextureFont::Format &format )
-	: mFont( font ), mFormat( format )
+	: mFont( font ), mFormat( format ), mSupportedCharsHash( hashSupportedChars( supportedChars ) )
 {
 	// get the glyph indices we'll need
 	vector<Font::Glyph>	tempGlyphs = font.getGlyphs( supportedChars );
@@ -61,7 +80,8 @@ TextureFont::TextureFont( const Font &font, const string &supportedChars, const
 
 	int glyphsWide = floor( mFormat.getTextureWidth() / (glyphExtents.x+3) );
 	int glyphsTall = floor( mFormat.getTextureHeight() / (glyphExtents.y+5) );	
-	uint8_t curGlyphIndex = 0, curTextureIndex = 0;
+	uint32_t curGlyphIndex = 0;
+	uint8_t curTextureIndex = 0;
 	Vec2i curOffset = Vec2i::zero();
 	CGGlyph renderGlyphs[glyphsWide*glyphsTall];
 	CGPoint renderPositions[glyphsWide*glyphsTall];
@@ -74,10 +94,6 @@ TextureFont::TextureFont( const Font &font, const string &supportedChars, const
 	::CGContextSetFontSize( cgContext, font.getSize() );
 	::CGContextSetTextMatrix( cgContext, CGAffineTransformIdentity );
 
-#if defined( CINDER_GLES )
-	std::shared_ptr<uint8_t> lumAlphaData( new uint8_t[mFormat.getTextureWidth()*mFormat.getTextureHeight()*2], checked_array_deleter<uint8_t>() );
-#endif
-
 	for( set<Font::Glyph>::const_iterator glyphIt = glyphs.begin(); glyphIt != glyphs.end(); ) {
 		GlyphInfo newInfo;
 		newInfo.mTextureIndex = curTextureIndex;
@@ -96,30 +112,10 @@ TextureFont::TextureFont( const Font &font, const string &supportedChars, const
 		if( ( ++curGlyphIndex == glyphsWide * glyphsTall ) || ( glyphIt == glyphs.end() ) ) {
 			::CGContextShowGlyphsAtPositions( cgContext, renderGlyphs, renderPositions, curGlyphIndex );
 			
-			// pass premultiply and mipmapping preferences to Texture::Format
 			if( ! mFormat.getPremultiply() )
 				ip::unpremultiply( &surface );
 
-			gl::Texture::Format textureFormat = gl::Texture::Format();
-			textureFormat.enableMipmapping( mFormat.hasMipmapping() );
-			textureFormat.setInternalFormat( GL_LUMINANCE_ALPHA );
-#if defined( CINDER_GLES )
-			// under iOS format and interalFormat must match, so let's make a block of LUMINANCE_ALPHA data
-			Surface8u::ConstIter iter( surface, surface.getBounds() );
-			size_t offset = 0;
-			while( iter.line() ) {
-				while( iter.pixel() ) {
-					lumAlphaData.get()[offset+0] = iter.r();
-					lumAlphaData.get()[offset+1] = iter.a();
-					offset += 2;
-				}
-			}
-			mTextures.push_back( gl::Texture( lumAlphaData.get(), GL_LUMINANCE_ALPHA, mFormat.getTextureWidth(), mFormat.getTextureHeight(), textureFormat ) );
-#else
-			mTextures.push_back( gl::Texture( surface, textureFormat ) );
-			if( mFormat.hasMipmapping() )
-				mTextures.back().setMinFilter( GL_LINEAR_MIPMAP_LINEAR );
-#endif
+			addTexture( surface );
 			ip::fill( &surface, ColorA8u( 0, 0, 0, 0 ) );			
 			curOffset = Vec2i::zero();
 			curGlyphIndex = 0;
@@ -190,7 +186,7 @@ set<Font::Glyph> getNecessaryGlyphs( const Font &font, const string &supportedCh
 }
 
 TextureFont::TextureFont( const Font &font, const string &utf8Chars, const Format &format )
-	: mFont( font ), mFormat( format )
+	: mFont( font ), mFormat( format ), mSupportedCharsHash( hashSupportedChars( utf8Chars ) )
 {
 	// get the glyph indices we'll need
 	set<Font::Glyph> glyphs = getNecessaryGlyphs( font, utf8Chars );
@@ -213,7 +209,8 @@ TextureFont::TextureFont( const Font &font, const string &utf8Chars, const Forma
 
 	int glyphsWide = mFormat.getTextureWidth() / glyphExtents.x;
 	int glyphsTall = mFormat.getTextureHeight() / glyphExtents.y;	
-	uint8_t curGlyphIndex = 0, curTextureIndex = 0;
+	uint32_t curGlyphIndex = 0;
+	uint8_t curTextureIndex = 0;
 	Vec2i curOffset = Vec2i::zero();
 
 	Channel channel( mFormat.getTextureWidth(), mFormat.getTextureHeight() );
@@ -265,10 +262,7 @@ TextureFont::TextureFont( const Font &font, const string &utf8Chars, const Forma
 			if( ! format.getPremultiply() )
 				ip::unpremultiply( &tempSurface );
 			
-			gl::Texture::Format textureFormat = gl::Texture::Format();
-			textureFormat.enableMipmapping( mFormat.hasMipmapping() );
-			textureFormat.setInternalFormat( GL_LUMINANCE_ALPHA );
-			mTextures.push_back( gl::Texture( tempSurface, textureFormat ) );
+			addTexture( tempSurface );
 			ip::fill<uint8_t>( &channel, 0 );			
 			curOffset = Vec2i::zero();
 			curGlyphIndex = 0;
@@ -284,201 +278,343 @@ TextureFont::TextureFont( const Font &font, const string &utf8Chars, const Forma
 }
 #endif
 
-void TextureFont::drawGlyphs( const vector<pair<uint16_t,Vec2f> > &glyphMeasures, const Vec2f &baselineIn, const DrawOptions &options, const std::vector<ColorA8u> &colors )
+TextureFont::TextureFont( const Font &font, const string &supportedChars, const Format &format, DataSourceRef atlas )
+	: mFont( font ), mFormat( format ), mSupportedCharsHash( hashSupportedChars( supportedChars ) )
 {
-	if( mTextures.empty() )
-		return;
+	IStreamRef in = atlas->createStream();
+	if( ! in )
+		throw TextureFontAtlasExc( "unable to open the atlas" );
+
+	try {
+		uint32_t magic;
+		uint8_t version;
+		in->readLittle( &magic );
+		in->read( &version );
+		if( magic != ATLAS_MAGIC || version != ATLAS_VERSION )
+			throw TextureFontAtlasExc( "not a TextureFont atlas, or an unsupported version" );
+
+		string fontName;
+		float fontSize;
+		uint32_t supportedCharsHash;
+		int32_t textureWidth, textureHeight;
+		uint8_t premultiply;
+		in->read( &fontName );
+		in->readLittle( &fontSize );
+		in->readLittle( &supportedCharsHash );
+		in->readLittle( &textureWidth );
+		in->readLittle( &textureHeight );
+		in->read( &premultiply );
+		if( fontName != mFont.getName() || fontSize != mFont.getSize() )
+			throw TextureFontAtlasExc( "atlas was saved for the font " + fontName + " at size " + toString( fontSize ) );
+		if( supportedCharsHash != mSupportedCharsHash )
+			throw TextureFontAtlasExc( "atlas was saved for different supported characters" );
+		if( textureWidth != mFormat.getTextureWidth() || textureHeight != mFormat.getTextureHeight() || ( premultiply != 0 ) != mFormat.getPremultiply() )
+			throw TextureFontAtlasExc( "atlas was saved with a different TextureFont::Format" );
+
+		uint32_t numGlyphs;
+		in->readLittle( &numGlyphs );
+		for( uint32_t glyph = 0; glyph < numGlyphs; ++glyph ) {
+			Font::Glyph glyphIndex;
+			GlyphInfo info;
+			in->readLittle( &glyphIndex );
+			in->read( &info.mTextureIndex );
+			in->readLittle( &info.mTexCoords.x1 ); in->readLittle( &info.mTexCoords.y1 );
+			in->readLittle( &info.mTexCoords.x2 ); in->readLittle( &info.mTexCoords.y2 );
+			in->readLittle( &info.mOriginOffset.x ); in->readLittle( &info.mOriginOffset.y );
+			mGlyphMap[glyphIndex] = info;
+		}
 
-	if( ! colors.empty() )
-		assert( glyphMeasures.size() == colors.size() );
+		uint32_t numTextures;
+		in->readLittle( &numTextures );
+		for( boost::unordered_map<Font::Glyph, GlyphInfo>::const_iterator glyphIt = mGlyphMap.begin(); glyphIt != mGlyphMap.end(); ++glyphIt ) {
+			if( glyphIt->second.mTextureIndex >= numTextures )
+				throw TextureFontAtlasExc( "atlas is corrupt" );
+		}
 
-	SaveTextureBindState saveBindState( mTextures[0].getTarget() );
-	BoolState saveEnabledState( mTextures[0].getTarget() );
-	ClientBoolState vertexArrayState( GL_VERTEX_ARRAY );
-	ClientBoolState colorArrayState( GL_COLOR_ARRAY );
-	ClientBoolState texCoordArrayState( GL_TEXTURE_COORD_ARRAY );	
-	gl::enable( mTextures[0].getTarget() );
+		const size_t textureBytes = mFormat.getTextureWidth() * mFormat.getTextureHeight() * 2;
+		for( uint32_t texIdx = 0; texIdx < numTextures; ++texIdx ) {
+			std::shared_ptr<uint8_t> lumAlphaData( new uint8_t[textureBytes], checked_array_deleter<uint8_t>() );
+			in->readData( lumAlphaData.get(), textureBytes );
+			addTexture( lumAlphaData );
+		}
+	}
+	catch( StreamExc & ) {
+		throw TextureFontAtlasExc( "atlas is truncated" );
+	}
+}
 
-	Vec2f baseline = baselineIn;
+TextureFontRef TextureFont::create( const Font &font, DataSourceRef atlas, const Format &format, const std::string &supportedChars )
+{
+	return TextureFontRef( new TextureFont( font, supportedChars, format, atlas ) );
+}
 
-	glEnableClientState( GL_VERTEX_ARRAY );
-	if ( colors.empty() )
-		glDisableClientState( GL_COLOR_ARRAY );
-	else
-		glEnableClientState( GL_COLOR_ARRAY );
-	glEnableClientState( GL_TEXTURE_COORD_ARRAY );
-	const float scale = options.getScale();
-	for( size_t texIdx = 0; texIdx < mTextures.size(); ++texIdx ) {
-		vector<float> verts, texCoords;
-		vector<ColorA8u> vertColors;
-		const gl::Texture &curTex = mTextures[texIdx];
-#if defined( CINDER_GLES )
-		vector<uint16_t> indices;
-		uint16_t curIdx = 0;
-		GLenum indexType = GL_UNSIGNED_SHORT;
-#else
-		vector<uint32_t> indices;
-		uint32_t curIdx = 0;
-		GLenum indexType = GL_UNSIGNED_INT;
+TextureFontRef TextureFont::create( const Font &font, const fs::path &atlasPath, const Format &format, const std::string &supportedChars )
+{
+	if( fs::exists( atlasPath ) ) {
+		try {
+			return TextureFontRef( new TextureFont( font, supportedChars, format, loadFile( atlasPath ) ) );
+		}
+		catch( TextureFontAtlasExc & ) { // stale atlas; rasterize and replace it below
+		}
+	}
+
+	TextureFontRef result( new TextureFont( font, supportedChars, Format( format ).retainAtlas() ) );
+	try {
+		result->save( writeFile( atlasPath ) );
+	}
+	catch( Exception & ) { // failing to cache the atlas shouldn't fail creating the font
+	}
+
+	if( ! format.getRetainAtlas() ) {
+		result->mFormat.retainAtlas( false );
+		result->mAtlasData.clear();
+	}
+	return result;
+}
+
+void TextureFont::save( DataTargetRef target ) const
+{
+	if( mAtlasData.size() != mTextures.size() )
+		throw TextureFontAtlasExc( "saving requires a TextureFont created with Format::retainAtlas()" );
+
+	OStreamRef out = target->getStream();
+	if( ! out )
+		throw TextureFontAtlasExc( "unable to write the atlas" );
+
+	out->writeLittle( ATLAS_MAGIC );
+	out->write( ATLAS_VERSION );
+	out->write( mFont.getName() );
+	out->writeLittle( mFont.getSize() );
+	out->writeLittle( mSupportedCharsHash );
+	out->writeLittle( mFormat.getTextureWidth() );
+	out->writeLittle( mFormat.getTextureHeight() );
+	out->write( static_cast<uint8_t>( mFormat.getPremultiply() ? 1 : 0 ) );
+
+	out->writeLittle( static_cast<uint32_t>( mGlyphMap.size() ) );
+	for( boost::unordered_map<Font::Glyph, GlyphInfo>::const_iterator glyphIt = mGlyphMap.begin(); glyphIt != mGlyphMap.end(); ++glyphIt ) {
+		const GlyphInfo &info = glyphIt->second;
+		out->writeLittle( glyphIt->first );
+		out->write( info.mTextureIndex );
+		out->writeLittle( info.mTexCoords.x1 ); out->writeLittle( info.mTexCoords.y1 );
+		out->writeLittle( info.mTexCoords.x2 ); out->writeLittle( info.mTexCoords.y2 );
+		out->writeLittle( info.mOriginOffset.x ); out->writeLittle( info.mOriginOffset.y );
+	}
+
+	const size_t textureBytes = mFormat.getTextureWidth() * mFormat.getTextureHeight() * 2;
+	out->writeLittle( static_cast<uint32_t>( mAtlasData.size() ) );
+	for( vector<std::shared_ptr<uint8_t> >::const_iterator dataIt = mAtlasData.begin(); dataIt != mAtlasData.end(); ++dataIt )
+		out->writeData( dataIt->get(), textureBytes );
+}
+
+void TextureFont::addTexture( const Surface8u &surface )
+{
+#if ! defined( CINDER_GLES )
+	if( ! mFormat.getRetainAtlas() ) {
+		gl::Texture::Format textureFormat = gl::Texture::Format();
+		textureFormat.enableMipmapping( mFormat.hasMipmapping() );
+		textureFormat.setInternalFormat( GL_LUMINANCE_ALPHA );
+		mTextures.push_back( gl::Texture( surface, textureFormat ) );
+		if( mFormat.hasMipmapping() )
+			mTextures.back().setMinFilter( GL_LINEAR_MIPMAP_LINEAR );
+		return;
+	}
 #endif
-		if( options.getPixelSnap() )
-			baseline = Vec2f( floor( baseline.x ), floor( baseline.y ) );
-			
-		for( vector<pair<uint16_t,Vec2f> >::const_iterator glyphIt = glyphMeasures.begin(); glyphIt != glyphMeasures.end(); ++glyphIt ) {
-			boost::unordered_map<Font::Glyph, GlyphInfo>::const_iterator glyphInfoIt = mGlyphMap.find( glyphIt->first );
-			if( (glyphInfoIt == mGlyphMap.end()) || (mGlyphMap[glyphIt->first].mTextureIndex != texIdx) )
-				continue;
-				
-			const GlyphInfo &glyphInfo = glyphInfoIt->second;
-			
-			Rectf destRect( glyphInfo.mTexCoords );
-			Rectf srcCoords = curTex.getAreaTexCoords( glyphInfo.mTexCoords );
-			destRect -= destRect.getUpperLeft();
-			destRect.scale( scale );
-			destRect += glyphIt->second * scale;
-			destRect += Vec2f( floor( glyphInfo.mOriginOffset.x + 0.5f ), floor( glyphInfo.mOriginOffset.y ) ) * scale;
-			destRect += Vec2f( baseline.x, baseline.y - mFont.getAscent() * scale );
-			if( options.getPixelSnap() )
-				destRect -= Vec2f( destRect.x1 - floor( destRect.x1 ), destRect.y1 - floor( destRect.y1 ) );				
-			
-			verts.push_back( destRect.getX2() ); verts.push_back( destRect.getY1() );
-			verts.push_back( destRect.getX1() ); verts.push_back( destRect.getY1() );
-			verts.push_back( destRect.getX2() ); verts.push_back( destRect.getY2() );
-			verts.push_back( destRect.getX1() ); verts.push_back( destRect.getY2() );
-
-			texCoords.push_back( srcCoords.getX2() ); texCoords.push_back( srcCoords.getY1() );
-			texCoords.push_back( srcCoords.getX1() ); texCoords.push_back( srcCoords.getY1() );
-			texCoords.push_back( srcCoords.getX2() ); texCoords.push_back( srcCoords.getY2() );
-			texCoords.push_back( srcCoords.getX1() ); texCoords.push_back( srcCoords.getY2() );
-			
-			if( ! colors.empty() ) {
-				for( int i = 0; i < 4; ++i )
-					vertColors.push_back( colors[glyphIt-glyphMeasures.begin()] );
-			}
 
-			indices.push_back( curIdx + 0 ); indices.push_back( curIdx + 1 ); indices.push_back( curIdx + 2 );
-			indices.push_back( curIdx + 2 ); indices.push_back( curIdx + 1 ); indices.push_back( curIdx + 3 );
-			curIdx += 4;
+	// under iOS format and interalFormat must match, so let's make a block of LUMINANCE_ALPHA data
+	std::shared_ptr<uint8_t> lumAlphaData( new uint8_t[surface.getWidth()*surface.getHeight()*2], checked_array_deleter<uint8_t>() );
+	Surface8u::ConstIter iter( surface, surface.getBounds() );
+	size_t offset = 0;
+	while( iter.line() ) {
+		while( iter.pixel() ) {
+			lumAlphaData.get()[offset+0] = iter.r();
+			lumAlphaData.get()[offset+1] = iter.a();
+			offset += 2;
 		}
-		
-		if( curIdx == 0 )
-			continue;
-		
-		curTex.bind();
-		glVertexPointer( 2, GL_FLOAT, 0, &verts[0] );
-		glTexCoordPointer( 2, GL_FLOAT, 0, &texCoords[0] );
-		if( ! colors.empty() )
-			glColorPointer( 4, GL_UNSIGNED_BYTE, 0, &vertColors[0] );
-		glDrawElements( GL_TRIANGLES, indices.size(), indexType, &indices[0] );
 	}
+	addTexture( lumAlphaData );
 }
 
-void TextureFont::drawGlyphs( const std::vector<std::pair<uint16_t,Vec2f> > &glyphMeasures, const Rectf &clip, Vec2f offset, const DrawOptions &options, const std::vector<ColorA8u> &colors )
+void TextureFont::addTexture( const std::shared_ptr<uint8_t> &lumAlphaData )
 {
-	if( mTextures.empty() )
-		return;
+	gl::Texture::Format textureFormat = gl::Texture::Format();
+	textureFormat.enableMipmapping( mFormat.hasMipmapping() );
+	textureFormat.setInternalFormat( GL_LUMINANCE_ALPHA );
+	mTextures.push_back( gl::Texture( lumAlphaData.get(), GL_LUMINANCE_ALPHA, mFormat.getTextureWidth(), mFormat.getTextureHeight(), textureFormat ) );
+#if ! defined( CINDER_GLES )
+	if( mFormat.hasMipmapping() )
+		mTextures.back().setMinFilter( GL_LINEAR_MIPMAP_LINEAR );
+#endif
+	if( mFormat.getRetainAtlas() )
+		mAtlasData.push_back( lumAlphaData );
+}
 
-	if( ! colors.empty() )
-		assert( glyphMeasures.size() == colors.size() );
+TextureFontAtlasExc::TextureFontAtlasExc( const std::string &message ) throw()
+{
+	sprintf( mMessage, "%s", message.substr( 0, sizeof(mMessage) - 1 ).c_str() );
+}
 
-	SaveTextureBindState saveBindState( mTextures[0].getTarget() );
-	BoolState saveEnabledState( mTextures[0].getTarget() );
-	ClientBoolState vertexArrayState( GL_VERTEX_ARRAY );
-	ClientBoolState colorArrayState( GL_COLOR_ARRAY );
-	ClientBoolState texCoordArrayState( GL_TEXTURE_COORD_ARRAY );	
-	gl::enable( mTextures[0].getTarget() );
-	const float scale = options.getScale();
-	glEnableClientState( GL_VERTEX_ARRAY );
-	if ( colors.empty() )
-		glDisableClientState( GL_COLOR_ARRAY );
-	else
-		glEnableClientState( GL_COLOR_ARRAY );
-	glEnableClientState( GL_TEXTURE_COORD_ARRAY );
-	for( size_t texIdx = 0; texIdx < mTextures.size(); ++texIdx ) {
-		vector<float> verts, texCoords;
-		vector<ColorA8u> vertColors;
-		const gl::Texture &curTex = mTextures[texIdx];
+namespace {
 #if defined( CINDER_GLES )
-		vector<uint16_t> indices;
-		uint16_t curIdx = 0;
-		GLenum indexType = GL_UNSIGNED_SHORT;
+typedef uint16_t	QuadIndex;
+const GLenum		QUAD_INDEX_TYPE = GL_UNSIGNED_SHORT;
+const size_t		MAX_QUADS_PER_DRAW = 65536 / 4;
 #else
-		vector<uint32_t> indices;
-		uint32_t curIdx = 0;
-		GLenum indexType = GL_UNSIGNED_INT;
+typedef uint32_t	QuadIndex;
+const GLenum		QUAD_INDEX_TYPE = GL_UNSIGNED_INT;
+const size_t		MAX_QUADS_PER_DRAW = 0x3FFFFFFF;
 #endif
+
+// Returns the triangle indices for at least 'numQuads' quads of 4 vertices each, shared by every draw
+const QuadIndex* getQuadIndices( size_t numQuads )
+{
+	static vector<QuadIndex> sIndices;
+	for( size_t quad = sIndices.size() / 6; quad < numQuads; ++quad ) {
+		QuadIndex curIdx = static_cast<QuadIndex>( quad * 4 );
+		sIndices.push_back( curIdx + 0 ); sIndices.push_back( curIdx + 1 ); sIndices.push_back( curIdx + 2 );
+		sIndices.push_back( curIdx + 2 ); sIndices.push_back( curIdx + 1 ); sIndices.push_back( curIdx + 3 );
+	}
+	return &sIndices[0];
+}
+
+} // anonymous namespace
+
+Vec2f TextureFont::calcBaselineOffset( const Vec2f &baselineIn, const DrawOptions &options ) const
+{
+	Vec2f baseline = baselineIn;
+	if( options.getPixelSnap() )
+		baseline = Vec2f( floor( baseline.x ), floor( baseline.y ) );
+	return Vec2f( baseline.x, baseline.y - mFont.getAscent() * options.getScale() );
+}
+
+void TextureFont::appendQuads( const vector<pair<uint16_t,Vec2f> > &glyphMeasures, Vec2f offset, const Rectf *clip, const DrawOptions &options,
+								const std::vector<ColorA8u> &colors, vector<Quads> *result ) const
+{
+	if( result->size() < mTextures.size() )
+		result->resize( mTextures.size() );
+
+	const float scale = options.getScale();
+	if( clip && options.getPixelSnap() )
+		offset = Vec2f( floor( offset.x ), floor( offset.y ) );
+
+	for( vector<pair<uint16_t,Vec2f> >::const_iterator glyphIt = glyphMeasures.begin(); glyphIt != glyphMeasures.end(); ++glyphIt ) {
+		boost::unordered_map<Font::Glyph, GlyphInfo>::const_iterator glyphInfoIt = mGlyphMap.find( glyphIt->first );
+		if( glyphInfoIt == mGlyphMap.end() )
+			continue;
+
+		const GlyphInfo &glyphInfo = glyphInfoIt->second;
+		const gl::Texture &curTex = mTextures[glyphInfo.mTextureIndex];
+		Quads &quads = (*result)[glyphInfo.mTextureIndex];
+
+		Rectf srcTexCoords = curTex.getAreaTexCoords( glyphInfo.mTexCoords );
+		Rectf destRect( glyphInfo.mTexCoords );
+		destRect -= destRect.getUpperLeft();
+		destRect.scale( scale );
+		destRect += glyphIt->second * scale;
+		destRect += Vec2f( floor( glyphInfo.mOriginOffset.x + 0.5f ), floor( glyphInfo.mOriginOffset.y ) ) * scale;
+		destRect += offset;
 		if( options.getPixelSnap() )
-			offset = Vec2f( floor( offset.x ), floor( offset.y ) );
+			destRect -= Vec2f( destRect.x1 - floor( destRect.x1 ), destRect.y1 - floor( destRect.y1 ) );
 
-		for( vector<pair<uint16_t,Vec2f> >::const_iterator glyphIt = glyphMeasures.begin(); glyphIt != glyphMeasures.end(); ++glyphIt ) {
-			boost::unordered_map<Font::Glyph, GlyphInfo>::const_iterator glyphInfoIt = mGlyphMap.find( glyphIt->first );
-			if( (glyphInfoIt == mGlyphMap.end()) || (mGlyphMap[glyphIt->first].mTextureIndex != texIdx) )
-				continue;
-				
-			const GlyphInfo &glyphInfo = glyphInfoIt->second;
-			Rectf srcTexCoords = curTex.getAreaTexCoords( glyphInfo.mTexCoords );
-			Rectf destRect( glyphInfo.mTexCoords );
-			destRect -= destRect.getUpperLeft();
-			destRect.scale( scale );
-			destRect += glyphIt->second * scale;
-			destRect += Vec2f( floor( glyphInfo.mOriginOffset.x + 0.5f ), floor( glyphInfo.mOriginOffset.y ) ) * scale;
-			destRect += Vec2f( offset.x, offset.y );
-			if( options.getPixelSnap() )
-				destRect -= Vec2f( destRect.x1 - floor( destRect.x1 ), destRect.y1 - floor( destRect.y1 ) );				
-
-			// clip
-			Rectf clipped( destRect );
+		Rectf clipped( destRect );
+		if( clip ) {
 			if( options.getClipHorizontal() ) {
-				clipped.x1 = std::max( destRect.x1, clip.x1 );
-				clipped.x2 = std::min( destRect.x2, clip.x2 );
+				clipped.x1 = std::max( destRect.x1, clip->x1 );
+				clipped.x2 = std::min( destRect.x2, clip->x2 );
 			}
 			if( options.getClipVertical() ) {
-				clipped.y1 = std::max( destRect.y1, clip.y1 );
-				clipped.y2 = std::min( destRect.y2, clip.y2 );
+				clipped.y1 = std::max( destRect.y1, clip->y1 );
+				clipped.y2 = std::min( destRect.y2, clip->y2 );
 			}
-			
+
 			if( clipped.x1 >= clipped.x2 || clipped.y1 >= clipped.y2 )
 				continue;
-			
+
 			Vec2f coordScale( 1 / (float)destRect.getWidth() / curTex.getWidth() * glyphInfo.mTexCoords.getWidth(),
 				1 / (float)destRect.getHeight() / curTex.getHeight() * glyphInfo.mTexCoords.getHeight() );
 			srcTexCoords.x1 = srcTexCoords.x1 + ( clipped.x1 - destRect.x1 ) * coordScale.x;
 			srcTexCoords.x2 = srcTexCoords.x1 + ( clipped.x2 - clipped.x1 ) * coordScale.x;
 			srcTexCoords.y1 = srcTexCoords.y1 + ( clipped.y1 - destRect.y1 ) * coordScale.y;
 			srcTexCoords.y2 = srcTexCoords.y1 + ( clipped.y2 - clipped.y1 ) * coordScale.y;
+		}
 
-			verts.push_back( clipped.getX2() ); verts.push_back( clipped.getY1() );
-			verts.push_back( clipped.getX1() ); verts.push_back( clipped.getY1() );
-			verts.push_back( clipped.getX2() ); verts.push_back( clipped.getY2() );
-			verts.push_back( clipped.getX1() ); verts.push_back( clipped.getY2() );
+		quads.mVerts.push_back( clipped.getX2() ); quads.mVerts.push_back( clipped.getY1() );
+		quads.mVerts.push_back( clipped.getX1() ); quads.mVerts.push_back( clipped.getY1() );
+		quads.mVerts.push_back( clipped.getX2() ); quads.mVerts.push_back( clipped.getY2() );
+		quads.mVerts.push_back( clipped.getX1() ); quads.mVerts.push_back( clipped.getY2() );
 
-			texCoords.push_back( srcTexCoords.getX2() ); texCoords.push_back( srcTexCoords.getY1() );
-			texCoords.push_back( srcTexCoords.getX1() ); texCoords.push_back( srcTexCoords.getY1() );
-			texCoords.push_back( srcTexCoords.getX2() ); texCoords.push_back( srcTexCoords.getY2() );
-			texCoords.push_back( srcTexCoords.getX1() ); texCoords.push_back( srcTexCoords.getY2() );
+		quads.mTexCoords.push_back( srcTexCoords.getX2() ); quads.mTexCoords.push_back( srcTexCoords.getY1() );
+		quads.mTexCoords.push_back( srcTexCoords.getX1() ); quads.mTexCoords.push_back( srcTexCoords.getY1() );
+		quads.mTexCoords.push_back( srcTexCoords.getX2() ); quads.mTexCoords.push_back( srcTexCoords.getY2() );
+		quads.mTexCoords.push_back( srcTexCoords.getX1() ); quads.mTexCoords.push_back( srcTexCoords.getY2() );
 
-			if( ! colors.empty() ) {
-				for( int i = 0; i < 4; ++i )
-					vertColors.push_back( colors[glyphIt-glyphMeasures.begin()] );
-			}
-			
-			indices.push_back( curIdx + 0 ); indices.push_back( curIdx + 1 ); indices.push_back( curIdx + 2 );
-			indices.push_back( curIdx + 2 ); indices.push_back( curIdx + 1 ); indices.push_back( curIdx + 3 );
-			curIdx += 4;
-		}
-		
-		if( curIdx == 0 )
-			continue;
-		
-		curTex.bind();
-		glVertexPointer( 2, GL_FLOAT, 0, &verts[0] );
-		glTexCoordPointer( 2, GL_FLOAT, 0, &texCoords[0] );
 		if( ! colors.empty() )
-			glColorPointer( 4, GL_UNSIGNED_BYTE, 0, &vertColors[0] );
-		glDrawElements( GL_TRIANGLES, indices.size(), indexType, &indices[0] );
+			quads.mColors.insert( quads.mColors.end(), 4, colors[glyphIt-glyphMeasures.begin()] );
 	}
 }
 
+void TextureFont::drawQuads( const vector<Quads> &quads, bool useColors )
+{
+	if( mTextures.empty() )
+		return;
+
+	SaveTextureBindState saveBindState( mTextures[0].getTarget() );
+	BoolState saveEnabledState( mTextures[0].getTarget() );
+	ClientBoolState vertexArrayState( GL_VERTEX_ARRAY );
+	ClientBoolState colorArrayState( GL_COLOR_ARRAY );
+	ClientBoolState texCoordArrayState( GL_TEXTURE_COORD_ARRAY );	
+	gl::enable( mTextures[0].getTarget() );
+
+	glEnableClientState( GL_VERTEX_ARRAY );
+	if( useColors )
+		glEnableClientState( GL_COLOR_ARRAY );
+	else
+		glDisableClientState( GL_COLOR_ARRAY );
+	glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+	for( size_t texIdx = 0; texIdx < std::min( quads.size(), mTextures.size() ); ++texIdx ) {
+		const Quads &texQuads = quads[texIdx];
+		const size_t numQuads = texQuads.mVerts.size() / 8;
+		if( numQuads == 0 )
+			continue;
+
+		mTextures[texIdx].bind();
+		const QuadIndex *indices = getQuadIndices( std::min( numQuads, MAX_QUADS_PER_DRAW ) );
+		for( size_t firstQuad = 0; firstQuad < numQuads; firstQuad += MAX_QUADS_PER_DRAW ) {
+			const size_t drawQuads = std::min( numQuads - firstQuad, MAX_QUADS_PER_DRAW );
+			glVertexPointer( 2, GL_FLOAT, 0, &texQuads.mVerts[firstQuad * 8] );
+			glTexCoordPointer( 2, GL_FLOAT, 0, &texQuads.mTexCoords[firstQuad * 8] );
+			if( useColors )
+				glColorPointer( 4, GL_UNSIGNED_BYTE, 0, &texQuads.mColors[firstQuad * 4] );
+			glDrawElements( GL_TRIANGLES, (GLsizei)( drawQuads * 6 ), QUAD_INDEX_TYPE, indices );
+		}
+	}
+}
+
+void TextureFont::drawGlyphs( const vector<pair<uint16_t,Vec2f> > &glyphMeasures, const Vec2f &baseline, const DrawOptions &options, const std::vector<ColorA8u> &colors )
+{
+	if( mTextures.empty() )
+		return;
+
+	if( ! colors.empty() )
+		assert( glyphMeasures.size() == colors.size() );
+
+	vector<Quads> quads;
+	appendQuads( glyphMeasures, calcBaselineOffset( baseline, options ), 0, options, colors, &quads );
+	drawQuads( quads, ! colors.empty() );
+}
+
+void TextureFont::drawGlyphs( const std::vector<std::pair<uint16_t,Vec2f> > &glyphMeasures, const Rectf &clip, Vec2f offset, const DrawOptions &options, const std::vector<ColorA8u> &colors )
+{
+	if( mTextures.empty() )
+		return;
+
+	if( ! colors.empty() )
+		assert( glyphMeasures.size() == colors.size() );
+
+	vector<Quads> quads;
+	appendQuads( glyphMeasures, offset, &clip, options, colors, &quads );
+	drawQuads( quads, ! colors.empty() );
+}
+
 void TextureFont::drawString( const std::string &str, const Vec2f &baseline, const DrawOptions &options )
 {
 	TextBox tbox = TextBox().font( mFont ).text( str ).size( TextBox::GROW, TextBox::GROW ).ligate( options.getLigate() );
@@ -540,4 +676,178 @@ vector<pair<uint16_t,Vec2f> > TextureFont::getGlyphPlacements( const std::string
 	return tbox.measureGlyphs();
 }
 
+bool TextureFont::update( Layout *layout ) const
+{
+	if( layout->mTextureFont != this ) {
+		layout->mTextureFont = this;
+		layout->mPlacementsDirty = true;
+	}
+	if( ! layout->isDirty() )
+		return false;
+
+	const DrawOptions &options = layout->mOptions;
+	if( layout->mPlacementsDirty ) {
+		TextBox tbox = TextBox().font( mFont ).text( layout->mText ).ligate( options.getLigate() );
+		if( layout->mMode == Layout::FIT )
+			tbox.size( TextBox::GROW, (int)layout->mFitRect.getHeight() );
+		else if( layout->mMode == Layout::FIT_WRAPPED )
+			tbox.size( (int)layout->mFitRect.getWidth(), (int)layout->mFitRect.getHeight() );
+		else
+			tbox.size( TextBox::GROW, TextBox::GROW );
+		layout->mPlacements = tbox.measureGlyphs();
+		layout->mPlacementsDirty = false;
+	}
+
+	// retain the storage of the previous quads
+	for( vector<Quads>::iterator quadsIt = layout->mQuads.begin(); quadsIt != layout->mQuads.end(); ++quadsIt ) {
+		quadsIt->mVerts.clear();
+		quadsIt->mTexCoords.clear();
+		quadsIt->mColors.clear();
+	}
+
+	vector<ColorA8u> colors;
+	if( layout->mHasColor )
+		colors.assign( layout->mPlacements.size(), layout->mColor );
+	if( layout->mMode == Layout::FIT ) {
+		appendQuads( layout->mPlacements, layout->mFitRect.getUpperLeft() + layout->mOffset, &layout->mFitRect, options, colors, &layout->mQuads );
+	}
+	else {
+		Vec2f baseline = ( layout->mMode == Layout::FIT_WRAPPED ) ? layout->mFitRect.getUpperLeft() + layout->mOffset : layout->mBaseline;
+		appendQuads( layout->mPlacements, calcBaselineOffset( baseline, options ), 0, options, colors, &layout->mQuads );
+	}
+	layout->mQuadsDirty = false;
+
+	return true;
+}
+
+void TextureFont::drawLayout( Layout *layout )
+{
+	update( layout );
+	drawQuads( layout->mQuads, layout->mHasColor );
+}
+
+void TextureFont::drawBatch( const Batch &batch )
+{
+	drawQuads( batch.mQuads, batch.mHasColors );
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// TextureFont::Layout
+TextureFont::Layout::Layout()
+	: mMode( BASELINE ), mBaseline( Vec2f::zero() ), mOffset( Vec2f::zero() ), mFitRect( 0, 0, 0, 0 ), mHasColor( false ),
+	mTextureFont( 0 ), mPlacementsDirty( true ), mQuadsDirty( true )
+{
+}
+
+TextureFont::Layout& TextureFont::Layout::text( const std::string &str )
+{
+	if( str != mText ) {
+		mText = str;
+		mPlacementsDirty = true;
+	}
+	return *this;
+}
+
+TextureFont::Layout& TextureFont::Layout::baseline( const Vec2f &baseline )
+{
+	if( mMode != BASELINE ) {
+		mMode = BASELINE;
+		mPlacementsDirty = true;
+	}
+	if( baseline != mBaseline ) {
+		mBaseline = baseline;
+		mQuadsDirty = true;
+	}
+	return *this;
+}
+
+TextureFont::Layout& TextureFont::Layout::fit( const Rectf &fitRect, const Vec2f &offset, bool wrap )
+{
+	Mode mode = wrap ? FIT_WRAPPED : FIT;
+	// line breaking depends only on the size of the fit rect, not its position
+	if( mode != mMode || fitRect.getWidth() != mFitRect.getWidth() || fitRect.getHeight() != mFitRect.getHeight() ) {
+		mMode = mode;
+		mPlacementsDirty = true;
+	}
+	if( fitRect.getUpperLeft() != mFitRect.getUpperLeft() || fitRect.getLowerRight() != mFitRect.getLowerRight() || offset != mOffset ) {
+		mFitRect = fitRect;
+		mOffset = offset;
+		mQuadsDirty = true;
+	}
+	return *this;
+}
+
+TextureFont::Layout& TextureFont::Layout::options( const DrawOptions &options )
+{
+	if( options.getLigate() != mOptions.getLigate() )
+		mPlacementsDirty = true;
+	if( options.getScale() != mOptions.getScale() || options.getPixelSnap() != mOptions.getPixelSnap()
+		|| options.getClipHorizontal() != mOptions.getClipHorizontal() || options.getClipVertical() != mOptions.getClipVertical() )
+		mQuadsDirty = true;
+	mOptions = options;
+	return *this;
+}
+
+TextureFont::Layout& TextureFont::Layout::color( const ColorA8u &color )
+{
+	if( ( ! mHasColor ) || color != mColor ) {
+		mHasColor = true;
+		mColor = color;
+		mQuadsDirty = true;
+	}
+	return *this;
+}
+
+size_t TextureFont::Layout::getNumQuads() const
+{
+	size_t result = 0;
+	for( vector<Quads>::const_iterator quadsIt = mQuads.begin(); quadsIt != mQuads.end(); ++quadsIt )
+		result += quadsIt->mVerts.size() / 8;
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// TextureFont::Batch
+void TextureFont::Batch::clear()
+{
+	for( vector<Quads>::iterator quadsIt = mQuads.begin(); quadsIt != mQuads.end(); ++quadsIt ) {
+		quadsIt->mVerts.clear();
+		quadsIt->mTexCoords.clear();
+		quadsIt->mColors.clear();
+	}
+	mHasColors = false;
+}
+
+void TextureFont::Batch::append( const Layout &layout )
+{
+	if( mQuads.size() < layout.mQuads.size() )
+		mQuads.resize( layout.mQuads.size() );
+
+	// the first colored layout gives every quad batched so far a color
+	if( layout.mHasColor && ! mHasColors ) {
+		for( vector<Quads>::iterator quadsIt = mQuads.begin(); quadsIt != mQuads.end(); ++quadsIt )
+			quadsIt->mColors.resize( quadsIt->mVerts.size() / 2, ColorA8u( 255, 255, 255, 255 ) );
+		mHasColors = true;
+	}
+
+	for( size_t texIdx = 0; texIdx < layout.mQuads.size(); ++texIdx ) {
+		const Quads &src = layout.mQuads[texIdx];
+		Quads &dst = mQuads[texIdx];
+		dst.mVerts.insert( dst.mVerts.end(), src.mVerts.begin(), src.mVerts.end() );
+		dst.mTexCoords.insert( dst.mTexCoords.end(), src.mTexCoords.begin(), src.mTexCoords.end() );
+		if( layout.mHasColor )
+			dst.mColors.insert( dst.mColors.end(), src.mColors.begin(), src.mColors.end() );
+		else if( mHasColors )
+			dst.mColors.resize( dst.mVerts.size() / 2, ColorA8u( 255, 255, 255, 255 ) );
+	}
+}
+
+size_t TextureFont::Batch::getNumQuads() const
+{
+	size_t result = 0;
+	for( vector<Quads>::const_iterator quadsIt = mQuads.begin(); quadsIt != mQuads.end(); ++quadsIt )
+		result += quadsIt->mVerts.size() / 8;
+	return result;
+}
+
 } } // namespace cinder::gl
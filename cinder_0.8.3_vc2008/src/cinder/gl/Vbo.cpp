@@ -21,6 +21,7 @@
 */
 
 #include "cinder/gl/Vbo.h"
+#include "cinder/TriMeshOptimizer.h"
 #include <sstream>
 
 using namespace std;
@@ -104,9 +105,16 @@ bool VboMesh::Layout::hasDynamicTexCoords() const
 }
 
 
-VboMesh::VboMesh( const TriMesh &triMesh, Layout layout )
+VboMesh::VboMesh( const TriMesh &sourceMesh, Layout layout )
 	: mObj( shared_ptr<Obj>( new Obj ) )
 {
+	TriMesh optimizedMesh;
+	if( layout.getOptimizeVertexCache() ) {
+		optimizedMesh = sourceMesh;
+		optimizeTriMesh( &optimizedMesh );
+	}
+	const TriMesh &triMesh = layout.getOptimizeVertexCache() ? optimizedMesh : sourceMesh;
+
 	if( layout.isDefaults() ) { // we need to start by preparing our layout
 		if( triMesh.hasNormals() )
 			mObj->mLayout.setStaticNormals();
@@ -27,9 +27,15 @@
 #include "cinder/ImageIo.h"
 #include "cinder/Base64.h"
 #include "cinder/Text.h"
+#include "cinder/Thread.h"
+#include "cinder/Timer.h"
+#include "cinder/Triangulate.h"
 
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/case_conv.hpp>
+#include <algorithm>
+#include <ostream>
+#include <typeinfo>
 	
 using namespace std;
 
@@ -215,6 +221,47 @@ vector<string> readStringList( const std::string &s, bool stripQuotes = false )
 	return result;
 }
 
+// Returns the SVG element name corresponding to the type of 'node', used to key DocStats
+const char* getNodeTypeName( const Node &node )
+{
+	const std::type_info &type = typeid( node );
+	if( type == typeid(Path) ) return "path";
+	else if( type == typeid(Group) ) return "g";
+	else if( type == typeid(Polygon) ) return "polygon";
+	else if( type == typeid(Polyline) ) return "polyline";
+	else if( type == typeid(Line) ) return "line";
+	else if( type == typeid(Rect) ) return "rect";
+	else if( type == typeid(Circle) ) return "circle";
+	else if( type == typeid(Ellipse) ) return "ellipse";
+	else if( type == typeid(Use) ) return "use";
+	else if( type == typeid(Image) ) return "image";
+	else if( type == typeid(Text) ) return "text";
+	else if( type == typeid(TextSpan) ) return "tspan";
+	else if( type == typeid(Doc) ) return "svg";
+	else return "other";
+}
+
+// Counts the elements beneath 'xml' and the <g> elements directly beneath it, and reports whether the subtree contains an <image>
+void scanSubtree( const XmlTree &xml, size_t *numElements, size_t *numChildGroups, bool *containsImage )
+{
+	for( XmlTree::ConstIter childIt = xml.begin(); childIt != xml.end(); ++childIt ) {
+		if( ! childIt->isElement() || childIt->getTag().empty() )
+			continue;
+		++*numElements;
+		if( numChildGroups && childIt->getTag() == "g" )
+			++*numChildGroups;
+		if( childIt->getTag() == "image" )
+			*containsImage = true;
+		scanSubtree( *childIt, numElements, 0, containsImage );
+	}
+}
+
+// Guards Doc::mStats against nodes tessellated lazily from several threads
+std::mutex sStatsMutex;
+
+// Initialized statically rather than on first use, since styles are resolved from several threads while parsing
+const vector<string> sFontFamiliesDefault( 1, "Arial" );
+
 } // anonymous namespace
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -354,13 +401,7 @@ void Style::clear()
 
 const std::vector<std::string>&	Style::getFontFamiliesDefault()
 {
-	static shared_ptr<vector<string> > sDefault;
-	if( ! sDefault ) {
-		sDefault = shared_ptr<vector<string> >( new vector<string>() );
-		sDefault->push_back( "Arial" );
-	}
-	
-	return *sDefault;
+	return sFontFamiliesDefault;
 }
 
 void Style::parseStyleAttribute( const std::string &stylePropertyString, const Node *parent )
@@ -1012,6 +1053,117 @@ MatrixAffine2f Node::getTransformAbsolute() const
 	return result;
 }
 
+struct Node::GeometryCache {
+	GeometryCache() : mHasFillMesh( false ), mHasOutlines( false ) {}
+
+	bool					mHasFillMesh, mHasOutlines;
+	FillRule				mFillRule;
+	float					mFillApproximationScale, mOutlineApproximationScale;
+	TriMesh2d				mFillMesh;
+	std::vector<PolyLine2f>	mOutlines;
+};
+
+const TriMesh2d& Node::getFillMesh( FillRule fillRule, float approximationScale ) const
+{
+	if( ! mGeometryCache || ! mGeometryCache->mHasFillMesh || mGeometryCache->mFillRule != fillRule || mGeometryCache->mFillApproximationScale != approximationScale ) {
+		Timer timer( true );
+		DocStats stats;
+		cacheFillMesh( fillRule, approximationScale, &stats );
+		Doc *doc = getDoc();
+		if( doc )
+			doc->addTessellateStats( stats, timer.getSeconds() );
+	}
+	return mGeometryCache->mFillMesh;
+}
+
+const std::vector<PolyLine2f>& Node::getOutlines( float approximationScale ) const
+{
+	if( ! mGeometryCache || ! mGeometryCache->mHasOutlines || mGeometryCache->mOutlineApproximationScale != approximationScale ) {
+		Timer timer( true );
+		DocStats stats;
+		cacheOutlines( approximationScale, &stats );
+		Doc *doc = getDoc();
+		if( doc )
+			doc->addTessellateStats( stats, timer.getSeconds() );
+	}
+	return mGeometryCache->mOutlines;
+}
+
+void Node::cacheFillMesh( FillRule fillRule, float approximationScale, DocStats *stats ) const
+{
+	Timer timer( true );
+	if( ! mGeometryCache )
+		mGeometryCache = shared_ptr<GeometryCache>( new GeometryCache );
+
+	Shape2d shape = getShape();
+	mGeometryCache->mFillMesh.clear();
+	if( ! shape.getContours().empty() ) {
+		Triangulator::Winding winding = ( fillRule == FILL_RULE_NONZERO ) ? Triangulator::WINDING_NONZERO : Triangulator::WINDING_ODD;
+		mGeometryCache->mFillMesh = Triangulator( shape, approximationScale ).calcMesh( winding );
+	}
+	mGeometryCache->mHasFillMesh = true;
+	mGeometryCache->mFillRule = fillRule;
+	mGeometryCache->mFillApproximationScale = approximationScale;
+	if( stats )
+		stats->addTessellate( getNodeTypeName( *this ), timer.getSeconds() );
+}
+
+void Node::cacheOutlines( float approximationScale, DocStats *stats ) const
+{
+	Timer timer( true );
+	if( ! mGeometryCache )
+		mGeometryCache = shared_ptr<GeometryCache>( new GeometryCache );
+
+	Shape2d shape = getShape();
+	mGeometryCache->mOutlines.clear();
+	for( vector<Path2d>::const_iterator contourIt = shape.getContours().begin(); contourIt != shape.getContours().end(); ++contourIt ) {
+		if( contourIt->getNumSegments() == 0 )
+			continue;
+		mGeometryCache->mOutlines.push_back( PolyLine2f( contourIt->subdivide( approximationScale ) ) );
+	}
+	mGeometryCache->mHasOutlines = true;
+	mGeometryCache->mOutlineApproximationScale = approximationScale;
+	if( stats )
+		stats->addTessellate( getNodeTypeName( *this ), timer.getSeconds() );
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// DocStats
+void DocStats::addParse( const std::string &nodeType, double seconds )
+{
+	NodeType &entry = mNodeTypes[nodeType];
+	++entry.mNumParsed;
+	entry.mParseSeconds += seconds;
+}
+
+void DocStats::addTessellate( const std::string &nodeType, double seconds )
+{
+	NodeType &entry = mNodeTypes[nodeType];
+	++entry.mNumTessellated;
+	entry.mTessellateSeconds += seconds;
+}
+
+void DocStats::appendNodeTypes( const DocStats &rhs )
+{
+	for( map<string,NodeType>::const_iterator typeIt = rhs.mNodeTypes.begin(); typeIt != rhs.mNodeTypes.end(); ++typeIt ) {
+		NodeType &entry = mNodeTypes[typeIt->first];
+		entry.mNumParsed += typeIt->second.mNumParsed;
+		entry.mParseSeconds += typeIt->second.mParseSeconds;
+		entry.mNumTessellated += typeIt->second.mNumTessellated;
+		entry.mTessellateSeconds += typeIt->second.mTessellateSeconds;
+	}
+}
+
+std::ostream& operator<<( std::ostream &out, const DocStats &stats )
+{
+	out << "xml: " << stats.getXmlSeconds() << "s parse: " << stats.getParseSeconds() << "s tessellate: " << stats.getTessellateSeconds() << "s" << std::endl;
+	for( map<string,DocStats::NodeType>::const_iterator typeIt = stats.getNodeTypes().begin(); typeIt != stats.getNodeTypes().end(); ++typeIt ) {
+		out << "  " << typeIt->first << ": " << typeIt->second.mNumParsed << " parsed in " << typeIt->second.mParseSeconds << "s, "
+			<< typeIt->second.mNumTessellated << " tessellated in " << typeIt->second.mTessellateSeconds << "s" << std::endl;
+	}
+	return out;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 // Gradient
 Gradient::Gradient( const Node *parent, const XmlTree &xml )
@@ -1657,6 +1809,13 @@ Group::Group( const Node *parent, const XmlTree &xml )
 	parse( xml );
 }
 
+Group::Group( const Node *parent, const XmlTree &xml, bool parseChildren )
+	: Node( parent, xml )
+{
+	if( parseChildren )
+		parse( xml );
+}
+
 Group::~Group()
 {
 	for( list<Node*>::iterator childIt = mChildren.begin(); childIt != mChildren.end(); ++childIt )
@@ -1665,35 +1824,156 @@ Group::~Group()
 
 void Group::parse( const XmlTree &xml )
 {
+	parse( xml, 0, 0 );
+}
+
+struct Group::PendingGroup {
+	Group			*mGroup;
+	const XmlTree	*mXml;
+	size_t			mNumElements, mNumChildGroups;
+
+	bool operator<( const PendingGroup &rhs ) const { return mNumElements > rhs.mNumElements; } // heaviest first
+};
+
+/* Every child of this group is created before any child <g> is descended into, so that a reference from inside a subtree
+	always sees all of its ancestors' children, whether the subtree is parsed here or on another thread. */
+void Group::parse( const XmlTree &xml, DocStats *stats, PendingGroups *pending )
+{
+	vector<std::pair<Group*,const XmlTree*> > childGroups;
 	for( XmlTree::ConstIter treeIt = xml.begin(); treeIt != xml.end(); ++treeIt ) {
+		Node *child = parseChild( *treeIt, stats );
+		if( ! child )
+			continue;
+		if( treeIt->getTag() == "defs" )
+			mDefs = shared_ptr<Group>( static_cast<Group*>( child ) );
+		else
+			mChildren.push_back( child );
 		if( treeIt->getTag() == "g" )
-			mChildren.push_back( new Group( this, *treeIt ) );
-		else if( treeIt->getTag() == "path" )
-			mChildren.push_back( new Path( this, *treeIt ) );
-		else if( treeIt->getTag() == "polygon" )
-			mChildren.push_back( new Polygon( this, *treeIt ) );
-		else if( treeIt->getTag() == "polyline" )
-			mChildren.push_back( new Polyline( this, *treeIt ) );
-		else if( treeIt->getTag() == "line" )
-			mChildren.push_back( new Line( this, *treeIt ) );
-		else if( treeIt->getTag() == "rect" )
-			mChildren.push_back( new Rect( this, *treeIt ) );
-		else if( treeIt->getTag() == "circle" )
-			mChildren.push_back( new Circle( this, *treeIt ) );
-		else if( treeIt->getTag() == "ellipse" )
-			mChildren.push_back( new Ellipse( this, *treeIt ) );
-		else if( treeIt->getTag() == "use" )
-			mChildren.push_back( new Use( this, *treeIt ) );
-		else if( treeIt->getTag() == "defs" )
-			mDefs = shared_ptr<Group>( new Group( this, *treeIt ) );
-		else if( treeIt->getTag() == "image" )
-			mChildren.push_back( new Image( this, *treeIt ) );
-		else if( treeIt->getTag() == "linearGradient" )
-			mChildren.push_back( new LinearGradient( this, *treeIt ) );
-		else if( treeIt->getTag() == "radialGradient" )
-			mChildren.push_back( new RadialGradient( this, *treeIt ) );
-		else if( treeIt->getTag() == "text" )
-			mChildren.push_back( new Text( this, *treeIt ) );
+			childGroups.push_back( std::make_pair( static_cast<Group*>( child ), &*treeIt ) );
+	}
+
+	// Subtrees with images stay on this thread because image decoding may depend on per-thread state, such as COM on MSW
+	for( size_t g = 0; g < childGroups.size(); ++g ) {
+		PendingGroup pendingGroup = { childGroups[g].first, childGroups[g].second, 0, 0 };
+		bool containsImage = false;
+		if( pending )
+			scanSubtree( *pendingGroup.mXml, &pendingGroup.mNumElements, &pendingGroup.mNumChildGroups, &containsImage );
+		if( pending && ! containsImage )
+			pending->push_back( pendingGroup );
+		else
+			pendingGroup.mGroup->parse( *pendingGroup.mXml, stats, pending );
+	}
+}
+
+Node* Group::parseChild( const XmlTree &xml, DocStats *stats )
+{
+	const string &tag = xml.getTag();
+	Timer timer( stats != 0 );
+	Node *result;
+	Group *group = 0;
+	if( tag == "g" || tag == "defs" )
+		result = group = new Group( this, xml, false );
+	else if( tag == "path" )
+		result = new Path( this, xml );
+	else if( tag == "polygon" )
+		result = new Polygon( this, xml );
+	else if( tag == "polyline" )
+		result = new Polyline( this, xml );
+	else if( tag == "line" )
+		result = new Line( this, xml );
+	else if( tag == "rect" )
+		result = new Rect( this, xml );
+	else if( tag == "circle" )
+		result = new Circle( this, xml );
+	else if( tag == "ellipse" )
+		result = new Ellipse( this, xml );
+	else if( tag == "use" )
+		result = new Use( this, xml );
+	else if( tag == "image" )
+		result = new Image( this, xml );
+	else if( tag == "linearGradient" )
+		result = new LinearGradient( this, xml );
+	else if( tag == "radialGradient" )
+		result = new RadialGradient( this, xml );
+	else if( tag == "text" )
+		result = new Text( this, xml );
+	else
+		return 0;
+
+	if( stats )
+		stats->addParse( tag, timer.getSeconds() );
+
+	// a group's own timing covers only its attributes; its children are timed individually. Defs are completed
+	// immediately since later siblings may refer to their contents; <g> children are left to the caller.
+	if( group && tag == "defs" )
+		group->parse( xml, stats, 0 );
+
+	return result;
+}
+
+struct Group::ParseTask {
+	ParseTask( PendingGroups *pending, DocStats *stats, std::mutex *mutex )
+		: mPending( pending ), mStats( stats ), mMutex( mutex )
+	{}
+
+	void operator()( size_t begin, size_t end ) const
+	{
+		DocStats stats;
+		for( size_t i = begin; i < end; ++i ) {
+			const PendingGroup &pendingGroup = (*mPending)[i];
+			pendingGroup.mGroup->parse( *pendingGroup.mXml, mStats ? &stats : 0, 0 );
+		}
+		if( mStats ) {
+			std::lock_guard<std::mutex> lock( *mMutex );
+			mStats->appendNodeTypes( stats );
+		}
+	}
+
+	PendingGroups	*mPending;
+	DocStats		*mStats;
+	std::mutex		*mMutex;
+};
+
+/* Sibling <g> subtrees are independent while being parsed: lookups by id only ever read a node's ancestors, their
+	immediate children and their defs, all of which are complete before any subtree is handed to another thread.
+	Since parse() builds a whole level before descending, what a lookup sees doesn't depend on how far the tree was
+	expanded here, so the result is the same for any number of threads.
+	The groups nearest the root are created on this thread, in document order, with their children left pending.
+	While one pending group holds a large share of the remaining elements it is expanded in turn, so that a single
+	wrapping <g> doesn't serialize the document. The remaining groups are then parsed in parallel, heaviest first. */
+void Group::parseParallel( const XmlTree &xml, DocStats *stats )
+{
+	const size_t numThreads = std::max<size_t>( 1, std::thread::hardware_concurrency() );
+	PendingGroups pending;
+	parse( xml, stats, &pending );
+
+	for( ;; ) {
+		size_t totalElements = 0, heaviest = 0;
+		for( size_t i = 0; i < pending.size(); ++i ) {
+			totalElements += pending[i].mNumElements;
+			if( pending[i].mNumElements > pending[heaviest].mNumElements )
+				heaviest = i;
+		}
+		if( pending.empty() || pending[heaviest].mNumChildGroups < 2 || pending[heaviest].mNumElements * numThreads * 2 <= totalElements )
+			break;
+		PendingGroup expanded = pending[heaviest];
+		pending.erase( pending.begin() + heaviest );
+		expanded.mGroup->parse( *expanded.mXml, stats, &pending );
+	}
+
+	std::sort( pending.begin(), pending.end() );
+	std::mutex mutex;
+	parallelFor( pending.size(), ParseTask( &pending, stats, &mutex ), 1 );
+}
+
+void Group::collectNodes( std::vector<const Node*> *result ) const
+{
+	if( mDefs )
+		mDefs->collectNodes( result );
+	for( list<Node*>::const_iterator childIt = mChildren.begin(); childIt != mChildren.end(); ++childIt ) {
+		result->push_back( *childIt );
+		if( typeid(**childIt) == typeid(Group) )
+			static_cast<const Group*>( *childIt )->collectNodes( result );
 	}
 }
 
@@ -2148,7 +2428,10 @@ void Doc::loadDoc( DataSourceRef source, fs::path filePath )
 {
 	if( ! filePath.empty() )
 		mFilePath = filePath.parent_path();
+	mStats.clear();
+	Timer xmlTimer( true );
 	mXmlTree = shared_ptr<XmlTree>( new XmlTree( source, XmlTree::ParseOptions().ignoreDataChildren( false ) ) );
+	mStats.mXmlSeconds = xmlTimer.getSeconds();
 
 	const XmlTree &xml( mXmlTree->getChild( "svg" ) );
 
@@ -2194,7 +2477,9 @@ void Doc::loadDoc( DataSourceRef source, fs::path filePath )
 		mTransform.setToIdentity();
 
 	// we can't parse the group w/o having parsed the viewBox, dimensions, etc, so we have to do this manually:
-	Group::parse( xml );
+	Timer timer( true );
+	parseParallel( xml, &mStats );
+	mStats.mParseSeconds = timer.getSeconds();
 }
 
 shared_ptr<Surface8u> Doc::loadImage( fs::path relativePath )
@@ -2225,6 +2510,69 @@ void Doc::renderSelf( Renderer &renderer ) const
 	Group::renderSelf( renderer );
 }
 
+struct Doc::IsNotText {
+	bool operator()( const Node *node ) const { return ! dynamic_cast<const Text*>( node ) && ! dynamic_cast<const TextSpan*>( node ); }
+};
+
+struct Doc::CacheTask {
+	CacheTask( const vector<const Node*> *nodes, float approximationScale, DocStats *stats, std::mutex *mutex )
+		: mNodes( nodes ), mApproximationScale( approximationScale ), mStats( stats ), mMutex( mutex )
+	{}
+
+	void operator()( size_t begin, size_t end ) const
+	{
+		DocStats stats;
+		Doc::cacheNodes( &(*mNodes)[begin], end - begin, mApproximationScale, &stats );
+		std::lock_guard<std::mutex> lock( *mMutex );
+		mStats->appendNodeTypes( stats );
+	}
+
+	const vector<const Node*>	*mNodes;
+	float						mApproximationScale;
+	DocStats					*mStats;
+	std::mutex					*mMutex;
+};
+
+void Doc::cacheNodes( const Node * const *nodes, size_t count, float approximationScale, DocStats *stats )
+{
+	for( size_t i = 0; i < count; ++i ) {
+		const Node *node = nodes[i];
+		if( ! node->isDrawable() )
+			continue;
+		if( ! node->getFill().isNone() )
+			node->cacheFillMesh( node->getFillRule(), approximationScale, stats );
+		if( ! node->getStroke().isNone() )
+			node->cacheOutlines( approximationScale, stats );
+	}
+}
+
+void Doc::cacheGeometry( float approximationScale ) const
+{
+	Timer timer( true );
+	vector<const Node*> nodes;
+	collectNodes( &nodes );
+
+	// text shapes come from Fonts, which on MSW share a single device context, so text stays on this thread like <image>
+	vector<const Node*> textNodes;
+	vector<const Node*>::iterator textBegin = std::stable_partition( nodes.begin(), nodes.end(), IsNotText() );
+	textNodes.assign( textBegin, nodes.end() );
+	nodes.erase( textBegin, nodes.end() );
+
+	DocStats stats;
+	std::mutex mutex;
+	parallelFor( nodes.size(), CacheTask( &nodes, approximationScale, &stats, &mutex ), 64 );
+	if( ! textNodes.empty() )
+		cacheNodes( &textNodes[0], textNodes.size(), approximationScale, &stats );
+	addTessellateStats( stats, timer.getSeconds() );
+}
+
+void Doc::addTessellateStats( const DocStats &stats, double seconds ) const
+{
+	std::lock_guard<std::mutex> lock( sStatsMutex );
+	mStats.appendNodeTypes( stats );
+	mStats.mTessellateSeconds += seconds;
+}
+
 ExcChildNotFound::ExcChildNotFound( const string &child ) throw()
 {
 	sprintf( mMessage, "Could not find child: %s", child.c_str() );
@@ -506,6 +506,8 @@ TESStesselator* tessNewTess( TESSalloc* alloc )
 
 	tess->windingRule = TESS_WINDING_ODD;
 
+	tess->outOfMemory = 0;
+
 	tess->callCombine = &noCombine;
 
 	if (tess->alloc.regionBucketSize < 16)